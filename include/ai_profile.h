@@ -0,0 +1,34 @@
+#ifndef AI_PROFILE_H
+#define AI_PROFILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "pong_sim.h"
+
+// Tipos de controlador automático disponibles para las paletas
+enum class AIKind {
+    CHASE,      // sigue la Y de la pelota (cpuPlayerAThread / cpuPlayerBThread)
+    PREDICT     // predice el punto de llegada con reflejos (ai_opponent_thread)
+};
+
+struct AIProfile {
+    std::string name;
+    AIKind kind;
+    float difficulty;   // 0..1, igual que ai_difficulty: menor -> mayor margen de error
+    float jitter;       // probabilidad de no reaccionar en un tick
+};
+
+// Cada controlador tira su jitter con un flujo aleatorio propio, sembrado con la
+// semilla de la partida y el lado: el RNG de la partida (que decide los saques) no
+// depende de qué perfiles juegan.
+uint32_t aiSeed(uint32_t matchSeed, int side);
+
+// Decide el movimiento de la paleta del lado indicado (1 = izquierda, 2 = derecha);
+// rng es el flujo del controlador (aiSeed) y avanza en cada tirada
+int aiDecide(const AIProfile& profile, const SimState& state, int side, uint32_t& rng);
+
+std::vector<AIProfile> defaultRoster();
+bool loadRoster(const std::string& path, std::vector<AIProfile>& roster);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef ALLOC_GUARD_H
+#define ALLOC_GUARD_H
+
+#include <cstdint>
+
+// Contador global de reservas de memoria: alloc_guard.cpp reemplaza operator new
+// (todas sus variantes) y cuenta cada llamada, en cualquier hilo.
+uint64_t allocationCount();
+
+// Reservas por frame en estado estable: los primeros WARMUP_FRAMES no cuentan
+// (buffers que crecen hasta su tamaño final, hilos que arrancan)
+class FrameAllocationProbe {
+public:
+    static const uint64_t WARMUP_FRAMES = 60;
+
+    FrameAllocationProbe() { reset(); }
+    void reset();
+    void mark();        // llamar una vez por frame pintado
+    uint64_t steadyFrames() const { return frames > WARMUP_FRAMES ? frames - WARMUP_FRAMES : 0; }
+    uint64_t steadyAllocations() const { return allocations; }
+    uint64_t worstFrame() const { return worst; }
+
+private:
+    uint64_t last;
+    uint64_t frames;
+    uint64_t allocations;
+    uint64_t worst;
+};
+
+#endif
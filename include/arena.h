@@ -0,0 +1,16 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+// Servidor de arena: muchas partidas (jugador vs CPU) en un solo proceso. Cada
+// sesión vive en su propio pseudo-terminal o conexión de socket Unix; la simulación
+// y el pintado de todas las sesiones se reparten en un WorkStealingPool compartido
+// en lugar de usar 3-5 hilos propios por partida.
+//
+// Sin --attach ni --socket corre como prueba de carga: un proceso hijo hace de
+// clientes (lee los frames y manda teclas) y se reporta la latencia de tick por
+// sesión y el CPU total del servidor.
+// Uso: ./Pong --arena [--sessions N] [--threads T] [--duration S] [--scaling]
+//                     [--attach] [--socket RUTA]
+int runArena(int argc, char* argv[]);
+
+#endif
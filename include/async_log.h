@@ -0,0 +1,49 @@
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+#include <cstdint>
+#include <string>
+
+// Registro asíncrono de mensajes (errores, avisos, estado). Cada hilo escribe en su
+// propio anillo de registros de tamaño fijo sin candados (un productor, un
+// consumidor); un hilo aparte los vacía al archivo en lotes de pocos milisegundos,
+// ordenados por tiempo, con nivel, segundos desde la apertura y el id del hilo. Sin
+// mensajes ese hilo duerme sin despertares periódicos. Registrar un mensaje no reserva
+// memoria y no espera; solo el primero tras un silencio hace una llamada al sistema
+// (despertar al escritor). Con el anillo lleno el mensaje se descarta y se cuenta.
+// Nunca escribe en el stdout del juego.
+//
+// Sin logOpen() (herramientas de línea de comandos) los mensajes van directo a stderr.
+
+enum LogLevel {
+    LOG_DEBUG = 0,
+    LOG_INFO,
+    LOG_WARN,
+    LOG_ERROR
+};
+
+const int LOG_MAX_THREADS = 64;         // anillos disponibles (se reciclan al terminar un hilo)
+const int LOG_RING_SLOTS = 128;         // registros por anillo
+const int LOG_TEXT_BYTES = 112;         // texto por registro (se trunca): 128 bytes en total
+
+// Abre (o agrega a) el archivo y arranca el hilo escritor; false si no se pudo abrir
+bool logOpen(const std::string& path, LogLevel minLevel);
+// Vacía lo pendiente, detiene el escritor y cierra el archivo
+void logClose();
+bool logIsOpen();
+void logSetLevel(LogLevel minLevel);
+// Interpreta "debug", "info", "warn" o "error"; false si no es un nivel
+bool logParseLevel(const char* name, LogLevel& level);
+
+// Formato printf; seguro desde cualquier hilo
+void logWrite(LogLevel level, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+uint64_t logWritten();                  // registros escritos al archivo
+uint64_t logDropped();                  // descartados por anillo lleno o sin anillo libre
+
+// Benchmark: costo por llamada con N hilos registrando a la vez, contra fprintf a un
+// archivo con candado, y registros descartados.
+// Uso: ./Pong --log-bench [--threads N] [--messages M] [--out ARCHIVO]
+int runLogBench(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef BOT_API_H
+#define BOT_API_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "latency.h"
+#include "step_kernel.h"
+
+// API de bots por memoria compartida: el juego publica el estado de cada tick en un
+// segmento POSIX (/dev/shm/pong-bot-NOMBRE) y un proceso externo, en cualquier lenguaje,
+// contesta con un movimiento por paleta en un slot de comando sin locks.
+//
+// Diseño del segmento (256 bytes, little-endian, offsets fijos):
+//   0    char[8]  "PONGBOT1"
+//   8    u32      versión (1)
+//   12   u32      ancho, 16 alto, 20 alto de paleta
+//   24   u32      plazo para contestar en us (informativo)
+//   64   u32      seq: seqlock, impar mientras el juego escribe (también es un futex)
+//   68   u32      frame: contador de publicaciones (no se reinicia entre partidas)
+//   72   u32      tick de la partida
+//   76   i32 x 8  ballX, ballY, ballSpeedX, ballSpeedY, paddle1Y, paddle2Y, scoreP1, scoreP2
+//   108  u32      estado: 1 = jugando, 2 = partida terminada, 3 = servidor cerrado
+//   112  u64      publishNs (CLOCK_MONOTONIC)
+//   128  slot P1, 192 slot P2:
+//        +0  u64  comando = (frame << 32) | (movimiento + 1), movimiento en -1..1
+//        +8  u64  sentNs del bot (CLOCK_MONOTONIC; 0 si no lo mide)
+//        +16 u32  pid del bot conectado (0 = libre)
+// Para leer el estado: seq (par), copiar, seq otra vez; si cambió, repetir. El bot
+// escribe sentNs antes que el comando; el juego solo acepta comandos del frame actual.
+
+const uint32_t BOT_STATUS_PLAYING = 1;
+const uint32_t BOT_STATUS_MATCH_OVER = 2;
+const uint32_t BOT_STATUS_CLOSED = 3;
+
+struct BotCommandSlot {
+    std::atomic<uint64_t> command;
+    std::atomic<uint64_t> sentNs;
+    std::atomic<uint32_t> botPid;
+    uint8_t reserved[44];
+};
+
+struct BotSegment {
+    char magic[8];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t paddleHeight;
+    uint32_t deadlineUs;
+    uint8_t reserved0[36];
+    std::atomic<uint32_t> seq;
+    uint32_t frame;
+    uint32_t tick;
+    int32_t ballX, ballY, ballSpeedX, ballSpeedY;
+    int32_t paddle1Y, paddle2Y, scoreP1, scoreP2;
+    uint32_t status;
+    uint64_t publishNs;
+    uint8_t reserved1[8];
+    BotCommandSlot slots[2];
+};
+
+// Estado leído por un bot (copia consistente del segmento)
+struct BotView {
+    uint32_t seq;
+    uint32_t frame;
+    uint32_t status;
+    uint64_t publishNs;
+    World world;
+};
+
+// Lado del juego: crea el segmento, publica ticks y recoge comandos
+class BotServer {
+public:
+    BotServer();
+    ~BotServer();
+    bool create(const std::string& name, uint32_t deadlineUs);
+    void close();
+    bool isOpen() const { return segment != nullptr; }
+    const std::string& path() const { return shmName; }
+
+    // Bot conectado (pid vivo) en el slot del jugador
+    bool attached(int player) const { return (attachedMask & (1u << (player - 1))) != 0; }
+    void publish(const World& world, uint32_t status);
+    // Comando del frame publicado; false si todavía no llegó
+    bool poll(int player, int& move);
+    // Espera los comandos de los bots conectados hasta deadlineNs (spin con sched_yield)
+    void waitCommands(uint64_t deadlineNs);
+    // Movimiento del bot para el frame; false (y cuenta fuera de plazo si hay bot
+    // conectado) cuando no contestó: el llamador usa la IA integrada
+    bool take(int player, int& move);
+    // Revisa qué slots tienen un bot vivo (publish lo hace cada 64 frames)
+    void refreshBots();
+    void resetStats();
+
+    uint64_t commands(int player) const { return received[player - 1]; }
+    uint64_t misses(int player) const { return missed[player - 1]; }
+    const LatencyHistogram& latency(int player) const { return responseNs[player - 1]; }
+
+private:
+    BotSegment* segment;
+    std::string shmName;
+    uint32_t frame;
+    uint64_t publishNs;
+    std::atomic<uint32_t> attachedMask;     // lo leen también los hilos de IA
+    int pendingMove[2];
+    bool pending[2];
+    uint64_t received[2];
+    uint64_t missed[2];
+    LatencyHistogram responseNs[2];     // tick publicado -> comando, en ns
+};
+
+// Lado del bot (cliente de referencia en C++)
+class BotClient {
+public:
+    BotClient();
+    ~BotClient();
+    bool open(const std::string& name, int player);
+    void close();
+    // Espera un estado nuevo (seq distinto de lastSeq); false si se acabó el tiempo
+    bool waitState(uint32_t lastSeq, BotView& view, int timeoutMs);
+    void send(uint32_t frame, int move);
+
+private:
+    BotSegment* segment;
+    int slot;
+};
+
+// Partidas bot contra bot sin terminal (o a 60 Hz con --realtime) y cliente de referencia.
+// Uso: ./Pong --bot-match [--shm NOMBRE] [--games N] [--target P] [--max-ticks T]
+//                         [--deadline-us D] [--wait-bots S] [--realtime] [--seed S]
+//      ./Pong --bot-client [--shm NOMBRE] [--player 1|2] [--delay-us D]
+int runBotMatch(int argc, char* argv[]);
+int runBotClient(int argc, char* argv[]);
+
+#endif
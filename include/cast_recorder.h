@@ -0,0 +1,83 @@
+#ifndef CAST_RECORDER_H
+#define CAST_RECORDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Grabador asciicast v2 (.cast). El hilo que pinta solo copia los bytes del frame a
+// una cola circular acotada sin candados (un productor, un consumidor); un hilo
+// aparte convierte los tiempos, arma lotes y escribe. Si el disco se atrasa y la cola
+// se llena, el frame se descarta y se cuenta: pintar nunca espera al disco.
+class CastRecorder {
+public:
+    static const int QUEUE_SLOTS = 256;
+    // Cada casilla reserva al abrir max(SLOT_RESERVE, columnas * filas * SLOT_BYTES_PER_CELL)
+    // bytes: con 4 bytes por celda entra una repintada completa con atributos. Un frame
+    // más grande reserva una vez en su casilla, que conserva esa capacidad.
+    static const size_t SLOT_RESERVE = 4096;
+    static const size_t SLOT_BYTES_PER_CELL = 4;
+
+    CastRecorder();
+    ~CastRecorder();
+
+    bool open(const std::string& path, int cols, int rows);
+    // Productor (hilo de render): copia el frame; false si la cola está llena. Si los
+    // frames son diferenciales, el siguiente que se grabe debe ser completo.
+    bool push(const char* data, size_t len);
+    // Vacía la cola, escribe lo pendiente y cierra el archivo
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    // Prueba: retraso artificial por cada escritura de lote (simula disco lento)
+    void setWriteDelayUs(unsigned int micros) { writeDelayUs = micros; }
+
+    const std::string& path() const { return filePath; }
+    uint64_t recordedFrames() const { return recorded.load(); }
+    uint64_t droppedFrames() const { return dropped.load(); }
+    uint64_t bytesWritten() const { return written.load(); }
+    // Costo medio y máximo de push() en el hilo de render (ns)
+    double averagePushNs() const;
+    uint64_t maxPushNs() const { return pushMaxNs; }
+
+private:
+    struct Slot {
+        uint64_t stampNs;
+        std::string data;
+    };
+
+    std::vector<Slot> slots;
+    std::atomic<uint32_t> head;     // siguiente a escribir (productor)
+    std::atomic<uint32_t> tail;     // siguiente a leer (consumidor)
+
+    std::thread writer;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCond;
+    std::atomic<bool> writerSleeping;
+    std::atomic<bool> stopping;
+
+    FILE* file;
+    std::string filePath;
+    uint64_t startNs;
+    unsigned int writeDelayUs;
+
+    std::atomic<uint64_t> recorded;
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> written;
+    uint64_t pushTotalNs;
+    uint64_t pushCount;
+    uint64_t pushMaxNs;
+
+    void writerLoop();
+};
+
+// Benchmark sin terminal: frames sintéticos contra un escritor lento
+// Uso: ./Pong --cast-bench [--frames N] [--bytes B] [--fps F] [--writer-delay-us D]
+int runCastBench(int argc, char* argv[]);
+
+#endif
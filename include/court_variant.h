@@ -0,0 +1,41 @@
+#ifndef COURT_VARIANT_H
+#define COURT_VARIANT_H
+
+#include <cstdint>
+#include <string>
+#include "step_kernel.h"
+#include "term_encoder.h"
+
+// Núcleo de una cancha (simulación + armado del frame) instanciado para unas reglas.
+// Las canchas estándar se compilan con FixedCourt: límites, zonas de paleta y la capa
+// fija de la cancha (bordes y red) son constantes. La genérica lee las dimensiones de
+// RuntimeCourt y arma la capa fija al vuelo. En las especializadas el argumento court
+// se ignora.
+struct CourtVariant {
+    const char* name;
+    RuntimeCourt court;         // dimensiones de la instancia (la genérica: 0)
+    bool specialised;
+    void (*init)(World& world, uint32_t seed, const RuntimeCourt& court);
+    // Avanza ticks con la IA de seguimiento en ambas paletas; devuelve los puntos
+    int (*simulate)(World& world, int ticks, const RuntimeCourt& court);
+    // Marcador en la fila 0 y la cancha en las filas 1..alto de un frame de al menos
+    // ancho columnas y alto + 2 filas (la última queda para quien llama); un frame
+    // más chico no se toca
+    void (*compose)(const World& world, const RuntimeCourt& court, TermFrame& frame);
+};
+
+// "ANCHOxALTOxPALETA", p. ej. 80x25x3; false si no es una cancha válida
+bool parseCourt(const std::string& text, RuntimeCourt& court);
+// La instancia especializada de esa cancha o, si no hay, la genérica
+const CourtVariant& selectCourtVariant(const RuntimeCourt& court);
+const CourtVariant& genericCourtVariant();
+
+// CPU contra CPU en la cancha pedida con la instancia que elige selectCourtVariant
+// Uso: ./Pong --court 120x40x4 [--seed S] [--max-ticks T]
+int runCourtDemo(int argc, char* argv[]);
+// Especializada contra genérica en cada cancha: ns por tick, µs por frame y que den
+// los mismos estados y las mismas celdas
+// Uso: ./Pong --court-bench [--ticks N] [--frames F] [--courts 80x25x3,100x30x3]
+int runCourtBench(int argc, char* argv[]);
+
+#endif
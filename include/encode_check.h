@@ -0,0 +1,10 @@
+#ifndef ENCODE_CHECK_H
+#define ENCODE_CHECK_H
+
+// Comprueba TermEncoder contra un emulador de terminal mínimo: frames aleatorios que
+// cambian de a poco (con invalidaciones y todas las combinaciones de capacidades) se
+// codifican, se aplican al emulador y la pantalla resultante se compara celda a celda.
+// Uso: ./Pong --encode-check [--frames N] [--seed S]
+int runEncodeCheck(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef FRAME_EXPORT_H
+#define FRAME_EXPORT_H
+
+// Exportación de partidas a imágenes. Re-simula una partida (por semilla o desde un
+// archivo guardado) sin terminal, rasteriza cada tick con la misma distribución que
+// PongRenderer (marcador, cancha, paletas y pelota) y codifica los cuadros en paralelo.
+// Formatos: ppm (un P6 por cuadro) o raw (un solo archivo RGB24 para ffmpeg rawvideo).
+// Uso: ./Pong --export [--seed S] [--left PERFIL] [--right PERFIL] [--roster ARCHIVO]
+//                      [--save ARCHIVO] [--target P] [--max-ticks T] [--frames N]
+//                      [--out DIR] [--format ppm|raw] [--scale K] [--threads N] [--scaling]
+int runFrameExport(int argc, char* argv[]);
+
+#endif
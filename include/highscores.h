@@ -13,21 +13,31 @@ struct HighScore {
     std::string date;
 };
 
+// Archivo compartido entre procesos: los escritores se serializan con flock sobre
+// "<archivo>.lock", releen y fusionan antes de escribir, y reemplazan el archivo con
+// rename(); los lectores toman una instantánea con mmap sin ningún candado.
 class HighScoreManager {
 private:
     std::vector<HighScore> highScores;
     static const int MAX_SCORES = 10;
     std::string filename;
+    size_t maxScores;
     sem_t file_semaphore;
+
+    static std::string currentDate();
+    void mergeAndWrite(const std::vector<HighScore>& newScores);
     
 public:
-    HighScoreManager();
+    explicit HighScoreManager(const std::string& path = "pong_highscores.txt", size_t capacity = MAX_SCORES);
     ~HighScoreManager();
     void addScore(const std::string& p1Name, const std::string& p2Name, int p1Score, int p2Score);
+    void addScores(const std::vector<HighScore>& scores);
     void loadScores();
     void saveScores();
     void displayHighScores();
     std::vector<HighScore> getHighScores() const;
+    // Instantánea sin candados (mmap del archivo actual); false si no existe
+    static bool readSnapshot(const std::string& path, std::vector<HighScore>& out);
     void safeAddScore(const std::string& p1Name, const std::string& p2Name, int p1Score, int p2Score);
 };
 
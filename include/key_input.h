@@ -0,0 +1,163 @@
+#ifndef KEY_INPUT_H
+#define KEY_INPUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+// Teclas especiales (las demás se representan con su carácter en minúscula)
+const int KEY_ARROW_UP = 0x101;
+const int KEY_ARROW_DOWN = 0x102;
+// Respuesta del terminal a DSR 5 (CSI 5 n -> CSI 0 n). No es una tecla: el render la
+// usa para saber hasta qué byte de su salida llegó el terminal.
+const int KEY_STATUS_REPLY = 0x103;
+// Reporte del mouse en modo SGR (CSI < botón ; columna ; fila M/m); la posición va
+// en mouseCol/mouseRow (desde 1, como las manda el terminal)
+const int KEY_MOUSE = 0x104;
+
+enum KeyAction {
+    KEY_PRESS,
+    KEY_REPEAT,
+    KEY_RELEASE
+};
+
+struct KeyEvent {
+    int code;
+    KeyAction action;
+    // Solo con KEY_MOUSE: movimiento sin cambio de botones (KEY_REPEAT en action)
+    int mouseCol;
+    int mouseRow;
+};
+
+// Decodifica la entrada byte a byte: teclas sueltas, flechas (ESC [ A/B), el
+// protocolo de teclado de kitty (CSI código ; mods:evento u, CSI 1 ; mods:evento A/B)
+// y los reportes SGR del mouse
+class KeyDecoder {
+public:
+    KeyDecoder() { reset(); }
+    void reset();
+    // true si el byte completó un evento
+    bool feed(unsigned char byte, KeyEvent& event);
+    // Decodifica un bloque leído y entrega cada evento a onEvent (que devuelve false
+    // para dejar de leer). Los movimientos del mouse seguidos se juntan: solo se
+    // entrega el último, justo antes del siguiente evento distinto o al final.
+    template <typename OnEvent>
+    bool feedBlock(const unsigned char* data, size_t len, OnEvent&& onEvent) {
+        KeyEvent motion;
+        bool hasMotion = false;
+        for (size_t i = 0; i < len; i++) {
+            KeyEvent event;
+            if (!feed(data[i], event)) continue;
+            if (event.code == KEY_MOUSE && event.action == KEY_REPEAT) {
+                if (hasMotion) coalescedMotion++;
+                motion = event;
+                hasMotion = true;
+                continue;
+            }
+            if (hasMotion && !onEvent(motion)) return false;
+            hasMotion = false;
+            if (!onEvent(event)) return false;
+        }
+        return !hasMotion || onEvent(motion);
+    }
+    // Movimientos descartados por feedBlock
+    uint64_t motionCoalesced() const { return coalescedMotion; }
+
+private:
+    enum State { NORMAL, ESCAPE, CSI };
+    State state;
+    bool privateMode;       // CSI ? ... (respuestas del terminal, se ignoran)
+    bool mouseMode;         // CSI < ... (reporte SGR del mouse)
+    int mouseParams[3];     // botón, columna, fila
+    uint64_t coalescedMotion = 0;
+    int params[3];          // código, modificadores, tipo de evento
+    int paramIndex;
+    bool subParam;          // después de ':' dentro del parámetro actual
+    int subIndex;
+};
+
+// Protocolo de teclado de kitty (banderas 1|2|8: eventos de soltar y todas las teclas
+// como secuencias). Pregunta al terminal con CSI ? u seguido de DA1 como centinela;
+// solo se activa si responde. PONG_KITTY=0 lo desactiva.
+bool enableKittyKeyboard(int timeoutMs);
+void disableKittyKeyboard();
+// Lee y descarta la entrada hasta la respuesta de un DSR 5 pendiente (o timeoutMs),
+// para que no llegue después como teclas al menú
+bool awaitStatusReply(int timeoutMs);
+
+// Reportes del mouse con cualquier movimiento (1003) en formato SGR (1006), que no
+// tiene el límite de 223 columnas del formato clásico. PONG_MOUSE=0 los desactiva.
+bool enableMouseReporting();
+void disableMouseReporting();
+
+// Última posición del puntero por jugador. Un trackball manda cientos de reportes por
+// segundo: en lugar de encolarlos, cada reporte reemplaza al anterior y la física toma
+// solo el más reciente en cada tick. Cuenta cuántos se descartaron así y la mayor
+// cantidad que llegó entre dos ticks (lo que habría crecido una cola).
+class MousePointer {
+public:
+    MousePointer() { reset(); }
+    void reset();
+    // Hilo de entrada; player es 1 o 2
+    void onReport(int player, int row, uint64_t readNs);
+    // Física: true si hubo reportes desde la última llamada (row y readNs del último)
+    bool take(int player, int& row, uint64_t& readNs);
+    uint64_t reports(int player);
+    uint64_t coalesced(int player);
+    uint64_t maxBurst(int player);
+
+private:
+    struct Slot {
+        bool fresh;
+        int row;
+        uint64_t readNs;
+        uint64_t sinceTake;     // reportes desde el último take
+        uint64_t reports;
+        uint64_t coalesced;
+        uint64_t maxBurst;
+    };
+
+    std::mutex pointerMutex;
+    Slot slots[2];
+};
+
+// Estado de las teclas de movimiento. Con eventos de soltar (kitty) una tecla está
+// presionada hasta que llega su KEY_RELEASE; sin ellos se deduce por tiempo: un
+// evento aislado es un toque (un paso) y, cuando llegan repeticiones seguidas, se
+// mide el intervalo de auto-repetición y la tecla sigue presionada a ese ritmo.
+class HeldKeys {
+public:
+    enum Slot { P1_UP, P1_DOWN, P2_UP, P2_DOWN, SLOTS };
+
+    HeldKeys();
+    void reset();
+    void setReleaseEvents(bool available);
+    bool releaseEvents() const { return hasReleaseEvents; }
+    void onEvent(int slot, KeyAction action, uint64_t nowNs);
+    // Dirección (-1, 0, +1) de la paleta del jugador. Si hubo una pulsación nueva
+    // desde la última llamada devuelve su instante en pressNs (si no, 0).
+    int direction(int player, uint64_t nowNs, uint64_t& pressNs);
+
+private:
+    struct Hold {
+        bool down;
+        bool repeating;
+        bool fresh;             // pulsación aún no aplicada a la paleta
+        uint64_t pressNs;
+        uint64_t lastEventNs;
+        uint64_t intervalNs;    // intervalo de auto-repetición estimado
+    };
+
+    std::mutex holdMutex;
+    Hold holds[SLOTS];
+    bool hasReleaseEvents;
+
+    bool isHeld(Hold& hold, uint64_t nowNs);
+};
+
+// Inundación sintética de reportes del mouse: costo de decodificación y profundidad
+// de la cola si cada reporte se encolara, contra quedarse con el último por tick.
+// Uso: ./Pong --mouse-bench [--rate HZ] [--seconds S] [--stall-ms MS]
+int runMouseBench(int argc, char* argv[]);
+
+#endif
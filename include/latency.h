@@ -0,0 +1,53 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+// Reloj monotónico en nanosegundos (steady_clock)
+uint64_t monotonicNowNs();
+
+// Histograma log-lineal de latencias en microsegundos (16 sub-buckets por potencia de 2)
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKETS = 16;
+    static const int NUM_BUCKETS = SUB_BUCKETS + 40 * SUB_BUCKETS;
+
+    LatencyHistogram();
+    void record(uint64_t micros);
+    void reset();
+    void merge(const LatencyHistogram& other);
+    uint64_t count() const;
+    uint64_t max() const;
+    uint64_t percentile(double p) const;
+
+private:
+    uint64_t buckets[NUM_BUCKETS];
+    uint64_t total;
+    uint64_t maxValue;
+
+    static int bucketIndex(uint64_t micros);
+    static uint64_t bucketUpperBound(int index);
+};
+
+// Recolecta latencias tecla -> frame escrito por jugador, separando la
+// espera en cola/paleta del tiempo hasta que el frame sale a la terminal
+class LatencyTracker {
+public:
+    static const int MAX_PLAYERS = 2;
+
+    void recordSample(int player, uint64_t readNs, uint64_t appliedNs, uint64_t frameNs);
+    void reset();
+    bool hasSamples() const;
+    uint64_t framePercentile(int player, double p) const;    // tecla -> frame, en us
+    void formatSummary(char* line, size_t size) const;
+    void printReport(const std::string& name1, const std::string& name2) const;
+
+private:
+    mutable std::mutex trackerMutex;
+    LatencyHistogram toPaddle[MAX_PLAYERS];
+    LatencyHistogram toFrame[MAX_PLAYERS];
+};
+
+#endif
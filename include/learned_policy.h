@@ -0,0 +1,55 @@
+#ifndef LEARNED_POLICY_H
+#define LEARNED_POLICY_H
+
+#include <string>
+#include "pong_sim.h"
+
+// Red neuronal mínima (8 entradas -> 8 ocultas ReLU -> 3 acciones) entrenada por
+// autojuego. La inferencia usa vectores de 8 floats y no reserva memoria.
+struct PolicyWeights {
+    static const int INPUTS = 8;
+    static const int HIDDEN = 8;
+    static const int ACTIONS = 3;
+    static const int COUNT = INPUTS * HIDDEN + HIDDEN + ACTIONS * HIDDEN + ACTIONS;
+
+    // Desplazamientos en params (en floats). w1, b1 y w2 empiezan en múltiplos de 8:
+    // cada columna o fila de 8 floats queda alineada a 32 bytes
+    static const int W1 = 0;                        // columna por entrada
+    static const int B1 = W1 + INPUTS * HIDDEN;
+    static const int W2 = B1 + HIDDEN;              // fila por acción
+    static const int B2 = W2 + ACTIONS * HIDDEN;
+    static_assert(B2 + ACTIONS == COUNT, "los bloques deben cubrir params");
+    static_assert(B1 % 8 == 0 && W2 % 8 == 0, "columnas y filas alineadas a 32 bytes");
+
+    // Un solo arreglo: el entrenamiento y el archivo recorren los COUNT floats
+    // seguidos, y solo dentro de un arreglo eso está definido
+    alignas(32) float params[COUNT];
+
+    const float* w1(int input) const { return params + W1 + input * HIDDEN; }
+    const float* b1() const { return params + B1; }
+    const float* w2(int action) const { return params + W2 + action * HIDDEN; }
+    const float* b2() const { return params + B2; }
+
+    float* data() { return params; }
+    const float* data() const { return params; }
+};
+
+class LearnedPolicy {
+public:
+    LearnedPolicy();
+
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    // Movimiento (-1, 0, +1) para la paleta del lado indicado (1 = izquierda, 2 = derecha)
+    int decide(const SimState& state, int side) const;
+
+    PolicyWeights weights;
+};
+
+// Entrenamiento por estrategias evolutivas con partidas sin terminal en paralelo
+// Uso: ./Pong --train-policy [--out archivo] [--generations N] [--population P]
+//                            [--games G] [--threads T] [--seed S]
+int runPolicyTraining(int argc, char* argv[]);
+
+#endif
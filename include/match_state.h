@@ -0,0 +1,178 @@
+#ifndef MATCH_STATE_H
+#define MATCH_STATE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <pthread.h>
+#include "latency.h"
+#include "step_kernel.h"
+
+// Estado de la partida agrupado por hilo escritor. Cada bloque ocupa sus propias
+// líneas de caché: una escritura de un hilo no invalida lo que leen o escriben los
+// demás (false sharing). Los valores que se leen sin lock son atómicos con órdenes
+// de memoria explícitos.
+const size_t CACHE_LINE = 64;
+
+// Eventos de teclado producidos por inputListenerThread
+enum class EventType {
+    P1_UP,
+    P1_DOWN,
+    P2_UP,
+    P2_DOWN
+};
+
+// Evento en cola con el instante (monotónico) en que se leyó de stdin
+struct InputEvent {
+    EventType type;
+    uint64_t readNs;
+};
+
+// Cola de eventos de capacidad fija (anillo): encolar una tecla no reserva memoria.
+// Misma interfaz que std::queue; la protege el mutex de su InputLane.
+struct InputQueue {
+    static const int CAPACITY = 256;
+    InputEvent events[CAPACITY];
+    int head = 0;
+    int count = 0;
+
+    bool empty() const { return count == 0; }
+    const InputEvent& front() const { return events[head]; }
+    // Con la cola llena la tecla se descarta (el consumidor la vacía en cada despertar)
+    bool push(const InputEvent& ev) {
+        if (count == CAPACITY) return false;
+        events[(head + count) % CAPACITY] = ev;
+        count++;
+        return true;
+    }
+    void pop() {
+        head = (head + 1) % CAPACITY;
+        count--;
+    }
+};
+
+// Teclas aplicadas a la paleta que aún no han llegado a pantalla
+struct PendingInputs {
+    static const int CAPACITY = 64;
+    uint64_t readNs[CAPACITY];
+    uint64_t appliedNs[CAPACITY];
+    int count = 0;
+};
+
+// Pelota, marcador, RNG y tick: solo los escribe el hilo de física (bucle principal
+// o ball_thread). Los demás hilos leen una copia consistente con un seqlock: seq es
+// impar mientras se escribe y el lector repite si cambió durante la copia.
+struct alignas(CACHE_LINE) BallBlock {
+    std::atomic<uint32_t> seq;
+    std::atomic<int> x, y, speedX, speedY;
+    std::atomic<int> scoreP1, scoreP2;
+    std::atomic<uint32_t> rng;
+    std::atomic<uint32_t> tick;
+
+    BallBlock() : seq(0), x(0), y(0), speedX(0), speedY(0), scoreP1(0), scoreP2(0), rng(1), tick(0) {}
+
+    // Solo el hilo de física; las paletas de world se ignoran
+    void publish(const World& world) {
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        x.store(world.ballX, std::memory_order_relaxed);
+        y.store(world.ballY, std::memory_order_relaxed);
+        speedX.store(world.ballSpeedX, std::memory_order_relaxed);
+        speedY.store(world.ballSpeedY, std::memory_order_relaxed);
+        scoreP1.store(world.scoreP1, std::memory_order_relaxed);
+        scoreP2.store(world.scoreP2, std::memory_order_relaxed);
+        rng.store(world.rng, std::memory_order_relaxed);
+        tick.store(world.tick, std::memory_order_relaxed);
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    // Cualquier hilo; copia todo menos las paletas
+    void read(World& world) const {
+        for (;;) {
+            uint32_t before = seq.load(std::memory_order_acquire);
+            world.ballX = x.load(std::memory_order_relaxed);
+            world.ballY = y.load(std::memory_order_relaxed);
+            world.ballSpeedX = speedX.load(std::memory_order_relaxed);
+            world.ballSpeedY = speedY.load(std::memory_order_relaxed);
+            world.scoreP1 = scoreP1.load(std::memory_order_relaxed);
+            world.scoreP2 = scoreP2.load(std::memory_order_relaxed);
+            world.rng = rng.load(std::memory_order_relaxed);
+            world.tick = tick.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if ((before & 1u) == 0 && seq.load(std::memory_order_relaxed) == before) return;
+        }
+    }
+};
+
+// Una paleta: mutex de sus escritores (hilo del jugador, IA, física con teclas
+// mantenidas o bots), la posición, que se lee sin lock, y lo que cambia con cada paso.
+// Un bloque por paleta: mover una no invalida la línea de la otra.
+struct alignas(CACHE_LINE) PaddleBlock {
+    pthread_mutex_t mutex;
+    std::atomic<int> y;
+    uint64_t lastMoveNs;        // suavidad: intervalo entre pasos consecutivos
+    uint64_t moves;
+    PendingInputs pending;      // teclas aplicadas que aún no se pintaron
+    LatencyHistogram moveInterval;
+
+    PaddleBlock() : y(0), lastMoveNs(0), moves(0) { pthread_mutex_init(&mutex, nullptr); }
+    ~PaddleBlock() { pthread_mutex_destroy(&mutex); }
+    PaddleBlock(const PaddleBlock&) = delete;
+    PaddleBlock& operator=(const PaddleBlock&) = delete;
+
+    int load() const { return y.load(std::memory_order_relaxed); }
+};
+
+// Cola de teclas de un jugador con su mutex y condición: la comparten solo el hilo
+// de entrada y el hilo de ese jugador
+struct alignas(CACHE_LINE) InputLane {
+    pthread_mutex_t mutex;
+    pthread_cond_t cv;
+    std::atomic<uint64_t> eventsApplied;    // contador para el arnés PTY
+    InputQueue queue;
+
+    InputLane() : eventsApplied(0) {
+        pthread_mutex_init(&mutex, nullptr);
+        pthread_cond_init(&cv, nullptr);
+    }
+    ~InputLane() {
+        pthread_mutex_destroy(&mutex);
+        pthread_cond_destroy(&cv);
+    }
+    InputLane(const InputLane&) = delete;
+    InputLane& operator=(const InputLane&) = delete;
+};
+
+// Banderas de control: las escribe casi siempre el hilo de entrada y las leen todos en
+// cada vuelta. En su propia línea quedan compartidas en todas las cachés y solo se
+// invalidan cuando de verdad cambian.
+struct alignas(CACHE_LINE) ControlBlock {
+    std::atomic<bool> gameRunning;
+    std::atomic<bool> resetRequested;
+    std::atomic<bool> roundInProgress;
+    std::atomic<bool> isAIEnabled;
+    std::atomic<bool> showLatency;
+    std::atomic<bool> saveRequested;
+    std::atomic<bool> loadRequested;
+    std::atomic<bool> rewindRequested;
+    std::atomic<bool> serveRequested;    // serve_manager_thread -> física: sacar de nuevo
+
+    ControlBlock() : gameRunning(true), resetRequested(false), roundInProgress(false), isAIEnabled(false),
+                     showLatency(false), saveRequested(false), loadRequested(false),
+                     rewindRequested(false), serveRequested(false) {}
+};
+
+static_assert(sizeof(BallBlock) == CACHE_LINE, "BallBlock debe ocupar una línea");
+static_assert(alignof(PaddleBlock) == CACHE_LINE && alignof(InputLane) == CACHE_LINE,
+              "los bloques por escritor deben empezar en una línea propia");
+
+// Microbenchmark de false sharing: los mismos hilos escritores (física, dos paletas,
+// entrada) y un lector (render) sobre la distribución anterior (campos contiguos y
+// mutex juntos) y la particionada. Reporta operaciones por segundo, líneas de caché
+// compartidas por escritores distintos y, si perf_event_open está disponible, fallos
+// de caché por operación.
+// Uso: ./Pong --layout-bench [--seconds S] [--runs N]
+int runLayoutBench(int argc, char* argv[]);
+
+#endif
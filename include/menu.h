@@ -3,6 +3,9 @@
 
 enum MenuOption {
     INICIAR_PARTIDA,
+    JUGADOR_VS_JUGADOR,
+    JUGADOR_VS_CPU,
+    CPU_VS_CPU,
     INSTRUCCIONES,
     PUNTAJES,
     SALIR
@@ -10,4 +13,4 @@ enum MenuOption {
 
 MenuOption mostrarMenu();
 
-#endif
\ No newline at end of file
+#endif
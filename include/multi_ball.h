@@ -0,0 +1,60 @@
+#ifndef MULTI_BALL_H
+#define MULTI_BALL_H
+
+#include <cstdint>
+#include <vector>
+#include "pong_sim.h"
+
+// Modo caos: muchas pelotas a la vez que rebotan entre sí, en las paredes y en las
+// paletas. Las pelotas (diámetro de una celda) viven en columnas por pelota y en una
+// grilla uniforme de celdas del mismo tamaño: cada celda tiene una lista enlazada de
+// sus pelotas y en cada tick solo se mueven de lista las que cambiaron de celda. Para
+// los choques basta mirar la celda propia y sus vecinas, así que el costo por tick
+// crece casi lineal con la cantidad de pelotas (con densidad acotada).
+
+const float BALL_DIAMETER = 1.0f;
+const float BALL_MIN_SPEED_X = 0.15f;       // sin esto una pelota puede quedar rebotando en vertical
+const float BALL_LEFT_PADDLE_X = 3.0f;      // cara interna de la paleta izquierda (columna 2)
+const float BALL_RIGHT_PADDLE_X = WIDTH - 3.0f;
+const int BALL_MAX_COUNT = 100000;
+
+struct BallField {
+    int width = 0;
+    int height = 0;
+    bool closed = false;            // true: las cuatro paredes rebotan (benchmark)
+
+    int balls = 0;
+    std::vector<float> x, y, vx, vy;
+    // Grilla: head[celda] es la primera pelota; next/prev enlazan las de la misma celda
+    std::vector<int32_t> cell, next, prev;
+    std::vector<int32_t> head;
+
+    int paddleTop[2] = {0, 0};
+    int score[2] = {0, 0};
+    uint32_t rng = 1;
+    uint64_t tick = 0;
+    uint64_t collisions = 0;        // acumulados
+    uint64_t pairTests = 0;
+};
+
+void ballFieldInit(BallField& field, int width, int height, int count, uint32_t seed, bool closed);
+// Agrega pelotas en el centro o quita las últimas
+void ballFieldResize(BallField& field, int count);
+// Un tick: paletas (-1, 0, +1), movimiento, paredes, paletas y goles, grilla y choques
+void ballFieldStep(BallField& field, const int* paddleMoves);
+// Igual, pero los choques se buscan probando todos los pares (referencia del benchmark)
+void ballFieldStepNaive(BallField& field, const int* paddleMoves);
+// Pares que se tocan en el estado actual, con la grilla o probando todos los pares
+uint64_t ballFieldContactsGrid(const BallField& field);
+uint64_t ballFieldContactsNaive(const BallField& field);
+// IA: sigue a la pelota más cercana que va hacia su lado
+int ballFieldDecide(const BallField& field, int side);
+
+// Partida en el terminal. + y - agregan o quitan 10 pelotas.
+// Uso: ./Pong --balls N [--humans H] [--seed S] [--max-ticks T]
+int runMultiBall(int argc, char* argv[]);
+// Tiempo por tick de 1 a 10.000 pelotas con densidad constante, contra todos los pares
+// Uso: ./Pong --balls-bench [--counts 1,10,100,1000,10000] [--density D] [--naive-max N]
+int runMultiBallBench(int argc, char* argv[]);
+
+#endif
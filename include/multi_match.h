@@ -0,0 +1,74 @@
+#ifndef MULTI_MATCH_H
+#define MULTI_MATCH_H
+
+#include <cstdint>
+#include <vector>
+#include "pong_sim.h"
+
+// Variante de 2 a 8 jugadores con paletas en los cuatro bordes de la cancha. Todo lo
+// que es por jugador (tramo del borde, paleta, puntaje, controlador, cola de teclas)
+// vive en arreglos indexados por jugador; el choque con las paletas se resuelve con
+// una tabla celda -> dueño por borde, así que un tick cuesta lo mismo con 2 que con 8.
+
+const int MULTI_MAX_PLAYERS = 8;
+
+enum CourtEdge {
+    EDGE_LEFT = 0,
+    EDGE_RIGHT,
+    EDGE_TOP,
+    EDGE_BOTTOM,
+    EDGE_COUNT
+};
+
+// Líneas donde están las paletas; la pelota se mueve entre ellas
+const int MULTI_LEFT_LINE = 2;
+const int MULTI_RIGHT_LINE = WIDTH - 3;
+const int MULTI_TOP_LINE = 1;
+const int MULTI_BOTTOM_LINE = HEIGHT - 2;
+// Las celdas son el doble de altas que de anchas: las paletas horizontales son más largas
+const int MULTI_HORIZONTAL_PADDLE = 2 * PADDLE_HEIGHT;
+// ...y avanzan dos columnas por paso para cubrir lo que la pelota recorre en diagonal
+const int MULTI_HORIZONTAL_STEP = 2;
+
+// Estado de la partida en columnas por entidad (una entrada por jugador)
+struct MultiCourt {
+    int players = 0;
+    std::vector<uint8_t> edge;          // CourtEdge de cada jugador
+    std::vector<int> segmentLo;         // tramo que defiende: [segmentLo, segmentHi)
+    std::vector<int> segmentHi;
+    std::vector<int> paddlePos;         // primera celda de la paleta a lo largo del borde
+    std::vector<int> paddleLen;
+    std::vector<int> conceded;          // goles recibidos
+    std::vector<int> scored;            // goles hechos (último en tocar la pelota)
+    std::vector<int> hits;
+    // Dueño de cada celda de cada borde (-1 = pared que rebota)
+    std::vector<int8_t> owner[EDGE_COUNT];
+
+    int ballX = WIDTH / 2;
+    int ballY = HEIGHT / 2;
+    int ballSpeedX = 1;
+    int ballSpeedY = 1;
+    int lastHitter = -1;
+    uint32_t rng = 1;
+    uint32_t tick = 0;
+};
+
+// Reparte los bordes (izquierda, derecha, arriba, abajo, y de nuevo) y parte cada
+// borde en tramos iguales entre sus jugadores
+void multiInit(MultiCourt& court, int players, uint32_t seed);
+// Avanza un tick con el movimiento de cada paleta (-1, 0, +1 a lo largo de su borde;
+// las horizontales avanzan MULTI_HORIZONTAL_STEP celdas por unidad).
+// Devuelve el jugador que recibió un gol en este tick o -1.
+int multiStep(MultiCourt& court, const int* moves);
+// IA de seguimiento: mueve la paleta hacia la pelota cuando viene hacia su borde
+int multiDecide(const MultiCourt& court, int player);
+const char* multiEdgeName(int edge);
+
+// Partida en el terminal: los primeros H jugadores con teclado, el resto con IA.
+// Uso: ./Pong --players N [--humans H] [--target P] [--seed S] [--max-ticks T]
+int runMultiMatch(int argc, char* argv[]);
+// Costo por tick (simulación, IA, armado del frame y codificación) con 2, 4 y 8 jugadores.
+// Uso: ./Pong --players-bench [--ticks T] [--players 2,4,8]
+int runMultiBench(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef PAUSE_GATE_H
+#define PAUSE_GATE_H
+
+#include <atomic>
+#include <cstdint>
+#include <pthread.h>
+
+// Punto de espera común para pausar una partida: los hilos que llaman park() quedan
+// bloqueados en una sola variable de condición (sin temporizadores) hasta resume().
+class PauseGate {
+public:
+    PauseGate();
+    ~PauseGate();
+
+    void pause();
+    void resume();
+    bool isPaused() const { return paused.load(std::memory_order_acquire); }
+
+    // Bloquea mientras la partida esté en pausa; devuelve true si llegó a detenerse
+    bool park();
+
+    // Tiempo total en pausa desde el último reset() (ns)
+    uint64_t pausedNs() const;
+    void reset();
+
+private:
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    std::atomic<bool> paused;
+    uint64_t pausedSinceNs;
+    uint64_t totalPausedNs;
+};
+
+#endif
@@ -3,35 +3,131 @@
 
 #include "pong_render.h"
 #include "highscores.h"
+#include "latency.h"
+#include "save_state.h"
+#include "rollout_ai.h"
+#include "learned_policy.h"
+#include "thread_tuning.h"
+#include "pause_gate.h"
+#include "rally_log.h"
+#include "alloc_guard.h"
+#include "key_input.h"
+#include "bot_api.h"
+#include "ai_profile.h"
+#include "match_state.h"
 #include <string>
 #include <thread>
 #include <mutex>
 #include <atomic>
+#include <memory>
+#include <cstdint>
+#include <pthread.h>
 #include <semaphore.h>
 
+// Movimiento de las paletas humanas: una celda por evento de teclado (depende de la
+// auto-repetición del terminal) o velocidad constante mientras la tecla está mantenida
+enum class PaddleInput {
+    EVENT,
+    HELD
+};
+
+class PongGame;
+
+struct ThreadData {
+    PongGame* game;
+    int player_id;
+};
+
 class PongGame {
 private:
     PongRenderer renderer;
     HighScoreManager scoreManager;
-    
-    // Estado del juego
-    int scoreP1;
-    int scoreP2;
-    int paddle1Y;
-    int paddle2Y;
-    int ballX;
-    int ballY;
-    int ballSpeedX;
-    int ballSpeedY;
-    
-    std::atomic<bool> gameRunning;
+    LatencyTracker latencyTracker;
+
+    // Estado del juego, agrupado por hilo escritor (match_state.h)
+    BallBlock ball;
+    PaddleBlock paddles[2];
+    InputLane lanes[2];
+    ControlBlock control;
+
+    float ai_difficulty;
+    std::unique_ptr<RolloutPlanner> planner;     // null = heurística clásica
+    std::unique_ptr<LearnedPolicy> learnedPolicy;
     std::string playerName1;
     std::string playerName2;
-    
-    // Sincronización
-    std::mutex gameMutex;
+
+    // Sincronización de rondas y del render de CPU vs CPU (fuera de las líneas calientes)
     sem_t sem_highscore;
-    
+    alignas(CACHE_LINE) pthread_mutex_t mutex_start_round;
+    pthread_cond_t cond_start_round;
+    alignas(CACHE_LINE) pthread_mutex_t mutex_game_state;
+    pthread_cond_t cond_frame_ready;
+
+    // Frames escritos (arnés PTY); los eventos aplicados van en cada InputLane
+    alignas(CACHE_LINE) std::atomic<uint64_t> framesRendered;
+    // Teclas mantenidas y velocidad de las paletas (modo PaddleInput::HELD); la física
+    // integra la velocidad en cada tick
+    PaddleInput paddleInput;
+    alignas(CACHE_LINE) HeldKeys heldKeys;      // entrada escribe, física lee
+    bool kittyKeyboard;
+    // Mouse (reportes SGR): la física centra la paleta en la última fila del puntero
+    MousePointer mousePointer;
+    bool mouseReporting;
+    uint64_t mouseDecoded;          // reportes leídos (hilo de entrada; se lee tras el join)
+    uint64_t mouseApplied;          // posiciones que aplicó la física
+    int paddleDir[2];
+    uint64_t paddleTravel[2];   // avance acumulado en celdas * 1e9
+    uint64_t lastIntegrateNs;
+
+    // Bots externos por memoria compartida (--bot-shm): controlan la paleta de su slot
+    BotServer botServer;
+    AIProfile botFallback;
+    uint32_t botRng[2];             // jitter del respaldo por slot (aiSeed)
+
+    // Reservas de memoria por frame en estado estable (deben ser 0)
+    FrameAllocationProbe frameAllocations;
+    char latencyLine[160];
+    // Teclas que ya entraron en un frame armado pero aún no pintado (se omitió por
+    // contrapresión): se miden con el próximo frame que salga
+    PendingInputs composedInputs[2];
+
+    // Jitter: retraso al despertar del bucle de física y desviación entre frames
+    LatencyHistogram tickJitter;
+    LatencyHistogram frameJitter;
+
+    // Grabación asciicast opcional (--record PREFIJO): un archivo por partida
+    std::string recordPrefix;
+    int recordedMatches;
+    CastRecorder recorder;
+
+    // Registro de peloteos opcional (--rally-log ARCHIVO): eventos de todas las partidas
+    RallyLog rallyLog;
+    RallyColumns rallyEvents;
+    RallyTracker rallyTracker;
+    std::mutex rallyMutex;      // física y serve_manager_thread registran en paralelo
+
+    // Pausa (P): todos los hilos de la partida se estacionan aquí
+    PauseGate pauseGate;
+
+    // Guardado, rebobinado y repetición instantánea (los aplica el bucle principal)
+    RewindBuffer rewind;
+    bool replayPending;
+    // Repetición en curso: ticks grabados que faltan por mostrar, uno por vuelta del
+    // bucle (0 = ninguna). Mientras dura, la pelota y el saque esperan
+    size_t replayRemaining;
+    int loopTicksPerSecond;     // ritmo del bucle que llena rewind (60 o 10)
+    std::string statusMessage;
+    uint64_t statusUntilNs;
+
+    // Hilos POSIX
+    pthread_t input_thread;
+    pthread_t playerThreads[2];     // uno por paleta: teclado o IA según el modo
+    pthread_t serve_thread;
+    pthread_t ball_thread;
+    pthread_t cpuA_thread;
+    pthread_t cpuB_thread;
+    ThreadData playerData[2];
+
     // Hilos del Integrante 4
     std::thread renderer_thread;
     std::thread highscore_thread;
@@ -40,7 +136,7 @@ private:
 public:
     PongGame();
     ~PongGame();
-    
+
     // Métodos principales
     void initializeGame();
     void runDemo();
@@ -48,16 +144,90 @@ public:
     void runGameWithPlayers();
     void showHighScores();
     void resetBall();
-    
+
     // Métodos que faltaban
     void startGame(int gameMode);
     void handleInput();
 
+    // IA por búsqueda para el modo JvsCPU (budgetUs = 0 vuelve a la heurística)
+    void configureRolloutAI(int threads, int budgetUs);
+    // Política aprendida para la IA de JvsCPU y los jugadores de CPU vs CPU
+    bool configureLearnedPolicy(const std::string& path);
+    // Graba cada partida en PREFIJO-NNN.cast (vacío = no grabar)
+    void configureRecording(const std::string& prefix);
+    // Agrega los eventos de peloteo de cada partida a ARCHIVO (false si no se pudo abrir)
+    bool configureRallyLog(const std::string& path);
+    // "event" = una celda por tecla, "held" = velocidad con teclas mantenidas (por defecto)
+    bool configurePaddleInput(const std::string& mode);
+    // Publica cada tick en /dev/shm/pong-bot-NOMBRE y acepta comandos de bots externos
+    bool configureBotApi(const std::string& name);
+
 private:
     void rendererThread();
     void highscoreThread();
     void collisionThread();
     void processInput();
+
+    // Física y reglas (núcleo compartido step_kernel.h)
+    int advanceBall();
+    void onPointScored();
+
+    // Latencia de entrada
+    void pushEvent(int player, EventType type, uint64_t readNs);
+    bool drainLane(int player);
+    void applyPaddleEvent(int player, const InputEvent& ev);
+    bool handleKey(const KeyEvent& key, uint64_t readNs);
+    void integratePaddles();
+    void followPointer(uint64_t nowNs);
+    void driveBots();
+    void movePaddle(int player, int delta, uint64_t pressNs, uint64_t nowNs);
+    void recordPaddleMove(int player, uint64_t nowNs);
+    void beginKeyboard();
+    void endKeyboard();
+    void renderFrame(const char* banner = nullptr);
+    bool presentFrame(const char* banner);
+    void showMatchReport();
+    void printHarnessStats();
+    void beginRecording();
+    void endRecording();
+    void beginRallyLog(bool serveOnMiss);
+    void endRallyLog();
+
+    // Acceso al estado compartido (match_state.h)
+    bool running() const { return control.gameRunning.load(std::memory_order_acquire); }
+    void shiftPaddle(int player, int delta);
+    void syncRenderer(const World& world);
+
+    // Guardado y rebobinado
+    MatchSnapshot snapshot();
+    void restore(const MatchSnapshot& snap);
+    void captureTick();
+    void handleMatchCommands();
+    void startInstantReplay();
+    bool showReplayFrame();     // false si no hay repetición en curso
+    void flashStatus(const std::string& message);
+
+    // Wrappers para pthread_create
+    static void* inputThreadWrapper(void* arg);
+    static void* ballThreadWrapper(void* arg);
+    static void* cpuPlayerAThreadWrapper(void* arg);
+    static void* cpuPlayerBThreadWrapper(void* arg);
+    static void* playerThreadWrapper(void* arg);
+    static void* aiThreadWrapper(void* arg);
+    static void* serveThreadWrapper(void* arg);
+
+    void inputThread();
+    void playerThread(int player_id);
+    void aiThread();
+    void serveThread();
+    void serveBall();
+
+    // Hilos de juego
+    void requestQuit();
+    void inputListenerThread();
+    void player_keyboard_adapter_thread();
+    void serve_manager_thread();
+    void ai_opponent_thread();
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -5,6 +5,8 @@
 #include <string>
 #include <mutex>
 #include "utils.h"
+#include "term_encoder.h"
+#include "cast_recorder.h"
 
 using namespace std;
 
@@ -12,6 +14,23 @@ const int WIDTH = 80;
 const int HEIGHT = 25;
 const int PADDLE_HEIGHT = 3;
 
+// Pantalla de juego: marcador (3) + cancha + controles (2) + línea de estado
+const int SCREEN_ROWS = HEIGHT + 6;
+const int SCOREBOARD_ROWS = 3;      // la cancha empieza en esta fila (desde 0)
+const int SCREEN_COLS = WIDTH;
+
+// Contrapresión de la salida. El frame se omite si la terminal va atrasada:
+// - lo encolado en el tty (TIOCOUTQ) más lo que un write no bloqueante no alcanzó a
+//   entregar pasa de dos frames, con un piso de OUTPUT_QUEUE_MIN (PONG_OUTQ=bytes);
+// - o la respuesta al último DSR 5 tarda más que el menor tiempo de ida y vuelta
+//   visto más OUTPUT_LAG_SLACK_NS (en un PTY o por SSH TIOCOUTQ siempre es 0).
+// Aun atrasada sale un frame cada OUTPUT_MAX_SKIP_NS para no congelar la pantalla.
+const size_t OUTPUT_QUEUE_MIN = 512;
+const uint64_t OUTPUT_PROBE_INTERVAL_NS = 50ULL * 1000000ULL;
+const uint64_t OUTPUT_LAG_SLACK_NS = 33ULL * 1000000ULL;
+const uint64_t OUTPUT_MAX_SKIP_NS = 1000ULL * 1000000ULL;
+const uint64_t OUTPUT_PROBE_TIMEOUT_NS = 3000ULL * 1000000ULL;
+
 class PongRenderer {
 private:
     int scoreP1;
@@ -24,20 +43,93 @@ private:
     int ballDirY;
     string playerName1;
     string playerName2;
+    string statusLine;
     mutex renderMutex;
 
+    // Salida: diferencial (TermEncoder) o completa como antes (PONG_RENDER=full)
+    bool diffOutput;
+    TermFrame frame;
+    TermEncoder encoder;
+    uint64_t outputFrames;
+    uint64_t outputBytes;
+    CastRecorder* recorder;     // opcional: copia de cada frame emitido
+    // Escritura no bloqueante a la terminal; lo que no entró queda en pendingOut
+    int outFd;
+    bool ownsOutFd;
+    string pendingOut;
+    size_t pendingOffset;
+    size_t fixedQueueLimit;     // 0 = adaptativo (dos frames)
+    size_t lastFrameBytes;
+    uint64_t skippedFrames;
+    size_t lastQueueDepth;
+    size_t maxQueueDepth;
+    uint64_t lastPresentNs;
+    // Sonda DSR 5: el terminal responde cuando procesó todo lo anterior
+    bool probeEnabled;
+    bool terminalAnswers;       // respondió al menos una vez
+    bool probeOutstanding;
+    uint64_t probeSentNs;
+    uint64_t minRttNs;
+    uint64_t lastLagNs;
+    uint64_t maxLagNs;
+    string text;        // frame en texto plano
+    string scratch;     // marcador/cancha sueltos (renderScoreBoard, renderCourt)
+    string fullBytes;
+
+    void appendScoreBoard(string& out);
+    // Armado del frame en plantilla sobre las reglas de la cancha (step_kernel.h),
+    // igual que stepCourt: el juego usa ClassicCourt y los límites quedan constantes
+    template <typename Court> void appendCourt(string& out, const Court& court);
+    template <typename Court> void composeText(const Court& court);
+    template <typename Court> void fillCells(const Court& court);
+    const string& composeFrame();
+    size_t queuedOutput();
+    bool flushPending();
+    void writeOutput(const char* data, size_t len);
+    void drainPending();
+
 public:
     PongRenderer();
+    ~PongRenderer();
+    PongRenderer(const PongRenderer&) = delete;
+    PongRenderer& operator=(const PongRenderer&) = delete;
     void updateScores(int p1, int p2);
     void updatePaddles(int p1Y, int p2Y);
     void updateBall(int x, int y, int dirX, int dirY);
     void updatePlayerNames(const string& name1, const string& name2);
-    void renderGame();
+    void setStatusLine(const string& line);
+    void setStatusLine(const char* line);
+    // Pinta el frame actual; false si se omitió porque la terminal va atrasada (el
+    // siguiente que salga parte de lo último enviado y muestra el estado más reciente)
+    bool renderGame();
+    // Igual que renderGame pero devuelve los bytes en lugar de escribirlos en cout
+    // (la arena escribe cada sesión en su propio PTY o socket)
+    const string& encodeGame();
+    // Celdas del frame (texto y atributos) sin generar bytes de terminal: la
+    // exportación a imágenes rasteriza esta misma distribución
+    const TermFrame& layoutGame();
     void renderScoreBoard();
     void renderCourt();
     void renderPaddles();
     void renderBall();
     void clearScreen();
+
+    // Otra pantalla escribió en el terminal: el próximo frame se pinta completo
+    void invalidateScreen();
+    // Deja el cursor visible y los atributos normales al salir de la partida
+    void restoreTerminal();
+    void resetOutputStats();
+    double bytesPerFrame();
+    uint64_t skippedFrameCount();
+    size_t outputQueueDepth();          // bytes encolados en el último frame
+    size_t maxOutputQueueDepth();
+    uint64_t maxOutputLagNs();          // mayor atraso medido con la sonda
+    // Solo con un hilo que lea la entrada y entregue las respuestas a onStatusReply
+    void setOutputProbe(bool enabled);
+    // Llegó CSI 0 n (hilo de entrada)
+    void onStatusReply(uint64_t nowNs);
+    bool usesDiffOutput() const { return diffOutput; }
+    void setRecorder(CastRecorder* rec);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef PONG_SIM_H
+#define PONG_SIM_H
+
+#include <cstdint>
+#include "pong_render.h"
+
+// Estado completo de una partida sin terminal (para torneos, IA y repeticiones)
+struct SimState {
+    int ballX;
+    int ballY;
+    int ballSpeedX;
+    int ballSpeedY;
+    int paddle1Y;
+    int paddle2Y;
+    int scoreP1;
+    int scoreP2;
+    uint32_t rng;
+    uint32_t tick;
+};
+
+// Generador xorshift32 determinista: misma semilla -> misma partida
+uint32_t simRandom(SimState& state);
+
+void simInit(SimState& state, uint32_t seed);
+void simResetBall(SimState& state);
+
+// Avanza un tick: mueve paletas (-1, 0, +1), pelota, rebotes y anotaciones.
+// Delegan en step() de step_kernel.h; la versión de referencia conserva las
+// reglas originales con saltos para comprobar equivalencia.
+void simStep(SimState& state, int moveP1, int moveP2);
+void simStepReference(SimState& state, int moveP1, int moveP2);
+
+#endif
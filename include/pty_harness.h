@@ -0,0 +1,11 @@
+#ifndef PTY_HARNESS_H
+#define PTY_HARNESS_H
+
+// Arnés sin terminal: lanza ./Pong bajo un pseudo-terminal, navega el menú,
+// inyecta teclas a una tasa configurable y reporta pérdidas, FPS y uso de CPU.
+// Uso: ./Pong --harness [--mode jvj|jvc] [--rate N] [--duration S]
+//                       [--script teclas] [--seed N] [--capture archivo]
+//                       [--drain-timeout S] [--alloc-check]
+int runPtyHarness(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef RALLY_LOG_H
+#define RALLY_LOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "step_kernel.h"
+
+// Eventos de un peloteo
+enum RallyEventKind {
+    RALLY_HIT = 0,      // la paleta devolvió la pelota
+    RALLY_MISS = 1,     // la paleta falló: fin del peloteo (rally = golpes que tuvo)
+    RALLY_SERVE = 2     // saque: side = quien recibe, offset = 1 si sale hacia abajo
+};
+
+// Eventos en columnas (un vector por campo), igual que en el archivo
+struct RallyColumns {
+    std::vector<uint8_t> kind;
+    std::vector<uint8_t> side;      // 1 o 2
+    std::vector<uint8_t> offset;    // golpe: fila de la paleta que tocó (0..PADDLE_HEIGHT)
+    std::vector<uint8_t> ballY;     // fila de la pelota en el evento (mapas de calor)
+    std::vector<uint16_t> rally;    // golpe: número de golpe en el peloteo; fallo: largo
+    std::vector<uint32_t> tick;
+    std::vector<uint32_t> match;
+
+    void add(int kind, int side, int offset, int ballY, int rally, uint32_t tick, uint32_t match);
+    void append(const RallyColumns& other);
+    size_t size() const { return kind.size(); }
+    void clear();
+    void reserve(size_t events);
+};
+
+// Deduce los eventos comparando el estado antes y después de step()
+class RallyTracker {
+public:
+    explicit RallyTracker(uint32_t matchId = 0, bool serveOnMiss = true);
+    void observe(const World& before, const World& after, int scorer, RallyColumns& out) {
+        if (scorer == STEP_NO_SCORE && before.ballSpeedX == after.ballSpeedX) return;
+        recordChange(before, after, scorer, out);
+    }
+    // Saque hecho fuera del núcleo (serve_manager_thread en JvsCPU)
+    void recordServe(const World& state, RallyColumns& out);
+    void reset(uint32_t matchId, bool serveOnMiss);
+
+private:
+    uint32_t matchId;
+    bool serveOnMiss;
+    uint16_t rallyHits;
+
+    void recordChange(const World& before, const World& after, int scorer, RallyColumns& out);
+};
+
+// Archivo de eventos: cabecera "PONGRLY1" y bloques de hasta BLOCK_EVENTS eventos,
+// cada uno con sus columnas contiguas y alineadas a 32 bytes para leerlas con mmap.
+// Cada open() elige una sesión aleatoria de 64 bits que va en la cabecera de sus
+// bloques; la columna match es el contador de partidas de esa sesión, así que una
+// partida se identifica por (sesión, match) aunque varios procesos o corridas
+// escriban en el mismo archivo.
+class RallyLog {
+public:
+    static const size_t BLOCK_EVENTS = 65536;
+
+    RallyLog();
+    ~RallyLog();
+    bool open(const std::string& path);     // agrega al final si ya existe
+    // Escribe los eventos ya (un bloque, o varios si no caben)
+    void append(const RallyColumns& columns);
+    // Junta los eventos de muchas partidas chicas en bloques compartidos: se escriben
+    // al llenarse uno o en flush()/close()
+    void appendBatched(const RallyColumns& columns);
+    void flush();
+    void close();
+    bool isOpen() const { return fd >= 0; }
+    uint64_t eventsWritten() const { return written; }
+    uint64_t sessionId() const { return session; }
+    // Número de la próxima partida de esta sesión (desde 0, seguro entre hilos)
+    uint32_t nextMatchId() { return nextMatch.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+    int fd;
+    std::mutex writeMutex;
+    uint64_t written;
+    uint64_t session;
+    std::atomic<uint32_t> nextMatch;
+    std::vector<char> buffer;
+    RallyColumns staged;
+
+    void writeBlocks(const RallyColumns& columns);      // con writeMutex tomado
+};
+
+// Análisis fuera de línea: ./Pong --rally-stats ARCHIVO
+int runRallyStats(int argc, char* argv[]);
+// Genera un registro sintético grande y mide el análisis
+// Uso: ./Pong --rally-bench [--events N] [--file RUTA]
+int runRallyBench(int argc, char* argv[]);
+
+#endif
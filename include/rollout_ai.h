@@ -0,0 +1,62 @@
+#ifndef ROLLOUT_AI_H
+#define ROLLOUT_AI_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "match_state.h"
+#include "pong_sim.h"
+
+// IA de búsqueda por simulaciones: para cada acción posible (-1, 0, +1) corre muchas
+// partidas cortas con step() en paralelo y elige la de mejor resultado promedio.
+// Es "anytime": al vencer el presupuesto de tiempo devuelve la mejor acción hallada.
+class RolloutPlanner {
+public:
+    RolloutPlanner(int threads, uint64_t budgetNs, int horizonTicks);
+    ~RolloutPlanner();
+
+    int decide(const SimState& state, int side);
+
+    void setBudgetNs(uint64_t budget);
+    uint64_t budgetNs() const;
+    uint64_t lastRollouts() const;
+    double rolloutsPerSecond() const;
+
+private:
+    static const int NUM_ACTIONS = 3;
+
+    // Una línea de caché propia por ayudante (el vector usa new alineado de C++17)
+    struct alignas(CACHE_LINE) WorkerStats {
+        double reward[NUM_ACTIONS];
+        uint64_t count[NUM_ACTIONS];
+    };
+
+    std::vector<std::thread> helpers;
+    std::vector<WorkerStats> stats;
+
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    uint64_t generation;
+    int activeHelpers;
+    bool stopping;
+
+    SimState root;
+    int rootSide;
+    std::atomic<uint64_t> deadlineNs;
+    std::atomic<uint64_t> budget;
+    int horizon;
+
+    uint64_t rolloutsLast;
+    uint64_t rolloutsTotal;
+    uint64_t searchNsTotal;
+
+    void helperLoop(int id);
+    void search(int id, uint32_t seed);
+    double rollout(SimState state, int side, int action, uint32_t& seed) const;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef SAVE_STATE_H
+#define SAVE_STATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "pong_sim.h"
+
+// Estado completo de la partida: simulación + estado de la ronda
+struct MatchSnapshot {
+    SimState sim;
+    bool roundInProgress;
+};
+
+// Serialización binaria compacta (SNAPSHOT_BYTES bytes, little-endian)
+const size_t SNAPSHOT_BYTES = 19;
+void packSnapshot(const MatchSnapshot& snapshot, uint8_t* out);
+void unpackSnapshot(const uint8_t* in, MatchSnapshot& snapshot);
+
+bool saveSnapshotFile(const std::string& path, const MatchSnapshot& snapshot);
+bool loadSnapshotFile(const std::string& path, MatchSnapshot& snapshot);
+
+// Buffer circular de memoria fija con los últimos ticks codificados como deltas
+// (máscara de bytes cambiados + bytes nuevos) y keyframes periódicos
+class RewindBuffer {
+public:
+    RewindBuffer(size_t maxTicks, int keyframeInterval);
+
+    void clear();
+    void capture(const MatchSnapshot& snapshot);
+    size_t size() const;
+    // ticksBack = 0 es el último estado capturado
+    bool get(size_t ticksBack, MatchSnapshot& snapshot) const;
+    // Descarta los estados más recientes (al rebobinar la partida)
+    void truncate(size_t ticksBack);
+
+    size_t bytesUsed() const;
+    size_t bytesCapacity() const;
+    uint64_t captureCount() const;
+    double averageCaptureNs() const;
+
+private:
+    struct Entry {
+        uint32_t offset;
+        uint8_t length;
+        bool keyframe;
+    };
+
+    std::vector<Entry> entries;         // anillo de descriptores
+    std::vector<uint8_t> bytes;         // anillo de datos codificados
+    size_t firstEntry;
+    size_t entryCount;
+    size_t byteHead;
+    size_t byteCount;
+    int keyframeInterval;
+    int sinceKeyframe;
+    uint8_t last[SNAPSHOT_BYTES];
+    uint64_t captures;
+    uint64_t captureNsTotal;
+
+    void dropOldestRun();
+    void writeByte(uint8_t value);
+    uint8_t readByte(size_t offset) const;
+    void decode(const Entry& entry, uint8_t* state) const;
+};
+
+#endif
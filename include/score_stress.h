@@ -0,0 +1,10 @@
+#ifndef SCORE_STRESS_H
+#define SCORE_STRESS_H
+
+// Prueba de concurrencia del archivo de puntajes entre procesos: varios escritores
+// agregan registros a la vez mientras lectores toman instantáneas con mmap; al final
+// se verifica que no se perdió ni duplicó ningún registro.
+// Uso: ./Pong --score-stress [--writers N] [--records N] [--readers N] [--file RUTA]
+int runScoreStress(int argc, char* argv[]);
+
+#endif
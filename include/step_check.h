@@ -0,0 +1,9 @@
+#ifndef STEP_CHECK_H
+#define STEP_CHECK_H
+
+// Comprueba que step() coincide con la referencia en millones de estados aleatorios
+// y compara el tiempo por tick de ambas versiones.
+// Uso: ./Pong --step-check [--states N] [--seed S]
+int runStepCheck(int argc, char* argv[]);
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef STEP_KERNEL_H
+#define STEP_KERNEL_H
+
+#include <cstdint>
+#include "pong_sim.h"
+
+// Núcleo único de simulación compartido por todos los modos (demo, JvJ, JvsCPU,
+// CPU vs CPU, torneos e IA). Solo usa operaciones enteras: las colisiones y rebotes
+// se resuelven con máscaras y selecciones (cmov). El único salto separa el caso
+// común (pelota lejos de las paletas), que la predicción acierta casi siempre.
+typedef SimState World;
+
+struct Inputs {
+    int moveP1;     // -1, 0, +1
+    int moveP2;
+};
+
+// Quién anotó en el tick: 0 = nadie, 1 = jugador 1, 2 = jugador 2
+enum StepScore {
+    STEP_NO_SCORE = 0,
+    STEP_SCORE_P1 = 1,
+    STEP_SCORE_P2 = 2
+};
+
+static inline int stepClamp(int v, int lo, int hi) {
+    v = v < lo ? lo : v;
+    return v > hi ? hi : v;
+}
+
+static inline uint32_t stepXorshift(uint32_t x) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+// Reglas y dimensiones de la cancha. Las variantes estándar las fijan al compilar
+// (FixedCourt): en stepCourt los límites, las zonas de paleta y el saque quedan como
+// constantes. RuntimeCourt lleva los mismos datos en variables para cualquier otra
+// cancha. Ver court_variant.h para elegir la instancia en tiempo de ejecución.
+template <int W, int H, int PADDLE>
+struct FixedCourt {
+    static_assert(W >= 16 && H >= 8 && PADDLE >= 1 && PADDLE <= H - 4, "cancha inválida");
+    static constexpr int width = W;
+    static constexpr int height = H;
+    static constexpr int paddleHeight = PADDLE;
+};
+
+struct RuntimeCourt {
+    int width;
+    int height;
+    int paddleHeight;
+};
+
+typedef FixedCourt<WIDTH, HEIGHT, PADDLE_HEIGHT> ClassicCourt;
+
+template <typename Court>
+static inline int stepCourt(World& w, Inputs in, const Court& court) {
+    const int width = court.width;
+    const int height = court.height;
+    const int paddle = court.paddleHeight;
+    const int p1 = stepClamp(w.paddle1Y + in.moveP1, 1, height - paddle - 1);
+    const int p2 = stepClamp(w.paddle2Y + in.moveP2, 1, height - paddle - 1);
+    w.paddle1Y = p1;
+    w.paddle2Y = p2;
+
+    const int x = w.ballX + w.ballSpeedX;
+    const int y = w.ballY + w.ballSpeedY;
+
+    // Rebote vertical: vy = -vy cuando toca el borde
+    const int bounce = (y <= 1) | (y >= height - 2);
+    int vy = (w.ballSpeedY ^ -bounce) + bounce;
+
+    // Fuera de las zonas de paleta solo hay movimiento y rebote (caso común):
+    // un único salto sin signo cubre x <= 3 || x >= width - 4
+    if (__builtin_expect(static_cast<unsigned>(x - 4) < static_cast<unsigned>(width - 8), 1)) {
+        w.ballX = x;
+        w.ballY = y;
+        w.ballSpeedY = vy;
+        w.tick++;
+        return STEP_NO_SCORE;
+    }
+
+    // Zonas de paleta y resultado (golpe o fallo)
+    const int atLeft = x <= 3;
+    const int atRight = x >= width - 4;
+    const int hitLeft = atLeft & (y >= p1) & (y <= p1 + paddle);
+    const int hitRight = atRight & (y >= p2) & (y <= p2 + paddle);
+    const int missLeft = atLeft & (hitLeft ^ 1);
+    const int missRight = atRight & (hitRight ^ 1);
+    const int miss = missLeft | missRight;
+
+    int vx = w.ballSpeedX;
+    vx += hitLeft * (1 - vx) + hitRight * (-1 - vx);
+
+    w.scoreP2 += missLeft;
+    w.scoreP1 += missRight;
+
+    // Saque tras un punto sin saltos: el RNG solo avanza si hubo fallo
+    const uint32_t r1 = stepXorshift(w.rng);
+    const uint32_t r2 = stepXorshift(r1);
+    const int serveVx = 1 - 2 * static_cast<int>(r1 & 1u);
+    const int serveVy = 1 - 2 * static_cast<int>(r2 & 1u);
+
+    w.ballX = miss ? width / 2 : x;
+    w.ballY = miss ? height / 2 : y;
+    w.ballSpeedX = miss ? serveVx : vx;
+    w.ballSpeedY = miss ? serveVy : vy;
+    w.rng = miss ? r2 : w.rng;
+    w.tick++;
+
+    return missRight * STEP_SCORE_P1 + missLeft * STEP_SCORE_P2;
+}
+
+// La cancha del juego: la instancia con las constantes de pong_render.h
+static inline int step(World& w, Inputs in) {
+    return stepCourt(w, in, ClassicCourt());
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef TERM_ENCODER_H
+#define TERM_ENCODER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Atributos de celda (bits SGR)
+const uint8_t ATTR_NONE = 0;
+const uint8_t ATTR_BOLD = 1;
+const uint8_t ATTR_REVERSE = 2;
+
+// Una columna de terminal: un carácter UTF-8 (1 a 4 bytes) y sus atributos
+struct TermCell {
+    char bytes[4];
+    uint8_t len;
+    uint8_t attr;
+};
+
+// Pantalla lógica de filas x columnas que arma el renderer en cada frame
+class TermFrame {
+public:
+    TermFrame(int rows, int cols);
+    void clear();
+    // Escribe texto UTF-8 desde (row, col); lo que no cabe se descarta
+    void put(int row, int col, std::string_view text, uint8_t attr = ATTR_NONE);
+    const TermCell& at(int row, int col) const { return cells[row * numCols + col]; }
+    TermCell& at(int row, int col) { return cells[row * numCols + col]; }
+    int rows() const { return numRows; }
+    int cols() const { return numCols; }
+
+private:
+    int numRows;
+    int numCols;
+    std::vector<TermCell> cells;
+};
+
+// Capacidades opcionales del terminal (se deducen de TERM/TERM_PROGRAM;
+// PONG_SYNC=0|1 y PONG_REP=0|1 las fuerzan)
+struct TermCaps {
+    bool syncUpdates = false;   // DEC 2026: ESC[?2026h ... ESC[?2026l
+    bool repeat = false;        // REP: ESC[nb repite el último carácter
+};
+
+TermCaps detectTermCaps();
+
+struct EscSeq;
+
+// Codificador diferencial: compara el frame nuevo con lo que ya está en pantalla y
+// emite la secuencia más corta que lo alcanza (movimientos relativos o absolutos,
+// reescribir huecos cortos, borrar/repetir corridas, SGR solo cuando cambia).
+// Los candidatos se arman en la pila y la salida reutiliza su buffer: codificar un
+// frame no reserva memoria.
+class TermEncoder {
+public:
+    TermEncoder(int rows, int cols);
+    void setCaps(const TermCaps& caps);
+    // El contenido real de la pantalla es desconocido: el siguiente frame se pinta completo
+    void invalidate();
+    // Devuelve los bytes que llevan la pantalla al frame indicado
+    const std::string& encode(const TermFrame& next);
+
+private:
+    TermFrame screen;
+    TermCaps caps;
+    bool valid;
+    int curRow;     // -1 = posición desconocida
+    int curCol;
+    int curAttr;    // -1 = desconocido
+    std::string out;
+
+    void moveTo(int row, int col);
+    void appendHorizontal(EscSeq& seq, int row, int fromCol, int col) const;
+    void setAttr(uint8_t attr);
+    void writeCell(int row, int col, const TermCell& cell);
+    void encodeRow(const TermFrame& next, int row);
+};
+
+#endif
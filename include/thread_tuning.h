@@ -0,0 +1,77 @@
+#ifndef THREAD_TUNING_H
+#define THREAD_TUNING_H
+
+#include <cstdint>
+#include <string>
+#include <pthread.h>
+#include <sched.h>
+#include "latency.h"
+
+// Roles de los hilos de una partida
+enum class ThreadRole {
+    PHYSICS,    // ball_thread (CPU vs CPU) y bucle principal de JvJ / JvsCPU
+    INPUT,      // inputListenerThread y consumidores de colas de jugador
+    AI,         // hilos CPU, ai_opponent_thread y ayudantes de la búsqueda
+    RENDER,     // bucle de pintado de CPU vs CPU (en JvJ/JvsCPU pinta el hilo PHYSICS)
+    COUNT
+};
+
+struct RoleConfig {
+    int cpu = -1;           // -1 = sin fijar
+    int fifoPriority = 0;   // 0 = planificación normal; 1..99 = SCHED_FIFO
+};
+
+struct ThreadTuning {
+    RoleConfig roles[static_cast<int>(ThreadRole::COUNT)];
+    bool lockMemory = false;
+    int backgroundLoad = 0;     // hilos de carga sintética
+};
+
+// Opciones: --pin-<rol> CPU, --fifo-<rol> PRIO, --mlockall, --background-load N
+// (rol = physics | input | ai | render). Devuelve cuántos argumentos consumió, o -1
+// (con el error en cerr) si la CPU no es un número entre 0 y CPU_SETSIZE - 1.
+int parseThreadTuningArg(int argc, char* argv[], int index, ThreadTuning& tuning);
+
+void setThreadTuning(const ThreadTuning& tuning);
+const ThreadTuning& threadTuning();
+
+// Aplica fijación de CPU y prioridad del rol al hilo que la llama
+void applyThreadRole(ThreadRole role);
+std::string threadTuningSummary();
+// El modo no tiene un hilo con ese rol: si se pidió fijación o prioridad para él,
+// queda como aviso en threadTuningSummary y en el registro
+void noteThreadRoleIgnored(ThreadRole role, const char* reason);
+
+// Aplica un rol al hilo actual y restaura su afinidad/planificación al salir del bloque
+class ScopedThreadRole {
+public:
+    explicit ScopedThreadRole(ThreadRole role);
+    ~ScopedThreadRole();
+
+private:
+    cpu_set_t savedCpus;
+    int savedPolicy;
+    sched_param savedParam;
+    bool saved;
+};
+
+// Carga de fondo: hilos que giran sin parar para competir por los núcleos
+void startBackgroundLoad(int threads);
+void stopBackgroundLoad();
+
+// Duerme y registra en el histograma el retraso al despertar (µs)
+void measuredSleepUs(unsigned int micros, LatencyHistogram& jitter);
+
+// Desviación del intervalo entre frames respecto al periodo nominal (µs)
+class FrameJitterProbe {
+public:
+    explicit FrameJitterProbe(uint64_t periodNs) : period(periodNs), last(0) {}
+    void mark(LatencyHistogram& jitter);
+    void reset() { last = 0; }
+
+private:
+    uint64_t period;
+    uint64_t last;
+};
+
+#endif
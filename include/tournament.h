@@ -0,0 +1,13 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+// Torneos de IA sin terminal: round-robin o suizo sobre un pool con robo de trabajo,
+// Elo incremental y guardado masivo de resultados con HighScoreManager en un archivo
+// propio (pong_tournament.txt por omisión), separado de los puntajes del juego.
+// Uso: ./Pong --tournament [--format rr|swiss] [--rounds R] [--games G]
+//                          [--threads N] [--roster archivo] [--target P]
+//                          [--max-ticks T] [--seed S] [--scaling] [--no-save]
+//                          [--save-to archivo] [--rally-log archivo]
+int runTournament(int argc, char* argv[]);
+
+#endif
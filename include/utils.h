@@ -3,6 +3,8 @@
 
 int getch(void);
 int kbhit(void);
+void enterRawInput(void);
+void leaveRawInput(void);
 void gotoxy(int x, int y);
 
 #endif
\ No newline at end of file
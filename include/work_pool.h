@@ -0,0 +1,49 @@
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pool de hilos con robo de trabajo: cada hilo tiene su propia cola (LIFO para
+// sí mismo) y, cuando se queda sin tareas, roba del frente de las colas ajenas.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int numWorkers);
+    ~WorkStealingPool();
+
+    void submit(std::function<void()> task);
+    void waitIdle();
+    int size() const;
+    uint64_t stealCount() const;
+
+private:
+    struct WorkerQueue {
+        std::mutex queueMutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex stateMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+    std::atomic<int> queued;
+    std::atomic<int> unfinished;
+    std::atomic<bool> stopping;
+    std::atomic<unsigned> nextQueue;
+    std::atomic<uint64_t> steals;
+
+    void workerLoop(int id);
+    bool popLocal(int id, std::function<void()>& task);
+    bool steal(int id, std::function<void()>& task);
+};
+
+#endif
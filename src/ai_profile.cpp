@@ -0,0 +1,101 @@
+/****************************************************
+ * Archivo: ai_profile.cpp
+ * Descripción: Controladores de IA reutilizables sobre SimState. Reproducen la
+ *              persecución simple de los hilos CPU y la predicción con margen de error
+ *              de ai_opponent_thread, parametrizados por perfil para los torneos.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "ai_profile.h"
+#include "step_kernel.h"
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+
+static int predictArrivalY(const SimState& state, int targetX) {
+    float distance = static_cast<float>(targetX - state.ballX);
+    float timeToReach = distance / static_cast<float>(state.ballSpeedX);
+    float predictedY = state.ballY + (state.ballSpeedY * timeToReach);
+    while (predictedY < 0 || predictedY > HEIGHT) {
+        if (predictedY < 0) predictedY = -predictedY;
+        else if (predictedY > HEIGHT) predictedY = 2 * HEIGHT - predictedY;
+    }
+    return static_cast<int>(predictedY);
+}
+
+uint32_t aiSeed(uint32_t matchSeed, int side) {
+    // Mezcla (finalizador de murmur3) para que semillas vecinas no den flujos parecidos
+    uint32_t x = matchSeed ^ (0x9E3779B9u * static_cast<uint32_t>(side));
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    x ^= x >> 16;
+    return x != 0 ? x : 1u;     // xorshift no sale de 0
+}
+
+int aiDecide(const AIProfile& profile, const SimState& state, int side, uint32_t& rng) {
+    if (profile.jitter > 0.0f) {
+        rng = stepXorshift(rng);
+        float roll = (rng % 1000) / 1000.0f;
+        if (roll < profile.jitter) return 0;
+    }
+
+    int paddleY = (side == 1) ? state.paddle1Y : state.paddle2Y;
+    bool incoming = (side == 1) ? state.ballSpeedX < 0 : state.ballSpeedX > 0;
+    if (!incoming) return 0;
+
+    if (profile.kind == AIKind::CHASE) {
+        int targetY = state.ballY - PADDLE_HEIGHT / 2;
+        if (paddleY < targetY) return 1;
+        if (paddleY > targetY) return -1;
+        return 0;
+    }
+
+    int targetX = (side == 1) ? 1 : WIDTH - 2;
+    int targetY = predictArrivalY(state, targetX) - PADDLE_HEIGHT / 2;
+    int errorMargin = static_cast<int>(PADDLE_HEIGHT * (1.0f - profile.difficulty));
+    int center = paddleY + PADDLE_HEIGHT / 2;
+    if (center < targetY - errorMargin) return 1;
+    if (center > targetY + errorMargin) return -1;
+    return 0;
+}
+
+vector<AIProfile> defaultRoster() {
+    return {
+        {"Chase", AIKind::CHASE, 1.0f, 0.0f},
+        {"ChaseLento", AIKind::CHASE, 1.0f, 0.35f},
+        {"ChaseTorpe", AIKind::CHASE, 1.0f, 0.6f},
+        {"Predice100", AIKind::PREDICT, 1.0f, 0.0f},
+        {"Predice80", AIKind::PREDICT, 0.8f, 0.1f},
+        {"Predice50", AIKind::PREDICT, 0.5f, 0.2f},
+        {"Predice30", AIKind::PREDICT, 0.3f, 0.3f},
+        {"Novato", AIKind::PREDICT, 0.0f, 0.5f}
+    };
+}
+
+// Formato: una línea por perfil -> nombre tipo(chase|predict) dificultad jitter
+bool loadRoster(const string& path, vector<AIProfile>& roster) {
+    ifstream file(path);
+    if (!file.is_open()) return false;
+
+    roster.clear();
+    string line;
+    while (getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        stringstream ss(line);
+        AIProfile profile;
+        string kind;
+        if (ss >> profile.name >> kind >> profile.difficulty >> profile.jitter) {
+            profile.kind = (kind == "chase") ? AIKind::CHASE : AIKind::PREDICT;
+            roster.push_back(profile);
+        }
+    }
+    return !roster.empty();
+}
@@ -0,0 +1,101 @@
+/****************************************************
+ * Archivo: alloc_guard.cpp
+ * Descripción: Contador de reservas de memoria. Reemplaza operator new/delete del
+ *              programa (normal, arreglos, nothrow y alineado) por versiones sobre
+ *              malloc/free que suman un contador atómico. El bucle de juego lo lee una
+ *              vez por frame para comprobar que el estado estable no reserva nada.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "alloc_guard.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+static atomic<uint64_t> allocations(0);
+
+uint64_t allocationCount() {
+    return allocations.load(memory_order_relaxed);
+}
+
+static void* countedAlloc(size_t size) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    return malloc(size == 0 ? 1 : size);
+}
+
+static void* countedAlignedAlloc(size_t size, align_val_t align) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    void* ptr = nullptr;
+    size_t alignment = static_cast<size_t>(align);
+    if (alignment < sizeof(void*)) alignment = sizeof(void*);
+    if (posix_memalign(&ptr, alignment, size == 0 ? 1 : size) != 0) return nullptr;
+    return ptr;
+}
+
+void* operator new(size_t size) {
+    void* ptr = countedAlloc(size);
+    if (ptr == nullptr) throw bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    void* ptr = countedAlloc(size);
+    if (ptr == nullptr) throw bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new(size_t size, align_val_t align) {
+    void* ptr = countedAlignedAlloc(size, align);
+    if (ptr == nullptr) throw bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size, align_val_t align) {
+    void* ptr = countedAlignedAlloc(size, align);
+    if (ptr == nullptr) throw bad_alloc();
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+void operator delete(void* ptr, const nothrow_t&) noexcept { free(ptr); }
+void operator delete[](void* ptr, const nothrow_t&) noexcept { free(ptr); }
+void operator delete(void* ptr, align_val_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, align_val_t) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t, align_val_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t, align_val_t) noexcept { free(ptr); }
+
+// ===================== SONDA POR FRAME =====================
+
+void FrameAllocationProbe::reset() {
+    last = allocationCount();
+    frames = 0;
+    allocations = 0;
+    worst = 0;
+}
+
+void FrameAllocationProbe::mark() {
+    uint64_t now = allocationCount();
+    uint64_t delta = now - last;
+    last = now;
+    if (++frames <= WARMUP_FRAMES) return;
+    allocations += delta;
+    if (delta > worst) worst = delta;
+}
@@ -0,0 +1,550 @@
+/****************************************************
+ * Archivo: arena.cpp
+ * Descripción: Servidor de arena. Aloja muchas partidas jugador vs CPU en un solo
+ *              proceso, cada una en su propio pseudo-terminal o conexión de socket
+ *              Unix. Un planificador marca los ticks a 60 Hz y reparte el trabajo de
+ *              cada sesión (entrada, step(), pintado diferencial y escritura) en un
+ *              WorkStealingPool compartido. Mide la latencia de tick por sesión y el
+ *              CPU total a medida que crece el número de sesiones.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "arena.h"
+#include "ai_profile.h"
+#include "latency.h"
+#include "pong_render.h"
+#include "step_kernel.h"
+#include "work_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <poll.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+static const uint64_t TICK_NS = 1000000000ULL / 60;
+static const int TARGET_SCORE = 5;
+static const int MAX_PENDING_MOVES = 4;
+// Un repintado completo cabe sin reservar (la cola nunca pasa de un frame)
+static const size_t PENDING_RESERVE = 16384;
+
+struct ArenaOptions {
+    int sessions = 8;
+    int threads = 0;            // 0 = todos los núcleos
+    double duration = -1.0;     // sin indicar: 5 s en la prueba, hasta Ctrl-C como servidor
+    bool scaling = false;
+    bool attach = false;        // deja los PTY abiertos para conectarse a mano
+    string socketPath;
+};
+
+// Una partida: su estado, su renderer (con su propio TermEncoder) y sus métricas.
+// Solo la toca una tarea del pool a la vez (busy).
+struct ArenaSession {
+    int id;
+    int fd;                     // maestro del PTY o conexión del socket
+    int slave;                  // esclavo abierto por el servidor (-1 en sockets)
+    string name;
+    World world;
+    AIProfile cpu;
+    PongRenderer renderer;
+    int pendingMoves;
+    int escState;               // 0 = normal, 1 = ESC, 2 = ESC [
+    uint32_t seed;
+    uint32_t cpuRng;            // jitter de la CPU (aiSeed), aparte del RNG de la partida
+    int matchesPlayed;
+
+    atomic<bool> busy;
+    atomic<bool> closed;
+
+    LatencyHistogram tickLatency;
+    uint64_t ticks;
+    uint64_t overruns;          // ticks saltados porque el anterior no había terminado
+    uint64_t droppedFrames;     // frames omitidos: el cliente no terminó de leer el anterior
+    // Cola de una escritura corta: se envía antes del próximo frame (como pendingOut
+    // en PongRenderer); mientras quede algo no se arma otro
+    string pendingOut;
+    size_t pendingOffset;
+    uint64_t workNs;
+
+    ArenaSession() : id(0), fd(-1), slave(-1), pendingMoves(0), escState(0), seed(1), cpuRng(1), matchesPlayed(0),
+                     busy(false), closed(false), ticks(0), overruns(0), droppedFrames(0), pendingOffset(0), workNs(0) {
+        pendingOut.reserve(PENDING_RESERVE);
+    }
+};
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onStopSignal(int) {
+    stopRequested = 1;
+}
+
+static bool parseOptions(int argc, char* argv[], ArenaOptions& opts) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--sessions" && hasValue) opts.sessions = atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue) opts.threads = atoi(argv[++i]);
+        else if (arg == "--duration" && hasValue) opts.duration = atof(argv[++i]);
+        else if (arg == "--socket" && hasValue) opts.socketPath = argv[++i];
+        else if (arg == "--scaling") opts.scaling = true;
+        else if (arg == "--attach") opts.attach = true;
+        else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return false;
+        }
+    }
+    if (opts.threads <= 0) {
+        opts.threads = max(1u, thread::hardware_concurrency());
+    }
+    opts.sessions = max(0, opts.sessions);
+    return true;
+}
+
+static uint64_t processCpuNs() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000ULL +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000ULL;
+}
+
+// ===================== SESIONES =====================
+
+static void startMatch(ArenaSession& s) {
+    s.seed = stepXorshift(s.seed);
+    simInit(s.world, s.seed);
+    s.cpuRng = aiSeed(s.seed, 2);
+    s.renderer.updatePlayerNames("Jugador", s.cpu.name);
+    s.renderer.setStatusLine("Arena - " + s.name + " | partidas: " + to_string(s.matchesPlayed) +
+                             " | W/S o flechas, Q: salir");
+}
+
+static unique_ptr<ArenaSession> newSession(int id, int fd, int slave, const string& name,
+                                           const vector<AIProfile>& roster) {
+    unique_ptr<ArenaSession> s(new ArenaSession());
+    s->id = id;
+    s->fd = fd;
+    s->slave = slave;
+    s->name = name;
+    s->cpu = roster[id % roster.size()];
+    s->seed = 2025u + 7919u * static_cast<uint32_t>(id);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    startMatch(*s);
+    return s;
+}
+
+// Crea un PTY con el esclavo en modo crudo (sin eco ni ONLCR), del tamaño de la pantalla
+static unique_ptr<ArenaSession> newPtySession(int id, const vector<AIProfile>& roster) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        perror("posix_openpt");
+        if (master >= 0) close(master);
+        return nullptr;
+    }
+    const char* slaveName = ptsname(master);
+    int slave = slaveName ? open(slaveName, O_RDWR | O_NOCTTY) : -1;
+    if (slave < 0) {
+        perror("ptsname");
+        close(master);
+        return nullptr;
+    }
+    struct termios raw;
+    tcgetattr(slave, &raw);
+    cfmakeraw(&raw);
+    tcsetattr(slave, TCSANOW, &raw);
+    struct winsize ws = {static_cast<unsigned short>(SCREEN_ROWS), static_cast<unsigned short>(SCREEN_COLS), 0, 0};
+    ioctl(master, TIOCSWINSZ, &ws);
+    return newSession(id, master, slave, slaveName, roster);
+}
+
+static void closeSession(ArenaSession& s) {
+    if (s.fd >= 0) {
+        const char* bye = "\x1b[m\x1b[?25h\r\nArena cerrada\r\n";
+        if (write(s.fd, bye, strlen(bye)) < 0) { /* el cliente ya no está */ }
+        close(s.fd);
+        s.fd = -1;
+    }
+    if (s.slave >= 0) {
+        close(s.slave);
+        s.slave = -1;
+    }
+}
+
+// Teclas del jugador: W/S o flechas mueven la paleta, Q termina la sesión
+static void readInput(ArenaSession& s) {
+    char buf[256];
+    for (;;) {
+        ssize_t n = read(s.fd, buf, sizeof(buf));
+        if (n == 0 || (n < 0 && errno == EIO)) {
+            s.closed = true;    // el cliente cerró la conexión
+            return;
+        }
+        if (n < 0) return;
+        for (ssize_t i = 0; i < n; i++) {
+            char c = buf[i];
+            int move = 0;
+            if (s.escState == 1) {
+                s.escState = (c == '[') ? 2 : 0;
+                continue;
+            }
+            if (s.escState == 2) {
+                s.escState = 0;
+                move = (c == 'A') ? -1 : (c == 'B') ? 1 : 0;
+            } else if (c == '\x1b') {
+                s.escState = 1;
+            } else if (c == 'w' || c == 'W') {
+                move = -1;
+            } else if (c == 's' || c == 'S') {
+                move = 1;
+            } else if (c == 'q' || c == 'Q') {
+                s.closed = true;
+                return;
+            }
+            s.pendingMoves = stepClamp(s.pendingMoves + move, -MAX_PENDING_MOVES, MAX_PENDING_MOVES);
+        }
+    }
+}
+
+// Envía lo que quedó de una escritura corta; true si ya no queda nada
+static bool flushPending(ArenaSession& s) {
+    while (s.pendingOffset < s.pendingOut.size()) {
+        ssize_t n = write(s.fd, s.pendingOut.data() + s.pendingOffset, s.pendingOut.size() - s.pendingOffset);
+        if (n > 0) {
+            s.pendingOffset += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (n < 0 && (errno == EIO || errno == EPIPE)) s.closed = true;
+            return false;
+        }
+    }
+    s.pendingOut.clear();
+    s.pendingOffset = 0;
+    return true;
+}
+
+// Un tick completo de la sesión; corre en un hilo del pool
+static void tickSession(ArenaSession& s, uint64_t scheduledNs) {
+    uint64_t start = monotonicNowNs();
+    readInput(s);
+    if (!s.closed) {
+        int move1 = (s.pendingMoves > 0) - (s.pendingMoves < 0);
+        s.pendingMoves -= move1;
+        int move2 = aiDecide(s.cpu, s.world, 2, s.cpuRng);
+        if (step(s.world, Inputs{move1, move2}) != STEP_NO_SCORE &&
+            (s.world.scoreP1 >= TARGET_SCORE || s.world.scoreP2 >= TARGET_SCORE)) {
+            s.matchesPlayed++;
+            startMatch(s);
+        }
+
+        s.renderer.updateScores(s.world.scoreP1, s.world.scoreP2);
+        s.renderer.updatePaddles(s.world.paddle1Y, s.world.paddle2Y);
+        s.renderer.updateBall(s.world.ballX, s.world.ballY, s.world.ballSpeedX, s.world.ballSpeedY);
+        if (!flushPending(s)) {
+            // El cliente no alcanza a leer: sin armar este frame, el codificador sigue
+            // partiendo del último encolado y el próximo lleva el estado más reciente
+            if (!s.closed) s.droppedFrames++;
+        } else {
+            const string& bytes = s.renderer.encodeGame();
+            ssize_t written = write(s.fd, bytes.data(), bytes.size());
+            if (written < 0 && (errno == EIO || errno == EPIPE)) {
+                s.closed = true;
+            } else if (written < static_cast<ssize_t>(bytes.size())) {
+                // Escritura corta o EAGAIN: el resto sale antes del próximo frame
+                s.pendingOut.assign(bytes, static_cast<size_t>(max<ssize_t>(written, 0)), string::npos);
+                s.pendingOffset = 0;
+            }
+        }
+    }
+    if (s.closed) closeSession(s);    // Q o desconexión: el planificador ya no la toma
+    uint64_t end = monotonicNowNs();
+    s.workNs += end - start;
+    s.tickLatency.record((end - scheduledNs) / 1000);
+    s.ticks++;
+    s.busy.store(false, memory_order_release);
+}
+
+// ===================== CLIENTES SIMULADOS =====================
+
+// Proceso hijo: lee y descarta los frames de cada esclavo y manda teclas al azar
+static void runSimulatedClients(const vector<int>& slaves, double seconds) {
+    vector<struct pollfd> fds;
+    for (int fd : slaves) fds.push_back({fd, POLLIN, 0});
+    uint32_t rng = 12345;
+    char buf[8192];
+    uint64_t end = monotonicNowNs() + static_cast<uint64_t>((seconds + 2.0) * 1e9);
+    uint64_t nextKeys = 0;
+    while (monotonicNowNs() < end && getppid() != 1) {
+        if (poll(fds.data(), fds.size(), 10) > 0) {
+            for (auto& p : fds) {
+                if (p.revents & POLLIN) {
+                    if (read(p.fd, buf, sizeof(buf)) < 0) { /* se vuelve a intentar */ }
+                }
+            }
+        }
+        uint64_t now = monotonicNowNs();
+        if (now >= nextKeys) {
+            // Unas 10 teclas por segundo por jugador
+            for (int fd : slaves) {
+                rng = stepXorshift(rng);
+                if ((rng & 3) == 0) continue;
+                char key = (rng & 4) ? 'w' : 's';
+                if (write(fd, &key, 1) < 0) { /* sesión cerrada */ }
+            }
+            nextKeys = now + 100 * 1000000ULL;
+        }
+    }
+    _exit(0);
+}
+
+// ===================== SERVIDOR =====================
+
+static int openListener(const string& path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+struct ArenaRun {
+    double seconds = 0.0;
+    uint64_t cpuNs = 0;
+    LatencyHistogram latency;       // todas las sesiones juntas
+    uint64_t worstP99 = 0;
+    uint64_t ticks = 0;
+    uint64_t overruns = 0;
+    uint64_t dropped = 0;
+    uint64_t workNs = 0;
+};
+
+// Marca los ticks y reparte las sesiones vivas en el pool hasta que termine el tiempo
+static void serveSessions(vector<unique_ptr<ArenaSession>>& sessions, WorkStealingPool& pool,
+                          int listener, const vector<AIProfile>& roster, double duration) {
+    uint64_t start = monotonicNowNs();
+    uint64_t end = duration > 0 ? start + static_cast<uint64_t>(duration * 1e9) : UINT64_MAX;
+    uint64_t scheduled = start;
+    int nextId = static_cast<int>(sessions.size());
+
+    while (!stopRequested && scheduled < end) {
+        if (listener >= 0) {
+            int client;
+            while ((client = accept(listener, nullptr, nullptr)) >= 0) {
+                sessions.push_back(newSession(nextId, client, -1, "socket #" + to_string(nextId), roster));
+                cout << "Sesión " << nextId << ": cliente conectado por socket\n";
+                nextId++;
+            }
+        }
+
+        for (auto& session : sessions) {
+            ArenaSession* s = session.get();
+            if (s->closed) continue;
+            if (s->busy.exchange(true, memory_order_acquire)) {
+                s->overruns++;
+                continue;
+            }
+            pool.submit([s, scheduled] { tickSession(*s, scheduled); });
+        }
+
+        scheduled += TICK_NS;
+        uint64_t now = monotonicNowNs();
+        if (now > scheduled + TICK_NS) {
+            scheduled = now;    // muy atrasados: no acumular ticks
+        } else if (now < scheduled) {
+            usleep(static_cast<useconds_t>((scheduled - now) / 1000));
+        }
+    }
+    pool.waitIdle();
+}
+
+static ArenaRun collect(const vector<unique_ptr<ArenaSession>>& sessions) {
+    ArenaRun run;
+    for (const auto& s : sessions) {
+        run.latency.merge(s->tickLatency);
+        run.worstP99 = max(run.worstP99, s->tickLatency.percentile(99));
+        run.ticks += s->ticks;
+        run.overruns += s->overruns;
+        run.dropped += s->droppedFrames;
+        run.workNs += s->workNs;
+    }
+    return run;
+}
+
+// Prueba de carga: N sesiones PTY con clientes simulados en un proceso hijo
+static bool runLoad(int count, const ArenaOptions& opts, const vector<AIProfile>& roster,
+                    vector<unique_ptr<ArenaSession>>& sessions, ArenaRun& run) {
+    for (int i = 0; i < count; i++) {
+        unique_ptr<ArenaSession> s = newPtySession(i, roster);
+        if (!s) return false;
+        sessions.push_back(move(s));
+    }
+
+    vector<int> slaves;
+    for (auto& s : sessions) slaves.push_back(s->slave);
+    pid_t clients = fork();
+    if (clients < 0) {
+        perror("fork");
+        return false;
+    }
+    if (clients == 0) {
+        for (auto& s : sessions) close(s->fd);
+        runSimulatedClients(slaves, opts.duration);
+    }
+    // Los esclavos quedan solo en el hijo
+    for (auto& s : sessions) {
+        close(s->slave);
+        s->slave = -1;
+    }
+
+    WorkStealingPool pool(opts.threads);
+    uint64_t cpuStart = processCpuNs();
+    uint64_t start = monotonicNowNs();
+    serveSessions(sessions, pool, -1, roster, opts.duration);
+    run = collect(sessions);
+    run.seconds = (monotonicNowNs() - start) / 1e9;
+    run.cpuNs = processCpuNs() - cpuStart;
+
+    kill(clients, SIGTERM);
+    waitpid(clients, nullptr, 0);
+    for (auto& s : sessions) closeSession(*s);
+    return true;
+}
+
+static void printSessionTable(const vector<unique_ptr<ArenaSession>>& sessions) {
+    cout << left << setw(14) << "Sesión" << setw(9) << "Ticks" << setw(9) << "p50 ms" << setw(9) << "p99 ms"
+         << setw(9) << "máx ms" << setw(9) << "Atrasos" << setw(10) << "Omitidos" << "us/tick\n";
+    cout << "------------------------------------------------------------------------\n";
+    for (const auto& s : sessions) {
+        const LatencyHistogram& h = s->tickLatency;
+        string name = s->name.size() > 13 ? s->name.substr(s->name.size() - 13) : s->name;
+        cout << left << setw(14) << name << setw(9) << s->ticks << fixed << setprecision(2)
+             << setw(9) << h.percentile(50) / 1000.0 << setw(9) << h.percentile(99) / 1000.0
+             << setw(9) << h.max() / 1000.0 << setw(9) << s->overruns << setw(10) << s->droppedFrames
+             << setprecision(1) << (s->ticks ? s->workNs / 1000.0 / s->ticks : 0.0) << "\n";
+    }
+}
+
+static void printRunSummary(int count, int threads, const ArenaRun& run) {
+    cout << "\nSesiones: " << count << "  hilos: " << threads << " del pool + 1 planificador"
+         << " (con hilos propios serían ~" << count * 4 << ")\n";
+    cout << "Latencia de tick (ms): p50 " << fixed << setprecision(2) << run.latency.percentile(50) / 1000.0
+         << "  p99 " << run.latency.percentile(99) / 1000.0 << "  máx " << run.latency.max() / 1000.0
+         << "  (peor p99 de una sesión " << run.worstP99 / 1000.0 << ")\n";
+    cout << "CPU del servidor: " << setprecision(1) << 100.0 * run.cpuNs / (run.seconds * 1e9)
+         << "% de un núcleo  (" << (run.ticks ? run.cpuNs / 1000.0 / run.ticks : 0.0)
+         << " us por tick de sesión)\n";
+    cout << "Atrasos: " << run.overruns << "  frames omitidos (cliente lento): " << run.dropped << "\n";
+}
+
+int runArena(int argc, char* argv[]) {
+    ArenaOptions opts;
+    if (!parseOptions(argc, argv, opts)) return 2;
+    vector<AIProfile> roster = defaultRoster();
+    signal(SIGINT, onStopSignal);
+    signal(SIGTERM, onStopSignal);
+    signal(SIGPIPE, SIG_IGN);
+
+    cout << "========================================\n";
+    cout << "              ARENA PONG                \n";
+    cout << "========================================\n";
+
+    // Modo servidor: sesiones para conectarse a mano y/o por socket
+    if (opts.attach || !opts.socketPath.empty()) {
+        vector<unique_ptr<ArenaSession>> sessions;
+        for (int i = 0; i < opts.sessions; i++) {
+            unique_ptr<ArenaSession> s = newPtySession(i, roster);
+            if (!s) return 1;
+            cout << "Sesión " << i << ": " << s->name << "  (socat -,raw,echo=0 " << s->name << ")\n";
+            sessions.push_back(move(s));
+        }
+        int listener = -1;
+        if (!opts.socketPath.empty()) {
+            listener = openListener(opts.socketPath);
+            if (listener < 0) {
+                perror("socket");
+                return 1;
+            }
+            cout << "Socket: " << opts.socketPath << "  (socat -,raw,echo=0 UNIX-CONNECT:"
+                 << opts.socketPath << ")\n";
+        }
+        if (opts.duration < 0) opts.duration = 0;
+        cout << (opts.duration > 0 ? "Sirviendo partidas..." : "Sirviendo partidas (Ctrl-C para terminar)...")
+             << "\n\n";
+
+        WorkStealingPool pool(opts.threads);
+        uint64_t cpuStart = processCpuNs();
+        uint64_t start = monotonicNowNs();
+        serveSessions(sessions, pool, listener, roster, opts.duration);
+        ArenaRun run = collect(sessions);
+        run.seconds = (monotonicNowNs() - start) / 1e9;
+        run.cpuNs = processCpuNs() - cpuStart;
+        for (auto& s : sessions) closeSession(*s);
+        if (listener >= 0) {
+            close(listener);
+            unlink(opts.socketPath.c_str());
+        }
+        printSessionTable(sessions);
+        printRunSummary(static_cast<int>(sessions.size()), opts.threads, run);
+        return 0;
+    }
+
+    if (opts.duration <= 0) opts.duration = 5.0;
+    if (!opts.scaling) {
+        vector<unique_ptr<ArenaSession>> sessions;
+        ArenaRun run;
+        if (!runLoad(opts.sessions, opts, roster, sessions, run)) return 1;
+        if (sessions.size() <= 32) printSessionTable(sessions);
+        printRunSummary(opts.sessions, opts.threads, run);
+        return 0;
+    }
+
+    // Escalamiento: 1, 2, 4, ... sesiones con el mismo pool
+    cout << left << setw(10) << "Sesiones" << setw(10) << "CPU %" << setw(10) << "us/tick"
+         << setw(10) << "p50 ms" << setw(10) << "p99 ms" << setw(10) << "máx ms" << "Atrasos\n";
+    cout << "------------------------------------------------------------------\n";
+    vector<int> counts;
+    for (int n = 1; n < opts.sessions; n *= 2) counts.push_back(n);
+    counts.push_back(max(1, opts.sessions));
+    for (int count : counts) {
+        if (stopRequested) break;
+        vector<unique_ptr<ArenaSession>> sessions;
+        ArenaRun run;
+        if (!runLoad(count, opts, roster, sessions, run)) return 1;
+        cout << left << setw(10) << count << fixed << setprecision(1)
+             << setw(10) << 100.0 * run.cpuNs / (run.seconds * 1e9)
+             << setw(10) << (run.ticks ? run.cpuNs / 1000.0 / run.ticks : 0.0) << setprecision(2)
+             << setw(10) << run.latency.percentile(50) / 1000.0
+             << setw(10) << run.latency.percentile(99) / 1000.0
+             << setw(10) << run.latency.max() / 1000.0 << run.overruns << "\n";
+    }
+    return 0;
+}
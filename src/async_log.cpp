@@ -0,0 +1,416 @@
+/****************************************************
+ * Archivo: async_log.cpp
+ * Descripción: Registro asíncrono de mensajes. Cada hilo toma un anillo propio de
+ *              registros fijos (un productor, un consumidor, sin candados); el hilo
+ *              escritor duerme en un futex hasta que llega algo, junta unos pocos
+ *              milisegundos, ordena el lote por tiempo y lo escribe al archivo. Incluye el benchmark contra fprintf directo.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "async_log.h"
+#include "latency.h"
+#include "match_state.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Con registros pendientes el escritor junta durante este intervalo antes de escribir
+// (un write por lote); sin nada pendiente duerme en un futex hasta que llegue algo
+static const auto DRAIN_INTERVAL = chrono::milliseconds(5);
+
+struct LogRecord {
+    uint64_t stampNs;
+    uint32_t tid;
+    uint8_t level;
+    uint8_t len;
+    char text[LOG_TEXT_BYTES];
+};
+static_assert(sizeof(LogRecord) == 128, "un registro debe ocupar dos líneas de caché");
+
+enum RingState : uint8_t {
+    RING_FREE,
+    RING_OWNED,
+    RING_RETIRED        // el hilo terminó: el escritor lo libera cuando quede vacío
+};
+
+// head lo escribe solo el hilo dueño y tail solo el escritor: líneas separadas
+struct alignas(CACHE_LINE) LogRing {
+    atomic<uint32_t> head;
+    atomic<uint64_t> dropped;
+    uint32_t tid;
+    alignas(CACHE_LINE) atomic<uint32_t> tail;
+    atomic<uint8_t> state;
+    LogRecord records[LOG_RING_SLOTS];
+
+    LogRing() : head(0), dropped(0), tid(0), tail(0), state(RING_FREE) {}
+};
+
+static LogRing rings[LOG_MAX_THREADS];
+static atomic<int> ringsUsed(0);                // rings[0, ringsUsed) fueron tomados alguna vez
+static atomic<uint64_t> droppedNoRing(0);
+static atomic<uint64_t> writtenRecords(0);
+static atomic<int> minLevel(LOG_INFO);
+static atomic<bool> logOpened(false);
+
+static mutex lifecycleMutex;                    // logOpen / logClose
+static FILE* logFile = nullptr;
+static uint64_t openNs = 0;
+static thread writer;
+static mutex wakeMutex;
+static condition_variable wakeCond;
+static atomic<bool> stopping(false);
+// Timbre del escritor (futex): 1 mientras duerme sin nada pendiente. El productor que
+// lo ve en 1 lo pone en 0 y lo despierta; si no, nadie hace llamadas al sistema
+static atomic<uint32_t> writerIdle(0);
+
+static const char* LEVEL_NAMES[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+
+// El dato (head o stopping) ya publicado antes de mirar el timbre: o el escritor lo
+// ve al revisar antes de dormir, o aquí se ve que duerme
+static void ringDoorbell() {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (writerIdle.load(memory_order_seq_cst) == 1 && writerIdle.exchange(0, memory_order_seq_cst) == 1) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&writerIdle), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+}
+
+// Devuelve el anillo al terminar el hilo
+struct RingHandle {
+    LogRing* ring = nullptr;
+    ~RingHandle() {
+        if (ring != nullptr) ring->state.store(RING_RETIRED, memory_order_release);
+    }
+};
+static thread_local RingHandle localRing;
+
+static LogRing* claimRing() {
+    for (int i = 0; i < LOG_MAX_THREADS; i++) {
+        uint8_t expected = RING_FREE;
+        if (rings[i].state.compare_exchange_strong(expected, RING_OWNED, memory_order_acq_rel)) {
+            rings[i].tid = static_cast<uint32_t>(syscall(SYS_gettid));
+            int used = ringsUsed.load(memory_order_relaxed);
+            while (used < i + 1 && !ringsUsed.compare_exchange_weak(used, i + 1, memory_order_release)) {
+            }
+            return &rings[i];
+        }
+    }
+    return nullptr;
+}
+
+void logWrite(LogLevel level, const char* format, ...) {
+    if (level < minLevel.load(memory_order_relaxed)) return;
+    va_list args;
+    va_start(args, format);
+
+    if (!logOpened.load(memory_order_acquire)) {
+        // Sin registro abierto (herramientas de consola): directo a stderr
+        char line[LOG_TEXT_BYTES * 2];
+        vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+        fprintf(stderr, "%s\n", line);
+        return;
+    }
+
+    LogRing* ring = localRing.ring;
+    if (ring == nullptr) ring = localRing.ring = claimRing();
+    if (ring == nullptr) {
+        va_end(args);
+        droppedNoRing.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    uint32_t head = ring->head.load(memory_order_relaxed);
+    if (head - ring->tail.load(memory_order_acquire) >= static_cast<uint32_t>(LOG_RING_SLOTS)) {
+        va_end(args);
+        ring->dropped.store(ring->dropped.load(memory_order_relaxed) + 1, memory_order_relaxed);
+        return;
+    }
+    LogRecord& record = ring->records[head % LOG_RING_SLOTS];
+    record.stampNs = monotonicNowNs();
+    record.tid = ring->tid;
+    record.level = static_cast<uint8_t>(level);
+    int len = vsnprintf(record.text, LOG_TEXT_BYTES, format, args);
+    va_end(args);
+    record.len = static_cast<uint8_t>(max(0, min(len, LOG_TEXT_BYTES - 1)));
+    ring->head.store(head + 1, memory_order_release);
+    ringDoorbell();
+}
+
+uint64_t logDropped() {
+    uint64_t total = droppedNoRing.load(memory_order_relaxed);
+    for (int i = 0; i < LOG_MAX_THREADS; i++) total += rings[i].dropped.load(memory_order_relaxed);
+    return total;
+}
+
+uint64_t logWritten() {
+    return writtenRecords.load(memory_order_relaxed);
+}
+
+// Copia lo pendiente de todos los anillos y libera los de hilos que ya terminaron
+static void collect(vector<LogRecord>& batch) {
+    int used = ringsUsed.load(memory_order_acquire);
+    for (int i = 0; i < used; i++) {
+        LogRing& ring = rings[i];
+        uint8_t state = ring.state.load(memory_order_acquire);
+        if (state == RING_FREE) continue;
+        uint32_t tail = ring.tail.load(memory_order_relaxed);
+        uint32_t head = ring.head.load(memory_order_acquire);
+        for (; tail != head; tail++) batch.push_back(ring.records[tail % LOG_RING_SLOTS]);
+        ring.tail.store(tail, memory_order_release);
+        if (state == RING_RETIRED) {
+            uint8_t expected = RING_RETIRED;
+            ring.state.compare_exchange_strong(expected, RING_FREE, memory_order_acq_rel);
+        }
+    }
+}
+
+static bool anyPending() {
+    int used = ringsUsed.load(memory_order_acquire);
+    for (int i = 0; i < used; i++) {
+        const LogRing& ring = rings[i];
+        if (ring.state.load(memory_order_acquire) == RING_FREE) continue;
+        if (ring.head.load(memory_order_acquire) != ring.tail.load(memory_order_relaxed)) return true;
+    }
+    return false;
+}
+
+// Duerme hasta que un productor toque el timbre (o logClose); nunca por tiempo
+static void waitForWork() {
+    writerIdle.store(1, memory_order_seq_cst);
+    atomic_thread_fence(memory_order_seq_cst);
+    while (writerIdle.load(memory_order_seq_cst) == 1) {
+        if (anyPending() || stopping.load(memory_order_acquire)) {
+            writerIdle.store(0, memory_order_relaxed);
+            return;
+        }
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&writerIdle), FUTEX_WAIT, 1, nullptr, nullptr, 0);
+    }
+}
+
+static void formatRecord(string& out, const LogRecord& record) {
+    char prefix[64];
+    double seconds = record.stampNs >= openNs ? (record.stampNs - openNs) / 1e9 : 0.0;
+    int len = snprintf(prefix, sizeof(prefix), "%12.6f %-5s [%u] ", seconds, LEVEL_NAMES[record.level], record.tid);
+    out.append(prefix, static_cast<size_t>(len));
+    out.append(record.text, record.len);
+    out += '\n';
+}
+
+static void writerLoop() {
+    vector<LogRecord> batch;
+    string out;
+    uint64_t reportedDrops = logDropped();
+    for (;;) {
+        bool stop = stopping.load(memory_order_acquire);
+        batch.clear();
+        collect(batch);
+        // Cada anillo ya está en orden; ordenar el lote intercala los hilos por tiempo
+        stable_sort(batch.begin(), batch.end(),
+                    [](const LogRecord& a, const LogRecord& b) { return a.stampNs < b.stampNs; });
+        out.clear();
+        for (const LogRecord& record : batch) formatRecord(out, record);
+        uint64_t drops = logDropped();
+        if (drops != reportedDrops) {
+            char line[96];
+            double seconds = (monotonicNowNs() - openNs) / 1e9;
+            int len = snprintf(line, sizeof(line), "%12.6f %-5s [registro] %llu mensajes descartados\n", seconds,
+                               LEVEL_NAMES[LOG_WARN], static_cast<unsigned long long>(drops - reportedDrops));
+            out.append(line, static_cast<size_t>(len));
+            reportedDrops = drops;
+        }
+        if (!out.empty()) {
+            fwrite(out.data(), 1, out.size(), logFile);
+            fflush(logFile);
+            writtenRecords.fetch_add(batch.size(), memory_order_relaxed);
+        }
+        if (stop) return;
+        // Sin nada pendiente no hay despertares periódicos (la partida en pausa queda
+        // quieta); con algo pendiente se deja juntar un lote antes de escribirlo
+        waitForWork();
+        unique_lock<mutex> lock(wakeMutex);
+        wakeCond.wait_for(lock, DRAIN_INTERVAL, [] { return stopping.load(memory_order_acquire); });
+    }
+}
+
+bool logOpen(const string& path, LogLevel level) {
+    logClose();
+    lock_guard<mutex> lock(lifecycleMutex);
+    logFile = fopen(path.c_str(), "a");
+    if (logFile == nullptr) return false;
+    // El hilo escritor debe terminar antes de que se destruya su std::thread
+    static bool exitHookRegistered = false;
+    if (!exitHookRegistered) exitHookRegistered = (atexit(logClose) == 0);
+    openNs = monotonicNowNs();
+    minLevel.store(level, memory_order_relaxed);
+    stopping.store(false, memory_order_release);
+    logOpened.store(true, memory_order_release);
+    writer = thread(writerLoop);
+    logWrite(LOG_INFO, "registro abierto (pid %d)", static_cast<int>(getpid()));
+    return true;
+}
+
+void logClose() {
+    lock_guard<mutex> lock(lifecycleMutex);
+    if (!logOpened.exchange(false, memory_order_acq_rel)) return;
+    {
+        lock_guard<mutex> wake(wakeMutex);
+        stopping.store(true, memory_order_release);
+    }
+    wakeCond.notify_one();
+    ringDoorbell();
+    writer.join();
+    fclose(logFile);
+    logFile = nullptr;
+}
+
+bool logIsOpen() {
+    return logOpened.load(memory_order_acquire);
+}
+
+void logSetLevel(LogLevel level) {
+    minLevel.store(level, memory_order_relaxed);
+}
+
+bool logParseLevel(const char* name, LogLevel& level) {
+    static const char* names[] = {"debug", "info", "warn", "error"};
+    for (int i = 0; i <= LOG_ERROR; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ===================== BENCHMARK =====================
+
+struct LogBenchOptions {
+    int threads = 4;
+    int messages = 100000;          // por hilo
+    int burst = 8;                  // mensajes seguidos antes de la pausa
+    int pauseUs = 1000;
+    string outPath = "/tmp/pong_log_bench.log";
+};
+
+struct LogBenchResult {
+    LatencyHistogram callNs;        // el histograma no tiene unidad: aquí guarda ns
+    double totalNs = 0;
+    uint64_t calls = 0;
+};
+
+// Llamada síncrona equivalente a escribir directo: candado, fprintf y fflush
+static mutex syncMutex;
+static FILE* syncFile = nullptr;
+
+static void syncWrite(int thread, int message) {
+    lock_guard<mutex> lock(syncMutex);
+    fprintf(syncFile, "%12.6f %-5s [%d] hilo %d mensaje %d\n", monotonicNowNs() / 1e9, "INFO",
+            static_cast<int>(syscall(SYS_gettid)), thread, message);
+    fflush(syncFile);
+}
+
+static void benchProducer(const LogBenchOptions& opts, int id, bool async, LogBenchResult& result) {
+    for (int m = 0; m < opts.messages; m++) {
+        uint64_t start = monotonicNowNs();
+        if (async) logWrite(LOG_INFO, "hilo %d mensaje %d", id, m);
+        else syncWrite(id, m);
+        uint64_t elapsed = monotonicNowNs() - start;
+        result.callNs.record(elapsed);
+        result.totalNs += static_cast<double>(elapsed);
+        result.calls++;
+        if (opts.burst > 0 && (m + 1) % opts.burst == 0) usleep(static_cast<useconds_t>(opts.pauseUs));
+    }
+}
+
+static LogBenchResult runProducers(const LogBenchOptions& opts, bool async) {
+    vector<LogBenchResult> results(opts.threads);
+    vector<thread> threads;
+    for (int t = 0; t < opts.threads; t++) {
+        threads.emplace_back(benchProducer, cref(opts), t, async, ref(results[t]));
+    }
+    for (thread& t : threads) t.join();
+    LogBenchResult merged;
+    for (const LogBenchResult& r : results) {
+        merged.callNs.merge(r.callNs);
+        merged.totalNs += r.totalNs;
+        merged.calls += r.calls;
+    }
+    return merged;
+}
+
+static void printBenchRow(const char* name, const LogBenchResult& r, uint64_t written, uint64_t dropped) {
+    cout << left << setw(20) << name << setw(10) << static_cast<long long>(r.totalNs / max<uint64_t>(1, r.calls))
+         << setw(10) << r.callNs.percentile(50) << setw(10) << r.callNs.percentile(99) << setw(12) << r.callNs.max()
+         << setw(11) << written << dropped << "\n";
+}
+
+int runLogBench(int argc, char* argv[]) {
+    LogBenchOptions opts;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--threads" && hasValue) opts.threads = max(1, atoi(argv[++i]));
+        else if (arg == "--messages" && hasValue) opts.messages = max(1, atoi(argv[++i]));
+        else if (arg == "--burst" && hasValue) opts.burst = max(0, atoi(argv[++i]));
+        else if (arg == "--pause-us" && hasValue) opts.pauseUs = max(0, atoi(argv[++i]));
+        else if (arg == "--out" && hasValue) opts.outPath = argv[++i];
+        else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    unlink(opts.outPath.c_str());
+    if (!logOpen(opts.outPath, LOG_DEBUG)) {
+        cerr << "No se pudo abrir " << opts.outPath << "\n";
+        return 1;
+    }
+    uint64_t writtenBefore = logWritten();
+    uint64_t droppedBefore = logDropped();
+    LogBenchResult async = runProducers(opts, true);
+    logClose();
+    uint64_t asyncWritten = logWritten() - writtenBefore;
+    uint64_t asyncDropped = logDropped() - droppedBefore;
+
+    string syncPath = opts.outPath + ".sync";
+    syncFile = fopen(syncPath.c_str(), "w");
+    if (syncFile == nullptr) {
+        cerr << "No se pudo abrir " << syncPath << "\n";
+        return 1;
+    }
+    LogBenchResult sync = runProducers(opts, false);
+    fclose(syncFile);
+    syncFile = nullptr;
+
+    cout << "========================================\n";
+    cout << "       REGISTRO ASÍNCRONO - PRUEBA      \n";
+    cout << "========================================\n";
+    cout << opts.threads << " hilos x " << opts.messages << " mensajes, ráfagas de " << opts.burst
+         << " con pausas de " << opts.pauseUs << " us\n\n";
+    cout << left << setw(20) << "Modo" << setw(10) << "media ns" << setw(10) << "p50 ns" << setw(10) << "p99 ns"
+         << setw(12) << "máx ns" << setw(11) << "escritos" << "descartados\n";
+    printBenchRow("anillos por hilo", async, asyncWritten, asyncDropped);
+    printBenchRow("fprintf + fflush", sync, sync.calls, 0);
+    cout << "\nArchivos: " << opts.outPath << "  " << syncPath << "\n";
+    return 0;
+}
@@ -0,0 +1,461 @@
+/****************************************************
+ * Archivo: bot_api.cpp
+ * Descripción: API de bots por memoria compartida. El juego publica el estado de cada
+ *              tick en un segmento POSIX con un seqlock (y despierta a los bots con un
+ *              futex); cada bot contesta en su slot de comando con un store atómico.
+ *              Si el comando no llega antes del plazo juega la IA integrada. Incluye
+ *              partidas bot contra bot sin terminal y un cliente de referencia.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "bot_api.h"
+#include "ai_profile.h"
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <linux/futex.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace std;
+
+static_assert(sizeof(BotCommandSlot) == 64, "slot de comando de 64 bytes");
+static_assert(offsetof(BotSegment, seq) == 64, "seq en el offset 64");
+static_assert(offsetof(BotSegment, ballX) == 76, "estado en el offset 76");
+static_assert(offsetof(BotSegment, status) == 108, "estado de la partida en el offset 108");
+static_assert(offsetof(BotSegment, publishNs) == 112, "publishNs en el offset 112");
+static_assert(offsetof(BotSegment, slots) == 128, "slots en el offset 128");
+static_assert(sizeof(BotSegment) == 256, "segmento de 256 bytes");
+static_assert(atomic<uint64_t>::is_always_lock_free, "los slots deben ser sin locks");
+
+static const char BOT_MAGIC[8] = {'P', 'O', 'N', 'G', 'B', 'O', 'T', '1'};
+static const uint32_t BOT_VERSION = 1;
+static const uint32_t REFRESH_FRAMES = 64;
+
+static string segmentName(const string& name) {
+    return "/pong-bot-" + name;
+}
+
+static void futexWake(atomic<uint32_t>& word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+static void futexWait(atomic<uint32_t>& word, uint32_t expected, uint64_t timeoutNs) {
+    struct timespec timeout = {static_cast<time_t>(timeoutNs / 1000000000ULL),
+                               static_cast<long>(timeoutNs % 1000000000ULL)};
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+static bool processAlive(uint32_t pid) {
+    return pid != 0 && (kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM);
+}
+
+// ===================== LADO DEL JUEGO =====================
+
+BotServer::BotServer() : segment(nullptr), frame(0), publishNs(0), attachedMask(0) {
+    resetStats();
+}
+
+BotServer::~BotServer() {
+    close();
+}
+
+bool BotServer::create(const string& name, uint32_t deadlineUs) {
+    close();
+    shmName = segmentName(name);
+    shm_unlink(shmName.c_str());   // segmento de una ejecución anterior
+    int fd = shm_open(shmName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return false;
+    if (ftruncate(fd, sizeof(BotSegment)) != 0) {
+        ::close(fd);
+        shm_unlink(shmName.c_str());
+        return false;
+    }
+    void* memory = mmap(nullptr, sizeof(BotSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) {
+        shm_unlink(shmName.c_str());
+        return false;
+    }
+    segment = static_cast<BotSegment*>(memory);
+    memset(static_cast<void*>(segment), 0, sizeof(BotSegment));
+    segment->version = BOT_VERSION;
+    segment->width = WIDTH;
+    segment->height = HEIGHT;
+    segment->paddleHeight = PADDLE_HEIGHT;
+    segment->deadlineUs = deadlineUs;
+    // El magic va al final: un bot que lo ve encuentra el encabezado completo
+    atomic_thread_fence(memory_order_release);
+    memcpy(segment->magic, BOT_MAGIC, sizeof(BOT_MAGIC));
+    frame = 0;
+    attachedMask = 0;
+    return true;
+}
+
+void BotServer::close() {
+    if (segment == nullptr) return;
+    uint32_t s = segment->seq.load(memory_order_relaxed);
+    segment->seq.store(s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    segment->status = BOT_STATUS_CLOSED;
+    segment->seq.store(s + 2, memory_order_release);
+    futexWake(segment->seq);
+    munmap(segment, sizeof(BotSegment));
+    shm_unlink(shmName.c_str());
+    segment = nullptr;
+    attachedMask = 0;
+}
+
+void BotServer::refreshBots() {
+    if (segment == nullptr) return;
+    uint32_t mask = 0;
+    for (int p = 0; p < 2; p++) {
+        if (processAlive(segment->slots[p].botPid.load(memory_order_relaxed))) mask |= 1u << p;
+    }
+    attachedMask = mask;
+}
+
+void BotServer::publish(const World& world, uint32_t status) {
+    if (segment == nullptr) return;
+    frame++;
+    uint32_t s = segment->seq.load(memory_order_relaxed);
+    segment->seq.store(s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    segment->frame = frame;
+    segment->tick = world.tick;
+    segment->ballX = world.ballX;
+    segment->ballY = world.ballY;
+    segment->ballSpeedX = world.ballSpeedX;
+    segment->ballSpeedY = world.ballSpeedY;
+    segment->paddle1Y = world.paddle1Y;
+    segment->paddle2Y = world.paddle2Y;
+    segment->scoreP1 = world.scoreP1;
+    segment->scoreP2 = world.scoreP2;
+    segment->status = status;
+    publishNs = monotonicNowNs();
+    segment->publishNs = publishNs;
+    segment->seq.store(s + 2, memory_order_release);
+    futexWake(segment->seq);
+    pending[0] = pending[1] = false;
+    if (frame % REFRESH_FRAMES == 1) refreshBots();
+}
+
+bool BotServer::poll(int player, int& move) {
+    int idx = player - 1;
+    if (pending[idx]) {
+        move = pendingMove[idx];
+        return true;
+    }
+    if (segment == nullptr || frame == 0) return false;
+    BotCommandSlot& slot = segment->slots[idx];
+    uint64_t word = slot.command.load(memory_order_acquire);
+    uint32_t code = static_cast<uint32_t>(word);
+    if (static_cast<uint32_t>(word >> 32) != frame || code > 2) return false;
+    uint64_t now = monotonicNowNs();
+    uint64_t sent = slot.sentNs.load(memory_order_relaxed);
+    // Con sentNs del bot se mide su respuesta exacta; si no, cuando el juego la vio
+    responseNs[idx].record((sent >= publishNs && sent <= now) ? sent - publishNs : now - publishNs);
+    received[idx]++;
+    pendingMove[idx] = static_cast<int>(code) - 1;
+    pending[idx] = true;
+    move = pendingMove[idx];
+    return true;
+}
+
+void BotServer::waitCommands(uint64_t deadlineNs) {
+    while (true) {
+        bool done = true;
+        int move;
+        for (int player = 1; player <= 2; player++) {
+            if (attached(player) && !poll(player, move)) done = false;
+        }
+        if (done || monotonicNowNs() >= deadlineNs) return;
+        // Con un solo núcleo el bot necesita el procesador para contestar
+        sched_yield();
+    }
+}
+
+bool BotServer::take(int player, int& move) {
+    if (!attached(player)) return false;
+    if (poll(player, move)) return true;
+    if (frame > 0) missed[player - 1]++;
+    return false;
+}
+
+void BotServer::resetStats() {
+    for (int p = 0; p < 2; p++) {
+        pending[p] = false;
+        pendingMove[p] = 0;
+        received[p] = 0;
+        missed[p] = 0;
+        responseNs[p].reset();
+    }
+}
+
+// ===================== LADO DEL BOT =====================
+
+BotClient::BotClient() : segment(nullptr), slot(0) {}
+
+BotClient::~BotClient() {
+    close();
+}
+
+bool BotClient::open(const string& name, int player) {
+    close();
+    int fd = shm_open(segmentName(name).c_str(), O_RDWR, 0);
+    if (fd < 0) return false;
+    void* memory = mmap(nullptr, sizeof(BotSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED) return false;
+    BotSegment* candidate = static_cast<BotSegment*>(memory);
+    if (memcmp(candidate->magic, BOT_MAGIC, sizeof(BOT_MAGIC)) != 0 || candidate->version != BOT_VERSION) {
+        munmap(memory, sizeof(BotSegment));
+        return false;
+    }
+    slot = player - 1;
+    uint32_t owner = candidate->slots[slot].botPid.load(memory_order_relaxed);
+    if (owner != 0 && owner != static_cast<uint32_t>(getpid()) && processAlive(owner)) {
+        munmap(memory, sizeof(BotSegment));
+        return false;
+    }
+    segment = candidate;
+    segment->slots[slot].botPid.store(static_cast<uint32_t>(getpid()), memory_order_release);
+    return true;
+}
+
+void BotClient::close() {
+    if (segment == nullptr) return;
+    segment->slots[slot].botPid.store(0, memory_order_release);
+    munmap(segment, sizeof(BotSegment));
+    segment = nullptr;
+}
+
+bool BotClient::waitState(uint32_t lastSeq, BotView& view, int timeoutMs) {
+    uint64_t deadline = monotonicNowNs() + static_cast<uint64_t>(timeoutMs) * 1000000ULL;
+    while (true) {
+        uint32_t s1 = segment->seq.load(memory_order_acquire);
+        if (s1 != lastSeq && (s1 & 1) == 0) {
+            view.frame = segment->frame;
+            view.status = segment->status;
+            view.publishNs = segment->publishNs;
+            view.world.tick = segment->tick;
+            view.world.ballX = segment->ballX;
+            view.world.ballY = segment->ballY;
+            view.world.ballSpeedX = segment->ballSpeedX;
+            view.world.ballSpeedY = segment->ballSpeedY;
+            view.world.paddle1Y = segment->paddle1Y;
+            view.world.paddle2Y = segment->paddle2Y;
+            view.world.scoreP1 = segment->scoreP1;
+            view.world.scoreP2 = segment->scoreP2;
+            view.world.rng = 0x9E3779B9u ^ segment->frame;
+            atomic_thread_fence(memory_order_acquire);
+            if (segment->seq.load(memory_order_relaxed) == s1) {
+                view.seq = s1;
+                return true;
+            }
+            continue;
+        }
+        uint64_t now = monotonicNowNs();
+        if (now >= deadline) return false;
+        if (s1 & 1) {
+            sched_yield();      // el juego está escribiendo: unos pocos ns
+        } else {
+            futexWait(segment->seq, s1, min<uint64_t>(deadline - now, 10000000ULL));
+        }
+    }
+}
+
+void BotClient::send(uint32_t frame, int move) {
+    BotCommandSlot& cmd = segment->slots[slot];
+    cmd.sentNs.store(monotonicNowNs(), memory_order_relaxed);
+    cmd.command.store((static_cast<uint64_t>(frame) << 32) | static_cast<uint32_t>(move + 1),
+                      memory_order_release);
+}
+
+// ===================== PARTIDAS BOT CONTRA BOT =====================
+
+struct BotMatchOptions {
+    string name = "pong";
+    int games = 1;
+    int targetScore = 5;
+    int maxTicks = 20000;
+    uint32_t deadlineUs = 1000;
+    double waitBots = 10.0;     // segundos esperando a que se conecten los bots
+    bool realtime = false;      // 60 Hz como el juego en vez de a toda velocidad
+    uint32_t seed = 2025;
+};
+
+static bool parseMatchOptions(int argc, char* argv[], BotMatchOptions& opts) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--shm" && hasValue) opts.name = argv[++i];
+        else if (arg == "--games" && hasValue) opts.games = atoi(argv[++i]);
+        else if (arg == "--target" && hasValue) opts.targetScore = atoi(argv[++i]);
+        else if (arg == "--max-ticks" && hasValue) opts.maxTicks = atoi(argv[++i]);
+        else if (arg == "--deadline-us" && hasValue) opts.deadlineUs = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (arg == "--wait-bots" && hasValue) opts.waitBots = atof(argv[++i]);
+        else if (arg == "--seed" && hasValue) opts.seed = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (arg == "--realtime") opts.realtime = true;
+        else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return false;
+        }
+    }
+    if (opts.games <= 0 || opts.targetScore <= 0 || opts.maxTicks <= 0) {
+        cerr << "Partidas, puntaje objetivo y ticks deben ser positivos\n";
+        return false;
+    }
+    return true;
+}
+
+int runBotMatch(int argc, char* argv[]) {
+    BotMatchOptions opts;
+    if (!parseMatchOptions(argc, argv, opts)) return 2;
+
+    const uint64_t TICK_NS = 1000000000ULL / 60;
+    BotServer server;
+    if (!server.create(opts.name, opts.realtime ? static_cast<uint32_t>(TICK_NS / 1000) : opts.deadlineUs)) {
+        cerr << "No se pudo crear el segmento " << segmentName(opts.name) << ": " << strerror(errno) << "\n";
+        return 1;
+    }
+    cout << "Segmento: /dev/shm" << server.path() << "  (esperando bots hasta " << opts.waitBots << " s)\n";
+    cout.flush();
+
+    // Mientras se conectan los bots se publica el saque con estado "terminada"
+    SimState state;
+    simInit(state, opts.seed);
+    uint64_t waitEnd = monotonicNowNs() + static_cast<uint64_t>(opts.waitBots * 1e9);
+    while (monotonicNowNs() < waitEnd && !(server.attached(1) && server.attached(2))) {
+        server.publish(state, BOT_STATUS_MATCH_OVER);
+        server.refreshBots();
+        usleep(20 * 1000);
+    }
+    bool bots[2] = {server.attached(1), server.attached(2)};
+    for (int p = 0; p < 2; p++) {
+        cout << "P" << (p + 1) << ": " << (bots[p] ? "bot externo" : "IA integrada (sin bot)") << "\n";
+    }
+    server.resetStats();
+
+    // IA integrada para lados sin bot y para comandos fuera de plazo
+    const AIProfile fallback = {"Integrada", AIKind::PREDICT, 0.8f, 0.1f};
+    uint64_t totalTicks = 0;
+    uint64_t start = monotonicNowNs();
+    uint64_t nextTick = start;
+    for (int game = 0; game < opts.games; game++) {
+        uint32_t gameSeed = opts.seed + static_cast<uint32_t>(game) * 7919u;
+        simInit(state, gameSeed);
+        uint32_t fallbackRng[2] = {aiSeed(gameSeed, 1), aiSeed(gameSeed, 2)};
+        while (state.scoreP1 < opts.targetScore && state.scoreP2 < opts.targetScore &&
+               static_cast<int>(state.tick) < opts.maxTicks) {
+            server.publish(state, BOT_STATUS_PLAYING);
+            uint64_t deadline = opts.realtime ? nextTick + TICK_NS
+                                              : monotonicNowNs() + opts.deadlineUs * 1000ULL;
+            server.waitCommands(deadline);
+            int moves[2];
+            for (int player = 1; player <= 2; player++) {
+                if (!server.take(player, moves[player - 1])) moves[player - 1] = aiDecide(fallback, state, player, fallbackRng[player - 1]);
+            }
+            step(state, Inputs{moves[0], moves[1]});
+            totalTicks++;
+            if (opts.realtime) {
+                nextTick += TICK_NS;
+                uint64_t now = monotonicNowNs();
+                if (nextTick > now) usleep(static_cast<useconds_t>((nextTick - now) / 1000));
+                else nextTick = now;
+            }
+        }
+        server.publish(state, BOT_STATUS_MATCH_OVER);
+        cout << "Partida " << (game + 1) << ": " << state.scoreP1 << " - " << state.scoreP2
+             << "  (" << state.tick << " ticks)\n";
+    }
+    double secs = (monotonicNowNs() - start) / 1e9;
+
+    cout << "Ticks: " << totalTicks << " en " << fixed << setprecision(2) << secs << " s  ("
+         << static_cast<long long>(totalTicks / secs) << " ticks/s"
+         << (opts.realtime ? ", 60 Hz" : ", sin terminal") << ")\n";
+    for (int player = 1; player <= 2; player++) {
+        if (!bots[player - 1]) continue;
+        uint64_t total = server.commands(player) + server.misses(player);
+        const LatencyHistogram& lat = server.latency(player);
+        cout << "P" << player << ": " << server.commands(player) << " comandos, "
+             << server.misses(player) << " fuera de plazo ("
+             << (total ? 100.0 * server.misses(player) / total : 0.0) << "%), tick -> comando us p50 "
+             << lat.percentile(50) / 1000.0 << " p99 " << lat.percentile(99) / 1000.0
+             << " máx " << lat.max() / 1000.0 << "\n";
+    }
+    server.close();
+    return 0;
+}
+
+// ===================== CLIENTE DE REFERENCIA =====================
+
+int runBotClient(int argc, char* argv[]) {
+    string name = "pong";
+    int player = 2;
+    int delayUs = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--shm" && hasValue) name = argv[++i];
+        else if (arg == "--player" && hasValue) player = atoi(argv[++i]);
+        else if (arg == "--delay-us" && hasValue) delayUs = atoi(argv[++i]);
+        else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return 2;
+        }
+    }
+    if (player != 1 && player != 2) {
+        cerr << "--player debe ser 1 o 2\n";
+        return 2;
+    }
+
+    // El servidor puede arrancar después que el bot
+    BotClient client;
+    uint64_t openDeadline = monotonicNowNs() + 10000000000ULL;
+    while (!client.open(name, player)) {
+        if (monotonicNowNs() > openDeadline) {
+            cerr << "No se encontró el segmento " << segmentName(name) << " (o el slot P" << player << " está ocupado)\n";
+            return 1;
+        }
+        usleep(50 * 1000);
+    }
+
+    const AIProfile brain = {"Referencia", AIKind::PREDICT, 1.0f, 0.0f};
+    uint32_t brainRng = aiSeed(static_cast<uint32_t>(getpid()), player);
+    BotView view;
+    uint32_t lastSeq = 0;
+    uint64_t sent = 0;
+    int idleWaits = 0;
+    while (true) {
+        if (!client.waitState(lastSeq, view, 1000)) {
+            // Sin publicaciones en 5 s: el servidor murió sin cerrar el segmento
+            if (++idleWaits >= 5) break;
+            continue;
+        }
+        idleWaits = 0;
+        lastSeq = view.seq;
+        if (view.status == BOT_STATUS_CLOSED) break;
+        if (view.status != BOT_STATUS_PLAYING) continue;
+        int move = aiDecide(brain, view.world, player, brainRng);
+        if (delayUs > 0) usleep(static_cast<useconds_t>(delayUs));
+        client.send(view.frame, move);
+        sent++;
+    }
+    client.close();
+    cout << "Bot P" << player << ": " << sent << " comandos enviados\n";
+    return 0;
+}
@@ -0,0 +1,234 @@
+/****************************************************
+ * Archivo: cast_recorder.cpp
+ * Descripción: Grabación de partidas en formato asciicast v2. El render copia cada
+ *              frame emitido a una cola circular sin candados; el hilo escritor le
+ *              pone tiempo relativo, lo escapa como JSON y escribe por lotes. Con la
+ *              cola llena el frame se descarta (contador) en lugar de bloquear.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "cast_recorder.h"
+#include "latency.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <unistd.h>
+
+using namespace std;
+
+// El escritor junta eventos y escribe cuando el lote crece o pasa este intervalo
+static const size_t FLUSH_BYTES = 64 * 1024;
+static const uint64_t FLUSH_INTERVAL_NS = 200ULL * 1000000ULL;
+
+CastRecorder::CastRecorder()
+    : slots(QUEUE_SLOTS), head(0), tail(0), writerSleeping(false), stopping(false),
+      file(nullptr), startNs(0), writeDelayUs(0), recorded(0), dropped(0), written(0),
+      pushTotalNs(0), pushCount(0), pushMaxNs(0) {
+    for (auto& slot : slots) slot.data.reserve(SLOT_RESERVE);
+}
+
+CastRecorder::~CastRecorder() {
+    close();
+}
+
+static void appendJsonString(string& out, const string& text) {
+    static const char HEX[] = "0123456789abcdef";
+    out += '"';
+    for (unsigned char ch : text) {
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += static_cast<char>(ch);
+        } else if (ch == '\n') {
+            out += "\\n";
+        } else if (ch == '\r') {
+            out += "\\r";
+        } else if (ch < 0x20) {
+            out += "\\u00";
+            out += HEX[ch >> 4];
+            out += HEX[ch & 15];
+        } else {
+            out += static_cast<char>(ch);
+        }
+    }
+    out += '"';
+}
+
+bool CastRecorder::open(const string& path, int cols, int rows) {
+    close();
+    file = fopen(path.c_str(), "w");
+    if (file == nullptr) return false;
+    filePath = path;
+    size_t reserve = max(SLOT_RESERVE, static_cast<size_t>(cols) * rows * SLOT_BYTES_PER_CELL);
+    for (auto& slot : slots) slot.data.reserve(reserve);
+
+    string header = "{\"version\": 2, \"width\": " + to_string(cols) + ", \"height\": " + to_string(rows) +
+                    ", \"timestamp\": " + to_string(static_cast<long long>(time(nullptr))) +
+                    ", \"env\": {\"TERM\": ";
+    appendJsonString(header, getenv("TERM") ? getenv("TERM") : "xterm");
+    header += "}}\n";
+    fwrite(header.data(), 1, header.size(), file);
+
+    head = 0;
+    tail = 0;
+    stopping = false;
+    recorded = 0;
+    dropped = 0;
+    written = header.size();
+    pushTotalNs = 0;
+    pushCount = 0;
+    pushMaxNs = 0;
+    startNs = monotonicNowNs();
+    writer = thread(&CastRecorder::writerLoop, this);
+    return true;
+}
+
+bool CastRecorder::push(const char* data, size_t len) {
+    if (file == nullptr) return false;
+    uint64_t t0 = monotonicNowNs();
+    uint32_t h = head.load(memory_order_relaxed);
+    if (h - tail.load(memory_order_acquire) >= static_cast<uint32_t>(QUEUE_SLOTS)) {
+        dropped++;
+        return false;
+    }
+    Slot& slot = slots[h % QUEUE_SLOTS];
+    slot.stampNs = t0;
+    slot.data.assign(data, len);
+    head.store(h + 1, memory_order_seq_cst);
+
+    // Solo se avisa si el escritor se durmió sin nada pendiente
+    if (writerSleeping.load(memory_order_seq_cst)) {
+        lock_guard<mutex> lock(wakeMutex);
+        wakeCond.notify_one();
+    }
+    recorded++;
+
+    uint64_t cost = monotonicNowNs() - t0;
+    pushTotalNs += cost;
+    pushCount++;
+    if (cost > pushMaxNs) pushMaxNs = cost;
+    return true;
+}
+
+void CastRecorder::writerLoop() {
+    string batch;
+    char stamp[32];
+    uint64_t lastFlushNs = monotonicNowNs();
+
+    auto flush = [&]() {
+        if (!batch.empty()) {
+            fwrite(batch.data(), 1, batch.size(), file);
+            fflush(file);
+            written += batch.size();
+            batch.clear();
+            if (writeDelayUs > 0) usleep(writeDelayUs);
+        }
+        lastFlushNs = monotonicNowNs();
+    };
+
+    while (true) {
+        uint32_t t = tail.load(memory_order_relaxed);
+        if (t != head.load(memory_order_acquire)) {
+            Slot& slot = slots[t % QUEUE_SLOTS];
+            snprintf(stamp, sizeof(stamp), "[%.6f, \"o\", ", (slot.stampNs - startNs) / 1e9);
+            batch += stamp;
+            appendJsonString(batch, slot.data);
+            batch += "]\n";
+            tail.store(t + 1, memory_order_release);
+            if (batch.size() >= FLUSH_BYTES) flush();
+            continue;
+        }
+        if (stopping) break;
+        if (!batch.empty() && monotonicNowNs() - lastFlushNs >= FLUSH_INTERVAL_NS) flush();
+
+        unique_lock<mutex> lock(wakeMutex);
+        if (batch.empty()) {
+            // Nada pendiente: dormir sin temporizador hasta el próximo frame
+            writerSleeping.store(true, memory_order_seq_cst);
+            if (tail.load(memory_order_relaxed) == head.load(memory_order_seq_cst) && !stopping) {
+                wakeCond.wait(lock);
+            }
+            writerSleeping.store(false, memory_order_relaxed);
+        } else {
+            // Lote abierto: esperar al intervalo de escritura (los frames se acumulan)
+            wakeCond.wait_for(lock, chrono::nanoseconds(FLUSH_INTERVAL_NS));
+        }
+    }
+    flush();
+}
+
+void CastRecorder::close() {
+    if (file == nullptr) return;
+    {
+        lock_guard<mutex> lock(wakeMutex);
+        stopping = true;
+        wakeCond.notify_one();
+    }
+    if (writer.joinable()) writer.join();
+    fclose(file);
+    file = nullptr;
+}
+
+double CastRecorder::averagePushNs() const {
+    return pushCount > 0 ? static_cast<double>(pushTotalNs) / pushCount : 0.0;
+}
+
+// ===================== BENCHMARK =====================
+
+int runCastBench(int argc, char* argv[]) {
+    int frames = 2000;
+    int frameBytes = 2400;
+    int fps = 0;                // 0 = lo más rápido posible
+    unsigned int delayUs = 0;
+    string path = "/tmp/pong_cast_bench.cast";
+    for (int i = 1; i + 1 < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--frames") frames = atoi(argv[++i]);
+        else if (arg == "--bytes") frameBytes = atoi(argv[++i]);
+        else if (arg == "--fps") fps = atoi(argv[++i]);
+        else if (arg == "--writer-delay-us") delayUs = static_cast<unsigned int>(atoi(argv[++i]));
+        else if (arg == "--file") path = argv[++i];
+    }
+
+    // Frame sintético parecido a la salida real: texto, escapes y saltos de línea
+    string frame;
+    while (static_cast<int>(frame.size()) < frameBytes) {
+        frame += "\x1b[12;40H|  #  \"ok\" \\ ñ\r\n";
+    }
+    frame.resize(frameBytes);
+
+    CastRecorder recorder;
+    recorder.setWriteDelayUs(delayUs);
+    if (!recorder.open(path, 80, 31)) {
+        cerr << "No se pudo abrir " << path << "\n";
+        return 1;
+    }
+    uint64_t startNs = monotonicNowNs();
+    for (int i = 0; i < frames; i++) {
+        recorder.push(frame.data(), frame.size());
+        if (fps > 0) usleep(1000000 / fps);
+    }
+    double pushSecs = (monotonicNowNs() - startNs) / 1e9;
+    recorder.close();
+    double totalSecs = (monotonicNowNs() - startNs) / 1e9;
+
+    cout << "========================================\n";
+    cout << "       GRABACIÓN ASCIICAST - PRUEBA     \n";
+    cout << "========================================\n";
+    cout << "Frames: " << frames << " de " << frameBytes << " bytes"
+         << (fps > 0 ? "  a " + to_string(fps) + " FPS" : string("  sin pausa"))
+         << "  retraso de escritura: " << delayUs << " us/lote\n";
+    cout << "Grabados: " << recorder.recordedFrames() << "  descartados: " << recorder.droppedFrames() << "\n";
+    cout << "Costo en el hilo de render: " << static_cast<long long>(recorder.averagePushNs())
+         << " ns/frame promedio, " << recorder.maxPushNs() << " ns máximo\n";
+    cout << "Archivo: " << recorder.bytesWritten() << " bytes  (productor " << pushSecs
+         << " s, cierre a los " << totalSecs << " s)\n";
+    unlink(path.c_str());
+    return 0;
+}
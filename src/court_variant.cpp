@@ -0,0 +1,416 @@
+/****************************************************
+ * Archivo: court_variant.cpp
+ * Descripción: Núcleo de simulación y armado del frame como plantilla sobre las reglas
+ *              de la cancha. Se instancia para unas pocas canchas estándar (con la capa
+ *              fija de la cancha generada al compilar) y para una genérica que recibe
+ *              las dimensiones en tiempo de ejecución; una tabla elige la instancia.
+ *              Incluye una partida de CPU contra CPU y el benchmark que compara ambas.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "court_variant.h"
+#include "latency.h"
+#include "utils.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <unistd.h>
+
+using namespace std;
+
+static const int COURT_TICKS_PER_SECOND = 60;
+
+// ===================== NÚCLEO EN PLANTILLA =====================
+
+// Celda de la capa fija: bordes laterales y la red al centro
+static constexpr TermCell layerCell(int x, int width) {
+    char ch = (x == 0 || x == width - 1) ? '#' : (x == width / 2) ? ':' : ' ';
+    return TermCell{{ch, 0, 0, 0}, 1, ATTR_NONE};
+}
+
+template <typename Court>
+struct CourtLayer {
+    static constexpr size_t SIZE = static_cast<size_t>(Court::width) * Court::height;
+    static constexpr array<TermCell, SIZE> build() {
+        array<TermCell, SIZE> cells{};
+        for (int y = 0; y < Court::height; y++) {
+            for (int x = 0; x < Court::width; x++) cells[y * Court::width + x] = layerCell(x, Court::width);
+        }
+        return cells;
+    }
+    static constexpr array<TermCell, SIZE> cells = build();
+};
+
+// La genérica arma la capa al vuelo y la conserva mientras no cambie la cancha
+static const TermCell* runtimeLayer(const RuntimeCourt& court) {
+    thread_local vector<TermCell> cells;
+    thread_local RuntimeCourt builtFor = {0, 0, 0};
+    if (builtFor.width != court.width || builtFor.height != court.height) {
+        cells.resize(static_cast<size_t>(court.width) * court.height);
+        for (int y = 0; y < court.height; y++) {
+            for (int x = 0; x < court.width; x++) cells[y * court.width + x] = layerCell(x, court.width);
+        }
+        builtFor = court;
+    }
+    return cells.data();
+}
+
+template <typename Court>
+static const TermCell* layerFor(const Court&) {
+    return CourtLayer<Court>::cells.data();
+}
+
+static const TermCell* layerFor(const RuntimeCourt& court) {
+    return runtimeLayer(court);
+}
+
+template <typename Court>
+static void initCourt(World& w, uint32_t seed, const Court& court) {
+    w.scoreP1 = 0;
+    w.scoreP2 = 0;
+    w.paddle1Y = court.height / 2 - court.paddleHeight / 2;
+    w.paddle2Y = w.paddle1Y;
+    w.rng = seed != 0 ? seed : 0x9E3779B9u;
+    w.tick = 0;
+    w.ballX = court.width / 2;
+    w.ballY = court.height / 2;
+    w.ballSpeedX = (simRandom(w) % 2 == 0) ? 1 : -1;
+    w.ballSpeedY = (simRandom(w) % 2 == 0) ? 1 : -1;
+}
+
+// IA de seguimiento: va hacia la fila de la pelota, pero uno de cada tres ticks no se
+// mueve (si no, nunca fallaría y no habría saques)
+static inline int trackMove(const World& w, int paddleY, int paddleHeight, int side) {
+    if ((w.tick + side) % 3 == 0) return 0;
+    int center = paddleY + paddleHeight / 2;
+    return (w.ballY < center) ? -1 : (w.ballY > center) ? 1 : 0;
+}
+
+template <typename Court>
+static int simulateCourt(World& w, int ticks, const Court& court) {
+    int points = 0;
+    for (int t = 0; t < ticks; t++) {
+        Inputs in = {trackMove(w, w.paddle1Y, court.paddleHeight, 0), trackMove(w, w.paddle2Y, court.paddleHeight, 1)};
+        points += stepCourt(w, in, court) != STEP_NO_SCORE;
+    }
+    return points;
+}
+
+template <typename Court>
+static void composeCourt(const World& w, const Court& court, TermFrame& frame) {
+    const int width = court.width;
+    const int height = court.height;
+    const int paddle = court.paddleHeight;
+    // Marcador, cancha y la fila de quien llama
+    if (frame.cols() < width || frame.rows() < height + 2) return;
+
+    // Marcador
+    static const TermCell BLANK_CELL = {{' ', 0, 0, 0}, 1, ATTR_NONE};
+    fill(&frame.at(0, 0), &frame.at(0, 0) + width, BLANK_CELL);
+    char line[64];
+    int len = snprintf(line, sizeof(line), "P1: %-4d", w.scoreP1);
+    frame.put(0, 2, string_view(line, static_cast<size_t>(len)));
+    len = snprintf(line, sizeof(line), "P2: %-4d", w.scoreP2);
+    frame.put(0, width - 10, string_view(line, static_cast<size_t>(len)));
+
+    // Capa fija: una sola copia si el frame tiene el ancho de la cancha (el caso
+    // normal); si es más ancho, fila por fila para no pisar el resto de cada fila
+    const TermCell* layer = layerFor(court);
+    if (frame.cols() == width) {
+        memcpy(&frame.at(1, 0), layer, sizeof(TermCell) * static_cast<size_t>(width) * height);
+    } else {
+        for (int y = 0; y < height; y++) {
+            memcpy(&frame.at(1 + y, 0), layer + static_cast<size_t>(y) * width, sizeof(TermCell) * width);
+        }
+    }
+
+    // Paletas y pelota
+    for (int k = 0; k < paddle; k++) {
+        TermCell& left = frame.at(1 + w.paddle1Y + k, 2);
+        TermCell& right = frame.at(1 + w.paddle2Y + k, width - 3);
+        left.bytes[0] = right.bytes[0] = '|';
+        left.attr = right.attr = ATTR_REVERSE;
+    }
+    if (w.ballX >= 0 && w.ballX < width && w.ballY >= 0 && w.ballY < height) {
+        TermCell& ball = frame.at(1 + w.ballY, w.ballX);
+        ball.bytes[0] = 'O';
+        ball.attr = ATTR_BOLD;
+    }
+}
+
+// ===================== INSTANCIAS =====================
+
+// Envoltorios con la misma firma para la tabla; las especializadas ignoran court
+template <typename Court>
+static void initFixed(World& w, uint32_t seed, const RuntimeCourt&) {
+    initCourt(w, seed, Court());
+}
+
+template <typename Court>
+static int simulateFixed(World& w, int ticks, const RuntimeCourt&) {
+    return simulateCourt(w, ticks, Court());
+}
+
+template <typename Court>
+static void composeFixed(const World& w, const RuntimeCourt&, TermFrame& frame) {
+    composeCourt(w, Court(), frame);
+}
+
+static void initGeneric(World& w, uint32_t seed, const RuntimeCourt& court) {
+    initCourt(w, seed, court);
+}
+
+static int simulateGeneric(World& w, int ticks, const RuntimeCourt& court) {
+    return simulateCourt(w, ticks, court);
+}
+
+static void composeGeneric(const World& w, const RuntimeCourt& court, TermFrame& frame) {
+    composeCourt(w, court, frame);
+}
+
+template <typename Court>
+static constexpr CourtVariant fixedVariant(const char* name) {
+    return CourtVariant{name, {Court::width, Court::height, Court::paddleHeight}, true,
+                        initFixed<Court>, simulateFixed<Court>, composeFixed<Court>};
+}
+
+static const CourtVariant STANDARD_COURTS[] = {
+    fixedVariant<ClassicCourt>("clásica"),
+    fixedVariant<FixedCourt<40, 16, 2>>("compacta"),
+    fixedVariant<FixedCourt<120, 40, 4>>("grande"),
+    fixedVariant<FixedCourt<160, 50, 5>>("panorámica"),
+};
+
+static const CourtVariant GENERIC_COURT = {"genérica", {0, 0, 0}, false, initGeneric, simulateGeneric, composeGeneric};
+
+bool parseCourt(const string& text, RuntimeCourt& court) {
+    char extra;
+    if (sscanf(text.c_str(), "%dx%dx%d%c", &court.width, &court.height, &court.paddleHeight, &extra) != 3) {
+        return false;
+    }
+    // Mismos límites que el static_assert de FixedCourt
+    return court.width >= 16 && court.width <= 1000 && court.height >= 8 && court.height <= 1000 &&
+           court.paddleHeight >= 1 && court.paddleHeight <= court.height - 4;
+}
+
+const CourtVariant& selectCourtVariant(const RuntimeCourt& court) {
+    for (const CourtVariant& variant : STANDARD_COURTS) {
+        if (variant.court.width == court.width && variant.court.height == court.height &&
+            variant.court.paddleHeight == court.paddleHeight) {
+            return variant;
+        }
+    }
+    return GENERIC_COURT;
+}
+
+const CourtVariant& genericCourtVariant() {
+    return GENERIC_COURT;
+}
+
+// ===================== PARTIDA =====================
+
+int runCourtDemo(int argc, char* argv[]) {
+    RuntimeCourt court = {WIDTH, HEIGHT, PADDLE_HEIGHT};
+    uint32_t seed = 2025;
+    int maxTicks = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--court" && hasValue) {
+            if (!parseCourt(argv[++i], court)) {
+                cerr << "Cancha inválida: " << argv[i] << " (ANCHOxALTOxPALETA, mínimo 16x8x1)\n";
+                return 1;
+            }
+        } else if (arg == "--seed" && hasValue) {
+            seed = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (arg == "--max-ticks" && hasValue) {
+            maxTicks = atoi(argv[++i]);
+        } else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    const CourtVariant& variant = selectCourtVariant(court);
+    World world;
+    variant.init(world, seed, court);
+    const int rows = court.height + 2;
+    TermFrame frame(rows, court.width);
+    TermEncoder encoder(rows, court.width);
+    encoder.setCaps(detectTermCaps());
+    frame.clear();
+    char status[96];
+    int len = snprintf(status, sizeof(status), "Q: salir | %dx%dx%d, instancia %s", court.width, court.height,
+                       court.paddleHeight, variant.name);
+    frame.put(rows - 1, 0, string_view(status, static_cast<size_t>(len)));
+
+    enterRawInput();
+    const uint64_t tickNs = 1000000000ULL / COURT_TICKS_PER_SECOND;
+    uint64_t next = monotonicNowNs();
+    while (maxTicks <= 0 || static_cast<int>(world.tick) < maxTicks) {
+        if (kbhit()) {
+            char key;
+            if (read(STDIN_FILENO, &key, 1) == 1 && (key == 'q' || key == 'Q')) break;
+        }
+        variant.simulate(world, 1, court);
+        variant.compose(world, court, frame);
+        const string& bytes = encoder.encode(frame);
+        cout.write(bytes.data(), bytes.size());
+        cout.flush();
+
+        next += tickNs;
+        uint64_t now = monotonicNowNs();
+        if (next > now) usleep(static_cast<useconds_t>((next - now) / 1000));
+        else next = now;
+    }
+    cout << "\x1b[m\x1b[?25h\x1b[H\x1b[2J";
+    cout.flush();
+    leaveRawInput();
+    cout << "Cancha " << court.width << "x" << court.height << "x" << court.paddleHeight << " (instancia "
+         << variant.name << "): " << world.tick << " ticks, P1 " << world.scoreP1 << " - P2 " << world.scoreP2
+         << "\n";
+    return 0;
+}
+
+// ===================== BENCHMARK =====================
+
+struct CourtBenchRow {
+    RuntimeCourt court;
+    const char* name;
+    bool specialised;
+    double stepNs[2];           // especializada, genérica
+    double composeUs[2];
+    bool sameStates;
+    bool sameFrames;
+};
+
+static double timeSimulate(const CourtVariant& variant, const RuntimeCourt& court, int ticks, World& world) {
+    variant.init(world, 2025, court);
+    uint64_t start = monotonicNowNs();
+    variant.simulate(world, ticks, court);
+    return static_cast<double>(monotonicNowNs() - start) / ticks;
+}
+
+static double timeCompose(const CourtVariant& variant, const RuntimeCourt& court, const vector<World>& states,
+                          TermFrame& frame) {
+    uint64_t start = monotonicNowNs();
+    for (const World& world : states) variant.compose(world, court, frame);
+    return static_cast<double>(monotonicNowNs() - start) / states.size() / 1000.0;
+}
+
+static bool sameFrame(const TermFrame& a, const TermFrame& b) {
+    for (int row = 0; row < a.rows(); row++) {
+        for (int col = 0; col < a.cols(); col++) {
+            const TermCell& x = a.at(row, col);
+            const TermCell& y = b.at(row, col);
+            if (x.len != y.len || x.attr != y.attr || memcmp(x.bytes, y.bytes, x.len) != 0) return false;
+        }
+    }
+    return true;
+}
+
+int runCourtBench(int argc, char* argv[]) {
+    int ticks = 2000000;
+    int frames = 2000;
+    vector<RuntimeCourt> courts;
+    for (const CourtVariant& variant : STANDARD_COURTS) courts.push_back(variant.court);
+    courts.push_back(RuntimeCourt{100, 30, 3});     // sin instancia propia
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--ticks" && hasValue) {
+            ticks = max(1000, atoi(argv[++i]));
+        } else if (arg == "--frames" && hasValue) {
+            frames = max(10, atoi(argv[++i]));
+        } else if (arg == "--courts" && hasValue) {
+            courts.clear();
+            stringstream list(argv[++i]);
+            string item;
+            while (getline(list, item, ',')) {
+                RuntimeCourt court;
+                if (!parseCourt(item, court)) {
+                    cerr << "Cancha inválida: " << item << "\n";
+                    return 1;
+                }
+                courts.push_back(court);
+            }
+        } else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    const CourtVariant& generic = genericCourtVariant();
+    vector<CourtBenchRow> rows;
+    for (const RuntimeCourt& court : courts) {
+        const CourtVariant& chosen = selectCourtVariant(court);
+        CourtBenchRow row = {court, chosen.name, chosen.specialised, {0, 0}, {0, 0}, true, true};
+
+        // Simulación: misma semilla en ambas; al final los estados deben coincidir
+        World fast, slow;
+        row.stepNs[0] = timeSimulate(chosen, court, ticks, fast);
+        row.stepNs[1] = timeSimulate(generic, court, ticks, slow);
+        row.sameStates = memcmp(&fast, &slow, sizeof(World)) == 0;
+
+        // Frames: estados de una partida, armados por ambas instancias
+        vector<World> states(static_cast<size_t>(frames));
+        World world;
+        generic.init(world, 7, court);
+        for (World& state : states) {
+            generic.simulate(world, 3, court);
+            state = world;
+        }
+        TermFrame frameA(court.height + 2, court.width);
+        TermFrame frameB(court.height + 2, court.width);
+        row.composeUs[0] = timeCompose(chosen, court, states, frameA);
+        row.composeUs[1] = timeCompose(generic, court, states, frameB);
+        for (size_t k = 0; k < states.size() && row.sameFrames; k += 97) {
+            chosen.compose(states[k], court, frameA);
+            generic.compose(states[k], court, frameB);
+            row.sameFrames = sameFrame(frameA, frameB);
+        }
+        rows.push_back(row);
+    }
+
+    cout << fixed << setprecision(2);
+    cout << "=== NÚCLEO POR CANCHA: ESPECIALIZADA vs GENÉRICA (" << ticks << " ticks, " << frames
+         << " frames) ===\n";
+    cout << left << setw(11) << "Cancha" << setw(14) << "Instancia" << setw(11) << "ns/tick" << setw(12)
+         << "genérica" << setw(9) << "acel." << setw(11) << "us/frame" << setw(12) << "genérica" << setw(9)
+         << "acel." << "Iguales\n";
+    bool allSame = true;
+    for (const CourtBenchRow& r : rows) {
+        string court = to_string(r.court.width) + "x" + to_string(r.court.height) + "x" + to_string(r.court.paddleHeight);
+        bool same = r.sameStates && r.sameFrames;
+        allSame = allSame && same;
+        // setw cuenta bytes: los nombres con tilde ocupan uno más
+        int nameWidth = 13 + static_cast<int>(strlen(r.name)) -
+                        static_cast<int>(count_if(r.name, r.name + strlen(r.name), [](char c) { return (c & 0xC0) != 0x80; }));
+        cout << left << setw(11) << court << setw(nameWidth + 1) << r.name;
+        if (r.specialised) {
+            cout << setw(11) << r.stepNs[0] << setw(11) << r.stepNs[1] << setw(9) << r.stepNs[1] / r.stepNs[0]
+                 << setw(11) << r.composeUs[0] << setw(11) << r.composeUs[1] << setw(9)
+                 << r.composeUs[1] / r.composeUs[0];
+        } else {
+            cout << setw(11) << "-" << setw(11) << r.stepNs[1] << setw(9) << "-" << setw(11) << "-" << setw(11)
+                 << r.composeUs[1] << setw(9) << "-";
+        }
+        cout << (same ? "sí" : "NO") << "\n";
+    }
+    if (!allSame) {
+        cout << "FALLA: la instancia especializada no coincide con la genérica\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,289 @@
+/****************************************************
+ * Archivo: encode_check.cpp
+ * Descripción: Verificación del codificador diferencial. Un emulador de terminal con
+ *              las secuencias que emite TermEncoder (CUP, CUU/CUD/CUF/CUB, BS, CR, ECH,
+ *              EL, ED, REP, SGR y los modos privados) aplica cada frame codificado y su
+ *              pantalla se compara celda a celda con el frame pedido.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "encode_check.h"
+#include "term_encoder.h"
+#include "step_kernel.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static const TermCell BLANK_CELL = {{' ', 0, 0, 0}, 1, ATTR_NONE};
+
+// ===================== EMULADOR =====================
+
+// Terminal tipo xterm reducido a lo que usa el codificador. Al escribir en la última
+// columna el cursor queda en "wrap pendiente": el siguiente carácter va a la fila
+// siguiente, y cualquier movimiento lo cancela.
+class CellEmulator {
+public:
+    CellEmulator(int rows, int cols) : screen(rows, cols) {
+        // Basura inicial: el primer frame tiene que borrarla
+        for (int r = 0; r < rows; r++) {
+            for (int c = 0; c < cols; c++) screen.at(r, c) = TermCell{{'?', 0, 0, 0}, 1, ATTR_REVERSE};
+        }
+    }
+
+    // false si aparece una secuencia que el emulador no conoce
+    bool feed(const string& bytes) {
+        size_t i = 0;
+        while (i < bytes.size()) {
+            unsigned char ch = static_cast<unsigned char>(bytes[i]);
+            if (ch == 0x1b) {
+                size_t used = 0;
+                if (!escape(bytes, i, used)) return false;
+                i += used;
+            } else if (ch == '\r') {
+                col = 0;
+                wrapPending = false;
+                i++;
+            } else if (ch == '\b') {
+                col = max(0, col - 1);
+                wrapPending = false;
+                i++;
+            } else if (ch < 0x20) {
+                return false;
+            } else {
+                size_t len = (ch < 0x80) ? 1 : (ch < 0xE0) ? 2 : (ch < 0xF0) ? 3 : 4;
+                TermCell cell = {{0, 0, 0, 0}, static_cast<uint8_t>(len), attr};
+                memcpy(cell.bytes, bytes.data() + i, len);
+                print(cell);
+                i += len;
+            }
+        }
+        return true;
+    }
+
+    const TermFrame& frame() const { return screen; }
+
+private:
+    TermFrame screen;
+    int row = 0;
+    int col = 0;
+    bool wrapPending = false;
+    uint8_t attr = ATTR_NONE;
+    TermCell last = BLANK_CELL;
+
+    void print(const TermCell& cell) {
+        if (wrapPending) {
+            col = 0;
+            row = min(row + 1, screen.rows() - 1);
+            wrapPending = false;
+        }
+        screen.at(row, col) = cell;
+        last = cell;
+        if (col == screen.cols() - 1) wrapPending = true;
+        else col++;
+    }
+
+    void moveTo(int r, int c) {
+        row = stepClamp(r, 0, screen.rows() - 1);
+        col = stepClamp(c, 0, screen.cols() - 1);
+        wrapPending = false;
+    }
+
+    bool escape(const string& bytes, size_t start, size_t& used) {
+        size_t i = start + 1;
+        if (i >= bytes.size() || bytes[i] != '[') return false;
+        i++;
+        bool privateMode = i < bytes.size() && bytes[i] == '?';
+        if (privateMode) i++;
+        int params[4] = {0, 0, 0, 0};
+        int count = 0;
+        bool any = false;
+        while (i < bytes.size() && ((bytes[i] >= '0' && bytes[i] <= '9') || bytes[i] == ';')) {
+            if (bytes[i] == ';') {
+                if (++count >= 4) return false;
+            } else {
+                params[count] = params[count] * 10 + (bytes[i] - '0');
+                any = true;
+            }
+            i++;
+        }
+        if (i >= bytes.size()) return false;
+        char final = bytes[i];
+        used = i + 1 - start;
+        int n = max(1, params[0]);
+        if (privateMode) {
+            // Cursor (25) y actualización sincronizada (2026): no cambian las celdas
+            return (final == 'h' || final == 'l') && (params[0] == 25 || params[0] == 2026);
+        }
+        switch (final) {
+        case 'H':
+            moveTo(max(1, params[0]) - 1, max(1, params[1]) - 1);
+            return true;
+        case 'A':
+            moveTo(row - n, col);
+            return true;
+        case 'B':
+            moveTo(row + n, col);
+            return true;
+        case 'C':
+            moveTo(row, col + n);
+            return true;
+        case 'D':
+            moveTo(row, col - n);
+            return true;
+        case 'X':
+            for (int k = 0; k < n && col + k < screen.cols(); k++) screen.at(row, col + k) = BLANK_CELL;
+            wrapPending = false;
+            return true;
+        case 'K':
+            if (params[0] != 0) return false;
+            for (int c = col; c < screen.cols(); c++) screen.at(row, c) = BLANK_CELL;
+            wrapPending = false;
+            return true;
+        case 'J':
+            if (params[0] != 2) return false;
+            screen.clear();
+            return true;
+        case 'b':
+            for (int k = 0; k < n; k++) print(last);
+            return true;
+        case 'm':
+            if (!any) {
+                attr = ATTR_NONE;
+                return true;
+            }
+            for (int k = 0; k <= count; k++) {
+                if (params[k] == 0) attr = ATTR_NONE;
+                else if (params[k] == 1) attr |= ATTR_BOLD;
+                else if (params[k] == 7) attr |= ATTR_REVERSE;
+                else return false;
+            }
+            return true;
+        default:
+            return false;
+        }
+    }
+};
+
+// ===================== FRAMES ALEATORIOS =====================
+
+static const char* const GLYPHS[] = {"#", "|", "o", "=", ":", "a", "Z", "\xc2\xb7", "\xe2\x95\x90", "\xe2\x86\x91"};
+static const int GLYPH_COUNT = sizeof(GLYPHS) / sizeof(GLYPHS[0]);
+
+static uint32_t nextRandom(uint32_t& seed) {
+    seed = stepXorshift(seed);
+    return seed;
+}
+
+static TermCell randomCell(uint32_t& seed) {
+    uint32_t r = nextRandom(seed);
+    if (r % 3 == 0) return BLANK_CELL;
+    const char* glyph = GLYPHS[(r >> 4) % GLYPH_COUNT];
+    TermCell cell = {{0, 0, 0, 0}, static_cast<uint8_t>(strlen(glyph)), static_cast<uint8_t>((r >> 12) % 4)};
+    memcpy(cell.bytes, glyph, cell.len);
+    return cell;
+}
+
+// Cambios como los de una partida: celdas sueltas, corridas iguales (REP), corridas
+// en blanco (ECH/EL) y de vez en cuando filas enteras nuevas
+static void mutate(TermFrame& frame, uint32_t& seed) {
+    int edits = 1 + static_cast<int>(nextRandom(seed) % 12);
+    for (int e = 0; e < edits; e++) {
+        uint32_t r = nextRandom(seed);
+        int row = static_cast<int>(r % frame.rows());
+        int col = static_cast<int>((r >> 8) % frame.cols());
+        int kind = static_cast<int>((r >> 20) % 8);
+        if (kind < 4) {
+            frame.at(row, col) = randomCell(seed);
+        } else if (kind < 7) {
+            TermCell cell = kind == 6 ? BLANK_CELL : randomCell(seed);
+            int len = 1 + static_cast<int>(nextRandom(seed) % frame.cols());
+            for (int c = col; c < min(frame.cols(), col + len); c++) frame.at(row, c) = cell;
+        } else {
+            for (int c = 0; c < frame.cols(); c++) frame.at(row, c) = randomCell(seed);
+        }
+    }
+}
+
+static bool sameCells(const TermCell& a, const TermCell& b) {
+    return a.len == b.len && a.attr == b.attr && memcmp(a.bytes, b.bytes, a.len) == 0;
+}
+
+static bool firstDifference(const TermFrame& a, const TermFrame& b, int& row, int& col) {
+    for (row = 0; row < a.rows(); row++) {
+        for (col = 0; col < a.cols(); col++) {
+            if (!sameCells(a.at(row, col), b.at(row, col))) return true;
+        }
+    }
+    return false;
+}
+
+int runEncodeCheck(int argc, char* argv[]) {
+    long long frames = 80000;
+    uint32_t seed = 2025;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "--frames") frames = max(1LL, atoll(argv[i + 1]));
+        else if (arg == "--seed") seed = static_cast<uint32_t>(atoi(argv[i + 1])) | 1u;
+        else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    // Tamaño del juego y uno chico (bordes y última columna más seguido)
+    const int SIZES[][2] = {{SCREEN_ROWS, SCREEN_COLS}, {4, 7}};
+    long long checked = 0;
+    long long mismatches = 0;
+    long long unknown = 0;
+    unsigned long long bytes = 0;
+    const long long perRun = max(1LL, frames / 8);
+    for (int run = 0; checked < frames; run++) {
+        const int rows = SIZES[run % 2][0];
+        const int cols = SIZES[run % 2][1];
+        TermCaps caps;
+        caps.syncUpdates = (run / 2) % 2 == 1;
+        caps.repeat = (run / 4) % 2 == 1;
+        TermEncoder encoder(rows, cols);
+        encoder.setCaps(caps);
+        CellEmulator emulator(rows, cols);
+        TermFrame frame(rows, cols);
+        for (long long f = 0; f < perRun && checked < frames; f++, checked++) {
+            mutate(frame, seed);
+            if (nextRandom(seed) % 200 == 0) encoder.invalidate();
+            const string& out = encoder.encode(frame);
+            bytes += out.size();
+            if (!emulator.feed(out)) {
+                if (unknown++ == 0) cout << "Secuencia desconocida en el frame " << checked << "\n";
+                break;
+            }
+            int row, col;
+            if (firstDifference(emulator.frame(), frame, row, col)) {
+                if (mismatches++ < 5) {
+                    cout << "Diferencia en el frame " << checked << " (" << rows << "x" << cols << ", sync "
+                         << caps.syncUpdates << ", rep " << caps.repeat << ") fila " << row << " columna " << col
+                         << "\n";
+                }
+                // Se sigue desde lo que muestra la pantalla real
+                encoder.invalidate();
+            }
+        }
+    }
+
+    cout << "========================================\n";
+    cout << "   CODIFICADOR DIFERENCIAL: EMULACIÓN   \n";
+    cout << "========================================\n";
+    cout << "Frames comparados: " << checked << "  diferencias: " << mismatches
+         << "  secuencias desconocidas: " << unknown << "\n";
+    cout << "Bytes por frame: " << (checked > 0 ? bytes / checked : 0) << "\n";
+    return (mismatches == 0 && unknown == 0) ? 0 : 1;
+}
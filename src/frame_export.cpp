@@ -0,0 +1,502 @@
+/****************************************************
+ * Archivo: frame_export.cpp
+ * Descripción: Exportación de partidas a cuadros de imagen. Re-simula la partida con el
+ *              núcleo de pasos, pide a PongRenderer la distribución de celdas de cada
+ *              tick y la rasteriza a píxeles (paredes, red, paletas, pelota y marcador
+ *              con una fuente de 5x7). Los cuadros se reparten por bloques en
+ *              WorkStealingPool; cada tarea tiene su propio renderer y buffer.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "frame_export.h"
+#include "ai_profile.h"
+#include "latency.h"
+#include "pong_render.h"
+#include "save_state.h"
+#include "step_kernel.h"
+#include "term_encoder.h"
+#include "work_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+// Celda de terminal en píxeles (a escala 1); solo se rasterizan marcador y cancha
+static const int CELL_W = 8;
+static const int CELL_H = 16;
+static const int RASTER_ROWS = 3 + HEIGHT;
+static const int EXPORT_FPS = 60;       // un cuadro por tick, como el juego en vivo
+
+struct ExportOptions {
+    uint32_t seed = 2025;
+    string leftName = "Predice80";
+    string rightName = "Predice50";
+    string rosterPath;
+    string savePath;            // partida guardada (formato de save_state)
+    int targetScore = 5;
+    int maxTicks = 20000;
+    int frames = 0;             // 0 = toda la partida
+    string outDir = "export";
+    string format = "ppm";
+    int scale = 1;
+    int threads = 0;            // 0 = todos los núcleos
+    bool scaling = false;
+};
+
+static bool parseOptions(int argc, char* argv[], ExportOptions& opts) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--seed" && hasValue) opts.seed = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (arg == "--left" && hasValue) opts.leftName = argv[++i];
+        else if (arg == "--right" && hasValue) opts.rightName = argv[++i];
+        else if (arg == "--roster" && hasValue) opts.rosterPath = argv[++i];
+        else if (arg == "--save" && hasValue) opts.savePath = argv[++i];
+        else if (arg == "--target" && hasValue) opts.targetScore = atoi(argv[++i]);
+        else if (arg == "--max-ticks" && hasValue) opts.maxTicks = atoi(argv[++i]);
+        else if (arg == "--frames" && hasValue) opts.frames = atoi(argv[++i]);
+        else if (arg == "--out" && hasValue) opts.outDir = argv[++i];
+        else if (arg == "--format" && hasValue) opts.format = argv[++i];
+        else if (arg == "--scale" && hasValue) opts.scale = atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue) opts.threads = atoi(argv[++i]);
+        else if (arg == "--scaling") opts.scaling = true;
+        else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return false;
+        }
+    }
+    if (opts.format != "ppm" && opts.format != "raw") {
+        cerr << "Formato desconocido: " << opts.format << " (usa ppm o raw)\n";
+        return false;
+    }
+    opts.scale = max(1, min(opts.scale, 8));
+    if (opts.threads <= 0) {
+        opts.threads = max(1u, thread::hardware_concurrency());
+    }
+    return true;
+}
+
+// ===================== FUENTE =====================
+
+// Fuente de 5x7: una fila por byte, el bit 4 es la columna izquierda
+struct Glyph {
+    char ch;
+    uint8_t rows[7];
+};
+
+static const Glyph FONT[] = {
+    {'0', {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}},
+    {'1', {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+    {'2', {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}},
+    {'3', {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}},
+    {'4', {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}},
+    {'5', {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}},
+    {'6', {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}},
+    {'7', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}},
+    {'8', {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}},
+    {'9', {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}},
+    {'A', {0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11}},
+    {'B', {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}},
+    {'C', {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}},
+    {'D', {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}},
+    {'E', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}},
+    {'F', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}},
+    {'G', {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}},
+    {'H', {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},
+    {'I', {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+    {'J', {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}},
+    {'K', {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}},
+    {'L', {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}},
+    {'M', {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}},
+    {'N', {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}},
+    {'O', {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+    {'P', {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}},
+    {'Q', {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}},
+    {'R', {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}},
+    {'S', {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}},
+    {'T', {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}},
+    {'U', {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+    {'V', {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}},
+    {'W', {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}},
+    {'X', {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}},
+    {'Y', {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}},
+    {'Z', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}},
+    {':', {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}},
+    {'-', {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}},
+    {'.', {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}},
+    {'_', {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F}},
+    {'?', {0x1F, 0x11, 0x11, 0x11, 0x11, 0x11, 0x1F}},     // carácter sin glifo: caja
+};
+
+// Índice por byte (las minúsculas usan el glifo de la mayúscula)
+static const uint8_t* glyphFor(unsigned char ch) {
+    static const vector<const uint8_t*> table = [] {
+        vector<const uint8_t*> t(256, nullptr);
+        for (const Glyph& g : FONT) t[static_cast<unsigned char>(g.ch)] = g.rows;
+        for (int c = 'a'; c <= 'z'; c++) t[c] = t[c - 'a' + 'A'];
+        return t;
+    }();
+    const uint8_t* rows = table[ch];
+    return rows != nullptr ? rows : table['?'];
+}
+
+// ===================== RASTERIZADO =====================
+
+struct Rgb {
+    uint8_t r, g, b;
+};
+
+static const Rgb COLOR_BACKGROUND = {12, 14, 20};
+static const Rgb COLOR_WALL = {110, 114, 128};
+static const Rgb COLOR_NET = {70, 74, 88};
+static const Rgb COLOR_TEXT = {230, 230, 230};
+static const Rgb COLOR_PADDLE1 = {80, 200, 255};
+static const Rgb COLOR_PADDLE2 = {255, 150, 60};
+static const Rgb COLOR_BALL = {255, 230, 80};
+
+class Rasterizer {
+public:
+    explicit Rasterizer(int scale)
+        : cellW(CELL_W * scale), cellH(CELL_H * scale), scale(scale),
+          imageW(WIDTH * CELL_W * scale), imageH(RASTER_ROWS * CELL_H * scale) {}
+
+    int width() const { return imageW; }
+    int height() const { return imageH; }
+    size_t frameBytes() const { return static_cast<size_t>(imageW) * imageH * 3; }
+
+    // Pinta las filas de marcador y cancha del frame en rgb (frameBytes() bytes)
+    void draw(const TermFrame& frame, uint8_t* rgb) const {
+        fillRect(rgb, 0, 0, imageW, imageH, COLOR_BACKGROUND);
+        int rows = min(frame.rows(), RASTER_ROWS);
+        int cols = min(frame.cols(), WIDTH);
+        for (int row = 0; row < rows; row++) {
+            for (int col = 0; col < cols; col++) {
+                const TermCell& cell = frame.at(row, col);
+                if (cell.len == 0 || (cell.len == 1 && cell.bytes[0] == ' ')) continue;
+                drawCell(rgb, row, col, cell);
+            }
+        }
+    }
+
+private:
+    int cellW;
+    int cellH;
+    int scale;
+    int imageW;
+    int imageH;
+
+    void fillRect(uint8_t* rgb, int x0, int y0, int w, int h, Rgb color) const {
+        for (int y = y0; y < y0 + h; y++) {
+            uint8_t* p = rgb + (static_cast<size_t>(y) * imageW + x0) * 3;
+            for (int x = 0; x < w; x++) {
+                p[0] = color.r;
+                p[1] = color.g;
+                p[2] = color.b;
+                p += 3;
+            }
+        }
+    }
+
+    void drawBall(uint8_t* rgb, int x0, int y0) const {
+        // Círculo inscrito en el ancho de la celda, centrado en la celda
+        int radius = cellW / 2;
+        int cx = x0 + cellW / 2;
+        int cy = y0 + cellH / 2;
+        for (int dy = -radius; dy < radius; dy++) {
+            for (int dx = -radius; dx < radius; dx++) {
+                // Centro de píxel en (dx + 0.5, dy + 0.5), en enteros x2
+                int ex = 2 * dx + 1;
+                int ey = 2 * dy + 1;
+                if (ex * ex + ey * ey > 4 * radius * radius) continue;
+                uint8_t* p = rgb + (static_cast<size_t>(cy + dy) * imageW + cx + dx) * 3;
+                p[0] = COLOR_BALL.r;
+                p[1] = COLOR_BALL.g;
+                p[2] = COLOR_BALL.b;
+            }
+        }
+    }
+
+    void drawGlyph(uint8_t* rgb, int x0, int y0, unsigned char ch) const {
+        // 5x7 con píxeles de 1x2 (a escala 1), centrado en la celda de 8x16
+        const uint8_t* rows = glyphFor(ch);
+        int px = scale;
+        int py = 2 * scale;
+        int gx = x0 + (cellW - 5 * px) / 2;
+        int gy = y0 + (cellH - 7 * py) / 2;
+        for (int r = 0; r < 7; r++) {
+            for (int c = 0; c < 5; c++) {
+                if (rows[r] & (0x10 >> c)) fillRect(rgb, gx + c * px, gy + r * py, px, py, COLOR_TEXT);
+            }
+        }
+    }
+
+    void drawCell(uint8_t* rgb, int row, int col, const TermCell& cell) const {
+        int x0 = col * cellW;
+        int y0 = row * cellH;
+        unsigned char ch = static_cast<unsigned char>(cell.bytes[0]);
+        if (cell.len > 1) ch = '?';
+        if (row < 3) {
+            // Marcador: líneas de '=' como regla horizontal, el resto como texto
+            if (ch == '=') fillRect(rgb, x0, y0 + cellH / 2 - scale, cellW, 2 * scale, COLOR_WALL);
+            else drawGlyph(rgb, x0, y0, ch);
+            return;
+        }
+        if (cell.attr & ATTR_BOLD) {
+            drawBall(rgb, x0, y0);
+        } else if (ch == '#') {
+            fillRect(rgb, x0, y0, cellW, cellH, COLOR_WALL);
+        } else if (ch == '|' && col == 2) {
+            fillRect(rgb, x0 + cellW / 4, y0, cellW / 2, cellH, COLOR_PADDLE1);
+        } else if (ch == '|' && col == WIDTH - 3) {
+            fillRect(rgb, x0 + cellW / 4, y0, cellW / 2, cellH, COLOR_PADDLE2);
+        } else if (ch == '|') {
+            // Red punteada: media celda pintada, media vacía
+            fillRect(rgb, x0 + cellW / 2 - scale, y0 + cellH / 4, 2 * scale, cellH / 2, COLOR_NET);
+        } else {
+            drawGlyph(rgb, x0, y0, ch);
+        }
+    }
+};
+
+// ===================== SIMULACIÓN =====================
+
+static const AIProfile* findProfile(const vector<AIProfile>& roster, const string& name) {
+    for (const AIProfile& profile : roster) {
+        if (profile.name == name) return &profile;
+    }
+    return nullptr;
+}
+
+// Estados de todos los ticks (el primero es el inicial). Se simula en serie: es
+// barato frente al rasterizado y deja la partida idéntica a la de los torneos.
+static vector<World> simulateMatch(const ExportOptions& opts, const AIProfile& left,
+                                   const AIProfile& right, const World& start) {
+    vector<World> worlds;
+    World state = start;
+    // Mismos flujos de jitter que el torneo con esta semilla
+    uint32_t rng1 = aiSeed(opts.seed, 1);
+    uint32_t rng2 = aiSeed(opts.seed, 2);
+    worlds.push_back(state);
+    while (state.scoreP1 < opts.targetScore && state.scoreP2 < opts.targetScore &&
+           static_cast<int>(state.tick) < opts.maxTicks &&
+           (opts.frames <= 0 || static_cast<int>(worlds.size()) < opts.frames)) {
+        int move1 = aiDecide(left, state, 1, rng1);
+        int move2 = aiDecide(right, state, 2, rng2);
+        step(state, Inputs{move1, move2});
+        worlds.push_back(state);
+    }
+    return worlds;
+}
+
+// ===================== EXPORTACIÓN =====================
+
+struct ExportResult {
+    double seconds;
+    uint64_t bytes;
+    bool ok;
+};
+
+static bool writeAll(int fd, const uint8_t* data, size_t len, off_t offset, bool positioned) {
+    while (len > 0) {
+        ssize_t n = positioned ? pwrite(fd, data, len, offset) : write(fd, data, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        len -= static_cast<size_t>(n);
+        offset += n;
+    }
+    return true;
+}
+
+// Rasteriza y escribe los cuadros [begin, end): un renderer y un buffer por bloque
+static bool exportChunk(const ExportOptions& opts, const vector<World>& worlds, size_t begin,
+                        size_t end, const string& leftName, const string& rightName, int rawFd) {
+    Rasterizer raster(opts.scale);
+    PongRenderer renderer;
+    renderer.updatePlayerNames(leftName, rightName);
+
+    char header[64];
+    int headerLen = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", raster.width(), raster.height());
+    bool ppm = (opts.format == "ppm");
+    size_t pixelOffset = ppm ? static_cast<size_t>(headerLen) : 0;
+    vector<uint8_t> buffer(pixelOffset + raster.frameBytes());
+    if (ppm) memcpy(buffer.data(), header, headerLen);
+
+    char path[512];
+    for (size_t i = begin; i < end; i++) {
+        const World& w = worlds[i];
+        renderer.updateScores(w.scoreP1, w.scoreP2);
+        renderer.updatePaddles(w.paddle1Y, w.paddle2Y);
+        renderer.updateBall(w.ballX, w.ballY, w.ballSpeedX, w.ballSpeedY);
+        raster.draw(renderer.layoutGame(), buffer.data() + pixelOffset);
+
+        if (!ppm) {
+            off_t offset = static_cast<off_t>(i * raster.frameBytes());
+            if (!writeAll(rawFd, buffer.data(), buffer.size(), offset, true)) return false;
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/frame-%06zu.ppm", opts.outDir.c_str(), i);
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        bool ok = writeAll(fd, buffer.data(), buffer.size(), 0, false);
+        ::close(fd);
+        if (!ok) return false;
+    }
+    return true;
+}
+
+static ExportResult exportFrames(const ExportOptions& opts, const vector<World>& worlds,
+                                 const string& leftName, const string& rightName, int threads) {
+    Rasterizer raster(opts.scale);
+    int rawFd = -1;
+    if (opts.format == "raw") {
+        string path = opts.outDir + "/frames.rgb";
+        rawFd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (rawFd < 0) {
+            cerr << "No se pudo crear " << path << "\n";
+            return {0.0, 0, false};
+        }
+        // Tamaño final de una vez: cada tarea escribe su bloque en su posición
+        if (ftruncate(rawFd, static_cast<off_t>(worlds.size() * raster.frameBytes())) != 0) {
+            ::close(rawFd);
+            return {0.0, 0, false};
+        }
+    }
+
+    // Bloques chicos para que el robo de trabajo reparta bien, sin bajar de 8 cuadros
+    size_t chunk = max<size_t>(8, worlds.size() / (static_cast<size_t>(threads) * 16));
+    atomic<bool> failed(false);
+    uint64_t start = monotonicNowNs();
+    {
+        WorkStealingPool pool(threads);
+        for (size_t begin = 0; begin < worlds.size(); begin += chunk) {
+            size_t end = min(worlds.size(), begin + chunk);
+            pool.submit([&, begin, end] {
+                if (failed.load(memory_order_relaxed)) return;
+                if (!exportChunk(opts, worlds, begin, end, leftName, rightName, rawFd)) {
+                    failed.store(true, memory_order_relaxed);
+                }
+            });
+        }
+        pool.waitIdle();
+    }
+    double seconds = (monotonicNowNs() - start) / 1e9;
+    if (rawFd >= 0) ::close(rawFd);
+
+    size_t perFrame = raster.frameBytes();
+    if (opts.format == "ppm") {
+        perFrame += static_cast<size_t>(snprintf(nullptr, 0, "P6\n%d %d\n255\n", raster.width(), raster.height()));
+    }
+    return {seconds, static_cast<uint64_t>(perFrame) * worlds.size(), !failed.load()};
+}
+
+static double peakRssMb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;    // Linux: KB
+}
+
+int runFrameExport(int argc, char* argv[]) {
+    ExportOptions opts;
+    if (!parseOptions(argc, argv, opts)) return 1;
+
+    vector<AIProfile> roster = defaultRoster();
+    if (!opts.rosterPath.empty() && !loadRoster(opts.rosterPath, roster)) {
+        cerr << "No se pudo leer el plantel " << opts.rosterPath << "\n";
+        return 1;
+    }
+    const AIProfile* left = findProfile(roster, opts.leftName);
+    const AIProfile* right = findProfile(roster, opts.rightName);
+    if (left == nullptr || right == nullptr) {
+        cerr << "Perfil desconocido: " << (left == nullptr ? opts.leftName : opts.rightName) << "\n";
+        return 1;
+    }
+
+    World start;
+    simInit(start, opts.seed);
+    if (!opts.savePath.empty()) {
+        MatchSnapshot snapshot;
+        if (!loadSnapshotFile(opts.savePath, snapshot)) {
+            cerr << "No se pudo leer la partida guardada " << opts.savePath << "\n";
+            return 1;
+        }
+        start = snapshot.sim;
+    }
+
+    if (mkdir(opts.outDir.c_str(), 0755) != 0 && errno != EEXIST) {
+        cerr << "No se pudo crear el directorio " << opts.outDir << "\n";
+        return 1;
+    }
+
+    uint64_t simStart = monotonicNowNs();
+    vector<World> worlds = simulateMatch(opts, *left, *right, start);
+    double simSeconds = (monotonicNowNs() - simStart) / 1e9;
+    const World& last = worlds.back();
+
+    Rasterizer raster(opts.scale);
+    cout << fixed << setprecision(1);
+    cout << "=== EXPORTAR CUADROS ===\n";
+    cout << left->name << " vs " << right->name << " | "
+         << (opts.savePath.empty() ? "semilla " + to_string(opts.seed) : "desde " + opts.savePath)
+         << " | final " << last.scoreP1 << "-" << last.scoreP2 << " en " << last.tick << " ticks\n";
+    cout << "Cuadros: " << worlds.size() << " de " << raster.width() << "x" << raster.height()
+         << " (" << opts.format << ") en " << opts.outDir << "/ | hilos: " << opts.threads << "\n";
+
+    ExportResult result = exportFrames(opts, worlds, left->name, right->name, opts.threads);
+    if (!result.ok) {
+        cerr << "Error al escribir los cuadros en " << opts.outDir << "\n";
+        return 1;
+    }
+    double mb = result.bytes / (1024.0 * 1024.0);
+    cout << "Simulación: " << setprecision(3) << simSeconds * 1000.0 << " ms | exportación: "
+         << result.seconds << " s\n" << setprecision(1);
+    cout << "Rendimiento: " << worlds.size() / result.seconds << " cuadros/s, "
+         << mb / result.seconds << " MB/s (" << mb << " MB escritos)\n";
+    cout << "Memoria pico (RSS): " << peakRssMb() << " MB\n";
+    if (opts.format == "raw") {
+        cout << "Video: ffmpeg -f rawvideo -pix_fmt rgb24 -s " << raster.width() << "x" << raster.height()
+             << " -r " << EXPORT_FPS << " -i " << opts.outDir << "/frames.rgb partida.mp4\n";
+    } else {
+        cout << "Video: ffmpeg -framerate " << EXPORT_FPS << " -i " << opts.outDir
+             << "/frame-%06d.ppm partida.mp4\n";
+    }
+
+    if (opts.scaling) {
+        cout << "\nEscalamiento (mismos cuadros):\n";
+        cout << std::left << setw(8) << "Hilos" << setw(16) << "Cuadros/s" << "Eficiencia\n";
+        vector<int> counts;
+        for (int threads = 1; threads < opts.threads; threads *= 2) counts.push_back(threads);
+        counts.push_back(opts.threads);
+
+        double baseRate = 0.0;
+        for (int threads : counts) {
+            ExportResult run = exportFrames(opts, worlds, left->name, right->name, threads);
+            if (!run.ok) return 1;
+            double rate = worlds.size() / run.seconds;
+            if (threads == 1) baseRate = rate;
+            cout << std::left << setw(8) << threads << setw(16) << setprecision(1) << rate
+                 << setprecision(0) << (100.0 * rate / (baseRate * threads)) << "%\n";
+        }
+        cout << setprecision(1) << "Memoria pico (RSS): " << peakRssMb() << " MB\n";
+    }
+    return 0;
+}
@@ -2,7 +2,8 @@
  * Archivo: highscores.cpp
  * Descripción: Implementa la gestión de puntajes altos del juego Pong.
  *              Permite guardar, cargar y mostrar los mejores puntajes
- *              con los nombres de los jugadores.
+ *              con los nombres de los jugadores. Varios procesos pueden usar el
+ *              mismo archivo: escritura con flock + fusión + rename, lectura con mmap.
  * - Marian Olivares
  * - Marcela Ordoñez
  * - Biancka Raxón
@@ -12,18 +13,28 @@
  ****************************************************/
 
 #include "highscores.h"
+#include "async_log.h"
 #include "utils.h"
 #include <iostream>
-#include <fstream>
 #include <algorithm>
 #include <ctime>
 #include <sstream>
 #include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
-HighScoreManager::HighScoreManager() {
-    filename = "pong_highscores.txt";
+HighScoreManager::HighScoreManager(const string& path, size_t capacity) {
+    filename = path;
+    maxScores = capacity;
     sem_init(&file_semaphore, 0, 1);
     loadScores();
 }
@@ -32,10 +43,9 @@ HighScoreManager::~HighScoreManager() {
     sem_destroy(&file_semaphore);
 }
 
+// addScore ya es seguro entre hilos y procesos; se conserva por compatibilidad
 void HighScoreManager::safeAddScore(const std::string& p1Name, const std::string& p2Name, int p1Score, int p2Score) {
-    sem_wait(&file_semaphore);
     addScore(p1Name, p2Name, p1Score, p2Score);
-    sem_post(&file_semaphore);
 }
 
 void HighScoreManager::addScore(const string& p1Name, const string& p2Name, int p1Score, int p2Score) {
@@ -45,96 +55,195 @@ void HighScoreManager::addScore(const string& p1Name, const string& p2Name, int
         newScore.player2Name = p2Name;
         newScore.player1Score = p1Score;
         newScore.player2Score = p2Score;
+        newScore.date = currentDate();
         
-        time_t now = time(0);
-        tm* timeinfo = localtime(&now);
-        if (timeinfo != nullptr) {
-            char buffer[11];
-            strftime(buffer, sizeof(buffer), "%d/%m/%Y", timeinfo);
-            newScore.date = string(buffer);
-        } else {
-            newScore.date = "01/01/2024";
-        }
-        
-        highScores.push_back(newScore);
-        
-        if (highScores.size() > MAX_SCORES) {
-            highScores.erase(highScores.begin());
+        mergeAndWrite(vector<HighScore>(1, newScore));
+    } catch (...) {
+        logWrite(LOG_ERROR, "Error al guardar puntaje, pero el juego continúa");
+    }
+}
+
+// Agrega varios resultados de una vez y reescribe el archivo una sola vez
+void HighScoreManager::addScores(const vector<HighScore>& scores) {
+    try {
+        string today = currentDate();
+        vector<HighScore> dated(scores);
+        for (auto& score : dated) {
+            if (score.date.empty()) score.date = today;
         }
-        
-        saveScores();
+        mergeAndWrite(dated);
     } catch (...) {
-        cout << "Error al guardar puntaje, pero el juego continúa.\n";
+        logWrite(LOG_ERROR, "Error al guardar puntajes, pero el juego continúa");
+    }
+}
+
+string HighScoreManager::currentDate() {
+    time_t now = time(0);
+    tm* timeinfo = localtime(&now);
+    if (timeinfo != nullptr) {
+        char buffer[11];
+        strftime(buffer, sizeof(buffer), "%d/%m/%Y", timeinfo);
+        return string(buffer);
     }
+    return "01/01/2024";
+}
+
+// Interpreta una línea "p1|p2|s1|s2|fecha"; las líneas incompletas se ignoran
+static bool parseScoreLine(const char* begin, const char* end, HighScore& score) {
+    const char* fields[5];
+    const char* fieldEnds[5];
+    const char* cursor = begin;
+    for (int f = 0; f < 5; f++) {
+        const char* bar = (f < 4) ? static_cast<const char*>(memchr(cursor, '|', end - cursor)) : end;
+        if (bar == nullptr) return false;
+        fields[f] = cursor;
+        fieldEnds[f] = bar;
+        cursor = bar + 1;
+    }
+
+    char* parsedEnd = nullptr;
+    long p1Score = strtol(fields[2], &parsedEnd, 10);
+    if (parsedEnd != fieldEnds[2] || fields[2] == fieldEnds[2]) return false;
+    long p2Score = strtol(fields[3], &parsedEnd, 10);
+    if (parsedEnd != fieldEnds[3] || fields[3] == fieldEnds[3]) return false;
+
+    score.player1Name.assign(fields[0], fieldEnds[0]);
+    score.player2Name.assign(fields[1], fieldEnds[1]);
+    score.player1Score = static_cast<int>(p1Score);
+    score.player2Score = static_cast<int>(p2Score);
+    score.date.assign(fields[4], fieldEnds[4]);
+    return true;
+}
+
+// El archivo nunca se modifica en sitio (los escritores lo reemplazan con rename),
+// así que el mapeo ve siempre una versión completa aunque otro proceso escriba.
+bool HighScoreManager::readSnapshot(const string& path, vector<HighScore>& out) {
+    out.clear();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+    void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    const char* begin = static_cast<const char*>(data);
+    const char* end = begin + st.st_size;
+    while (begin < end) {
+        const char* newline = static_cast<const char*>(memchr(begin, '\n', end - begin));
+        const char* lineEnd = newline ? newline : end;
+        HighScore score;
+        if (parseScoreLine(begin, lineEnd, score)) out.push_back(score);
+        begin = lineEnd + 1;
+    }
+    munmap(data, static_cast<size_t>(st.st_size));
+    return true;
 }
 
 void HighScoreManager::loadScores() {
     sem_wait(&file_semaphore);
-    
-    ifstream file(filename);
-    if (!file.is_open()) {
+
+    vector<HighScore> loaded;
+    if (readSnapshot(filename, loaded)) {
+        if (loaded.size() > maxScores) {
+            loaded.erase(loaded.begin(), loaded.end() - maxScores);
+        }
+        highScores.swap(loaded);
+    }
+
+    sem_post(&file_semaphore);
+}
+
+// Escribe el archivo completo con write() y fsync(): el rename posterior no puede
+// dejar a la vista un archivo cuyo contenido aún no llegó al disco
+static bool writeDurably(const string& path, const string& contents) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    size_t done = 0;
+    while (done < contents.size()) {
+        ssize_t n = write(fd, contents.data() + done, contents.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            close(fd);
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    bool synced = fsync(fd) == 0;
+    return close(fd) == 0 && synced;
+}
+
+static void syncParentDirectory(const string& path) {
+    size_t slash = path.rfind('/');
+    string dir = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) return;
+    if (fsync(fd) != 0) logWrite(LOG_WARN, "No se pudo sincronizar el directorio %s: %s", dir.c_str(), strerror(errno));
+    close(fd);
+}
+
+// Escritura entre procesos: candado exclusivo, releer lo que dejaron los demás,
+// agregar lo nuevo, recortar y reemplazar el archivo de forma atómica.
+void HighScoreManager::mergeAndWrite(const vector<HighScore>& newScores) {
+    sem_wait(&file_semaphore);
+
+    string lockPath = filename + ".lock";
+    int lockFd = open(lockPath.c_str(), O_RDWR | O_CREAT, 0644);
+    if (lockFd < 0 || flock(lockFd, LOCK_EX) != 0) {
+        logWrite(LOG_ERROR, "No se pudo bloquear el archivo de puntajes %s: %s", lockPath.c_str(), strerror(errno));
+        if (lockFd >= 0) close(lockFd);
         sem_post(&file_semaphore);
         return;
     }
-    
-    highScores.clear();
-    string line;
-    
-    while (getline(file, line) && highScores.size() < MAX_SCORES) {
-        stringstream ss(line);
-        string p1Name, p2Name, date;
-        int p1Score, p2Score;
-        
-        if (getline(ss, p1Name, '|') &&
-            getline(ss, p2Name, '|') &&
-            ss >> p1Score &&
-            ss.ignore(1, '|') &&
-            ss >> p2Score &&
-            ss.ignore(1, '|') &&
-            getline(ss, date)) {
-            
-            HighScore score;
-            score.player1Name = p1Name;
-            score.player2Name = p2Name;
-            score.player1Score = p1Score;
-            score.player2Score = p2Score;
-            score.date = date;
-            highScores.push_back(score);
-        }
+
+    vector<HighScore> merged;
+    readSnapshot(filename, merged);
+    merged.insert(merged.end(), newScores.begin(), newScores.end());
+    if (merged.size() > maxScores) {
+        merged.erase(merged.begin(), merged.end() - maxScores);
     }
-    
-    file.close();
+
+    string tmpPath = filename + ".tmp";
+    string contents;
+    for (const auto& score : merged) {
+        contents += score.player1Name + "|" + score.player2Name + "|" + to_string(score.player1Score) + "|" +
+                    to_string(score.player2Score) + "|" + score.date + "\n";
+    }
+    bool written = writeDurably(tmpPath, contents);
+    if (written && rename(tmpPath.c_str(), filename.c_str()) == 0) {
+        // El rename queda en disco solo cuando se sincroniza el directorio
+        syncParentDirectory(filename);
+        highScores.swap(merged);
+    } else {
+        logWrite(LOG_ERROR, "No se pudo guardar el archivo de puntajes %s", filename.c_str());
+        unlink(tmpPath.c_str());
+    }
+
+    flock(lockFd, LOCK_UN);
+    close(lockFd);
     sem_post(&file_semaphore);
 }
 
+// Reescribe el archivo fusionando con lo que hayan guardado otros procesos
 void HighScoreManager::saveScores() {
-    sem_wait(&file_semaphore);
-    
     try {
-        ofstream file(filename);
-        if (!file.is_open()) {
-            cout << "No se pudo guardar el archivo de puntajes.\n";
-            sem_post(&file_semaphore);
-            return;
-        }
-        
-        for (const auto& score : highScores) {
-            file << score.player1Name << "|"
-                 << score.player2Name << "|"
-                 << score.player1Score << "|"
-                 << score.player2Score << "|"
-                 << score.date << "\n";
-        }
-        
-        file.close();
+        mergeAndWrite(vector<HighScore>());
     } catch (...) {
-        cout << "Error al guardar archivo de puntajes.\n";
+        logWrite(LOG_ERROR, "Error al guardar archivo de puntajes");
     }
-    
-    sem_post(&file_semaphore);
 }
 
 void HighScoreManager::displayHighScores() {
+    // Otra instancia pudo haber guardado partidas desde que se abrió el juego
+    loadScores();
     sem_wait(&file_semaphore);
     
     system("clear");
@@ -30,7 +30,8 @@ void mostrarInstrucciones() {
     cout << "Controles:\n";
     cout << "Jugador 1 (izquierda): W = subir, S = bajar\n";
     cout << "Jugador 2 (derecha):  ↑ = subir, ↓ = bajar\n";
-    cout << "Comandos generales:   Q = salir, R = reiniciar\n\n";
+    cout << "Comandos generales:   Q = salir, R = reiniciar, L = ver latencia\n";
+    cout << "Partida:              G = guardar, C = cargar, B = rebobinar 1 s, P = pausa\n\n";
 
     cout << "Elementos visuales:\n";
     cout << "   O  -> pelota\n";
@@ -0,0 +1,549 @@
+/****************************************************
+ * Archivo: key_input.cpp
+ * Descripción: Entrada de teclado con estado de teclas presionadas. Decodifica las
+ *              secuencias del terminal (incluido el protocolo de teclado de kitty, que
+ *              informa cuándo se suelta una tecla), negocia ese protocolo al empezar la
+ *              partida y, en terminales sin él, deduce si una tecla sigue presionada a
+ *              partir del ritmo de auto-repetición medido.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "key_input.h"
+#include "latency.h"
+#include "match_state.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Margen sobre el intervalo de repetición antes de dar la tecla por soltada
+static const uint64_t MIN_REPEAT_GAP_NS = 45ULL * 1000000ULL;
+static const uint64_t MAX_REPEAT_GAP_NS = 200ULL * 1000000ULL;
+// Sin eventos de soltar: la auto-repetición llega cada 25-50 ms; un evento de la misma
+// tecla más espaciado es otro toque (o la primera repetición tras el retraso inicial)
+static const uint64_t REPEAT_STREAM_NS = 100ULL * 1000000ULL;
+// Con eventos de soltar: si se perdió el KEY_RELEASE (cambio de ventana) se suelta sola
+static const uint64_t STUCK_KEY_NS = 5000ULL * 1000000ULL;
+
+// ===================== DECODIFICADOR =====================
+
+void KeyDecoder::reset() {
+    state = NORMAL;
+    privateMode = false;
+    mouseMode = false;
+    paramIndex = 0;
+    subParam = false;
+    subIndex = 0;
+    params[0] = params[1] = params[2] = 0;
+    mouseParams[0] = mouseParams[1] = mouseParams[2] = 0;
+}
+
+bool KeyDecoder::feed(unsigned char byte, KeyEvent& event) {
+    switch (state) {
+    case NORMAL:
+        if (byte == 0x1b) {
+            state = ESCAPE;
+            return false;
+        }
+        event.code = (byte >= 'A' && byte <= 'Z') ? byte - 'A' + 'a' : byte;
+        event.action = KEY_PRESS;
+        return true;
+
+    case ESCAPE:
+        if (byte == '[') {
+            state = CSI;
+            privateMode = false;
+            mouseMode = false;
+            paramIndex = 0;
+            subParam = false;
+            subIndex = 0;
+            params[0] = params[1] = params[2] = 0;
+            mouseParams[0] = mouseParams[1] = mouseParams[2] = 0;
+            return false;
+        }
+        // ESC seguido de otra cosa: se descarta el ESC y se procesa el byte
+        state = NORMAL;
+        return feed(byte, event);
+
+    case CSI:
+        if (byte == '<' && paramIndex == 0) {
+            mouseMode = true;
+            return false;
+        }
+        if (byte == '?' || byte == '>' || byte == '<' || byte == '=') {
+            privateMode = true;
+            return false;
+        }
+        if (mouseMode && byte >= '0' && byte <= '9') {
+            if (paramIndex < 3 && mouseParams[paramIndex] < 100000) {
+                mouseParams[paramIndex] = mouseParams[paramIndex] * 10 + (byte - '0');
+            }
+            return false;
+        }
+        if (byte >= '0' && byte <= '9') {
+            // Código de tecla (param 0, sub 0), modificadores (param 1, sub 0) y
+            // tipo de evento (param 1, sub 1); el resto se ignora
+            int* target = nullptr;
+            if (paramIndex == 0 && !subParam) target = &params[0];
+            else if (paramIndex == 1 && !subParam) target = &params[1];
+            else if (paramIndex == 1 && subIndex == 1) target = &params[2];
+            if (target != nullptr && *target < 100000) *target = *target * 10 + (byte - '0');
+            return false;
+        }
+        if (byte == ';') {
+            paramIndex++;
+            subParam = false;
+            subIndex = 0;
+            return false;
+        }
+        if (byte == ':') {
+            subParam = true;
+            subIndex++;
+            return false;
+        }
+        // Byte final
+        state = NORMAL;
+        if (privateMode || byte < 0x40 || byte > 0x7e) return false;
+        if (mouseMode) {
+            // M = pulsar o mover (bit 32 del botón), m = soltar
+            if ((byte != 'M' && byte != 'm') || paramIndex != 2) return false;
+            event.code = KEY_MOUSE;
+            event.action = (byte == 'm') ? KEY_RELEASE : (mouseParams[0] & 32) ? KEY_REPEAT : KEY_PRESS;
+            event.mouseCol = mouseParams[1];
+            event.mouseRow = mouseParams[2];
+            return true;
+        }
+        if (byte == 'n' && paramIndex == 0 && params[0] == 0) {
+            event.code = KEY_STATUS_REPLY;
+            event.action = KEY_PRESS;
+            return true;
+        }
+        event.action = (params[2] == 2) ? KEY_REPEAT : (params[2] == 3) ? KEY_RELEASE : KEY_PRESS;
+        if (byte == 'A') {
+            event.code = KEY_ARROW_UP;
+            return true;
+        }
+        if (byte == 'B') {
+            event.code = KEY_ARROW_DOWN;
+            return true;
+        }
+        if (byte == 'u' && params[0] > 0 && params[0] < 0x100) {
+            int code = params[0];
+            event.code = (code >= 'A' && code <= 'Z') ? code - 'A' + 'a' : code;
+            return true;
+        }
+        return false;
+    }
+    return false;
+}
+
+// ===================== PROTOCOLO DE KITTY =====================
+
+static bool kittyActive = false;
+
+static void writeTerminal(const char* text) {
+    cout.flush();
+    size_t len = strlen(text);
+    if (write(STDOUT_FILENO, text, len) != static_cast<ssize_t>(len)) { /* sin terminal */ }
+}
+
+bool enableKittyKeyboard(int timeoutMs) {
+    const char* env = getenv("PONG_KITTY");
+    if (env != nullptr && env[0] == '0') return false;
+    if (!isatty(STDIN_FILENO)) return false;
+
+    // CSI ? u solo lo responden los terminales con el protocolo; DA1 (CSI c) lo
+    // responden todos y marca el final de la respuesta
+    writeTerminal("\x1b[?u\x1b[c");
+    string reply;
+    uint64_t deadline = monotonicNowNs() + static_cast<uint64_t>(timeoutMs) * 1000000ULL;
+    bool done = false;
+    while (!done) {
+        uint64_t now = monotonicNowNs();
+        if (now >= deadline) break;
+        struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+        if (poll(&pfd, 1, static_cast<int>((deadline - now) / 1000000ULL) + 1) <= 0) continue;
+        char buffer[64];
+        ssize_t n = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (n <= 0) break;
+        reply.append(buffer, static_cast<size_t>(n));
+        // La respuesta de DA1 es CSI ? ... c
+        size_t da1 = reply.find("\x1b[?");
+        while (da1 != string::npos) {
+            size_t end = reply.find_first_not_of("0123456789;", da1 + 3);
+            if (end != string::npos && reply[end] == 'c') {
+                done = true;
+                break;
+            }
+            da1 = reply.find("\x1b[?", da1 + 3);
+        }
+    }
+
+    size_t flags = reply.find("\x1b[?");
+    bool supported = false;
+    while (flags != string::npos) {
+        size_t end = reply.find_first_not_of("0123456789", flags + 3);
+        if (end != string::npos && reply[end] == 'u') supported = true;
+        flags = reply.find("\x1b[?", flags + 3);
+    }
+    if (supported) {
+        // 1 = desambiguar, 2 = tipos de evento, 8 = todas las teclas como secuencias
+        writeTerminal("\x1b[>11u");
+        kittyActive = true;
+    }
+    return supported;
+}
+
+void disableKittyKeyboard() {
+    if (!kittyActive) return;
+    writeTerminal("\x1b[<u");
+    kittyActive = false;
+}
+
+bool awaitStatusReply(int timeoutMs) {
+    KeyDecoder decoder;
+    uint64_t deadline = monotonicNowNs() + static_cast<uint64_t>(timeoutMs) * 1000000ULL;
+    for (;;) {
+        uint64_t now = monotonicNowNs();
+        if (now >= deadline) return false;
+        struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+        if (poll(&pfd, 1, static_cast<int>((deadline - now) / 1000000ULL) + 1) <= 0) continue;
+        unsigned char byte;
+        if (read(STDIN_FILENO, &byte, 1) != 1) return false;
+        KeyEvent event;
+        if (decoder.feed(byte, event) && event.code == KEY_STATUS_REPLY) return true;
+    }
+}
+
+// ===================== TECLAS PRESIONADAS =====================
+
+HeldKeys::HeldKeys() : hasReleaseEvents(false) {
+    reset();
+}
+
+void HeldKeys::reset() {
+    lock_guard<mutex> lock(holdMutex);
+    for (Hold& hold : holds) hold = Hold{false, false, false, 0, 0, 0};
+}
+
+void HeldKeys::setReleaseEvents(bool available) {
+    lock_guard<mutex> lock(holdMutex);
+    hasReleaseEvents = available;
+}
+
+void HeldKeys::onEvent(int slot, KeyAction action, uint64_t nowNs) {
+    if (slot < 0 || slot >= SLOTS) return;
+    lock_guard<mutex> lock(holdMutex);
+    Hold& hold = holds[slot];
+    if (action == KEY_RELEASE) {
+        hold.down = false;
+        hold.repeating = false;
+        return;
+    }
+    uint64_t gap = nowNs - hold.lastEventNs;
+    bool repeat;
+    if (hasReleaseEvents) {
+        repeat = hold.down && action == KEY_REPEAT;
+    } else {
+        // El terminal solo repite la última tecla: la otra del mismo jugador se soltó
+        holds[slot ^ 1].down = false;
+        repeat = hold.down && gap < REPEAT_STREAM_NS;
+    }
+    if (!repeat) {
+        hold = Hold{true, false, true, nowNs, nowNs, 0};
+        return;
+    }
+    hold.intervalNs = hold.intervalNs == 0 ? gap : (hold.intervalNs * 3 + gap) / 4;
+    hold.repeating = true;
+    hold.lastEventNs = nowNs;
+}
+
+bool HeldKeys::isHeld(Hold& hold, uint64_t nowNs) {
+    if (!hold.down) return false;
+    uint64_t quiet = nowNs - hold.lastEventNs;
+    if (hasReleaseEvents) {
+        if (quiet > STUCK_KEY_NS) hold.down = false;
+        return hold.down;
+    }
+    if (!hold.repeating) {
+        // Pulsación sin repeticiones todavía: no se sabe si es un toque o el inicio
+        // de una tecla sostenida (el terminal espera ~500 ms antes de repetir), así
+        // que cuenta como toque: un paso, que aplica direction() por ser nueva.
+        // La primera repetición llega como otra pulsación y la siguiente ya es flujo.
+        return false;
+    }
+    uint64_t gap = hold.intervalNs == 0 ? MAX_REPEAT_GAP_NS : hold.intervalNs + hold.intervalNs / 2;
+    if (gap < MIN_REPEAT_GAP_NS) gap = MIN_REPEAT_GAP_NS;
+    if (gap > MAX_REPEAT_GAP_NS) gap = MAX_REPEAT_GAP_NS;
+    return quiet < gap;
+}
+
+int HeldKeys::direction(int player, uint64_t nowNs, uint64_t& pressNs) {
+    lock_guard<mutex> lock(holdMutex);
+    Hold& up = holds[player == 1 ? P1_UP : P2_UP];
+    Hold& down = holds[player == 1 ? P1_DOWN : P2_DOWN];
+    pressNs = 0;
+    bool upActive = isHeld(up, nowNs) || up.fresh;
+    bool downActive = isHeld(down, nowNs) || down.fresh;
+    // Ambas presionadas: manda la más reciente
+    int dir = 0;
+    if (upActive && downActive) dir = (up.pressNs >= down.pressNs) ? -1 : 1;
+    else if (upActive) dir = -1;
+    else if (downActive) dir = 1;
+    Hold& active = (dir < 0) ? up : down;
+    if (dir != 0 && active.fresh) pressNs = active.pressNs;
+    up.fresh = false;
+    down.fresh = false;
+    return dir;
+}
+
+// ===================== MOUSE =====================
+
+static bool mouseActive = false;
+
+bool enableMouseReporting() {
+    const char* env = getenv("PONG_MOUSE");
+    if (env != nullptr && env[0] == '0') return false;
+    if (!isatty(STDIN_FILENO)) return false;
+    writeTerminal("\x1b[?1003h\x1b[?1006h");
+    mouseActive = true;
+    return true;
+}
+
+void disableMouseReporting() {
+    if (!mouseActive) return;
+    writeTerminal("\x1b[?1006l\x1b[?1003l");
+    mouseActive = false;
+}
+
+void MousePointer::reset() {
+    lock_guard<mutex> lock(pointerMutex);
+    for (Slot& slot : slots) slot = Slot{false, 0, 0, 0, 0, 0, 0};
+}
+
+void MousePointer::onReport(int player, int row, uint64_t readNs) {
+    if (player < 1 || player > 2) return;
+    lock_guard<mutex> lock(pointerMutex);
+    Slot& slot = slots[player - 1];
+    if (slot.fresh) slot.coalesced++;
+    slot.fresh = true;
+    slot.row = row;
+    slot.readNs = readNs;
+    slot.reports++;
+    slot.sinceTake++;
+    if (slot.sinceTake > slot.maxBurst) slot.maxBurst = slot.sinceTake;
+}
+
+bool MousePointer::take(int player, int& row, uint64_t& readNs) {
+    lock_guard<mutex> lock(pointerMutex);
+    Slot& slot = slots[player - 1];
+    slot.sinceTake = 0;
+    if (!slot.fresh) return false;
+    slot.fresh = false;
+    row = slot.row;
+    readNs = slot.readNs;
+    return true;
+}
+
+uint64_t MousePointer::reports(int player) {
+    lock_guard<mutex> lock(pointerMutex);
+    return slots[player - 1].reports;
+}
+
+uint64_t MousePointer::coalesced(int player) {
+    lock_guard<mutex> lock(pointerMutex);
+    return slots[player - 1].coalesced;
+}
+
+uint64_t MousePointer::maxBurst(int player) {
+    lock_guard<mutex> lock(pointerMutex);
+    return slots[player - 1].maxBurst;
+}
+
+// ===================== BENCHMARK DEL MOUSE =====================
+
+static const uint64_t MOUSE_READ_NS = 5ULL * 1000000ULL;        // sondeo del hilo de entrada
+static const uint64_t MOUSE_TICK_NS = 1000000000ULL / 60;
+
+// Lecturas de la inundación: cada una junta los reportes que llegaron en 5 ms
+struct MouseFlood {
+    vector<string> reads;
+    size_t reports = 0;
+    size_t bytes = 0;
+    int lastRow = 0;
+};
+
+// Movimiento de ida y vuelta por la cancha a la tasa pedida (CSI < 35 ; col ; fila M)
+static MouseFlood buildMouseFlood(double rate, double seconds) {
+    MouseFlood flood;
+    size_t total = static_cast<size_t>(rate * seconds);
+    size_t readCount = static_cast<size_t>(seconds * 1e9 / MOUSE_READ_NS) + 1;
+    flood.reads.resize(readCount);
+    char report[32];
+    for (size_t i = 0; i < total; i++) {
+        uint64_t atNs = static_cast<uint64_t>(i * 1e9 / rate);
+        int row = 4 + static_cast<int>(i / 3 % 50);
+        if (row > 28) row = 56 - row;
+        int len = snprintf(report, sizeof(report), "\x1b[<35;%d;%dM", 10 + static_cast<int>(i % 7), row);
+        size_t r = min(static_cast<size_t>(atNs / MOUSE_READ_NS), readCount - 1);
+        flood.reads[r].append(report, static_cast<size_t>(len));
+        flood.bytes += static_cast<size_t>(len);
+        flood.lastRow = row;
+    }
+    flood.reports = total;
+    return flood;
+}
+
+struct MouseRunStats {
+    double nsPerReport = 0;
+    uint64_t maxDepth = 0;          // reportes guardados esperando al tick
+    uint64_t maxBurst = 0;          // reportes que llegaron entre dos ticks
+    uint64_t dropped = 0;           // no entraron en la cola
+    uint64_t applied = 0;           // posiciones que aplicó la física
+    int finalRow = 0;               // fila de la paleta al terminar
+};
+
+// Recorre la inundación en tiempo simulado con un tick cada 1/60 s y una pausa de la
+// física a mitad de camino. queued = cada reporte a la cola de entrada (como las
+// teclas) y el tick la vacía; si no, se junta en MousePointer y el tick toma el último.
+static MouseRunStats runMouseFlood(const MouseFlood& flood, uint64_t stallNs, bool queued) {
+    MouseRunStats stats;
+    KeyDecoder decoder;
+    InputQueue queue;
+    MousePointer pointer;
+    uint64_t depth = 0;
+    uint64_t sinceTick = 0;
+    int paddleRow = 0;
+    uint64_t nextTickNs = MOUSE_TICK_NS;
+    uint64_t stallStart = flood.reads.size() * MOUSE_READ_NS / 2;
+    uint64_t stallEnd = stallStart + stallNs;
+
+    auto tick = [&]() {
+        sinceTick = 0;
+        if (queued) {
+            while (!queue.empty()) {
+                paddleRow = static_cast<int>(queue.front().readNs);
+                queue.pop();
+                depth--;
+                stats.applied++;
+            }
+        } else {
+            uint64_t readNs;
+            if (pointer.take(1, paddleRow, readNs)) stats.applied++;
+            depth = 0;
+        }
+    };
+
+    uint64_t start = monotonicNowNs();
+    for (size_t r = 0; r < flood.reads.size(); r++) {
+        const string& bytes = flood.reads[r];
+        const unsigned char* data = reinterpret_cast<const unsigned char*>(bytes.data());
+        if (queued) {
+            for (size_t i = 0; i < bytes.size(); i++) {
+                KeyEvent key;
+                if (!decoder.feed(data[i], key) || key.code != KEY_MOUSE) continue;
+                // La fila viaja en readNs: la cola de teclas no tiene lugar para más
+                if (queue.push(InputEvent{EventType::P1_UP, static_cast<uint64_t>(key.mouseRow)})) depth++;
+                else stats.dropped++;
+                sinceTick++;
+            }
+        } else {
+            decoder.feedBlock(data, bytes.size(), [&](const KeyEvent& key) {
+                if (key.code == KEY_MOUSE) pointer.onReport(1, key.mouseRow, 0);
+                return true;
+            });
+            // feedBlock ya juntó los movimientos de esta lectura
+            sinceTick += count(bytes.begin(), bytes.end(), 'M');
+            if (!bytes.empty()) depth = 1;
+        }
+        stats.maxDepth = max(stats.maxDepth, depth);
+        stats.maxBurst = max(stats.maxBurst, sinceTick);
+
+        uint64_t nowNs = (r + 1) * MOUSE_READ_NS;
+        if (nowNs < nextTickNs) continue;
+        nextTickNs += MOUSE_TICK_NS;
+        if (nowNs >= stallStart && nowNs < stallEnd) continue;
+        tick();
+    }
+    tick();     // el último tick ve todo lo que llegó
+    stats.finalRow = paddleRow;
+    stats.nsPerReport = static_cast<double>(monotonicNowNs() - start) / max<size_t>(1, flood.reports);
+    return stats;
+}
+
+int runMouseBench(int argc, char* argv[]) {
+    double rate = 1000.0;
+    double seconds = 5.0;
+    double stallMs = 500.0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--rate" && hasValue) rate = atof(argv[++i]);
+        else if (arg == "--seconds" && hasValue) seconds = atof(argv[++i]);
+        else if (arg == "--stall-ms" && hasValue) stallMs = atof(argv[++i]);
+        else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return 1;
+        }
+    }
+    if (rate <= 0 || seconds <= 0 || stallMs < 0) {
+        cerr << "La tasa y la duración deben ser positivas\n";
+        return 1;
+    }
+
+    MouseFlood flood = buildMouseFlood(rate, seconds);
+
+    // Decodificación sola, byte a byte, repetida hasta juntar ~0,2 s
+    KeyDecoder decoder;
+    uint64_t decoded = 0;
+    uint64_t passes = 0;
+    uint64_t start = monotonicNowNs();
+    while (monotonicNowNs() - start < 200000000ULL) {
+        for (const string& bytes : flood.reads) {
+            for (unsigned char byte : bytes) {
+                KeyEvent key;
+                if (decoder.feed(byte, key) && key.code == KEY_MOUSE) decoded++;
+            }
+        }
+        passes++;
+    }
+    double decodeNs = static_cast<double>(monotonicNowNs() - start) / passes;
+    if (decoded != flood.reports * passes) {
+        cout << "FALLA: se decodificaron " << decoded / passes << " de " << flood.reports << " reportes\n";
+        return 1;
+    }
+
+    uint64_t stallNs = static_cast<uint64_t>(stallMs * 1e6);
+    MouseRunStats queued = runMouseFlood(flood, stallNs, true);
+    MouseRunStats coalesced = runMouseFlood(flood, stallNs, false);
+
+    cout << fixed << setprecision(1);
+    cout << "=== MOUSE: " << flood.reports << " reportes SGR a " << rate << " Hz (" << flood.bytes
+         << " bytes), ticks a 60 Hz, física pausada " << stallMs << " ms ===\n";
+    cout << "Decodificación: " << decodeNs / flood.reports << " ns/reporte  "
+         << decodeNs / flood.bytes << " ns/byte\n";
+    cout << left << setw(12) << "Entrada" << setw(13) << "ns/reporte" << setw(19) << "Reportes/tick máx"
+         << setw(11) << "Cola máx" << setw(12)
+         << "Perdidos" << setw(13) << "Aplicados" << "Fila final (último reporte " << flood.lastRow << ")\n";
+    const MouseRunStats* rows[2] = {&queued, &coalesced};
+    const char* names[2] = {"encolada", "juntada"};
+    for (int k = 0; k < 2; k++) {
+        cout << left << setw(12) << names[k] << setw(13) << rows[k]->nsPerReport << setw(18) << rows[k]->maxBurst
+             << setw(10) << rows[k]->maxDepth
+             << setw(12) << rows[k]->dropped << setw(13) << rows[k]->applied << rows[k]->finalRow << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+/****************************************************
+ * Archivo: latency.cpp
+ * Descripción: Medición de latencia de entrada. Cada tecla se marca con un timestamp
+ *              monotónico al leerse de stdin; al aplicarse a la paleta y al escribirse
+ *              el frame se registran las diferencias en histogramas por jugador
+ *              (p50/p99/max).
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "latency.h"
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+
+uint64_t monotonicNowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ===================== HISTOGRAMA =====================
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    memset(buckets, 0, sizeof(buckets));
+    total = 0;
+    maxValue = 0;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (int i = 0; i < NUM_BUCKETS; i++) buckets[i] += other.buckets[i];
+    total += other.total;
+    if (other.maxValue > maxValue) maxValue = other.maxValue;
+}
+
+int LatencyHistogram::bucketIndex(uint64_t micros) {
+    if (micros < SUB_BUCKETS) return static_cast<int>(micros);
+    int exponent = 63 - __builtin_clzll(micros);           // >= 4
+    int sub = static_cast<int>((micros >> (exponent - 4)) & (SUB_BUCKETS - 1));
+    int index = SUB_BUCKETS + (exponent - 4) * SUB_BUCKETS + sub;
+    return index < NUM_BUCKETS ? index : NUM_BUCKETS - 1;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < SUB_BUCKETS) return static_cast<uint64_t>(index);
+    int exponent = (index - SUB_BUCKETS) / SUB_BUCKETS + 4;
+    uint64_t sub = static_cast<uint64_t>((index - SUB_BUCKETS) % SUB_BUCKETS);
+    uint64_t step = 1ULL << (exponent - 4);
+    return ((SUB_BUCKETS + sub) << (exponent - 4)) + step - 1;
+}
+
+void LatencyHistogram::record(uint64_t micros) {
+    buckets[bucketIndex(micros)]++;
+    total++;
+    if (micros > maxValue) maxValue = micros;
+}
+
+uint64_t LatencyHistogram::count() const {
+    return total;
+}
+
+uint64_t LatencyHistogram::max() const {
+    return maxValue;
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    if (total == 0) return 0;
+    uint64_t target = static_cast<uint64_t>(p / 100.0 * total);
+    if (target >= total) target = total - 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen > target) {
+            uint64_t bound = bucketUpperBound(i);
+            return bound < maxValue ? bound : maxValue;
+        }
+    }
+    return maxValue;
+}
+
+// ===================== TRACKER =====================
+
+void LatencyTracker::recordSample(int player, uint64_t readNs, uint64_t appliedNs, uint64_t frameNs) {
+    if (player < 1 || player > MAX_PLAYERS) return;
+    lock_guard<mutex> lock(trackerMutex);
+    toPaddle[player - 1].record((appliedNs - readNs) / 1000);
+    toFrame[player - 1].record((frameNs - readNs) / 1000);
+}
+
+void LatencyTracker::reset() {
+    lock_guard<mutex> lock(trackerMutex);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        toPaddle[i].reset();
+        toFrame[i].reset();
+    }
+}
+
+bool LatencyTracker::hasSamples() const {
+    lock_guard<mutex> lock(trackerMutex);
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (toFrame[i].count() > 0) return true;
+    }
+    return false;
+}
+
+uint64_t LatencyTracker::framePercentile(int player, double p) const {
+    if (player < 1 || player > MAX_PLAYERS) return 0;
+    lock_guard<mutex> lock(trackerMutex);
+    return toFrame[player - 1].percentile(p);
+}
+
+// Línea compacta para mostrar bajo el tablero (tecla L); se escribe en el buffer
+// del llamador porque se arma en cada frame
+void LatencyTracker::formatSummary(char* line, size_t size) const {
+    lock_guard<mutex> lock(trackerMutex);
+    snprintf(line, size,
+             "Latencia ms P1 p50 %.1f p99 %.1f max %.1f | P2 p50 %.1f p99 %.1f max %.1f",
+             toFrame[0].percentile(50) / 1000.0, toFrame[0].percentile(99) / 1000.0, toFrame[0].max() / 1000.0,
+             toFrame[1].percentile(50) / 1000.0, toFrame[1].percentile(99) / 1000.0, toFrame[1].max() / 1000.0);
+}
+
+void LatencyTracker::printReport(const string& name1, const string& name2) const {
+    lock_guard<mutex> lock(trackerMutex);
+    const string names[MAX_PLAYERS] = {name1, name2};
+
+    cout << "Latencia tecla -> frame (ms):\n";
+    for (int i = 0; i < MAX_PLAYERS; i++) {
+        if (toFrame[i].count() == 0) continue;
+        char line[200];
+        snprintf(line, sizeof(line),
+                 "  %-10.10s n=%-6llu paleta p50 %6.2f p99 %6.2f | frame p50 %6.2f p99 %6.2f max %6.2f\n",
+                 names[i].c_str(), static_cast<unsigned long long>(toFrame[i].count()),
+                 toPaddle[i].percentile(50) / 1000.0, toPaddle[i].percentile(99) / 1000.0,
+                 toFrame[i].percentile(50) / 1000.0, toFrame[i].percentile(99) / 1000.0,
+                 toFrame[i].max() / 1000.0);
+        cout << line;
+    }
+}
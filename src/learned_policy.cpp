@@ -0,0 +1,273 @@
+/****************************************************
+ * Archivo: learned_policy.cpp
+ * Descripción: Política de paleta aprendida. Una red de 8-8-3 se evalúa con vectores
+ *              de 8 floats (extensiones vectoriales de GCC, sin reservar memoria) y se
+ *              entrena por estrategias evolutivas: cada generación juega miles de
+ *              partidas sin terminal en paralelo contra sí misma y contra la IA clásica.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "learned_policy.h"
+#include "ai_profile.h"
+#include "latency.h"
+#include "step_kernel.h"
+#include "work_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+typedef float v8sf __attribute__((vector_size(32)));
+
+static const char POLICY_MAGIC[8] = {'P', 'O', 'N', 'G', 'M', 'L', 'P', '1'};
+
+LearnedPolicy::LearnedPolicy() {
+    memset(&weights, 0, sizeof(weights));
+}
+
+bool LearnedPolicy::save(const string& path) const {
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file.is_open()) return false;
+    file.write(POLICY_MAGIC, sizeof(POLICY_MAGIC));
+    file.write(reinterpret_cast<const char*>(weights.data()), PolicyWeights::COUNT * sizeof(float));
+    return file.good();
+}
+
+bool LearnedPolicy::load(const string& path) {
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) return false;
+    char magic[sizeof(POLICY_MAGIC)];
+    if (!file.read(magic, sizeof(magic)) || memcmp(magic, POLICY_MAGIC, sizeof(magic)) != 0) return false;
+    PolicyWeights loaded;
+    if (!file.read(reinterpret_cast<char*>(loaded.data()), PolicyWeights::COUNT * sizeof(float))) return false;
+    weights = loaded;
+    return true;
+}
+
+int LearnedPolicy::decide(const SimState& state, int side) const {
+    // Entradas normalizadas desde el punto de vista de la paleta (x crece hacia ella)
+    float toward = (side == 2) ? static_cast<float>(state.ballSpeedX) : static_cast<float>(-state.ballSpeedX);
+    float ballX = static_cast<float>(state.ballX) / WIDTH;
+    float depth = (side == 2) ? ballX : 1.0f - ballX;
+    float ballY = static_cast<float>(state.ballY) / HEIGHT;
+    int paddleY = (side == 2) ? state.paddle2Y : state.paddle1Y;
+    float paddle = static_cast<float>(paddleY + PADDLE_HEIGHT / 2) / HEIGHT;
+    const float in[PolicyWeights::INPUTS] = {
+        depth, ballY, toward, static_cast<float>(state.ballSpeedY),
+        paddle, (ballY - paddle) * 4.0f, 0.0f, 0.0f
+    };
+
+    v8sf hidden;
+    memcpy(&hidden, weights.b1(), sizeof(hidden));
+    for (int i = 0; i < PolicyWeights::INPUTS; i++) {
+        v8sf column;
+        memcpy(&column, weights.w1(i), sizeof(column));
+        hidden += in[i] * column;
+    }
+    v8sf zero = {0, 0, 0, 0, 0, 0, 0, 0};
+    hidden = hidden > zero ? hidden : zero;
+
+    int best = 0;
+    float bestValue = 0.0f;
+    for (int a = 0; a < PolicyWeights::ACTIONS; a++) {
+        v8sf row;
+        memcpy(&row, weights.w2(a), sizeof(row));
+        v8sf product = hidden * row;
+        float value = weights.b2()[a] + product[0] + product[1] + product[2] + product[3] +
+                      product[4] + product[5] + product[6] + product[7];
+        if (a == 0 || value > bestValue) {
+            best = a;
+            bestValue = value;
+        }
+    }
+    return best - 1;
+}
+
+// ===================== ENTRENAMIENTO =====================
+
+struct TrainingOptions {
+    string outPath = "pong_policy.bin";
+    int generations = 80;
+    int population = 32;        // pares antitéticos
+    int games = 6;
+    int threads = 0;
+    int maxTicks = 3000;
+    uint32_t seed = 7;
+};
+
+static bool parseTrainingOptions(int argc, char* argv[], TrainingOptions& opts) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--out" && hasValue) opts.outPath = argv[++i];
+        else if (arg == "--generations" && hasValue) opts.generations = atoi(argv[++i]);
+        else if (arg == "--population" && hasValue) opts.population = atoi(argv[++i]);
+        else if (arg == "--games" && hasValue) opts.games = atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue) opts.threads = atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue) opts.seed = static_cast<uint32_t>(atoi(argv[++i]));
+        else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return false;
+        }
+    }
+    if (opts.threads <= 0) opts.threads = max(1u, thread::hardware_concurrency());
+    if (opts.population < 1 || opts.games < 1 || opts.generations < 1) {
+        cerr << "Población, partidas y generaciones deben ser positivas\n";
+        return false;
+    }
+    return true;
+}
+
+// Aptitud del candidato en el lado derecho: puntos a favor - en contra + golpes
+static double playFitnessGame(const LearnedPolicy& candidate, const LearnedPolicy* selfOpponent,
+                              const AIProfile& classic, uint32_t seed, int maxTicks) {
+    SimState state;
+    simInit(state, seed);
+    uint32_t classicRng = aiSeed(seed, 1);
+    int hits = 0;
+    for (int t = 0; t < maxTicks && state.scoreP1 < 5 && state.scoreP2 < 5; t++) {
+        int leftMove = selfOpponent ? selfOpponent->decide(state, 1) : aiDecide(classic, state, 1, classicRng);
+        int rightMove = candidate.decide(state, 2);
+        int before = state.ballSpeedX;
+        step(state, Inputs{leftMove, rightMove});
+        if (before > 0 && state.ballSpeedX < 0) hits++;
+    }
+    return (state.scoreP2 - state.scoreP1) + 0.05 * hits;
+}
+
+static double evaluate(const LearnedPolicy& candidate, const LearnedPolicy& current,
+                       const AIProfile& classic, uint32_t seed, const TrainingOptions& opts) {
+    double total = 0.0;
+    for (int g = 0; g < opts.games; g++) {
+        // La mitad de las partidas contra la política actual (autojuego), la otra mitad contra la IA clásica
+        const LearnedPolicy* opponent = (g % 2 == 0) ? &current : nullptr;
+        total += playFitnessGame(candidate, opponent, classic, seed + g * 7919u, opts.maxTicks);
+    }
+    return total / opts.games;
+}
+
+static double benchmarkInference(const LearnedPolicy& policy) {
+    SimState state;
+    simInit(state, 99);
+    const int iterations = 2000000;
+    volatile int sink = 0;
+    uint64_t start = monotonicNowNs();
+    for (int i = 0; i < iterations; i++) {
+        state.ballY = 1 + (i % (HEIGHT - 2));
+        sink = sink + policy.decide(state, 1 + (i & 1));
+    }
+    return static_cast<double>(monotonicNowNs() - start) / iterations;
+}
+
+int runPolicyTraining(int argc, char* argv[]) {
+    TrainingOptions opts;
+    if (!parseTrainingOptions(argc, argv, opts)) return 2;
+
+    const int n = PolicyWeights::COUNT;
+    const double sigma = 0.2;
+    const double learningRate = 0.2;
+    const AIProfile classic = {"Predice80", AIKind::PREDICT, 0.8f, 0.1f};
+
+    mt19937 rng(opts.seed);
+    normal_distribution<float> gaussian(0.0f, 1.0f);
+
+    LearnedPolicy current;
+    float* theta = current.weights.data();
+    for (int i = 0; i < n; i++) theta[i] = 0.5f * gaussian(rng);
+
+    cout << "========================================\n";
+    cout << "      ENTRENAMIENTO DE POLÍTICA (ES)    \n";
+    cout << "========================================\n";
+    cout << "Generaciones: " << opts.generations << "  población: " << opts.population * 2
+         << "  partidas/candidato: " << opts.games << "  hilos: " << opts.threads << "\n\n";
+
+    WorkStealingPool pool(opts.threads);
+    uint64_t start = monotonicNowNs();
+    uint64_t gamesPlayed = 0;
+
+    vector<vector<float>> noise(opts.population, vector<float>(n));
+    vector<double> fitnessPlus(opts.population), fitnessMinus(opts.population);
+
+    for (int gen = 0; gen < opts.generations; gen++) {
+        uint32_t genSeed = opts.seed * 2654435761u + static_cast<uint32_t>(gen) * 40503u;
+        for (int k = 0; k < opts.population; k++) {
+            for (int i = 0; i < n; i++) noise[k][i] = gaussian(rng);
+        }
+
+        for (int k = 0; k < opts.population; k++) {
+            pool.submit([&, k] {
+                LearnedPolicy plus = current, minus = current;
+                for (int i = 0; i < n; i++) {
+                    plus.weights.data()[i] += static_cast<float>(sigma) * noise[k][i];
+                    minus.weights.data()[i] -= static_cast<float>(sigma) * noise[k][i];
+                }
+                // Mismas semillas para ambos lados del par (números aleatorios comunes)
+                fitnessPlus[k] = evaluate(plus, current, classic, genSeed, opts);
+                fitnessMinus[k] = evaluate(minus, current, classic, genSeed, opts);
+            });
+        }
+        pool.waitIdle();
+        gamesPlayed += static_cast<uint64_t>(opts.population) * 2 * opts.games;
+
+        // Gradiente estimado con aptitud por rangos centrados
+        vector<pair<double, int>> ranked;
+        for (int k = 0; k < opts.population; k++) {
+            ranked.push_back({fitnessPlus[k], 2 * k});
+            ranked.push_back({fitnessMinus[k], 2 * k + 1});
+        }
+        sort(ranked.begin(), ranked.end());
+        vector<double> utility(2 * opts.population);
+        for (size_t r = 0; r < ranked.size();) {
+            // Los empates comparten el rango promedio para no inventar gradiente
+            size_t end = r;
+            while (end < ranked.size() && ranked[end].first == ranked[r].first) end++;
+            double rank = (r + end - 1) / 2.0;
+            for (size_t j = r; j < end; j++) {
+                utility[ranked[j].second] = rank / (ranked.size() - 1) - 0.5;
+            }
+            r = end;
+        }
+        for (int i = 0; i < n; i++) {
+            double gradient = 0.0;
+            for (int k = 0; k < opts.population; k++) {
+                gradient += (utility[2 * k] - utility[2 * k + 1]) * noise[k][i];
+            }
+            theta[i] += static_cast<float>(learningRate * gradient / (2 * opts.population * sigma));
+        }
+
+        if (gen % 10 == 0 || gen == opts.generations - 1) {
+            double vsClassic = 0.0;
+            for (int g = 0; g < 8; g++) {
+                vsClassic += playFitnessGame(current, nullptr, classic, 1000u + g, opts.maxTicks);
+            }
+            cout << "Gen " << setw(4) << gen << "  aptitud media vs IA clásica: "
+                 << fixed << setprecision(2) << vsClassic / 8 << "\n";
+        }
+    }
+
+    double seconds = (monotonicNowNs() - start) / 1e9;
+    cout << "\nPartidas de entrenamiento: " << gamesPlayed << " en " << setprecision(2) << seconds
+         << " s (" << setprecision(0) << gamesPlayed / seconds << " partidas/s)\n";
+    cout << "Inferencia: " << setprecision(1) << benchmarkInference(current) << " ns por decisión\n";
+
+    if (!current.save(opts.outPath)) {
+        cerr << "No se pudo guardar " << opts.outPath << "\n";
+        return 1;
+    }
+    cout << "Pesos guardados en " << opts.outPath << " ("
+         << sizeof(POLICY_MAGIC) + PolicyWeights::COUNT * sizeof(float) << " bytes)\n";
+    return 0;
+}
@@ -15,13 +15,171 @@
 #include "instrucciones.h"
 #include "pong_game.h"
 #include "utils.h"
+#include "pty_harness.h"
+#include "tournament.h"
+#include "learned_policy.h"
+#include "step_check.h"
+#include "encode_check.h"
+#include "score_stress.h"
+#include "arena.h"
+#include "cast_recorder.h"
+#include "rally_log.h"
+#include "bot_api.h"
+#include "frame_export.h"
+#include "match_state.h"
+#include "multi_match.h"
+#include "multi_ball.h"
+#include "key_input.h"
+#include "court_variant.h"
+#include "async_log.h"
+#include "thread_tuning.h"
 #include <unistd.h>
+#include <string>
+#include <cstdlib>
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--harness") {
+        return runPtyHarness(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--tournament") {
+        return runTournament(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--train-policy") {
+        return runPolicyTraining(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--step-check") {
+        return runStepCheck(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--encode-check") {
+        return runEncodeCheck(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--score-stress") {
+        return runScoreStress(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--cast-bench") {
+        return runCastBench(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--arena") {
+        return runArena(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--bot-match") {
+        return runBotMatch(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--bot-client") {
+        return runBotClient(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--export") {
+        return runFrameExport(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--layout-bench") {
+        return runLayoutBench(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--players") {
+        return runMultiMatch(argc, argv);
+    }
+    if (argc > 1 && string(argv[1]) == "--players-bench") {
+        return runMultiBench(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--balls") {
+        return runMultiBall(argc, argv);
+    }
+    if (argc > 1 && string(argv[1]) == "--balls-bench") {
+        return runMultiBallBench(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--court") {
+        return runCourtDemo(argc, argv);
+    }
+    if (argc > 1 && string(argv[1]) == "--court-bench") {
+        return runCourtBench(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--mouse-bench") {
+        return runMouseBench(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--log-bench") {
+        return runLogBench(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--rally-stats") {
+        return runRallyStats(argc - 1, argv + 1);
+    }
+    if (argc > 1 && string(argv[1]) == "--rally-bench") {
+        return runRallyBench(argc - 1, argv + 1);
+    }
+
     PongGame game;
     bool salir = false;
 
+    // Opciones de la IA por búsqueda: --ai-budget-us N [--ai-threads N]
+    // Política aprendida: --ai-policy archivo (generado con --train-policy)
+    // Hilos: --pin-<rol> CPU, --fifo-<rol> PRIO, --mlockall, --background-load N
+    // Grabación: --record PREFIJO (asciicast v2, un archivo por partida)
+    // Peloteos: --rally-log ARCHIVO (analizar con --rally-stats ARCHIVO)
+    // Bots: --bot-shm NOMBRE (memoria compartida; ver --bot-client)
+    // Paletas: --paddle-input held|event (velocidad con teclas mantenidas o una celda por tecla)
+    // Registro: --log ARCHIVO (por defecto pong.log o $PONG_LOG), --log-level debug|info|warn|error
+    int aiBudgetUs = 0;
+    int aiThreads = 1;
+    const char* envLog = getenv("PONG_LOG");
+    string logPath = envLog != nullptr ? envLog : "pong.log";
+    LogLevel logLevel = LOG_INFO;
+    ThreadTuning tuning;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        int used = parseThreadTuningArg(argc, argv, i, tuning);
+        if (used < 0) return 1;
+        if (used > 0) {
+            i += used - 1;
+            continue;
+        }
+        if (i + 1 >= argc) break;
+        if (arg == "--ai-budget-us") aiBudgetUs = atoi(argv[++i]);
+        else if (arg == "--ai-threads") aiThreads = atoi(argv[++i]);
+        else if (arg == "--record") game.configureRecording(argv[++i]);
+        else if (arg == "--log") logPath = argv[++i];
+        else if (arg == "--log-level") {
+            const char* level = argv[++i];
+            if (!logParseLevel(level, logLevel)) {
+                cout << "Nivel de registro desconocido: " << level << " (usa debug, info, warn o error)\n";
+                return 1;
+            }
+        }
+        else if (arg == "--paddle-input") {
+            const char* mode = argv[++i];
+            if (!game.configurePaddleInput(mode)) {
+                cout << "Modo de paletas desconocido: " << mode << " (usa held o event)\n";
+                return 1;
+            }
+        }
+        else if (arg == "--bot-shm") {
+            const char* name = argv[++i];
+            if (!game.configureBotApi(name)) {
+                cout << "No se pudo crear el segmento de bots " << name << "\n";
+                return 1;
+            }
+        }
+        else if (arg == "--rally-log") {
+            const char* path = argv[++i];
+            if (!game.configureRallyLog(path)) {
+                cout << "No se pudo abrir el registro de peloteos " << path << "\n";
+                return 1;
+            }
+        }
+        else if (arg == "--ai-policy") {
+            const char* path = argv[++i];
+            if (!game.configureLearnedPolicy(path)) {
+                cout << "No se pudo cargar la política " << path << "\n";
+                return 1;
+            }
+        }
+    }
+    // Los mensajes de los hilos del juego van al archivo, nunca a la pantalla
+    if (!logOpen(logPath, logLevel)) {
+        cout << "No se pudo abrir el registro " << logPath << "\n";
+        return 1;
+    }
+    game.configureRolloutAI(aiThreads, aiBudgetUs);
+    setThreadTuning(tuning);
+
     while (!salir) {
         MenuOption opcion = mostrarMenu();
 
@@ -65,6 +223,7 @@ int main() {
         }
     }
 
+    logClose();
     cout << "Gracias por jugar Pong ASCII!\n";
     return 0;
 }
\ No newline at end of file
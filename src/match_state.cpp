@@ -0,0 +1,479 @@
+/****************************************************
+ * Archivo: match_state.cpp
+ * Descripción: Microbenchmark de false sharing del estado de la partida. Corre los
+ *              mismos hilos que una partida (física, dos paletas, entrada y render)
+ *              en bucle cerrado sobre la distribución anterior de PongGame (campos y
+ *              mutex contiguos) y sobre los bloques por escritor de match_state.h, y
+ *              compara operaciones por segundo, líneas de caché con escritores
+ *              distintos y fallos de caché L1D medidos con perf_event_open.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "match_state.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <linux/perf_event.h>
+#include <memory>
+#include <semaphore.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+// Hilos de la partida (bits para saber quién escribe cada campo)
+enum BenchRole {
+    ROLE_PHYSICS = 0,
+    ROLE_PADDLE1,
+    ROLE_PADDLE2,
+    ROLE_INPUT,
+    ROLE_RENDER,
+    ROLE_COUNT
+};
+
+static const char* ROLE_NAMES[ROLE_COUNT] = {"Física", "Paleta 1", "Paleta 2", "Entrada", "Render"};
+static const unsigned W_PHYSICS = 1u << ROLE_PHYSICS;
+static const unsigned W_PADDLE1 = 1u << ROLE_PADDLE1;
+static const unsigned W_PADDLE2 = 1u << ROLE_PADDLE2;
+static const unsigned W_INPUT = 1u << ROLE_INPUT;
+static const unsigned W_RENDER = 1u << ROLE_RENDER;
+
+// ===================== DISTRIBUCIONES =====================
+
+// Mismo orden de campos que tenía PongGame antes de partir el estado por escritor
+// (los int de la partida son atómicos relajados: mismo tráfico, sin carreras de datos)
+struct LegacyLayout {
+    atomic<int> scoreP1, scoreP2;
+    atomic<int> paddle1Y, paddle2Y;
+    atomic<int> ballX, ballY, ballSpeedX, ballSpeedY;
+    atomic<uint32_t> rngState, tickCount;
+    atomic<bool> gameRunning, resetRequested, roundInProgress, isAIEnabled, showLatency;
+    float ai_difficulty;
+    void* planner;
+    void* learnedPolicy;
+    string playerName1, playerName2;
+    sem_t sem_highscore;
+    pthread_mutex_t mtxQueueP1, mtxQueueP2, mutex_paddleA, mutex_paddleB;
+    pthread_mutex_t mutex_start_round, mutex_game_state;
+    pthread_cond_t cvP1, cvP2, cond_start_round, cond_frame_ready;
+    InputQueue queueP1, queueP2;
+    PendingInputs pendingP1, pendingP2;
+    atomic<uint64_t> eventsApplied[2];
+    atomic<uint64_t> framesRendered;
+
+    LegacyLayout() : scoreP1(0), scoreP2(0), paddle1Y(10), paddle2Y(10), ballX(WIDTH / 2), ballY(HEIGHT / 2),
+                     ballSpeedX(1), ballSpeedY(1), rngState(1), tickCount(0), gameRunning(true),
+                     resetRequested(false), roundInProgress(true), isAIEnabled(false), showLatency(false),
+                     ai_difficulty(0.8f), planner(nullptr), learnedPolicy(nullptr), framesRendered(0) {
+        eventsApplied[0] = 0;
+        eventsApplied[1] = 0;
+        pthread_mutex_t* mutexes[] = {&mtxQueueP1, &mtxQueueP2, &mutex_paddleA, &mutex_paddleB,
+                                      &mutex_start_round, &mutex_game_state};
+        for (pthread_mutex_t* m : mutexes) pthread_mutex_init(m, nullptr);
+        pthread_cond_t* conds[] = {&cvP1, &cvP2, &cond_start_round, &cond_frame_ready};
+        for (pthread_cond_t* c : conds) pthread_cond_init(c, nullptr);
+    }
+};
+
+// Los bloques de PongGame en el mismo orden en que los declara pong_game.h
+struct PartitionedLayout {
+    BallBlock ball;
+    PaddleBlock paddles[2];
+    InputLane lanes[2];
+    ControlBlock control;
+    alignas(CACHE_LINE) atomic<uint64_t> framesRendered;
+
+    PartitionedLayout() : framesRendered(0) {
+        World world = {};
+        world.ballX = WIDTH / 2;
+        world.ballY = HEIGHT / 2;
+        world.ballSpeedX = 1;
+        world.ballSpeedY = 1;
+        world.rng = 1;
+        ball.publish(world);
+        paddles[0].y = 10;
+        paddles[1].y = 10;
+        control.roundInProgress = true;
+    }
+};
+
+// ===================== LÍNEAS COMPARTIDAS =====================
+
+struct FieldSpan {
+    const char* name;
+    size_t offset;
+    size_t size;
+    unsigned writers;
+};
+
+template <class T, class F>
+static FieldSpan span(const T& base, const F& field, const char* name, unsigned writers) {
+    size_t offset = reinterpret_cast<const char*>(&field) - reinterpret_cast<const char*>(&base);
+    return {name, offset, sizeof(F), writers};
+}
+
+static vector<FieldSpan> legacyFields(const LegacyLayout& s) {
+    return {
+        span(s, s.scoreP1, "scoreP1", W_PHYSICS), span(s, s.scoreP2, "scoreP2", W_PHYSICS),
+        span(s, s.paddle1Y, "paddle1Y", W_PADDLE1), span(s, s.paddle2Y, "paddle2Y", W_PADDLE2),
+        span(s, s.ballX, "ballX", W_PHYSICS), span(s, s.ballY, "ballY", W_PHYSICS),
+        span(s, s.ballSpeedX, "ballSpeedX", W_PHYSICS), span(s, s.ballSpeedY, "ballSpeedY", W_PHYSICS),
+        span(s, s.rngState, "rngState", W_PHYSICS), span(s, s.tickCount, "tickCount", W_PHYSICS),
+        span(s, s.gameRunning, "gameRunning", W_INPUT), span(s, s.resetRequested, "resetRequested", W_INPUT),
+        span(s, s.showLatency, "showLatency", W_INPUT),
+        span(s, s.mtxQueueP1, "mtxQueueP1", W_INPUT | W_PADDLE1),
+        span(s, s.mtxQueueP2, "mtxQueueP2", W_INPUT | W_PADDLE2),
+        span(s, s.mutex_paddleA, "mutex_paddleA", W_PADDLE1 | W_RENDER),
+        span(s, s.mutex_paddleB, "mutex_paddleB", W_PADDLE2 | W_RENDER),
+        span(s, s.cvP1, "cvP1", W_INPUT | W_PADDLE1), span(s, s.cvP2, "cvP2", W_INPUT | W_PADDLE2),
+        span(s, s.queueP1, "queueP1", W_INPUT | W_PADDLE1), span(s, s.queueP2, "queueP2", W_INPUT | W_PADDLE2),
+        span(s, s.pendingP1, "pendingP1", W_PADDLE1 | W_RENDER),
+        span(s, s.pendingP2, "pendingP2", W_PADDLE2 | W_RENDER),
+        span(s, s.eventsApplied[0], "eventsApplied[0]", W_PADDLE1),
+        span(s, s.eventsApplied[1], "eventsApplied[1]", W_PADDLE2),
+        span(s, s.framesRendered, "framesRendered", W_RENDER),
+    };
+}
+
+static vector<FieldSpan> partitionedFields(const PartitionedLayout& s) {
+    vector<FieldSpan> fields = {
+        span(s, s.ball, "ball", W_PHYSICS),
+        span(s, s.control, "control", W_INPUT),
+        span(s, s.framesRendered, "framesRendered", W_RENDER),
+    };
+    const unsigned paddleWriter[2] = {W_PADDLE1, W_PADDLE2};
+    const char* names[2][5] = {{"paddles[0].mutex", "paddles[0].y", "paddles[0].pending", "lanes[0].mutex", "lanes[0].queue"},
+                               {"paddles[1].mutex", "paddles[1].y", "paddles[1].pending", "lanes[1].mutex", "lanes[1].queue"}};
+    for (int p = 0; p < 2; p++) {
+        const PaddleBlock& paddle = s.paddles[p];
+        const InputLane& lane = s.lanes[p];
+        fields.push_back(span(s, paddle.mutex, names[p][0], paddleWriter[p] | W_RENDER));
+        fields.push_back(span(s, paddle.y, names[p][1], paddleWriter[p]));
+        fields.push_back(span(s, paddle.pending, names[p][2], paddleWriter[p] | W_RENDER));
+        fields.push_back(span(s, lane.mutex, names[p][3], W_INPUT | paddleWriter[p]));
+        fields.push_back(span(s, lane.queue, names[p][4], W_INPUT | paddleWriter[p]));
+    }
+    return fields;
+}
+
+// Líneas con false sharing: las escriben hilos que no comparten ningún campo de la
+// línea (la unión de escritores es mayor que los escritores de cualquier campo)
+static int falselySharedLines(const vector<FieldSpan>& fields, bool verbose) {
+    size_t end = 0;
+    for (const FieldSpan& f : fields) end = max(end, f.offset + f.size);
+    size_t lines = (end + CACHE_LINE - 1) / CACHE_LINE;
+    vector<unsigned> unionWriters(lines, 0);
+    vector<unsigned> widestField(lines, 0);
+    vector<string> names(lines);
+    for (const FieldSpan& f : fields) {
+        for (size_t line = f.offset / CACHE_LINE; line <= (f.offset + f.size - 1) / CACHE_LINE; line++) {
+            unionWriters[line] |= f.writers;
+            if (__builtin_popcount(f.writers) > __builtin_popcount(widestField[line])) widestField[line] = f.writers;
+            if (!names[line].empty()) names[line] += ", ";
+            names[line] += f.name;
+        }
+    }
+    int shared = 0;
+    for (size_t line = 0; line < lines; line++) {
+        if (unionWriters[line] == widestField[line]) continue;
+        shared++;
+        if (verbose) cout << "    línea " << line << ": " << names[line] << "\n";
+    }
+    return shared;
+}
+
+// ===================== HILOS =====================
+
+static void bounce(int& y, int& dir) {
+    y += dir;
+    if (y <= 1 || y >= HEIGHT - PADDLE_HEIGHT - 1) dir = -dir;
+}
+
+// Una vuelta de cada hilo: lo mismo que hacen advanceBall, applyPaddleEvent,
+// handleKey/pushEvent y renderFrame + syncRenderer
+static void physicsOp(LegacyLayout& s, World& local) {
+    local.paddle1Y = s.paddle1Y.load(memory_order_relaxed);
+    local.paddle2Y = s.paddle2Y.load(memory_order_relaxed);
+    step(local, Inputs{0, 0});
+    s.ballX.store(local.ballX, memory_order_relaxed);
+    s.ballY.store(local.ballY, memory_order_relaxed);
+    s.ballSpeedX.store(local.ballSpeedX, memory_order_relaxed);
+    s.ballSpeedY.store(local.ballSpeedY, memory_order_relaxed);
+    s.scoreP1.store(local.scoreP1, memory_order_relaxed);
+    s.scoreP2.store(local.scoreP2, memory_order_relaxed);
+    s.rngState.store(local.rng, memory_order_relaxed);
+    s.tickCount.store(local.tick, memory_order_relaxed);
+}
+
+static void physicsOp(PartitionedLayout& s, World& local) {
+    local.paddle1Y = s.paddles[0].load();
+    local.paddle2Y = s.paddles[1].load();
+    step(local, Inputs{0, 0});
+    s.ball.publish(local);
+}
+
+static void paddleOp(LegacyLayout& s, int player, int& y, int& dir) {
+    pthread_mutex_t* queueMutex = player == 1 ? &s.mtxQueueP1 : &s.mtxQueueP2;
+    InputQueue& queue = player == 1 ? s.queueP1 : s.queueP2;
+    pthread_mutex_t* paddleMutex = player == 1 ? &s.mutex_paddleA : &s.mutex_paddleB;
+    atomic<int>& paddleY = player == 1 ? s.paddle1Y : s.paddle2Y;
+    PendingInputs& pending = player == 1 ? s.pendingP1 : s.pendingP2;
+
+    pthread_mutex_lock(queueMutex);
+    if (!queue.empty()) queue.pop();
+    pthread_mutex_unlock(queueMutex);
+    pthread_mutex_lock(paddleMutex);
+    bounce(y, dir);
+    paddleY.store(y, memory_order_relaxed);
+    if (pending.count < PendingInputs::CAPACITY) pending.readNs[pending.count++] = static_cast<uint64_t>(y);
+    pthread_mutex_unlock(paddleMutex);
+    s.eventsApplied[player - 1].fetch_add(1, memory_order_relaxed);
+}
+
+static void paddleOp(PartitionedLayout& s, int player, int& y, int& dir) {
+    InputLane& lane = s.lanes[player - 1];
+    PaddleBlock& paddle = s.paddles[player - 1];
+
+    pthread_mutex_lock(&lane.mutex);
+    if (!lane.queue.empty()) lane.queue.pop();
+    pthread_mutex_unlock(&lane.mutex);
+    pthread_mutex_lock(&paddle.mutex);
+    bounce(y, dir);
+    paddle.y.store(y, memory_order_relaxed);
+    if (paddle.pending.count < PendingInputs::CAPACITY) paddle.pending.readNs[paddle.pending.count++] = static_cast<uint64_t>(y);
+    pthread_mutex_unlock(&paddle.mutex);
+    lane.eventsApplied.fetch_add(1, memory_order_relaxed);
+}
+
+static void inputOp(LegacyLayout& s, uint64_t n) {
+    bool first = (n & 1) == 0;
+    pthread_mutex_t* queueMutex = first ? &s.mtxQueueP1 : &s.mtxQueueP2;
+    InputQueue& queue = first ? s.queueP1 : s.queueP2;
+    pthread_mutex_lock(queueMutex);
+    queue.push(InputEvent{first ? EventType::P1_UP : EventType::P2_UP, n});
+    pthread_mutex_unlock(queueMutex);
+    if ((n & 1023) == 0) s.showLatency.store(!s.showLatency.load(memory_order_relaxed), memory_order_relaxed);
+}
+
+static void inputOp(PartitionedLayout& s, uint64_t n) {
+    InputLane& lane = s.lanes[n & 1];
+    pthread_mutex_lock(&lane.mutex);
+    lane.queue.push(InputEvent{(n & 1) == 0 ? EventType::P1_UP : EventType::P2_UP, n});
+    pthread_mutex_unlock(&lane.mutex);
+    if ((n & 1023) == 0) s.control.showLatency.store(!s.control.showLatency.load(memory_order_relaxed), memory_order_relaxed);
+}
+
+// Antes: la pelota se leía suelta y cada paleta con su mutex
+static uint64_t renderOp(LegacyLayout& s) {
+    World w;
+    w.ballX = s.ballX.load(memory_order_relaxed);
+    w.ballY = s.ballY.load(memory_order_relaxed);
+    w.scoreP1 = s.scoreP1.load(memory_order_relaxed);
+    w.scoreP2 = s.scoreP2.load(memory_order_relaxed);
+    pthread_mutex_lock(&s.mutex_paddleA);
+    w.paddle1Y = s.paddle1Y.load(memory_order_relaxed);
+    s.pendingP1.count = 0;
+    pthread_mutex_unlock(&s.mutex_paddleA);
+    pthread_mutex_lock(&s.mutex_paddleB);
+    w.paddle2Y = s.paddle2Y.load(memory_order_relaxed);
+    s.pendingP2.count = 0;
+    pthread_mutex_unlock(&s.mutex_paddleB);
+    s.framesRendered.fetch_add(1, memory_order_relaxed);
+    return static_cast<uint64_t>(w.ballX + w.ballY + w.paddle1Y + w.paddle2Y + w.scoreP1 + w.scoreP2);
+}
+
+// Ahora: seqlock para la pelota, paletas sin lock; el mutex solo para vaciar pendientes
+static uint64_t renderOp(PartitionedLayout& s) {
+    World w;
+    s.ball.read(w);
+    w.paddle1Y = s.paddles[0].load();
+    w.paddle2Y = s.paddles[1].load();
+    for (PaddleBlock& paddle : s.paddles) {
+        pthread_mutex_lock(&paddle.mutex);
+        paddle.pending.count = 0;
+        pthread_mutex_unlock(&paddle.mutex);
+    }
+    s.framesRendered.fetch_add(1, memory_order_relaxed);
+    return static_cast<uint64_t>(w.ballX + w.ballY + w.paddle1Y + w.paddle2Y + w.scoreP1 + w.scoreP2);
+}
+
+// ===================== CONTADORES DE HARDWARE =====================
+
+// Fallos de lectura en L1D de todo el proceso (hilos hijos incluidos); -1 si el
+// kernel o la máquina virtual no exponen el contador
+class L1MissCounter {
+public:
+    L1MissCounter() : fd(-1) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~L1MissCounter() {
+        if (fd >= 0) ::close(fd);
+    }
+    bool available() const { return fd >= 0; }
+    void start() {
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    int64_t stop() {
+        if (fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t value = 0;
+        if (read(fd, &value, sizeof(value)) != static_cast<ssize_t>(sizeof(value))) return -1;
+        return static_cast<int64_t>(value);
+    }
+
+private:
+    int fd;
+};
+
+// ===================== BENCHMARK =====================
+
+// Suma de lo leído por el render: evita que el compilador descarte las lecturas
+static atomic<uint64_t> benchSink(0);
+
+struct LayoutRun {
+    uint64_t ops[ROLE_COUNT];
+    double seconds;
+    int64_t l1Misses;
+};
+
+template <class Layout>
+static LayoutRun runLayout(double seconds) {
+    unique_ptr<Layout> state(new Layout());
+    atomic<bool> stop(false);
+    atomic<int> ready(0);
+    LayoutRun run = {};
+
+    auto worker = [&](int role) {
+        World local = {};
+        local.ballX = WIDTH / 2;
+        local.ballY = HEIGHT / 2;
+        local.ballSpeedX = 1;
+        local.ballSpeedY = 1;
+        local.rng = 1;
+        int y = 10;
+        int dir = 1;
+        uint64_t n = 0;
+        uint64_t acc = 0;
+        // Todos arrancan juntos cuando el hilo principal abre la barrera
+        ready.fetch_add(1);
+        while (ready.load(memory_order_acquire) <= ROLE_COUNT) this_thread::yield();
+        while (!stop.load(memory_order_relaxed)) {
+            switch (role) {
+            case ROLE_PHYSICS: physicsOp(*state, local); break;
+            case ROLE_PADDLE1: paddleOp(*state, 1, y, dir); break;
+            case ROLE_PADDLE2: paddleOp(*state, 2, y, dir); break;
+            case ROLE_INPUT: inputOp(*state, n); break;
+            default: acc += renderOp(*state); break;
+            }
+            n++;
+        }
+        // Un solo store al final: el conteo no agrega tráfico entre hilos
+        run.ops[role] = n;
+        benchSink.fetch_add(acc, memory_order_relaxed);
+    };
+
+    L1MissCounter misses;
+    vector<thread> threads;
+    for (int role = 0; role < ROLE_COUNT; role++) threads.emplace_back(worker, role);
+    while (ready.load() < ROLE_COUNT) this_thread::yield();
+    misses.start();
+    uint64_t start = monotonicNowNs();
+    ready.store(ROLE_COUNT + 1, memory_order_release);
+    this_thread::sleep_for(chrono::microseconds(static_cast<int64_t>(seconds * 1e6)));
+    stop.store(true, memory_order_relaxed);
+    for (thread& t : threads) t.join();
+    run.seconds = (monotonicNowNs() - start) / 1e9;
+    run.l1Misses = misses.stop();
+    return run;
+}
+
+static void printRun(const char* title, const LayoutRun& run) {
+    uint64_t total = 0;
+    for (int role = 0; role < ROLE_COUNT; role++) total += run.ops[role];
+    cout << "  " << left << setw(14) << title;
+    for (int role = 0; role < ROLE_COUNT; role++) {
+        cout << right << setw(10) << setprecision(2) << run.ops[role] / run.seconds / 1e6;
+    }
+    cout << right << setw(10) << setprecision(2) << total / run.seconds / 1e6;
+    if (run.l1Misses >= 0) cout << setw(12) << setprecision(3) << static_cast<double>(run.l1Misses) / total;
+    else cout << setw(12) << "n/d";
+    cout << "\n";
+}
+
+int runLayoutBench(int argc, char* argv[]) {
+    double seconds = 1.0;
+    int runs = 3;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--seconds" && hasValue) seconds = atof(argv[++i]);
+        else if (arg == "--runs" && hasValue) runs = atoi(argv[++i]);
+        else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return 1;
+        }
+    }
+    runs = max(1, runs);
+
+    cout << fixed;
+    cout << "=== FALSE SHARING DEL ESTADO DE LA PARTIDA ===\n";
+    cout << "Núcleos: " << thread::hardware_concurrency() << " | hilos: " << ROLE_COUNT
+         << " | " << runs << " corridas de " << setprecision(1) << seconds << " s por distribución\n";
+    if (thread::hardware_concurrency() < 2) {
+        cout << "Aviso: con un solo núcleo los hilos no corren a la vez y no hay tráfico entre cachés\n";
+    }
+
+    unique_ptr<LegacyLayout> legacy(new LegacyLayout());
+    unique_ptr<PartitionedLayout> partitioned(new PartitionedLayout());
+    cout << "\nLíneas de " << CACHE_LINE << " bytes escritas por hilos sin campos en común:\n";
+    cout << "  Antes (" << sizeof(LegacyLayout) << " bytes):\n";
+    int before = falselySharedLines(legacyFields(*legacy), true);
+    cout << "  Después (" << sizeof(PartitionedLayout) << " bytes):\n";
+    int after = falselySharedLines(partitionedFields(*partitioned), true);
+    if (after == 0) cout << "    ninguna\n";
+    cout << "  Total: " << before << " -> " << after << "\n";
+
+    cout << "\nMillones de operaciones por segundo por hilo (y fallos L1D por operación):\n";
+    cout << "  " << left << setw(14) << "";
+    for (int role = 0; role < ROLE_COUNT; role++) cout << right << setw(10) << ROLE_NAMES[role];
+    cout << right << setw(10) << "Total" << setw(12) << "L1D/op" << "\n";
+    double legacyTotal = 0.0;
+    double partitionedTotal = 0.0;
+    for (int r = 0; r < runs; r++) {
+        LayoutRun a = runLayout<LegacyLayout>(seconds);
+        LayoutRun b = runLayout<PartitionedLayout>(seconds);
+        printRun("Antes", a);
+        printRun("Después", b);
+        for (int role = 0; role < ROLE_COUNT; role++) {
+            legacyTotal += a.ops[role] / a.seconds;
+            partitionedTotal += b.ops[role] / b.seconds;
+        }
+    }
+    cout << "\nOperaciones totales: " << setprecision(2) << legacyTotal / runs / 1e6 << " -> "
+         << partitionedTotal / runs / 1e6 << " M/s (x" << partitionedTotal / max(legacyTotal, 1.0) << ")\n";
+    return 0;
+}
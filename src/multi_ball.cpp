@@ -0,0 +1,566 @@
+/****************************************************
+ * Archivo: multi_ball.cpp
+ * Descripción: Modo caos con muchas pelotas. Simulación en columnas por pelota con
+ *              una grilla uniforme (listas enlazadas por celda que se actualizan solo
+ *              para las pelotas que cambiaron de celda) como fase amplia de choques,
+ *              partida en el terminal y benchmark de 1 a 10.000 pelotas contra la
+ *              prueba de todos los pares.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "multi_ball.h"
+#include "key_input.h"
+#include "latency.h"
+#include "match_state.h"
+#include "term_encoder.h"
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+
+static const int BALL_TICKS_PER_SECOND = 60;
+static const int BALL_ROWS = 3 + 1 + HEIGHT + 1 + 1;     // marcador, cancha con bordes, estado
+static const int BALL_STEP = 10;                         // pelotas por cada + o -
+
+// ===================== SIMULACIÓN =====================
+
+static inline float randomUnit(uint32_t& rng) {
+    rng = stepXorshift(rng);
+    return static_cast<float>(rng >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline int cellOf(const BallField& field, float x, float y) {
+    int cx = min(max(static_cast<int>(x), 0), field.width - 1);
+    int cy = min(max(static_cast<int>(y), 0), field.height - 1);
+    return cy * field.width + cx;
+}
+
+static void link(BallField& field, int i, int c) {
+    field.cell[i] = c;
+    field.prev[i] = -1;
+    field.next[i] = field.head[c];
+    if (field.head[c] >= 0) field.prev[field.head[c]] = i;
+    field.head[c] = i;
+}
+
+static void unlink(BallField& field, int i) {
+    int c = field.cell[i];
+    if (field.prev[i] >= 0) field.next[field.prev[i]] = field.next[i];
+    else field.head[c] = field.next[i];
+    if (field.next[i] >= 0) field.prev[field.next[i]] = field.prev[i];
+}
+
+// Centro de la cancha con dirección al azar; con paredes cerradas, en cualquier lugar
+// (así la densidad del benchmark es pareja desde el primer tick)
+static void spawn(BallField& field, int i) {
+    if (field.closed) {
+        field.x[i] = field.width * randomUnit(field.rng);
+        field.y[i] = field.height * randomUnit(field.rng);
+    } else {
+        field.x[i] = field.width * (0.4f + 0.2f * randomUnit(field.rng));
+        field.y[i] = field.height * (0.2f + 0.6f * randomUnit(field.rng));
+    }
+    float speed = 0.3f + 0.4f * randomUnit(field.rng);
+    float angle = (randomUnit(field.rng) - 0.5f) * 1.6f;        // hasta ~45° de la horizontal
+    float dir = randomUnit(field.rng) < 0.5f ? -1.0f : 1.0f;
+    field.vx[i] = dir * speed * cosf(angle);
+    field.vy[i] = speed * sinf(angle);
+}
+
+void ballFieldInit(BallField& field, int width, int height, int count, uint32_t seed, bool closed) {
+    field.width = width;
+    field.height = height;
+    field.closed = closed;
+    field.balls = 0;
+    field.head.assign(static_cast<size_t>(width) * height, -1);
+    field.paddleTop[0] = field.paddleTop[1] = height / 2 - PADDLE_HEIGHT / 2;
+    field.score[0] = field.score[1] = 0;
+    field.rng = seed | 1u;
+    field.tick = 0;
+    field.collisions = 0;
+    field.pairTests = 0;
+    ballFieldResize(field, count);
+}
+
+void ballFieldResize(BallField& field, int count) {
+    count = max(0, min(count, BALL_MAX_COUNT));
+    if (static_cast<size_t>(count) > field.x.size()) {
+        size_t n = static_cast<size_t>(count);
+        for (auto* column : {&field.x, &field.y, &field.vx, &field.vy}) column->resize(n);
+        for (auto* column : {&field.cell, &field.next, &field.prev}) column->resize(n);
+    }
+    while (field.balls > count) unlink(field, --field.balls);
+    while (field.balls < count) {
+        int i = field.balls++;
+        spawn(field, i);
+        link(field, i, cellOf(field, field.x[i], field.y[i]));
+    }
+}
+
+// Paletas, movimiento, paredes y goles; deja las celdas sin actualizar
+static void integrate(BallField& field, const int* paddleMoves) {
+    for (int p = 0; p < 2; p++) {
+        field.paddleTop[p] = stepClamp(field.paddleTop[p] + paddleMoves[p], 0, field.height - PADDLE_HEIGHT);
+    }
+    const float w = static_cast<float>(field.width);
+    const float h = static_cast<float>(field.height);
+    for (int i = 0; i < field.balls; i++) {
+        float px = field.x[i];
+        float nx = px + field.vx[i];
+        float ny = field.y[i] + field.vy[i];
+        if (ny < 0.0f) {
+            ny = -ny;
+            field.vy[i] = -field.vy[i];
+        } else if (ny >= h) {
+            ny = 2.0f * h - ny - 0.001f;
+            field.vy[i] = -field.vy[i];
+        }
+        if (field.closed) {
+            if (nx < 0.0f || nx >= w) {
+                nx = nx < 0.0f ? -nx : 2.0f * w - nx - 0.001f;
+                field.vx[i] = -field.vx[i];
+            }
+        } else {
+            // Paletas: la pelota cruza su cara interna con la fila dentro de la paleta
+            int row = static_cast<int>(ny);
+            if (px >= BALL_LEFT_PADDLE_X && nx < BALL_LEFT_PADDLE_X && row >= field.paddleTop[0] &&
+                row < field.paddleTop[0] + PADDLE_HEIGHT) {
+                nx = 2.0f * BALL_LEFT_PADDLE_X - nx;
+                field.vx[i] = -field.vx[i];
+            } else if (px < BALL_RIGHT_PADDLE_X && nx >= BALL_RIGHT_PADDLE_X && row >= field.paddleTop[1] &&
+                       row < field.paddleTop[1] + PADDLE_HEIGHT) {
+                nx = 2.0f * BALL_RIGHT_PADDLE_X - nx - 0.001f;
+                field.vx[i] = -field.vx[i];
+            } else if (nx < 0.0f || nx >= w) {
+                field.score[nx < 0.0f ? 1 : 0]++;
+                spawn(field, i);
+                continue;
+            }
+        }
+        field.x[i] = nx;
+        field.y[i] = ny;
+    }
+}
+
+// Actualización incremental: solo cambian de lista las pelotas que cambiaron de celda
+static void updateGrid(BallField& field) {
+    for (int i = 0; i < field.balls; i++) {
+        int c = cellOf(field, field.x[i], field.y[i]);
+        if (c == field.cell[i]) continue;
+        unlink(field, i);
+        link(field, i, c);
+    }
+}
+
+// Choque elástico entre masas iguales: intercambian la componente normal de la velocidad
+static inline bool collide(BallField& field, int i, int j) {
+    float dx = field.x[j] - field.x[i];
+    float dy = field.y[j] - field.y[i];
+    float d2 = dx * dx + dy * dy;
+    if (d2 >= BALL_DIAMETER * BALL_DIAMETER || d2 == 0.0f) return false;
+    float rvx = field.vx[j] - field.vx[i];
+    float rvy = field.vy[j] - field.vy[i];
+    float approach = rvx * dx + rvy * dy;
+    if (approach >= 0.0f) return false;     // ya se están separando
+    float k = approach / d2;
+    field.vx[i] += k * dx;
+    field.vy[i] += k * dy;
+    field.vx[j] -= k * dx;
+    field.vy[j] -= k * dy;
+    return true;
+}
+
+static inline void keepMoving(BallField& field, int i) {
+    if (fabsf(field.vx[i]) < BALL_MIN_SPEED_X) field.vx[i] = field.vx[i] < 0.0f ? -BALL_MIN_SPEED_X : BALL_MIN_SPEED_X;
+}
+
+// Fase amplia: cada pelota con las siguientes de su celda y con las de cuatro vecinas
+// (derecha y las tres de abajo); así cada par de celdas vecinas se revisa una vez
+template <typename PairFn>
+static void forEachCandidate(const BallField& field, PairFn&& pair) {
+    static const int NEIGHBORS[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+    for (int i = 0; i < field.balls; i++) {
+        for (int j = field.next[i]; j >= 0; j = field.next[j]) pair(i, j);
+        int c = field.cell[i];
+        int cx = c % field.width;
+        int cy = c / field.width;
+        for (const auto& offset : NEIGHBORS) {
+            int nx = cx + offset[0];
+            int ny = cy + offset[1];
+            if (nx < 0 || nx >= field.width || ny >= field.height) continue;
+            for (int j = field.head[ny * field.width + nx]; j >= 0; j = field.next[j]) pair(i, j);
+        }
+    }
+}
+
+void ballFieldStep(BallField& field, const int* paddleMoves) {
+    integrate(field, paddleMoves);
+    updateGrid(field);
+    uint64_t tests = 0;
+    uint64_t hits = 0;
+    forEachCandidate(field, [&](int i, int j) {
+        tests++;
+        if (collide(field, i, j)) {
+            hits++;
+            keepMoving(field, i);
+            keepMoving(field, j);
+        }
+    });
+    field.pairTests += tests;
+    field.collisions += hits;
+    field.tick++;
+}
+
+void ballFieldStepNaive(BallField& field, const int* paddleMoves) {
+    integrate(field, paddleMoves);
+    updateGrid(field);      // la grilla se mantiene igual para poder comparar
+    uint64_t hits = 0;
+    for (int i = 0; i < field.balls; i++) {
+        for (int j = i + 1; j < field.balls; j++) {
+            if (collide(field, i, j)) {
+                hits++;
+                keepMoving(field, i);
+                keepMoving(field, j);
+            }
+        }
+    }
+    field.pairTests += static_cast<uint64_t>(field.balls) * (field.balls - 1) / 2;
+    field.collisions += hits;
+    field.tick++;
+}
+
+static inline bool touching(const BallField& field, int i, int j) {
+    float dx = field.x[j] - field.x[i];
+    float dy = field.y[j] - field.y[i];
+    return dx * dx + dy * dy < BALL_DIAMETER * BALL_DIAMETER;
+}
+
+uint64_t ballFieldContactsGrid(const BallField& field) {
+    uint64_t contacts = 0;
+    forEachCandidate(field, [&](int i, int j) {
+        if (touching(field, i, j)) contacts++;
+    });
+    return contacts;
+}
+
+uint64_t ballFieldContactsNaive(const BallField& field) {
+    uint64_t contacts = 0;
+    for (int i = 0; i < field.balls; i++) {
+        for (int j = i + 1; j < field.balls; j++) {
+            if (touching(field, i, j)) contacts++;
+        }
+    }
+    return contacts;
+}
+
+int ballFieldDecide(const BallField& field, int side) {
+    float paddleX = side == 0 ? BALL_LEFT_PADDLE_X : BALL_RIGHT_PADDLE_X;
+    float best = 1e9f;
+    float targetY = field.height / 2.0f;
+    for (int i = 0; i < field.balls; i++) {
+        bool coming = side == 0 ? field.vx[i] < 0.0f : field.vx[i] > 0.0f;
+        if (!coming) continue;
+        float distance = fabsf(field.x[i] - paddleX);
+        if (distance < best) {
+            best = distance;
+            targetY = field.y[i];
+        }
+    }
+    int center = field.paddleTop[side] + PADDLE_HEIGHT / 2;
+    int target = static_cast<int>(targetY);
+    return (target < center) ? -1 : (target > center) ? 1 : 0;
+}
+
+// ===================== PARTIDA EN EL TERMINAL =====================
+
+struct MultiBallOptions {
+    int balls = 24;
+    int humans = 1;
+    uint32_t seed = 2025;
+    int maxTicks = 0;           // 0 = sin límite
+};
+
+static inline void setCell(TermFrame& frame, int row, int col, char ch, uint8_t attr = ATTR_NONE) {
+    TermCell& cell = frame.at(row, col);
+    cell.bytes[0] = ch;
+    cell.len = 1;
+    cell.attr = attr;
+}
+
+// Marcador, cancha y una línea de estado. Las pelotas se cuentan por celda recorriendo
+// las listas de la grilla: 'o' una sola, el número si hay varias, '@' con diez o más.
+static void composeBallFrame(const BallField& field, TermFrame& frame, const char* status) {
+    frame.clear();
+    char line[96];
+    for (int col = 0; col < WIDTH; col++) {
+        setCell(frame, 0, col, '=');
+        setCell(frame, 2, col, '=');
+        setCell(frame, 3, col, '#');
+        setCell(frame, 4 + HEIGHT, col, '#');
+    }
+    int len = snprintf(line, sizeof(line), "  P1: %-5d   CAOS: %d pelotas   P2: %-5d", field.score[0], field.balls,
+                       field.score[1]);
+    frame.put(1, 0, string_view(line, static_cast<size_t>(len)));
+
+    const int top = 4;
+    for (int y = 0; y < HEIGHT; y++) setCell(frame, top + y, WIDTH / 2, ':');
+    for (int k = 0; k < PADDLE_HEIGHT; k++) {
+        setCell(frame, top + field.paddleTop[0] + k, 2, '|');
+        setCell(frame, top + field.paddleTop[1] + k, WIDTH - 3, '|');
+    }
+    for (int c = 0; c < WIDTH * HEIGHT; c++) {
+        int count = 0;
+        for (int i = field.head[c]; i >= 0; i = field.next[i]) count++;
+        if (count == 0) continue;
+        char ch = count == 1 ? 'o' : count < 10 ? static_cast<char>('0' + count) : '@';
+        setCell(frame, top + c / WIDTH, c % WIDTH, ch, ATTR_BOLD);
+    }
+    frame.put(top + HEIGHT + 1, 0, status);
+}
+
+static bool parseMultiBallOptions(int argc, char* argv[], MultiBallOptions& opts) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--balls" && hasValue) opts.balls = atoi(argv[++i]);
+        else if (arg == "--humans" && hasValue) opts.humans = atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue) opts.seed = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (arg == "--max-ticks" && hasValue) opts.maxTicks = atoi(argv[++i]);
+        else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return false;
+        }
+    }
+    // Más de una pelota por celda en promedio ya no se distingue en pantalla
+    opts.balls = max(1, min(opts.balls, WIDTH * HEIGHT));
+    opts.humans = max(0, min(opts.humans, 2));
+    return true;
+}
+
+// Hilo de teclado: movimientos a la cola de cada jugador, + / - al contador pedido
+static void multiBallInputThread(InputLane* lanes, atomic<int>& requested, atomic<bool>& running) {
+    KeyDecoder decoder;
+    unsigned char buffer[64];
+    while (running.load(memory_order_acquire)) {
+        if (!kbhit()) {
+            usleep(5 * 1000);
+            continue;
+        }
+        ssize_t n = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (n <= 0) continue;
+        uint64_t readNs = monotonicNowNs();
+        for (ssize_t i = 0; i < n; i++) {
+            KeyEvent key;
+            if (!decoder.feed(buffer[i], key) || key.action == KEY_RELEASE) continue;
+            int player = -1;
+            EventType type = EventType::P1_UP;
+            if (key.code == 'q') {
+                running.store(false, memory_order_release);
+                return;
+            } else if (key.code == '+' || key.code == '=') {
+                requested.store(min(requested.load() + BALL_STEP, WIDTH * HEIGHT));
+            } else if (key.code == '-') {
+                requested.store(max(requested.load() - BALL_STEP, 1));
+            } else if (key.code == 'w' || key.code == 's') {
+                player = 0;
+                type = key.code == 'w' ? EventType::P1_UP : EventType::P1_DOWN;
+            } else if (key.code == KEY_ARROW_UP || key.code == KEY_ARROW_DOWN) {
+                player = 1;
+                type = key.code == KEY_ARROW_UP ? EventType::P2_UP : EventType::P2_DOWN;
+            }
+            if (player < 0) continue;
+            InputLane& lane = lanes[player];
+            pthread_mutex_lock(&lane.mutex);
+            lane.queue.push(InputEvent{type, readNs});
+            pthread_mutex_unlock(&lane.mutex);
+        }
+    }
+}
+
+static int drainPaddleMoves(InputLane& lane) {
+    int move = 0;
+    pthread_mutex_lock(&lane.mutex);
+    while (!lane.queue.empty()) {
+        EventType type = lane.queue.front().type;
+        move += (type == EventType::P1_UP || type == EventType::P2_UP) ? -1 : 1;
+        lane.queue.pop();
+    }
+    pthread_mutex_unlock(&lane.mutex);
+    return move;
+}
+
+int runMultiBall(int argc, char* argv[]) {
+    MultiBallOptions opts;
+    if (!parseMultiBallOptions(argc, argv, opts)) return 1;
+
+    BallField field;
+    ballFieldInit(field, WIDTH, HEIGHT, opts.balls, opts.seed, false);
+    InputLane lanes[2];
+    atomic<int> requested(opts.balls);
+    atomic<bool> running(true);
+    TermFrame frame(BALL_ROWS, WIDTH);
+    TermEncoder encoder(BALL_ROWS, WIDTH);
+    encoder.setCaps(detectTermCaps());
+
+    enterRawInput();
+    thread input(multiBallInputThread, lanes, ref(requested), ref(running));
+
+    const uint64_t tickNs = 1000000000ULL / BALL_TICKS_PER_SECOND;
+    uint64_t next = monotonicNowNs();
+    uint64_t stepNs = 0;
+    uint64_t lastCollisions = 0;
+    char status[96];
+    int moves[2] = {0, 0};
+    while (running.load(memory_order_acquire)) {
+        ballFieldResize(field, requested.load(memory_order_relaxed));
+        for (int p = 0; p < 2; p++) {
+            moves[p] = p < opts.humans ? drainPaddleMoves(lanes[p]) : ballFieldDecide(field, p);
+        }
+        uint64_t start = monotonicNowNs();
+        ballFieldStep(field, moves);
+        stepNs = (stepNs * 15 + (monotonicNowNs() - start)) / 16;
+        if (opts.maxTicks > 0 && field.tick >= static_cast<uint64_t>(opts.maxTicks)) break;
+
+        snprintf(status, sizeof(status), "Q: salir | +/-: pelotas | P1 w/s P2 ↑/↓ | tick %.1f us | %llu choques",
+                 stepNs / 1000.0, static_cast<unsigned long long>(field.collisions - lastCollisions));
+        if (field.tick % BALL_TICKS_PER_SECOND == 0) lastCollisions = field.collisions;
+        composeBallFrame(field, frame, status);
+        const string& bytes = encoder.encode(frame);
+        cout.write(bytes.data(), bytes.size());
+        cout.flush();
+
+        next += tickNs;
+        uint64_t now = monotonicNowNs();
+        if (next > now) usleep(static_cast<useconds_t>((next - now) / 1000));
+        else next = now;
+    }
+    running.store(false, memory_order_release);
+    input.join();
+
+    cout << "\x1b[m\x1b[?25h\x1b[H\x1b[2J";
+    cout.flush();
+    leaveRawInput();
+    cout << "========================================\n";
+    cout << "          MODO CAOS TERMINADO           \n";
+    cout << "========================================\n\n";
+    cout << "P1: " << field.score[0] << "  P2: " << field.score[1] << "\n";
+    cout << "Pelotas: " << field.balls << "  ticks: " << field.tick << "  choques entre pelotas: "
+         << field.collisions << "\n";
+    cout << "Pares revisados por tick: "
+         << (field.tick > 0 ? field.pairTests / field.tick : 0) << "  (todos los pares serían "
+         << static_cast<uint64_t>(field.balls) * (field.balls - 1) / 2 << ")\n";
+    return 0;
+}
+
+// ===================== BENCHMARK =====================
+
+struct BallBenchRow {
+    int balls;
+    int width, height;
+    double gridNs;
+    double naiveNs;             // < 0: no medido
+    double pairsPerTick;
+    double collisionsPerTick;
+    uint64_t contactsGrid, contactsNaive;
+};
+
+int runMultiBallBench(int argc, char* argv[]) {
+    vector<int> counts = {1, 10, 100, 1000, 10000};
+    double density = 0.05;      // pelotas por celda
+    int naiveMax = 3000;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--counts" && hasValue) {
+            counts.clear();
+            stringstream list(argv[++i]);
+            string item;
+            while (getline(list, item, ',')) {
+                int n = atoi(item.c_str());
+                if (n > 0 && n <= BALL_MAX_COUNT) counts.push_back(n);
+            }
+        } else if (arg == "--density" && hasValue) {
+            density = min(1.0, max(0.001, atof(argv[++i])));
+        } else if (arg == "--naive-max" && hasValue) {
+            naiveMax = atoi(argv[++i]);
+        } else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    const int noMoves[2] = {0, 0};
+    vector<BallBenchRow> rows;
+    for (int n : counts) {
+        // Densidad constante: la cancha crece con la cantidad (nunca menor que la del juego)
+        double cells = max(static_cast<double>(WIDTH * HEIGHT), n / density);
+        int height = max(HEIGHT, static_cast<int>(sqrt(cells * HEIGHT / WIDTH)));
+        int width = max(WIDTH, static_cast<int>(cells / height));
+        int ticks = max(50, min(20000, 2000000 / n));
+
+        BallBenchRow row = {n, width, height, 0, -1, 0, 0, 0, 0};
+        BallField field;
+        ballFieldInit(field, width, height, n, 2025, true);
+        for (int t = 0; t < 100; t++) ballFieldStep(field, noMoves);   // que se desparramen
+        row.contactsGrid = ballFieldContactsGrid(field);
+        if (n <= naiveMax) row.contactsNaive = ballFieldContactsNaive(field);
+
+        uint64_t tests = field.pairTests;
+        uint64_t hits = field.collisions;
+        uint64_t start = monotonicNowNs();
+        for (int t = 0; t < ticks; t++) ballFieldStep(field, noMoves);
+        row.gridNs = static_cast<double>(monotonicNowNs() - start) / ticks;
+        row.pairsPerTick = static_cast<double>(field.pairTests - tests) / ticks;
+        row.collisionsPerTick = static_cast<double>(field.collisions - hits) / ticks;
+
+        if (n <= naiveMax) {
+            BallField naive;
+            ballFieldInit(naive, width, height, n, 2025, true);
+            for (int t = 0; t < 100; t++) ballFieldStep(naive, noMoves);
+            int naiveTicks = max(10, min(ticks, static_cast<int>(4e8 / (static_cast<double>(n) * n))));
+            start = monotonicNowNs();
+            for (int t = 0; t < naiveTicks; t++) ballFieldStepNaive(naive, noMoves);
+            row.naiveNs = static_cast<double>(monotonicNowNs() - start) / naiveTicks;
+        }
+        rows.push_back(row);
+    }
+
+    cout << fixed;
+    cout << "=== MODO CAOS: TIEMPO POR TICK (densidad " << setprecision(3) << density << " pelotas/celda) ===\n";
+    cout << left << setw(9) << "Pelotas" << setw(11) << "Cancha" << setw(14) << "Grilla us" << setw(12) << "ns/pelota"
+         << setw(13) << "Pares/tick" << setw(13) << "Choques/tick" << setw(16) << "Todos pares us" << "Contactos grilla/todos\n";
+    bool contactsMatch = true;
+    for (const BallBenchRow& r : rows) {
+        string court = to_string(r.width) + "x" + to_string(r.height);
+        cout << left << setw(9) << r.balls << setw(11) << court << setprecision(2) << setw(14) << r.gridNs / 1000.0
+             << setprecision(1) << setw(12) << r.gridNs / r.balls << setw(13) << r.pairsPerTick << setprecision(2)
+             << setw(13) << r.collisionsPerTick;
+        if (r.naiveNs >= 0) {
+            cout << setw(16) << r.naiveNs / 1000.0 << r.contactsGrid << "/" << r.contactsNaive;
+            if (r.contactsGrid != r.contactsNaive) contactsMatch = false;
+        } else {
+            cout << setw(16) << "-" << r.contactsGrid << "/-";
+        }
+        cout << "\n";
+    }
+    if (!contactsMatch) {
+        cout << "FALLA: la grilla no encontró los mismos contactos que la prueba de todos los pares\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,474 @@
+/****************************************************
+ * Archivo: multi_match.cpp
+ * Descripción: Variante de N jugadores (2 a 8) con paletas en los cuatro bordes.
+ *              Simulación en columnas por jugador, IA de seguimiento, ruteo de teclas
+ *              por tabla a una cola por jugador, render al codificador diferencial y
+ *              benchmark del costo por tick según la cantidad de jugadores.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "multi_match.h"
+#include "key_input.h"
+#include "latency.h"
+#include "match_state.h"
+#include "term_encoder.h"
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+using namespace std;
+
+static const int MULTI_TICKS_PER_SECOND = 60;
+static const int MULTI_ROWS = 3 + HEIGHT + 1;      // marcador, cancha y línea de ayuda
+
+// Teclas por jugador: {hacia la coordenada menor, hacia la mayor} (arriba/abajo en
+// los bordes laterales, izquierda/derecha arriba y abajo)
+static const int KEY_BINDINGS[MULTI_MAX_PLAYERS][2] = {
+    {'w', 's'}, {KEY_ARROW_UP, KEY_ARROW_DOWN}, {'f', 'g'}, {'j', 'k'},
+    {'z', 'x'}, {'n', 'm'}, {'1', '2'}, {'9', '0'},
+};
+static const char* KEY_LABELS[MULTI_MAX_PLAYERS] = {
+    "w/s", "↑/↓", "f/g", "j/k", "z/x", "n/m", "1/2", "9/0",
+};
+
+const char* multiEdgeName(int edge) {
+    static const char* names[EDGE_COUNT] = {"izq", "der", "arr", "aba"};
+    return (edge >= 0 && edge < EDGE_COUNT) ? names[edge] : "?";
+}
+
+// ===================== SIMULACIÓN =====================
+
+static inline bool verticalEdge(int edge) {
+    return edge == EDGE_LEFT || edge == EDGE_RIGHT;
+}
+
+static void serve(MultiCourt& court) {
+    court.ballX = WIDTH / 2;
+    court.ballY = HEIGHT / 2;
+    court.rng = stepXorshift(court.rng);
+    court.ballSpeedX = 1 - 2 * static_cast<int>(court.rng & 1u);
+    court.rng = stepXorshift(court.rng);
+    court.ballSpeedY = 1 - 2 * static_cast<int>(court.rng & 1u);
+    court.lastHitter = -1;
+}
+
+void multiInit(MultiCourt& court, int players, uint32_t seed) {
+    int n = max(2, min(players, MULTI_MAX_PLAYERS));
+    court.players = n;
+    court.edge.assign(n, 0);
+    court.segmentLo.assign(n, 0);
+    court.segmentHi.assign(n, 0);
+    court.paddlePos.assign(n, 0);
+    court.paddleLen.assign(n, 0);
+    court.conceded.assign(n, 0);
+    court.scored.assign(n, 0);
+    court.hits.assign(n, 0);
+    for (int e = 0; e < EDGE_COUNT; e++) {
+        court.owner[e].assign(verticalEdge(e) ? HEIGHT : WIDTH, -1);
+    }
+
+    // Jugador i en el borde i % 4; cada borde se parte en tramos iguales
+    int perEdge[EDGE_COUNT] = {0, 0, 0, 0};
+    for (int i = 0; i < n; i++) perEdge[i % EDGE_COUNT]++;
+    for (int i = 0; i < n; i++) {
+        int e = i % EDGE_COUNT;
+        int k = i / EDGE_COUNT;
+        int base = verticalEdge(e) ? MULTI_TOP_LINE + 1 : MULTI_LEFT_LINE + 1;
+        int span = verticalEdge(e) ? MULTI_BOTTOM_LINE - base : MULTI_RIGHT_LINE - base;
+        int lo = base + span * k / perEdge[e];
+        int hi = base + span * (k + 1) / perEdge[e];
+        int len = min(verticalEdge(e) ? PADDLE_HEIGHT : MULTI_HORIZONTAL_PADDLE, hi - lo);
+        court.edge[i] = static_cast<uint8_t>(e);
+        court.segmentLo[i] = lo;
+        court.segmentHi[i] = hi;
+        court.paddleLen[i] = len;
+        court.paddlePos[i] = lo + (hi - lo - len) / 2;
+        for (int c = lo; c < hi; c++) court.owner[e][c] = static_cast<int8_t>(i);
+    }
+
+    court.rng = seed | 1u;
+    court.tick = 0;
+    serve(court);
+}
+
+static int concede(MultiCourt& court, int player) {
+    court.conceded[player]++;
+    if (court.lastHitter >= 0 && court.lastHitter != player) court.scored[court.lastHitter]++;
+    serve(court);
+    court.tick++;
+    return player;
+}
+
+// Rebote contra el borde: pared si la celda no tiene dueño, paleta si la cubre;
+// devuelve el dueño que recibe gol o -1 si la pelota rebotó
+static int edgeContact(MultiCourt& court, int edge, int along) {
+    int who = court.owner[edge][along];
+    if (who < 0) return -1;
+    int pos = court.paddlePos[who];
+    if (along < pos || along >= pos + court.paddleLen[who]) return who;
+    court.lastHitter = who;
+    court.hits[who]++;
+    return -1;
+}
+
+int multiStep(MultiCourt& court, const int* moves) {
+    for (int i = 0; i < court.players; i++) {
+        if (moves[i] == 0) continue;
+        int delta = verticalEdge(court.edge[i]) ? moves[i] : moves[i] * MULTI_HORIZONTAL_STEP;
+        court.paddlePos[i] = stepClamp(court.paddlePos[i] + delta, court.segmentLo[i],
+                                       court.segmentHi[i] - court.paddleLen[i]);
+    }
+
+    // Un eje por vez: primero los bordes laterales con la fila actual, después arriba
+    // y abajo con la columna ya resuelta (las esquinas rebotan en ambos)
+    int nx = court.ballX + court.ballSpeedX;
+    if (nx <= MULTI_LEFT_LINE || nx >= MULTI_RIGHT_LINE) {
+        int who = edgeContact(court, nx <= MULTI_LEFT_LINE ? EDGE_LEFT : EDGE_RIGHT, court.ballY);
+        if (who >= 0) return concede(court, who);
+        court.ballSpeedX = -court.ballSpeedX;
+        nx = court.ballX + court.ballSpeedX;
+    }
+    int ny = court.ballY + court.ballSpeedY;
+    if (ny <= MULTI_TOP_LINE || ny >= MULTI_BOTTOM_LINE) {
+        int who = edgeContact(court, ny <= MULTI_TOP_LINE ? EDGE_TOP : EDGE_BOTTOM, nx);
+        if (who >= 0) return concede(court, who);
+        court.ballSpeedY = -court.ballSpeedY;
+        ny = court.ballY + court.ballSpeedY;
+    }
+    court.ballX = nx;
+    court.ballY = ny;
+    court.tick++;
+    return -1;
+}
+
+int multiDecide(const MultiCourt& court, int player) {
+    // Reacción imperfecta: descansa uno de cada cuatro ticks (escalonado por jugador)
+    if ((court.tick + static_cast<uint32_t>(player)) % 4 == 0) return 0;
+    int e = court.edge[player];
+    bool coming = (e == EDGE_LEFT && court.ballSpeedX < 0) || (e == EDGE_RIGHT && court.ballSpeedX > 0) ||
+                  (e == EDGE_TOP && court.ballSpeedY < 0) || (e == EDGE_BOTTOM && court.ballSpeedY > 0);
+    int target = coming ? (verticalEdge(e) ? court.ballY : court.ballX)
+                        : (court.segmentLo[player] + court.segmentHi[player]) / 2;
+    int center = court.paddlePos[player] + court.paddleLen[player] / 2;
+    int slack = verticalEdge(e) ? 0 : MULTI_HORIZONTAL_STEP - 1;   // sin oscilar de a dos
+    return (target < center - slack) ? -1 : (target > center + slack) ? 1 : 0;
+}
+
+// ===================== RENDER =====================
+
+static inline void setCell(TermFrame& frame, int row, int col, char ch, uint8_t attr = ATTR_NONE) {
+    TermCell& cell = frame.at(row, col);
+    cell.bytes[0] = ch;
+    cell.len = 1;
+    cell.attr = attr;
+}
+
+// Marcador, cancha (bordes con el número del dueño de cada tramo), paletas y pelota.
+// El costo es el de limpiar la cancha más la longitud de cada paleta.
+static void composeMultiFrame(const MultiCourt& court, TermFrame& frame, const string& helpLine) {
+    frame.clear();
+    for (int col = 0; col < WIDTH; col++) {
+        setCell(frame, 0, col, '=');
+        setCell(frame, 2, col, '=');
+    }
+    int slot = WIDTH / court.players;
+    char entry[32];
+    for (int i = 0; i < court.players; i++) {
+        int len = snprintf(entry, sizeof(entry), "P%d %s %d", i + 1, multiEdgeName(court.edge[i]), court.conceded[i]);
+        frame.put(1, i * slot + 1, string_view(entry, static_cast<size_t>(len)));
+    }
+
+    const int top = 3;
+    for (int x = 0; x < WIDTH; x++) {
+        int up = court.owner[EDGE_TOP][x];
+        int down = court.owner[EDGE_BOTTOM][x];
+        setCell(frame, top, x, up >= 0 ? static_cast<char>('1' + up) : '#', up >= 0 ? ATTR_REVERSE : ATTR_NONE);
+        setCell(frame, top + HEIGHT - 1, x, down >= 0 ? static_cast<char>('1' + down) : '#',
+                down >= 0 ? ATTR_REVERSE : ATTR_NONE);
+    }
+    for (int y = 1; y < HEIGHT - 1; y++) {
+        int left = court.owner[EDGE_LEFT][y];
+        int right = court.owner[EDGE_RIGHT][y];
+        setCell(frame, top + y, 0, left >= 0 ? static_cast<char>('1' + left) : '#', left >= 0 ? ATTR_REVERSE : ATTR_NONE);
+        setCell(frame, top + y, WIDTH - 1, right >= 0 ? static_cast<char>('1' + right) : '#',
+                right >= 0 ? ATTR_REVERSE : ATTR_NONE);
+    }
+
+    for (int i = 0; i < court.players; i++) {
+        int e = court.edge[i];
+        for (int k = 0; k < court.paddleLen[i]; k++) {
+            int along = court.paddlePos[i] + k;
+            if (e == EDGE_LEFT) setCell(frame, top + along, MULTI_LEFT_LINE, '|');
+            else if (e == EDGE_RIGHT) setCell(frame, top + along, MULTI_RIGHT_LINE, '|');
+            else if (e == EDGE_TOP) setCell(frame, top + MULTI_TOP_LINE, along, '=');
+            else setCell(frame, top + MULTI_BOTTOM_LINE, along, '=');
+        }
+    }
+    setCell(frame, top + court.ballY, court.ballX, 'O', ATTR_BOLD);
+    frame.put(top + HEIGHT, 0, helpLine);
+}
+
+// ===================== PARTIDA EN EL TERMINAL =====================
+
+struct MultiOptions {
+    int players = 4;
+    int humans = 1;
+    int targetScore = 5;
+    uint32_t seed = 2025;
+    int maxTicks = 0;           // 0 = sin límite
+};
+
+static bool parseMultiOptions(int argc, char* argv[], MultiOptions& opts) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--players" && hasValue) opts.players = atoi(argv[++i]);
+        else if (arg == "--humans" && hasValue) opts.humans = atoi(argv[++i]);
+        else if (arg == "--target" && hasValue) opts.targetScore = atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue) opts.seed = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (arg == "--max-ticks" && hasValue) opts.maxTicks = atoi(argv[++i]);
+        else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return false;
+        }
+    }
+    if (opts.players < 2 || opts.players > MULTI_MAX_PLAYERS) {
+        cerr << "Jugadores: de 2 a " << MULTI_MAX_PLAYERS << "\n";
+        return false;
+    }
+    opts.humans = max(0, min(opts.humans, opts.players));
+    opts.targetScore = max(1, opts.targetScore);
+    return true;
+}
+
+// Tabla código de tecla -> (jugador, dirección): rutear una tecla es O(1)
+struct KeyRoute {
+    int8_t player[KEY_ARROW_DOWN + 1];
+    int8_t dir[KEY_ARROW_DOWN + 1];
+
+    explicit KeyRoute(int humans) {
+        fill(player, player + KEY_ARROW_DOWN + 1, static_cast<int8_t>(-1));
+        fill(dir, dir + KEY_ARROW_DOWN + 1, static_cast<int8_t>(0));
+        for (int i = 0; i < humans; i++) {
+            for (int k = 0; k < 2; k++) {
+                player[KEY_BINDINGS[i][k]] = static_cast<int8_t>(i);
+                dir[KEY_BINDINGS[i][k]] = static_cast<int8_t>(k == 0 ? -1 : 1);
+            }
+        }
+    }
+};
+
+// Hilo de teclado: decodifica y deja cada tecla en la cola de su jugador
+static void multiInputThread(const KeyRoute& route, InputLane* lanes, atomic<bool>& running) {
+    KeyDecoder decoder;
+    unsigned char buffer[64];
+    while (running.load(memory_order_acquire)) {
+        if (!kbhit()) {
+            usleep(5 * 1000);
+            continue;
+        }
+        ssize_t n = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (n <= 0) continue;
+        uint64_t readNs = monotonicNowNs();
+        for (ssize_t i = 0; i < n; i++) {
+            KeyEvent key;
+            if (!decoder.feed(buffer[i], key) || key.action == KEY_RELEASE) continue;
+            if (key.code == 'q') {
+                running.store(false, memory_order_release);
+                return;
+            }
+            if (key.code < 0 || key.code > KEY_ARROW_DOWN || route.player[key.code] < 0) continue;
+            // La dirección va en el tipo: UP = hacia la coordenada menor del borde
+            InputLane& lane = lanes[route.player[key.code]];
+            InputEvent ev = {route.dir[key.code] < 0 ? EventType::P1_UP : EventType::P1_DOWN, readNs};
+            pthread_mutex_lock(&lane.mutex);
+            lane.queue.push(ev);
+            pthread_mutex_unlock(&lane.mutex);
+            lane.eventsApplied.fetch_add(1, memory_order_relaxed);
+        }
+    }
+}
+
+// Movimiento acumulado de las teclas encoladas desde el tick anterior
+static int drainMoves(InputLane& lane) {
+    int move = 0;
+    pthread_mutex_lock(&lane.mutex);
+    while (!lane.queue.empty()) {
+        move += (lane.queue.front().type == EventType::P1_UP) ? -1 : 1;
+        lane.queue.pop();
+    }
+    pthread_mutex_unlock(&lane.mutex);
+    return move;
+}
+
+static void printMultiResults(const MultiCourt& court, const vector<uint8_t>& human) {
+    cout << "========================================\n";
+    cout << "     PARTIDA DE " << court.players << " JUGADORES TERMINADA\n";
+    cout << "========================================\n\n";
+    cout << left << setw(8) << "Jugador" << setw(8) << "Borde" << setw(10) << "Control"
+         << setw(10) << "Recibidos" << setw(8) << "Hechos" << "Golpes\n";
+    int best = 0;
+    for (int i = 0; i < court.players; i++) {
+        cout << left << setw(8) << ("P" + to_string(i + 1)) << setw(8) << multiEdgeName(court.edge[i])
+             << setw(10) << (human[i] ? "teclado" : "IA") << setw(10) << court.conceded[i]
+             << setw(8) << court.scored[i] << court.hits[i] << "\n";
+        bool fewer = court.conceded[i] < court.conceded[best];
+        bool tieMore = court.conceded[i] == court.conceded[best] && court.scored[i] > court.scored[best];
+        if (fewer || tieMore) best = i;
+    }
+    cout << "\nGana P" << (best + 1) << " (menos goles recibidos) en " << court.tick << " ticks\n";
+}
+
+int runMultiMatch(int argc, char* argv[]) {
+    MultiOptions opts;
+    if (!parseMultiOptions(argc, argv, opts)) return 1;
+
+    MultiCourt court;
+    multiInit(court, opts.players, opts.seed);
+    // Controladores y colas por jugador: teclado para los primeros, IA para el resto
+    vector<uint8_t> human(court.players, 0);
+    for (int i = 0; i < opts.humans; i++) human[i] = 1;
+    unique_ptr<InputLane[]> lanes(new InputLane[court.players]);
+    vector<int> moves(court.players, 0);
+
+    string helpLine = "Q: salir";
+    for (int i = 0; i < opts.humans; i++) {
+        helpLine += " | P" + to_string(i + 1) + " " + KEY_LABELS[i];
+    }
+
+    TermFrame frame(MULTI_ROWS, WIDTH);
+    TermEncoder encoder(MULTI_ROWS, WIDTH);
+    encoder.setCaps(detectTermCaps());
+    KeyRoute route(opts.humans);
+    atomic<bool> running(true);
+
+    enterRawInput();
+    thread input;
+    if (opts.humans > 0) input = thread(multiInputThread, cref(route), lanes.get(), ref(running));
+
+    const uint64_t tickNs = 1000000000ULL / MULTI_TICKS_PER_SECOND;
+    uint64_t next = monotonicNowNs();
+    bool finished = false;
+    while (running.load(memory_order_acquire) && !finished) {
+        for (int i = 0; i < court.players; i++) {
+            moves[i] = human[i] ? drainMoves(lanes[i]) : multiDecide(court, i);
+        }
+        int who = multiStep(court, moves.data());
+        if (who >= 0 && court.conceded[who] >= opts.targetScore) finished = true;
+        if (opts.maxTicks > 0 && static_cast<int>(court.tick) >= opts.maxTicks) finished = true;
+
+        composeMultiFrame(court, frame, helpLine);
+        const string& bytes = encoder.encode(frame);
+        cout.write(bytes.data(), bytes.size());
+        cout.flush();
+
+        next += tickNs;
+        uint64_t now = monotonicNowNs();
+        if (next > now) usleep(static_cast<useconds_t>((next - now) / 1000));
+        else next = now;
+    }
+    running.store(false, memory_order_release);
+    if (input.joinable()) input.join();
+
+    cout << "\x1b[m\x1b[?25h\x1b[H\x1b[2J";
+    cout.flush();
+    leaveRawInput();
+    printMultiResults(court, human);
+    return 0;
+}
+
+// ===================== BENCHMARK =====================
+
+struct MultiBenchRow {
+    int players;
+    double simNs;           // IA + paso por tick
+    double composeNs;       // armado del frame
+    double encodeNs;        // codificación diferencial
+    double bytesPerFrame;
+    int goals;
+};
+
+// Corre T ticks; stage 0 = solo simulación, 1 = + armado, 2 = + codificación
+static double timeTicks(int players, int ticks, int stage, uint64_t& bytes, int& goals) {
+    MultiCourt court;
+    multiInit(court, players, 2025);
+    vector<int> moves(court.players, 0);
+    TermFrame frame(MULTI_ROWS, WIDTH);
+    TermEncoder encoder(MULTI_ROWS, WIDTH);
+    const string help = "Q: salir";
+    bytes = 0;
+    goals = 0;
+
+    uint64_t start = monotonicNowNs();
+    for (int t = 0; t < ticks; t++) {
+        for (int i = 0; i < court.players; i++) moves[i] = multiDecide(court, i);
+        if (multiStep(court, moves.data()) >= 0) goals++;
+        if (stage >= 1) composeMultiFrame(court, frame, help);
+        if (stage >= 2) bytes += encoder.encode(frame).size();
+    }
+    return static_cast<double>(monotonicNowNs() - start) / ticks;
+}
+
+int runMultiBench(int argc, char* argv[]) {
+    int ticks = 200000;
+    vector<int> counts = {2, 4, 8};
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--ticks" && hasValue) ticks = max(1, atoi(argv[++i]));
+        else if (arg == "--players" && hasValue) {
+            counts.clear();
+            stringstream list(argv[++i]);
+            string item;
+            while (getline(list, item, ',')) {
+                int n = atoi(item.c_str());
+                if (n >= 2 && n <= MULTI_MAX_PLAYERS) counts.push_back(n);
+            }
+        } else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    vector<MultiBenchRow> rows;
+    for (int n : counts) {
+        uint64_t bytes = 0;
+        int goals = 0;
+        double sim = timeTicks(n, ticks, 0, bytes, goals);
+        double compose = timeTicks(n, ticks, 1, bytes, goals);
+        double full = timeTicks(n, ticks, 2, bytes, goals);
+        rows.push_back({n, sim, max(0.0, compose - sim), max(0.0, full - compose),
+                        static_cast<double>(bytes) / ticks, goals});
+    }
+
+    cout << fixed << setprecision(1);
+    cout << "=== COSTO POR TICK SEGÚN JUGADORES (" << ticks << " ticks) ===\n";
+    cout << left << setw(11) << "Jugadores" << setw(14) << "IA+paso ns" << setw(12) << "Armado ns"
+         << setw(17) << "Codificación ns" << setw(11) << "Total ns" << setw(14) << "Bytes/frame" << "Goles\n";
+    for (const MultiBenchRow& r : rows) {
+        cout << left << setw(11) << r.players << setw(14) << r.simNs << setw(12) << r.composeNs
+             << setw(17) << r.encodeNs << setw(11) << (r.simNs + r.composeNs + r.encodeNs)
+             << setw(14) << r.bytesPerFrame << r.goals << "\n";
+    }
+    if (rows.size() >= 2) {
+        const MultiBenchRow& a = rows.front();
+        const MultiBenchRow& b = rows.back();
+        double perPlayer = (b.simNs - a.simNs) / max(1, b.players - a.players);
+        cout << "IA+paso: " << perPlayer << " ns por jugador adicional\n";
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+/****************************************************
+ * Archivo: pause_gate.cpp
+ * Descripción: Pausa de la partida. Todos los hilos de juego se estacionan en la misma
+ *              variable de condición y no despiertan hasta que se reanuda, así que una
+ *              partida en pausa no consume CPU ni provoca cambios de contexto.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "pause_gate.h"
+#include "latency.h"
+
+using namespace std;
+
+PauseGate::PauseGate() : paused(false), pausedSinceNs(0), totalPausedNs(0) {
+    pthread_mutex_init(&mutex, nullptr);
+    pthread_cond_init(&cond, nullptr);
+}
+
+PauseGate::~PauseGate() {
+    pthread_mutex_destroy(&mutex);
+    pthread_cond_destroy(&cond);
+}
+
+void PauseGate::pause() {
+    pthread_mutex_lock(&mutex);
+    if (!paused) {
+        pausedSinceNs = monotonicNowNs();
+        paused.store(true, memory_order_release);
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+void PauseGate::resume() {
+    pthread_mutex_lock(&mutex);
+    if (paused) {
+        totalPausedNs += monotonicNowNs() - pausedSinceNs;
+        paused.store(false, memory_order_release);
+    }
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&mutex);
+}
+
+bool PauseGate::park() {
+    // Camino rápido: sin pausa no se toca el mutex
+    if (!paused.load(memory_order_acquire)) return false;
+    pthread_mutex_lock(&mutex);
+    bool parked = false;
+    while (paused) {
+        parked = true;
+        pthread_cond_wait(&cond, &mutex);
+    }
+    pthread_mutex_unlock(&mutex);
+    return parked;
+}
+
+uint64_t PauseGate::pausedNs() const {
+    return totalPausedNs;
+}
+
+void PauseGate::reset() {
+    pthread_mutex_lock(&mutex);
+    paused.store(false, memory_order_release);
+    totalPausedNs = 0;
+    pthread_cond_broadcast(&cond);
+    pthread_mutex_unlock(&mutex);
+}
@@ -12,8 +12,10 @@
  ****************************************************/
 
 #include "pong_game.h"
+#include "async_log.h"
 #include <unistd.h>
 #include "utils.h"
+#include "step_kernel.h"
 #include <cstdlib>
 #include <ctime>
 #include <chrono>
@@ -21,50 +23,59 @@
 #include <string>
 #include <limits>
 #include <functional>
+#include <cstdint>
+#include <algorithm>
 
 using namespace std;
 
+// Rebobinado: el bucle principal corre a ~60 ticks por segundo y el de
+// runGameWithPlayers a 10; la repetición y B usan el ritmo del bucle que grabó
+static const int TICKS_PER_SECOND = 60;
+static const int PLAYERS_TICKS_PER_SECOND = 10;
+static const int REWIND_SECONDS = 10;
+static const int REWIND_KEYFRAME_INTERVAL = 30;
+static const int REPLAY_SECONDS = 2;
+static const char* SAVE_FILE = "pong_save.bin";
+
+// Paletas por velocidad: celdas por segundo con la tecla mantenida (similar a una
+// auto-repetición de 30 Hz) y paso máximo de integración si un tick se retrasa
+static const uint64_t PADDLE_CELLS_PER_SECOND = 30;
+static const uint64_t MAX_INTEGRATE_NS = 50ULL * 1000000ULL;
+static const uint64_t CELL_UNITS = 1000000000ULL;
+// Pasos separados por más de esto no cuentan para la suavidad (otra pulsación)
+static const uint64_t MOVE_GAP_NS = 250ULL * 1000000ULL;
+
+// IA por búsqueda: simular hasta que la pelota vaya y vuelva (~2 cruces de cancha)
+static const int ROLLOUT_HORIZON = 160;
+
 // ===================== LÓGICA DE COLISIONES Y ANOTACIONES =====================
-void PongGame::checkCollisions() {
-    // Colisión con paleta izquierda
-    pthread_mutex_lock(&mutex_paddleA);
-    int p1Y = paddle1Y;
-    pthread_mutex_unlock(&mutex_paddleA);
-    if (ballX <= 3) {
-        if (ballY >= p1Y && ballY <= p1Y + PADDLE_HEIGHT) {
-            ballSpeedX = 1;
-        }
-    }
-    // Colisión con paleta derecha
-    pthread_mutex_lock(&mutex_paddleB);
-    int p2Y = paddle2Y;
-    pthread_mutex_unlock(&mutex_paddleB);
-    if (ballX >= WIDTH - 4) {
-        if (ballY >= p2Y && ballY <= p2Y + PADDLE_HEIGHT) {
-            ballSpeedX = -1;
+// Avanza la pelota un tick con el núcleo compartido (step_kernel.h) usando las
+// paletas actuales; las paletas las mueven los hilos de entrada/IA.
+int PongGame::advanceBall() {
+    World world = snapshot().sim;
+    World before = world;
+    int scorer = step(world, Inputs{0, 0});
+    if (rallyLog.isOpen()) {
+        lock_guard<mutex> lock(rallyMutex);
+        rallyTracker.observe(before, world, scorer, rallyEvents);
+        if (rallyEvents.size() + 2 >= RallyLog::BLOCK_EVENTS) {
+            rallyLog.append(rallyEvents);
+            rallyEvents.clear();
         }
     }
-    // Rebote superior/inferior
-    if (ballY <= 1 || ballY >= HEIGHT - 2) {
-        ballSpeedY = -ballSpeedY;
-    }
+    ball.publish(world);
+    return scorer;
 }
 
-void PongGame::checkScoring() {
-    // Anotación jugador 2
-    if (ballX < 1) {
-        scoreP2++;
-        resetBall();
-        roundInProgress = false;
+void PongGame::onPointScored() {
+    replayPending = true;
+    if (control.isAIEnabled.load(memory_order_relaxed)) {
         // Notificar al serve_thread que hay un reinicio pendiente
+        pthread_mutex_lock(&mutex_start_round);
+        control.roundInProgress.store(false, memory_order_release);
+        control.resetRequested.store(true, memory_order_release);
         pthread_cond_signal(&cond_start_round);
-    }
-    // Anotación jugador 1
-    else if (ballX > WIDTH - 2) {
-        scoreP1++;
-        resetBall();
-        roundInProgress = false;
-        pthread_cond_signal(&cond_start_round);
+        pthread_mutex_unlock(&mutex_start_round);
     }
 }
 
@@ -78,41 +89,16 @@ void* PongGame::inputThreadWrapper(void* arg) {
 // ===================== HILO DE LA PELOTA =====================
 void* PongGame::ballThreadWrapper(void* arg) {
     PongGame* game = static_cast<PongGame*>(arg);
+    applyThreadRole(ThreadRole::PHYSICS);
 
-    while (game->gameRunning) {
-        pthread_mutex_lock(&game->mutex_game_state);
-
-        // Mover pelota
-        game->ballX += game->ballSpeedX;
-        game->ballY += game->ballSpeedY;
-
-        // Rebotes con bordes superior e inferior
-        if (game->ballY <= 1 || game->ballY >= HEIGHT - 2) {
-            game->ballSpeedY = -game->ballSpeedY;
-        }
-
-        // Colisiones con paletas
-        if (game->ballX <= 3) {
-            if (game->ballY >= game->paddle1Y && game->ballY <= game->paddle1Y + PADDLE_HEIGHT) {
-                game->ballSpeedX = 1;
-            } else {
-                game->scoreP2++;
-                game->resetBall();
-            }
-        }
-        if (game->ballX >= WIDTH - 4) {
-            if (game->ballY >= game->paddle2Y && game->ballY <= game->paddle2Y + PADDLE_HEIGHT) {
-                game->ballSpeedX = -1;
-            } else {
-                game->scoreP1++;
-                game->resetBall();
-            }
-        }
-
-        pthread_mutex_unlock(&game->mutex_game_state);
+    while (game->running()) {
+        // Único escritor de la pelota: publica con el seqlock, sin tomar mutex_game_state
+        game->advanceBall();
 
+        pthread_mutex_lock(&game->mutex_game_state);
         pthread_cond_signal(&game->cond_frame_ready); // Notificar frame listo
-        usleep(100 * 1000); // ~60 FPS
+        pthread_mutex_unlock(&game->mutex_game_state);
+        measuredSleepUs(100 * 1000, game->tickJitter); // ~60 FPS
     }
     return nullptr;
 }
@@ -120,17 +106,17 @@ void* PongGame::ballThreadWrapper(void* arg) {
 // ===================== HILO CPU PLAYER A =====================
 void* PongGame::cpuPlayerAThreadWrapper(void* arg) {
     PongGame* game = static_cast<PongGame*>(arg);
-
-    while (game->gameRunning) {
-        pthread_mutex_lock(&game->mutex_game_state);
-
-        if (game->ballSpeedX < 0) { // Pelota va hacia la izquierda
-            int targetY = game->ballY - PADDLE_HEIGHT / 2;
-            if (game->paddle1Y < targetY) game->paddle1Y++;
-            else if (game->paddle1Y > targetY) game->paddle1Y--;
+    applyThreadRole(ThreadRole::AI);
+
+    while (game->running()) {
+        World world = game->snapshot().sim;
+        if (game->learnedPolicy) {
+            game->shiftPaddle(1, game->learnedPolicy->decide(world, 1));
+        } else if (world.ballSpeedX < 0) { // Pelota va hacia la izquierda
+            int targetY = world.ballY - PADDLE_HEIGHT / 2;
+            if (world.paddle1Y < targetY) game->shiftPaddle(1, 1);
+            else if (world.paddle1Y > targetY) game->shiftPaddle(1, -1);
         }
-
-        pthread_mutex_unlock(&game->mutex_game_state);
         usleep(16 * 1000);
     }
     return nullptr;
@@ -139,17 +125,17 @@ void* PongGame::cpuPlayerAThreadWrapper(void* arg) {
 // ===================== HILO CPU PLAYER B =====================
 void* PongGame::cpuPlayerBThreadWrapper(void* arg) {
     PongGame* game = static_cast<PongGame*>(arg);
-
-    while (game->gameRunning) {
-        pthread_mutex_lock(&game->mutex_game_state);
-
-        if (game->ballSpeedX > 0) { // Pelota va hacia la derecha
-            int targetY = game->ballY - PADDLE_HEIGHT / 2;
-            if (game->paddle2Y < targetY) game->paddle2Y++;
-            else if (game->paddle2Y > targetY) game->paddle2Y--;
+    applyThreadRole(ThreadRole::AI);
+
+    while (game->running()) {
+        World world = game->snapshot().sim;
+        if (game->learnedPolicy) {
+            game->shiftPaddle(2, game->learnedPolicy->decide(world, 2));
+        } else if (world.ballSpeedX > 0) { // Pelota va hacia la derecha
+            int targetY = world.ballY - PADDLE_HEIGHT / 2;
+            if (world.paddle2Y < targetY) game->shiftPaddle(2, 1);
+            else if (world.paddle2Y > targetY) game->shiftPaddle(2, -1);
         }
-
-        pthread_mutex_unlock(&game->mutex_game_state);
         usleep(16 * 1000);
     }
     return nullptr;
@@ -176,109 +162,110 @@ void* PongGame::serveThreadWrapper(void* arg) {
 }
 
 PongGame::~PongGame() {
-    // Destruir mutex
-    pthread_mutex_destroy(&mtxQueueP1);
-    pthread_mutex_destroy(&mtxQueueP2);
-    pthread_mutex_destroy(&mutex_paddleA);
-    pthread_mutex_destroy(&mutex_paddleB);
+    // Destruir mutex (los de colas y paletas los destruye su bloque)
     pthread_mutex_destroy(&mutex_start_round);
     pthread_mutex_destroy(&mutex_game_state);
 
     // Destruir variables de condición
-    pthread_cond_destroy(&cvP1);
-    pthread_cond_destroy(&cvP2);
     pthread_cond_destroy(&cond_start_round);
     pthread_cond_destroy(&cond_frame_ready);
 }
 
-PongGame::PongGame() {
+PongGame::PongGame() : paddleInput(PaddleInput::HELD), kittyKeyboard(false), mouseReporting(false),
+                       botFallback{"Integrada", AIKind::PREDICT, 0.8f, 0.1f}, recordedMatches(0), rewind(REWIND_SECONDS * TICKS_PER_SECOND, REWIND_KEYFRAME_INTERVAL),
+                       replayPending(false), replayRemaining(0), loopTicksPerSecond(TICKS_PER_SECOND) {
     srand(time(0));
+    World seed = {};
+    seed.rng = static_cast<uint32_t>(time(0)) | 1u;
+    ball.publish(seed);
 
     // Inicializar nombres por defecto
     playerName1 = "Jugador 1";
     playerName2 = "Jugador 2";
 
     // Inicializar mutex
-    pthread_mutex_init(&mtxQueueP1, nullptr);
-    pthread_mutex_init(&mtxQueueP2, nullptr);
-    pthread_mutex_init(&mutex_paddleA, nullptr);
-    pthread_mutex_init(&mutex_paddleB, nullptr);
     pthread_mutex_init(&mutex_start_round, nullptr);
     pthread_mutex_init(&mutex_game_state, nullptr);
     pthread_cond_init(&cond_frame_ready, nullptr);
 
 
     // Inicializar variables de condición
-    pthread_cond_init(&cvP1, nullptr);
-    pthread_cond_init(&cvP2, nullptr);
     pthread_cond_init(&cond_start_round, nullptr);
 
     // Inicializar datos de los hilos
-    playerAData = {this, 1};
-    playerBData = {this, 2};
-    aiData = {this, 2};
+    for (int p = 0; p < 2; p++) playerData[p] = {this, p + 1};
 
     initializeGame();
 }
 
 void PongGame::initializeGame() {
-    scoreP1 = 0;
-    scoreP2 = 0;
-    paddle1Y = HEIGHT / 2 - PADDLE_HEIGHT / 2;
-    paddle2Y = HEIGHT / 2 - PADDLE_HEIGHT / 2;
-    ballX = WIDTH / 2;
-    ballY = HEIGHT / 2;
-    ballSpeedX = (rand() % 2 == 0) ? 1 : -1;
-    ballSpeedY = (rand() % 2 == 0) ? 1 : -1;
-    gameRunning = true;
-    resetRequested = false;
+    World world;
+    ball.read(world);
+    world.scoreP1 = 0;
+    world.scoreP2 = 0;
+    world.tick = 0;
+    ball.publish(world);
+    resetBall();
+    control.gameRunning.store(true, memory_order_release);
+    control.resetRequested.store(false, memory_order_relaxed);
+    control.showLatency.store(false, memory_order_relaxed);
+    heldKeys.reset();
+    mousePointer.reset();
+    mouseDecoded = 0;
+    mouseApplied = 0;
+    uint32_t liveSeed = static_cast<uint32_t>(time(0));
+    botRng[0] = aiSeed(liveSeed, 1);
+    botRng[1] = aiSeed(liveSeed, 2);
+    lastIntegrateNs = 0;
+    for (int p = 0; p < 2; p++) {
+        PaddleBlock& paddle = paddles[p];
+        pthread_mutex_lock(&paddle.mutex);
+        paddle.y.store(HEIGHT / 2 - PADDLE_HEIGHT / 2, memory_order_relaxed);
+        paddle.pending.count = 0;
+        composedInputs[p].count = 0;
+        paddle.lastMoveNs = 0;
+        paddle.moves = 0;
+        paddle.moveInterval.reset();
+        pthread_mutex_unlock(&paddle.mutex);
+        paddleDir[p] = 0;
+        paddleTravel[p] = 0;
+        lanes[p].eventsApplied.store(0, memory_order_relaxed);
+    }
+    botServer.resetStats();
+    framesRendered = 0;
+    frameAllocations.reset();
+    latencyTracker.reset();
+    tickJitter.reset();
+    frameJitter.reset();
+    pauseGate.reset();
+    renderer.invalidateScreen();
+    renderer.resetOutputStats();
+    rewind.clear();
+    control.saveRequested.store(false, memory_order_relaxed);
+    control.loadRequested.store(false, memory_order_relaxed);
+    control.rewindRequested.store(false, memory_order_relaxed);
+    control.serveRequested.store(false, memory_order_relaxed);
+    replayPending = false;
+    replayRemaining = 0;
+    statusUntilNs = 0;
     // NO sobrescribir los nombres aquí - se mantienen los que el usuario ingresó
 }
 
 void PongGame::runDemo() {
     initializeGame();
-
-    for (int i = 0; i < 100 && gameRunning; i++) {
-        ballX += ballSpeedX;
-        ballY += ballSpeedY;
-
-        if (ballY <= 1 || ballY >= HEIGHT - 2) {
-            ballSpeedY = -ballSpeedY;
-        }
-
-        if (ballX <= 3) {
-            if (ballY >= paddle1Y && ballY <= paddle1Y + PADDLE_HEIGHT) {
-                ballSpeedX = 1;
-            } else {
-                scoreP2++;
-                resetBall();
-            }
-        }
-
-        if (ballX >= WIDTH - 4) {
-            if (ballY >= paddle2Y && ballY <= paddle2Y + PADDLE_HEIGHT) {
-                ballSpeedX = -1;
-            } else {
-                scoreP1++;
-                resetBall();
-            }
-        }
-
-        if (ballY < paddle1Y + PADDLE_HEIGHT / 2 && paddle1Y > 1) {
-            paddle1Y--;
-        } else if (ballY > paddle1Y + PADDLE_HEIGHT / 2 && paddle1Y < HEIGHT - PADDLE_HEIGHT - 1) {
-            paddle1Y++;
-        }
-
-        if (ballY < paddle2Y + PADDLE_HEIGHT / 2 && paddle2Y > 1) {
-            paddle2Y--;
-        } else if (ballY > paddle2Y + PADDLE_HEIGHT / 2 && paddle2Y < HEIGHT - PADDLE_HEIGHT - 1) {
-            paddle2Y++;
-        }
-
-        renderer.updateScores(scoreP1, scoreP2);
-        renderer.updatePaddles(paddle1Y, paddle2Y);
-        renderer.updateBall(ballX, ballY, ballSpeedX, ballSpeedY);
+    enterRawInput();
+
+    for (int i = 0; i < 100 && running(); i++) {
+        World world = snapshot().sim;
+        // Ambas paletas siguen a la pelota
+        auto follow = [&world](int paddleY) {
+            int center = paddleY + PADDLE_HEIGHT / 2;
+            return (world.ballY < center) ? -1 : (world.ballY > center) ? 1 : 0;
+        };
+        step(world, Inputs{follow(world.paddle1Y), follow(world.paddle2Y)});
+        restore(MatchSnapshot{world, control.roundInProgress.load(memory_order_relaxed)});
+
+        syncRenderer(world);
         renderer.renderGame();
 
         usleep(100 * 1000);
@@ -286,53 +273,96 @@ void PongGame::runDemo() {
         if (kbhit()) {
             int key = getch();
             if (key == 'q' || key == 'Q') {
-                gameRunning = false;
+                control.gameRunning.store(false, memory_order_release);
             }
         }
     }
 
+    renderer.restoreTerminal();
+    leaveRawInput();
     cout << "Demo finalizada. Presiona cualquier tecla para continuar...";
     getch();
 }
 
 void PongGame::inputThread() { this->inputListenerThread(); }
+// Hilo de un jugador humano: aplica las teclas de su cola (el mismo para cada paleta)
 void PongGame::playerThread(int player_id) {
-    if (player_id == 1) this->playerAThread();
-    else this->playerBThread();
+    applyThreadRole(ThreadRole::INPUT);
+    while (drainLane(player_id)) {
+    }
 }
 void PongGame::aiThread() { this->ai_opponent_thread(); }
 void PongGame::serveThread() { this->serve_manager_thread(); }
 
+// Solo desde el hilo de física (único escritor de la pelota)
 void PongGame::resetBall() {
-    ballX = WIDTH / 2;
-    ballY = HEIGHT / 2;
-    ballSpeedX = (rand() % 2 == 0) ? 1 : -1;
-    ballSpeedY = (rand() % 2 == 0) ? 1 : -1;
+    World world;
+    ball.read(world);
+    world.ballX = WIDTH / 2;
+    world.ballY = HEIGHT / 2;
+    world.rng = stepXorshift(world.rng);
+    world.ballSpeedX = (world.rng % 2 == 0) ? 1 : -1;
+    world.rng = stepXorshift(world.rng);
+    world.ballSpeedY = (world.rng % 2 == 0) ? 1 : -1;
+    ball.publish(world);
+}
+
+// Mueve una paleta de IA (o de CPU vs CPU) sin contar pasos ni latencia
+void PongGame::shiftPaddle(int player, int delta) {
+    if (delta == 0) return;
+    PaddleBlock& paddle = paddles[player - 1];
+    pthread_mutex_lock(&paddle.mutex);
+    int y = stepClamp(paddle.load() + delta, 1, HEIGHT - PADDLE_HEIGHT - 1);
+    paddle.y.store(y, memory_order_relaxed);
+    pthread_mutex_unlock(&paddle.mutex);
+}
+
+void PongGame::syncRenderer(const World& world) {
+    renderer.updateScores(world.scoreP1, world.scoreP2);
+    renderer.updatePaddles(world.paddle1Y, world.paddle2Y);
+    renderer.updateBall(world.ballX, world.ballY, world.ballSpeedX, world.ballSpeedY);
 }
 
 void PongGame::startGame(int gameMode) {
     initializeGame();
     getPlayerNames();
+    enterRawInput();
+    if (gameMode != 3) beginKeyboard();
+    // Las respuestas a la sonda de salida las recibe inputListenerThread (no en CPU vs CPU)
+    renderer.setOutputProbe(gameMode != 3);
+    beginRecording();
+    // En JvsCPU el saque lo decide serve_manager_thread, no el núcleo
+    beginRallyLog(gameMode != 2);
+    logWrite(LOG_INFO, "partida iniciada: modo %d, %s vs %s", gameMode, playerName1.c_str(), playerName2.c_str());
+
+    // El hilo principal hace física + pintado en JvJ/JvsCPU y solo pintado en CPU vs CPU
+    ScopedThreadRole mainRole(gameMode == 3 ? ThreadRole::RENDER : ThreadRole::PHYSICS);
+    if (gameMode != 3) noteThreadRoleIgnored(ThreadRole::RENDER, "en JvJ/JvsCPU se pinta en el hilo de física");
+    FrameJitterProbe frameProbe(gameMode == 3 ? 100 * 1000 * 1000ULL : 16 * 1000 * 1000ULL);
+    if (threadTuning().backgroundLoad > 0) {
+        startBackgroundLoad(threadTuning().backgroundLoad);
+    }
 
     if (gameMode == 1) { // JvJ
-        isAIEnabled = false;
-        roundInProgress = true;
+        control.isAIEnabled.store(false, memory_order_relaxed);
+        control.roundInProgress.store(true, memory_order_release);
         pthread_create(&input_thread, nullptr, &PongGame::inputThreadWrapper, this);
-        pthread_create(&player1_thread, nullptr, &PongGame::playerThreadWrapper, &playerAData);
-        pthread_create(&player2_thread, nullptr, &PongGame::playerThreadWrapper, &playerBData);
+        for (int p = 0; p < 2; p++) {
+            pthread_create(&playerThreads[p], nullptr, &PongGame::playerThreadWrapper, &playerData[p]);
+        }
     } else if (gameMode == 2) { // JvsCPU
-        isAIEnabled = true;
+        control.isAIEnabled.store(true, memory_order_relaxed);
         ai_difficulty = 0.8f;
-        roundInProgress = true;
+        control.roundInProgress.store(true, memory_order_release);
         // Un único lector de teclado: inputListenerThread crea eventos en la cola
         pthread_create(&input_thread, nullptr, [](void* arg) -> void* { static_cast<PongGame*>(arg)->inputListenerThread(); return nullptr; }, this);
         // player_keyboard_adapter_thread ahora consume la cola (no lee teclado directamente)
-        pthread_create(&player1_thread, nullptr, [](void* arg) -> void* { static_cast<PongGame*>(arg)->player_keyboard_adapter_thread(); return nullptr; }, this);
-        pthread_create(&player2_thread, nullptr, &PongGame::aiThreadWrapper, this);
+        pthread_create(&playerThreads[0], nullptr, [](void* arg) -> void* { static_cast<PongGame*>(arg)->player_keyboard_adapter_thread(); return nullptr; }, this);
+        pthread_create(&playerThreads[1], nullptr, &PongGame::aiThreadWrapper, this);
         pthread_create(&serve_thread, nullptr, &PongGame::serveThreadWrapper, this);
     } else if (gameMode == 3) { // CPU vs CPU
-        isAIEnabled = true;
-        gameRunning = true;
+        control.isAIEnabled.store(true, memory_order_relaxed);
+        control.gameRunning.store(true, memory_order_release);
 
         // Crear hilos
         pthread_create(&ball_thread, nullptr, &PongGame::ballThreadWrapper, this);
@@ -340,19 +370,18 @@ void PongGame::startGame(int gameMode) {
         pthread_create(&cpuB_thread, nullptr, &PongGame::cpuPlayerBThreadWrapper, this);
 
         // Bucle de renderizado sincronizado con cond_frame_ready
-        while (gameRunning) {
+        while (running()) {
             pthread_mutex_lock(&mutex_game_state);
             // Esperar hasta que el hilo de la pelota genere un nuevo frame
             pthread_cond_wait(&cond_frame_ready, &mutex_game_state);
-
-            // Actualizar renderer con el estado actual
-            renderer.updateScores(scoreP1, scoreP2);
-            renderer.updatePaddles(paddle1Y, paddle2Y);
-            renderer.updateBall(ballX, ballY, ballSpeedX, ballSpeedY);
             pthread_mutex_unlock(&mutex_game_state);
 
+            // Actualizar renderer con una copia consistente del estado
+            syncRenderer(snapshot().sim);
+
             // Renderizar
             renderer.renderGame();
+            frameProbe.mark(frameJitter);
         }
 
         // Esperar a que terminen los hilos
@@ -363,67 +392,532 @@ void PongGame::startGame(int gameMode) {
 
 
     // Bucle principal del juego
-    while (gameRunning) {
+    loopTicksPerSecond = TICKS_PER_SECOND;
+    while (running()) {
+        // En pausa: pintar el aviso y dormir hasta que se reanude (sin ticks pendientes)
+        if (pauseGate.isPaused()) {
+            renderFrame(">> PAUSA - P para continuar <<");
+            pauseGate.park();
+            frameProbe.reset();
+            continue;
+        }
         // Siempre renderiza, pero solo actualiza física si la ronda está activa
-        if (roundInProgress) {
-            updatePhysics();
-            checkCollisions();
-            checkScoring();
+        handleMatchCommands();
+        integratePaddles();
+        driveBots();
+        // Durante la repetición el saque queda pedido hasta que termine
+        if (!showReplayFrame()) {
+            if (control.serveRequested.exchange(false, memory_order_acq_rel)) serveBall();
+            if (control.roundInProgress.load(memory_order_acquire)) {
+                if (advanceBall() != STEP_NO_SCORE) onPointScored();
+                captureTick();
+                if (replayPending) startInstantReplay();
+            }
+            renderFrame();
         }
-        renderer.updateScores(scoreP1, scoreP2);
-        renderer.updatePaddles(paddle1Y, paddle2Y);
-        renderer.updateBall(ballX, ballY, ballSpeedX, ballSpeedY);
-        renderer.renderGame();
-        usleep(16 * 1000); // ~60 FPS
+        frameProbe.mark(frameJitter);
+        measuredSleepUs(16 * 1000, tickJitter); // ~60 FPS
     }
 
     // Esperar a que terminen todos los hilos
     pthread_join(input_thread, nullptr);
-    pthread_join(player1_thread, nullptr);
-    pthread_join(player2_thread, nullptr);
-    if (isAIEnabled) {
+    for (pthread_t& thread : playerThreads) pthread_join(thread, nullptr);
+    if (control.isAIEnabled.load(memory_order_relaxed)) {
         pthread_join(serve_thread, nullptr);
     }
 
+    if (botServer.isOpen()) botServer.publish(snapshot().sim, BOT_STATUS_MATCH_OVER);
+    stopBackgroundLoad();
+    endRecording();
+    endRallyLog();
+    endKeyboard();
+    World result = snapshot().sim;
+    logWrite(LOG_INFO, "partida terminada: %s %d - %d %s (%llu frames)", playerName1.c_str(), result.scoreP1,
+             result.scoreP2, playerName2.c_str(), static_cast<unsigned long long>(framesRendered.load()));
+    renderer.restoreTerminal();
+    renderer.setOutputProbe(false);
+    leaveRawInput();
+    printHarnessStats();
+    showMatchReport();
+
     // Limpiar estado para volver al menú correctamente
-    isAIEnabled = false;
-    roundInProgress = false;
-    gameRunning = true;
+    control.isAIEnabled.store(false, memory_order_relaxed);
+    control.roundInProgress.store(false, memory_order_relaxed);
+    control.gameRunning.store(true, memory_order_release);
+}
+
+// ===================== LATENCIA DE ENTRADA =====================
+
+// Encola un evento de teclado conservando el instante en que se leyó
+void PongGame::pushEvent(int player, EventType type, uint64_t readNs) {
+    InputEvent ev = {type, readNs};
+    InputLane& lane = lanes[player - 1];
+    pthread_mutex_lock(&lane.mutex);
+    lane.queue.push(ev);
+    pthread_mutex_unlock(&lane.mutex);
+    pthread_cond_signal(&lane.cv);
+}
+
+// Mueve la paleta y deja el evento pendiente hasta que se pinte el siguiente frame
+void PongGame::applyPaddleEvent(int player, const InputEvent& ev) {
+    auto inBounds = [](int y) {
+        if (y < 1) return 1;
+        if (y > HEIGHT - PADDLE_HEIGHT - 1) return HEIGHT - PADDLE_HEIGHT - 1;
+        return y;
+    };
+
+    PaddleBlock& paddle = paddles[player - 1];
+    PendingInputs& pending = paddle.pending;
+    bool up = (ev.type == EventType::P1_UP || ev.type == EventType::P2_UP);
+
+    pthread_mutex_lock(&paddle.mutex);
+    int before = paddle.load();
+    int after = inBounds(up ? before - 1 : before + 1);
+    paddle.y.store(after, memory_order_relaxed);
+    if (after != before) recordPaddleMove(player, monotonicNowNs());
+    if (pending.count < PendingInputs::CAPACITY) {
+        pending.readNs[pending.count] = ev.readNs;
+        pending.appliedNs[pending.count] = monotonicNowNs();
+        pending.count++;
+    }
+    pthread_mutex_unlock(&paddle.mutex);
+    lanes[player - 1].eventsApplied.fetch_add(1, memory_order_relaxed);
+}
+
+// ===================== TECLAS MANTENIDAS =====================
+
+// Negocia el protocolo de kitty (solo en modo por velocidad: el modo por evento
+// conserva el comportamiento clásico) y elige cómo se detecta que se soltó una tecla
+void PongGame::beginKeyboard() {
+    kittyKeyboard = (paddleInput == PaddleInput::HELD) && enableKittyKeyboard(300);
+    heldKeys.setReleaseEvents(kittyKeyboard);
+    mouseReporting = enableMouseReporting();
+}
+
+void PongGame::endKeyboard() {
+    if (kittyKeyboard) disableKittyKeyboard();
+    kittyKeyboard = false;
+    if (mouseReporting) disableMouseReporting();
+    mouseReporting = false;
+}
+
+// Integra la velocidad de las paletas humanas con las teclas mantenidas. Al empezar
+// a moverse (pulsación nueva o cambio de dirección) el primer paso es inmediato;
+// después avanza PADDLE_CELLS_PER_SECOND según el tiempo real entre ticks.
+void PongGame::integratePaddles() {
+    uint64_t now = monotonicNowNs();
+    followPointer(now);
+    if (paddleInput != PaddleInput::HELD) return;
+    uint64_t dtNs = (lastIntegrateNs == 0) ? 0 : min(now - lastIntegrateNs, MAX_INTEGRATE_NS);
+    lastIntegrateNs = now;
+
+    int humans = control.isAIEnabled.load(memory_order_relaxed) ? 1 : 2;
+    for (int player = 1; player <= humans; player++) {
+        int idx = player - 1;
+        uint64_t pressNs = 0;
+        int dir = heldKeys.direction(player, now, pressNs);
+        bool started = (dir != paddleDir[idx]);
+        paddleDir[idx] = dir;
+        if (dir == 0) {
+            paddleTravel[idx] = 0;
+            continue;
+        }
+        int steps = 0;
+        if (started || pressNs != 0) {
+            steps = 1;
+            paddleTravel[idx] = 0;
+        } else {
+            paddleTravel[idx] += PADDLE_CELLS_PER_SECOND * dtNs;
+            steps = static_cast<int>(paddleTravel[idx] / CELL_UNITS);
+            paddleTravel[idx] %= CELL_UNITS;
+        }
+        if (steps > 0) movePaddle(player, dir * steps, pressNs, now);
+    }
+}
+
+// Mouse: la paleta se centra en la fila del último reporte. Los anteriores ya se
+// descartaron (en la lectura y en MousePointer), así que es un movimiento por tick
+// sin importar cuántos reportes lleguen.
+void PongGame::followPointer(uint64_t nowNs) {
+    if (!mouseReporting) return;
+    int humans = control.isAIEnabled.load(memory_order_relaxed) ? 1 : 2;
+    for (int player = 1; player <= humans; player++) {
+        int row;
+        uint64_t readNs;
+        if (!mousePointer.take(player, row, readNs)) continue;
+        mouseApplied++;
+        int target = stepClamp(row - PADDLE_HEIGHT / 2, 1, HEIGHT - PADDLE_HEIGHT - 1);
+        int delta = target - paddles[player - 1].load();
+        if (delta != 0) movePaddle(player, delta, readNs, nowNs);
+    }
+}
+
+// Bots externos: aplica el comando del frame publicado en el tick anterior (si no
+// llegó a tiempo juega la IA integrada) y publica el estado de este tick
+void PongGame::driveBots() {
+    if (!botServer.isOpen()) return;
+    World world = snapshot().sim;
+    for (int player = 1; player <= 2; player++) {
+        if (!botServer.attached(player)) continue;
+        int move;
+        if (!botServer.take(player, move)) move = aiDecide(botFallback, world, player, botRng[player - 1]);
+        if (move != 0) movePaddle(player, move, 0, monotonicNowNs());
+    }
+    bool playing = control.roundInProgress.load(memory_order_acquire);
+    botServer.publish(snapshot().sim, playing ? BOT_STATUS_PLAYING : BOT_STATUS_MATCH_OVER);
+}
+
+// Mueve la paleta; si el paso viene de una pulsación nueva queda pendiente para la
+// latencia tecla -> frame igual que en applyPaddleEvent
+void PongGame::movePaddle(int player, int delta, uint64_t pressNs, uint64_t nowNs) {
+    PaddleBlock& paddle = paddles[player - 1];
+    PendingInputs& pending = paddle.pending;
+
+    pthread_mutex_lock(&paddle.mutex);
+    int before = paddle.load();
+    int after = stepClamp(before + delta, 1, HEIGHT - PADDLE_HEIGHT - 1);
+    paddle.y.store(after, memory_order_relaxed);
+    if (after != before) recordPaddleMove(player, nowNs);
+    if (pressNs != 0 && pending.count < PendingInputs::CAPACITY) {
+        pending.readNs[pending.count] = pressNs;
+        pending.appliedNs[pending.count] = nowNs;
+        pending.count++;
+    }
+    pthread_mutex_unlock(&paddle.mutex);
+}
+
+// Llamar con el mutex de la paleta tomado
+void PongGame::recordPaddleMove(int player, uint64_t nowNs) {
+    PaddleBlock& paddle = paddles[player - 1];
+    if (paddle.lastMoveNs != 0 && nowNs - paddle.lastMoveNs < MOVE_GAP_NS) {
+        paddle.moveInterval.record((nowNs - paddle.lastMoveNs) / 1000);
+    }
+    paddle.lastMoveNs = nowNs;
+    paddle.moves++;
+}
+
+// Pinta el estado actual y cierra la medición de las teclas que entraron en él. La
+// posición de cada paleta y sus teclas pendientes se toman juntas con el mutex de la
+// paleta: una tecla aplicada mientras se arma el frame queda para el siguiente.
+void PongGame::renderFrame(const char* banner) {
+    World world;
+    ball.read(world);
+    int ys[2];
+    for (int p = 0; p < 2; p++) {
+        PaddleBlock& paddle = paddles[p];
+        PendingInputs& composed = composedInputs[p];
+        pthread_mutex_lock(&paddle.mutex);
+        ys[p] = paddle.load();
+        for (int i = 0; i < paddle.pending.count && composed.count < PendingInputs::CAPACITY; i++) {
+            composed.readNs[composed.count] = paddle.pending.readNs[i];
+            composed.appliedNs[composed.count] = paddle.pending.appliedNs[i];
+            composed.count++;
+        }
+        paddle.pending.count = 0;
+        pthread_mutex_unlock(&paddle.mutex);
+    }
+    world.paddle1Y = ys[0];
+    world.paddle2Y = ys[1];
+    syncRenderer(world);
+
+    // Frame omitido por contrapresión: las teclas se miden cuando salga el próximo
+    if (!presentFrame(banner)) return;
+    uint64_t frameNs = monotonicNowNs();
+    for (int p = 0; p < 2; p++) {
+        PendingInputs& composed = composedInputs[p];
+        for (int i = 0; i < composed.count; i++) {
+            latencyTracker.recordSample(p + 1, composed.readNs[i], composed.appliedNs[i], frameNs);
+        }
+        composed.count = 0;
+    }
+}
+
+// Pinta lo que tenga el renderer con la línea de estado que corresponda; false si el
+// frame se omitió porque la terminal va atrasada
+bool PongGame::presentFrame(const char* banner) {
+    if (banner != nullptr) {
+        renderer.setStatusLine(banner);
+    } else if (monotonicNowNs() < statusUntilNs) {
+        renderer.setStatusLine(statusMessage);
+    } else if (control.showLatency.load(memory_order_relaxed)) {
+        latencyTracker.formatSummary(latencyLine, sizeof(latencyLine));
+        renderer.setStatusLine(latencyLine);
+    } else {
+        renderer.setStatusLine("");
+    }
+    bool presented = renderer.renderGame();
+    frameAllocations.mark();
+    if (presented) framesRendered.fetch_add(1, memory_order_relaxed);
+    return presented;
+}
+
+// Línea legible por máquina para el arnés PTY (solo si PONG_HARNESS está definido)
+void PongGame::printHarnessStats() {
+    if (getenv("PONG_HARNESS") == nullptr) return;
+    cout << "PONG_STATS frames=" << framesRendered.load()
+         << " p1_events=" << lanes[0].eventsApplied.load()
+         << " p2_events=" << lanes[1].eventsApplied.load()
+         << " steady_frames=" << frameAllocations.steadyFrames()
+         << " steady_allocs=" << frameAllocations.steadyAllocations()
+         << " worst_frame_allocs=" << frameAllocations.worstFrame()
+         << " kitty=" << (kittyKeyboard ? 1 : 0)
+         << " skipped_frames=" << renderer.skippedFrameCount()
+         << " max_outq=" << renderer.maxOutputQueueDepth()
+         << " max_lag_us=" << renderer.maxOutputLagNs() / 1000
+         << " mouse_reports=" << mouseDecoded
+         << " mouse_applied=" << mouseApplied
+         << " mouse_max_burst=" << max(mousePointer.maxBurst(1), mousePointer.maxBurst(2));
+    for (int p = 0; p < 2; p++) {
+        const PaddleBlock& paddle = paddles[p];
+        cout << " p" << (p + 1) << "_moves=" << paddle.moves
+             << " p" << (p + 1) << "_step_p50_us=" << paddle.moveInterval.percentile(50)
+             << " p" << (p + 1) << "_step_p99_us=" << paddle.moveInterval.percentile(99)
+             << " p" << (p + 1) << "_step_max_us=" << paddle.moveInterval.max()
+             << " p" << (p + 1) << "_key_p50_us=" << latencyTracker.framePercentile(p + 1, 50)
+             << " p" << (p + 1) << "_key_p99_us=" << latencyTracker.framePercentile(p + 1, 99);
+    }
+    cout << "\n";
+    cout.flush();
+}
+
+void PongGame::showMatchReport() {
+    if (!latencyTracker.hasSamples() && rewind.captureCount() == 0 && frameJitter.count() == 0) return;
+    system("clear");
+    cout << "========================================\n";
+    cout << "        ESTADÍSTICAS DE LA PARTIDA      \n";
+    cout << "========================================\n\n";
+    latencyTracker.printReport(playerName1, playerName2);
+    cout << "Rebobinado: " << rewind.size() << " ticks en buffer, "
+         << rewind.bytesUsed() << "/" << rewind.bytesCapacity() << " bytes, captura promedio "
+         << static_cast<int>(rewind.averageCaptureNs()) << " ns\n";
+    cout << "Jitter tick (ms):  p50 " << tickJitter.percentile(50) / 1000.0
+         << "  p99 " << tickJitter.percentile(99) / 1000.0
+         << "  max " << tickJitter.max() / 1000.0 << "\n";
+    cout << "Jitter frame (ms): p50 " << frameJitter.percentile(50) / 1000.0
+         << "  p99 " << frameJitter.percentile(99) / 1000.0
+         << "  max " << frameJitter.max() / 1000.0 << "\n";
+    cout << "Hilos: " << threadTuningSummary() << "\n";
+    cout << "Salida: " << static_cast<int>(renderer.bytesPerFrame()) << " bytes/frame ("
+         << (renderer.usesDiffOutput() ? "diferencial" : "completa") << "), "
+         << renderer.skippedFrameCount() << " frames omitidos por terminal lenta, cola máx "
+         << renderer.maxOutputQueueDepth() << " bytes, atraso máx "
+         << renderer.maxOutputLagNs() / 1000000.0 << " ms\n";
+    cout << "Paletas: " << (paddleInput == PaddleInput::HELD ? "por velocidad" : "por evento");
+    if (paddleInput == PaddleInput::HELD) {
+        cout << " (" << (kittyKeyboard ? "eventos de soltar de kitty" : "auto-repetición del terminal") << ")";
+    }
+    for (int p = 0; p < 2; p++) {
+        const PaddleBlock& paddle = paddles[p];
+        if (paddle.moves == 0) continue;
+        cout << " | P" << (p + 1) << " " << paddle.moves << " pasos, intervalo p50 "
+             << paddle.moveInterval.percentile(50) / 1000.0 << " p99 "
+             << paddle.moveInterval.percentile(99) / 1000.0 << " ms";
+    }
+    cout << "\n";
+    if (mouseDecoded > 0) {
+        cout << "Mouse: " << mouseDecoded << " reportes, " << mouseApplied
+             << " posiciones aplicadas (una por tick), hasta "
+             << max(mousePointer.maxBurst(1), mousePointer.maxBurst(2)) << " lecturas entre dos ticks\n";
+    }
+    for (int player = 1; player <= 2; player++) {
+        uint64_t total = botServer.commands(player) + botServer.misses(player);
+        if (total == 0) continue;
+        const LatencyHistogram& lat = botServer.latency(player);
+        cout << "Bot P" << player << ": " << botServer.commands(player) << " comandos, "
+             << botServer.misses(player) << " fuera de plazo (IA integrada), tick -> comando us p50 "
+             << lat.percentile(50) / 1000.0 << " p99 " << lat.percentile(99) / 1000.0 << "\n";
+    }
+    cout << "Memoria: " << frameAllocations.steadyAllocations() << " reservas en "
+         << frameAllocations.steadyFrames() << " frames estables\n";
+    if (!recordPrefix.empty() && !recorder.path().empty()) {
+        cout << "Grabación: " << recorder.path() << "  " << recorder.recordedFrames() << " frames, "
+             << recorder.droppedFrames() << " descartados, " << recorder.bytesWritten() << " bytes, "
+             << static_cast<int>(recorder.averagePushNs()) << " ns/frame en el render (máx "
+             << recorder.maxPushNs() << " ns)\n";
+    }
+    if (rallyLog.isOpen()) {
+        cout << "Peloteos: " << rallyLog.eventsWritten() << " eventos registrados\n";
+    }
+    if (pauseGate.pausedNs() > 0) {
+        cout << "En pausa: " << pauseGate.pausedNs() / 1000000000.0 << " s\n";
+    }
+    if (planner && control.isAIEnabled.load(memory_order_relaxed)) {
+        cout << "IA búsqueda: presupuesto " << planner->budgetNs() / 1000 << " us, "
+             << planner->lastRollouts() << " simulaciones en la última decisión, "
+             << static_cast<long long>(planner->rolloutsPerSecond()) << " simulaciones/s\n";
+    }
+    cout << "\nPresiona cualquier tecla para continuar...";
+    cout.flush();
+    getch();
 }
 
-void PongGame::updatePhysics() {
-    // Actualiza posición de la pelota
-    ballX += ballSpeedX;
-    ballY += ballSpeedY;
+// ===================== GUARDADO Y REBOBINADO =====================
+
+// Copia consistente del estado desde cualquier hilo: la pelota con el seqlock y
+// cada paleta con una lectura atómica (sin tomar mutex)
+MatchSnapshot PongGame::snapshot() {
+    MatchSnapshot snap;
+    ball.read(snap.sim);
+    snap.sim.paddle1Y = paddles[0].load();
+    snap.sim.paddle2Y = paddles[1].load();
+    snap.roundInProgress = control.roundInProgress.load(memory_order_acquire);
+    return snap;
+}
 
-    // Rebotes verticales
-    if (ballY <= 1 || ballY >= HEIGHT - 2) {
-        ballSpeedY = -ballSpeedY;
+// Solo desde el hilo de física
+void PongGame::restore(const MatchSnapshot& snap) {
+    ball.publish(snap.sim);
+    const int ys[2] = {snap.sim.paddle1Y, snap.sim.paddle2Y};
+    for (int p = 0; p < 2; p++) {
+        pthread_mutex_lock(&paddles[p].mutex);
+        paddles[p].y.store(ys[p], memory_order_relaxed);
+        pthread_mutex_unlock(&paddles[p].mutex);
     }
+    control.roundInProgress.store(snap.roundInProgress, memory_order_release);
+}
 
-    // Leer snapshots de paletas bajo lock breve (pthread)
-    int p1Y, p2Y;
-    pthread_mutex_lock(&mutex_paddleA);
-    p1Y = paddle1Y;
-    pthread_mutex_unlock(&mutex_paddleA);
+void PongGame::captureTick() {
+    rewind.capture(snapshot());
+}
 
-    pthread_mutex_lock(&mutex_paddleB);
-    p2Y = paddle2Y;
-    pthread_mutex_unlock(&mutex_paddleB);
+void PongGame::flashStatus(const string& message) {
+    statusMessage = message;
+    statusUntilNs = monotonicNowNs() + 1500ULL * 1000000ULL;
+    logWrite(LOG_INFO, "%s", message.c_str() + (message.compare(0, 3, ">> ") == 0 ? 3 : 0));
+}
 
-    // Colisiones con paletas
-    if (ballX <= 3) {
-        if (ballY >= p1Y && ballY <= p1Y + PADDLE_HEIGHT) {
-            ballSpeedX = 1;
+// Atiende G (guardar), C (cargar) y B (rebobinar) desde el hilo que mueve la pelota
+void PongGame::handleMatchCommands() {
+    if (control.saveRequested.exchange(false, memory_order_acq_rel)) {
+        if (saveSnapshotFile(SAVE_FILE, snapshot())) flashStatus(">> Partida guardada en " + string(SAVE_FILE));
+        else flashStatus(">> No se pudo guardar la partida");
+    }
+    if (control.loadRequested.exchange(false, memory_order_acq_rel)) {
+        MatchSnapshot snap;
+        if (loadSnapshotFile(SAVE_FILE, snap)) {
+            restore(snap);
+            rewind.clear();
+            replayRemaining = 0;
+            flashStatus(">> Partida cargada");
+        } else {
+            flashStatus(">> No hay partida guardada");
         }
     }
-    if (ballX >= WIDTH - 4) {
-        if (ballY >= p2Y && ballY <= p2Y + PADDLE_HEIGHT) {
-            ballSpeedX = -1;
+    if (control.rewindRequested.exchange(false, memory_order_acq_rel)) {
+        size_t back = min(static_cast<size_t>(loopTicksPerSecond), rewind.size() > 0 ? rewind.size() - 1 : 0);
+        MatchSnapshot snap;
+        if (rewind.get(back, snap)) {
+            restore(snap);
+            rewind.truncate(back);
+            replayRemaining = 0;
+            flashStatus(">> Rebobinado 1 segundo");
         }
     }
 }
 
+// Repite los últimos REPLAY_SECONDS del punto (el estado actual no se toca). La
+// reproducen los bucles de juego, un tick grabado por vuelta: entrada, comandos y
+// bots siguen atendiéndose y el ritmo es el mismo con el que se grabó.
+void PongGame::startInstantReplay() {
+    replayPending = false;
+    replayRemaining = min(static_cast<size_t>(REPLAY_SECONDS * loopTicksPerSecond), rewind.size());
+}
+
+bool PongGame::showReplayFrame() {
+    if (replayRemaining == 0) return false;
+    MatchSnapshot snap;
+    if (!rewind.get(--replayRemaining, snap)) {
+        replayRemaining = 0;
+        return false;
+    }
+    // Se pintan las paletas grabadas: ningún frame de la repetición muestra las teclas
+    // aplicadas mientras dura, así que no entran en la latencia tecla -> frame
+    for (int p = 0; p < 2; p++) {
+        pthread_mutex_lock(&paddles[p].mutex);
+        paddles[p].pending.count = 0;
+        pthread_mutex_unlock(&paddles[p].mutex);
+        composedInputs[p].count = 0;
+    }
+    syncRenderer(snap.sim);
+    presentFrame(">> REPETICIÓN <<");
+    return true;
+}
+
+void PongGame::configureRecording(const string& prefix) {
+    recordPrefix = prefix;
+    // "partida.cast" y "partida" producen partida-001.cast, partida-002.cast, ...
+    if (recordPrefix.size() > 5 && recordPrefix.compare(recordPrefix.size() - 5, 5, ".cast") == 0) {
+        recordPrefix.erase(recordPrefix.size() - 5);
+    }
+}
+
+void PongGame::beginRecording() {
+    if (recordPrefix.empty()) return;
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), "-%03d.cast", ++recordedMatches);
+    if (recorder.open(recordPrefix + suffix, SCREEN_COLS, SCREEN_ROWS)) {
+        renderer.setRecorder(&recorder);
+    } else {
+        flashStatus(">> No se pudo abrir " + recordPrefix + suffix);
+    }
+}
+
+void PongGame::endRecording() {
+    if (!recorder.isOpen()) return;
+    renderer.setRecorder(nullptr);
+    recorder.close();
+}
+
+bool PongGame::configurePaddleInput(const string& mode) {
+    if (mode == "event") paddleInput = PaddleInput::EVENT;
+    else if (mode == "held") paddleInput = PaddleInput::HELD;
+    else return false;
+    return true;
+}
+
+bool PongGame::configureBotApi(const string& name) {
+    // Plazo de un tick: el comando del frame N se aplica al empezar el frame N + 1
+    return botServer.create(name, 1000000 / TICKS_PER_SECOND);
+}
+
+bool PongGame::configureRallyLog(const string& path) {
+    // Un bloque completo reservado de una vez: registrar eventos no reserva memoria
+    rallyEvents.reserve(RallyLog::BLOCK_EVENTS);
+    return rallyLog.open(path);
+}
+
+void PongGame::beginRallyLog(bool serveOnMiss) {
+    if (!rallyLog.isOpen()) return;
+    World serve = snapshot().sim;
+    lock_guard<mutex> lock(rallyMutex);
+    rallyEvents.clear();
+    rallyTracker.reset(rallyLog.nextMatchId(), serveOnMiss);
+    rallyTracker.recordServe(serve, rallyEvents);
+}
+
+// Los eventos se juntan en memoria y se escriben en un solo bloque al terminar
+void PongGame::endRallyLog() {
+    if (!rallyLog.isOpen()) return;
+    lock_guard<mutex> lock(rallyMutex);
+    rallyLog.append(rallyEvents);
+    rallyEvents.clear();
+}
+
+void PongGame::configureRolloutAI(int threads, int budgetUs) {
+    if (budgetUs <= 0) {
+        planner.reset();
+        return;
+    }
+    planner.reset(new RolloutPlanner(threads, static_cast<uint64_t>(budgetUs) * 1000ULL, ROLLOUT_HORIZON));
+}
+
+bool PongGame::configureLearnedPolicy(const string& path) {
+    unique_ptr<LearnedPolicy> policy(new LearnedPolicy());
+    if (!policy->load(path)) return false;
+    learnedPolicy = move(policy);
+    return true;
+}
+
 void PongGame::handleInput() {
     // No usado directamente: la entrada se maneja por hilos
 }
@@ -460,71 +954,76 @@ void PongGame::getPlayerNames() {
 void PongGame::runGameWithPlayers() {
     getPlayerNames();
     initializeGame();
+    enterRawInput();
+    beginKeyboard();
+    beginRallyLog(true);
 
     // Actualizar los nombres en el renderer
     renderer.updatePlayerNames(playerName1, playerName2);
 
     // Lanzar hilos
-    gameRunning = true;
+    control.gameRunning.store(true, memory_order_release);
     pthread_create(&input_thread, nullptr, &PongGame::inputThreadWrapper, this);
-    pthread_create(&player1_thread, nullptr, &PongGame::playerThreadWrapper, &playerAData);
-    pthread_create(&player2_thread, nullptr, &PongGame::playerThreadWrapper, &playerBData);
+    for (int p = 0; p < 2; p++) {
+        pthread_create(&playerThreads[p], nullptr, &PongGame::playerThreadWrapper, &playerData[p]);
+    }
 
     // Bucle principal de juego (física + render)
-    while (gameRunning) {
-        if (resetRequested) {
-            resetBall();
-            resetRequested = false;
+    loopTicksPerSecond = PLAYERS_TICKS_PER_SECOND;
+    while (running()) {
+        if (pauseGate.isPaused()) {
+            renderFrame(">> PAUSA - P para continuar <<");
+            pauseGate.park();
+            continue;
         }
-
-        updatePhysics();
-
-        // Anotaciones (cuando la pelota pasa el límite)
-        if (ballX < 1) {
-            scoreP2++;
-            resetBall();
-        } else if (ballX > WIDTH - 2) {
-            scoreP1++;
+        if (control.resetRequested.exchange(false, memory_order_acq_rel)) {
             resetBall();
         }
+        handleMatchCommands();
+        integratePaddles();
+
+        if (!showReplayFrame()) {
+            bool scored = advanceBall() != STEP_NO_SCORE;
+            captureTick();
+            if (scored) startInstantReplay();
 
-        // Pintar
-        {
-            int p1, p2;
-            pthread_mutex_lock(&mutex_paddleA);
-            p1 = paddle1Y;
-            pthread_mutex_unlock(&mutex_paddleA);
-            pthread_mutex_lock(&mutex_paddleB);
-            p2 = paddle2Y;
-            pthread_mutex_unlock(&mutex_paddleB);
-            renderer.updateScores(scoreP1, scoreP2);
-            renderer.updatePaddles(p1, p2);
-            renderer.updateBall(ballX, ballY, ballSpeedX, ballSpeedY);
+            // Pintar
+            renderFrame();
         }
-        renderer.renderGame();
 
         usleep(100 * 1000);
     }
 
     // Cerrar hilos limpiamente
-    pthread_cond_broadcast(&cvP1);
-    pthread_cond_broadcast(&cvP2);
+    pthread_cond_broadcast(&lanes[0].cv);
+    pthread_cond_broadcast(&lanes[1].cv);
     pthread_join(input_thread, nullptr);
-    pthread_join(player1_thread, nullptr);
-    pthread_join(player2_thread, nullptr);
+    for (pthread_t& thread : playerThreads) pthread_join(thread, nullptr);
+    endRallyLog();
+    endKeyboard();
 
     // Mostrar resultados finales
+    renderer.restoreTerminal();
+    leaveRawInput();
     system("clear");
     cout << "========================================\n";
     cout << "           PARTIDA TERMINADA            \n";
     cout << "========================================\n\n";
+    World final = snapshot().sim;
     cout << "Resultado final:\n";
-    cout << playerName1 << ": " << scoreP1 << " puntos\n";
-    cout << playerName2 << ": " << scoreP2 << " puntos\n\n";
+    cout << playerName1 << ": " << final.scoreP1 << " puntos\n";
+    cout << playerName2 << ": " << final.scoreP2 << " puntos\n\n";
+    if (latencyTracker.hasSamples()) {
+        latencyTracker.printReport(playerName1, playerName2);
+        cout << "\n";
+    }
+    cout << "Rebobinado: " << rewind.size() << " ticks en buffer, "
+         << rewind.bytesUsed() << "/" << rewind.bytesCapacity() << " bytes, captura promedio "
+         << static_cast<int>(rewind.averageCaptureNs()) << " ns\n\n";
 
     // Guardar el puntaje (nota: el manager actual siempre guarda 0-0 durante desarrollo)
     try {
-        scoreManager.addScore(playerName1, playerName2, scoreP1, scoreP2);
+        scoreManager.addScore(playerName1, playerName2, final.scoreP1, final.scoreP2);
         cout << "Puntaje guardado exitosamente!\n";
     } catch (...) {
         cout << "No se pudo guardar el puntaje, pero el juego funcionó correctamente.\n";
@@ -540,180 +1039,178 @@ void PongGame::showHighScores() {
 
 // ===================== HILOS (JvJ) =====================
 
+// Termina la partida y despierta a todos los hilos bloqueados (también en pausa)
+void PongGame::requestQuit() {
+    control.gameRunning.store(false, memory_order_release);
+    // Tomar el mutex de cada cola antes de despertar: un hilo que ya evaluó la
+    // condición no puede quedarse dormido después del broadcast
+    for (InputLane& lane : lanes) {
+        pthread_mutex_lock(&lane.mutex);
+        pthread_cond_broadcast(&lane.cv);
+        pthread_mutex_unlock(&lane.mutex);
+    }
+    // Despertar al serve_thread si está esperando
+    pthread_cond_broadcast(&cond_start_round);
+    pauseGate.resume();
+}
+
 void PongGame::inputListenerThread() {
-    while (gameRunning) {
-        if (kbhit()) {
-            int key = getch();
-            if (key == 'q' || key == 'Q') {
-                gameRunning = false;
-                // despertar a los hilos bloqueados
-                pthread_cond_broadcast(&cvP1);
-                pthread_cond_broadcast(&cvP2);
-                // Despertar al serve_thread si está esperando
-                pthread_cond_broadcast(&cond_start_round);
+    applyThreadRole(ThreadRole::INPUT);
+    KeyDecoder decoder;
+    unsigned char buffer[64];
+    while (running()) {
+        // En pausa: lectura bloqueante, sin sondeo cada 5 ms
+        bool paused = pauseGate.isPaused();
+        if (!paused && !kbhit()) {
+            usleep(5 * 1000);
+            continue;
+        }
+        ssize_t n = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (n <= 0) {
+            if (paused) {
+                requestQuit();
                 break;
-            } else if (key == 'r' || key == 'R') {
-                // solicitar reinicio y notificar al serve thread
-                resetRequested = true;
-                pthread_cond_signal(&cond_start_round);
-            } else if (key == 'w' || key == 'W') {
-                pthread_mutex_lock(&mtxQueueP1);
-                queueP1.push(EventType::P1_UP);
-                pthread_mutex_unlock(&mtxQueueP1);
-                pthread_cond_signal(&cvP1);
-            } else if (key == 's' || key == 'S') {
-                pthread_mutex_lock(&mtxQueueP1);
-                queueP1.push(EventType::P1_DOWN);
-                pthread_mutex_unlock(&mtxQueueP1);
-                pthread_cond_signal(&cvP1);
-            } else if (key == 27) { // ESC: posible secuencia de flechas
-                if (kbhit()) {
-                    int k2 = getch();
-                    if (k2 == 91 && kbhit()) { // '['
-                        int k3 = getch();
-                        if (k3 == 65) { // Up
-                            pthread_mutex_lock(&mtxQueueP2);
-                            queueP2.push(EventType::P2_UP);
-                            pthread_mutex_unlock(&mtxQueueP2);
-                            pthread_cond_signal(&cvP2);
-                        } else if (k3 == 66) { // Down
-                            pthread_mutex_lock(&mtxQueueP2);
-                            queueP2.push(EventType::P2_DOWN);
-                            pthread_mutex_unlock(&mtxQueueP2);
-                            pthread_cond_signal(&cvP2);
-                        }
-                    }
-                }
             }
+            continue;
         }
-        usleep(5 * 1000);
+        uint64_t readNs = monotonicNowNs();
+        bool keepRunning = decoder.feedBlock(buffer, static_cast<size_t>(n), [&](const KeyEvent& key) {
+            if (key.code == KEY_MOUSE) mouseDecoded++;
+            return handleKey(key, readNs);
+        });
+        if (!keepRunning) break;
     }
+    mouseDecoded += decoder.motionCoalesced();
 }
 
-void PongGame::playerAThread() {
-    auto inBounds = [](int y) {
-        if (y < 1) return 1;
-        if (y > HEIGHT - PADDLE_HEIGHT - 1) return HEIGHT - PADDLE_HEIGHT - 1;
-        return y;
-    };
-
-    while (gameRunning) {
-        // Esperar hasta que haya eventos o termine el juego
-        pthread_mutex_lock(&mtxQueueP1);
-        while (queueP1.empty() && gameRunning) {
-            pthread_cond_wait(&cvP1, &mtxQueueP1);
-        }
-        if (!gameRunning) {
-            pthread_mutex_unlock(&mtxQueueP1);
-            break;
+// Aplica una tecla decodificada; false si la partida termina
+bool PongGame::handleKey(const KeyEvent& key, uint64_t readNs) {
+    if (key.code == KEY_STATUS_REPLY) {
+        renderer.onStatusReply(readNs);
+        return true;
+    }
+    if (key.code == KEY_MOUSE) {
+        if (key.action == KEY_RELEASE || pauseGate.isPaused()) return true;
+        // Contra la CPU el puntero es de P1; entre dos jugadores, de quien tenga su
+        // mitad de la cancha bajo el puntero
+        bool vsCpu = control.isAIEnabled.load(memory_order_relaxed);
+        int player = (vsCpu || key.mouseCol <= WIDTH / 2) ? 1 : 2;
+        mousePointer.onReport(player, key.mouseRow - 1 - SCOREBOARD_ROWS, readNs);
+        return true;
+    }
+    int slot = -1;
+    if (key.code == 'w') slot = HeldKeys::P1_UP;
+    else if (key.code == 's') slot = HeldKeys::P1_DOWN;
+    else if (key.code == KEY_ARROW_UP) slot = HeldKeys::P2_UP;
+    else if (key.code == KEY_ARROW_DOWN) slot = HeldKeys::P2_DOWN;
+
+    if (slot >= 0) {
+        if (pauseGate.isPaused()) return true;
+        if (paddleInput == PaddleInput::HELD) {
+            heldKeys.onEvent(slot, key.action, readNs);
+            if (key.action != KEY_RELEASE) lanes[slot / 2].eventsApplied.fetch_add(1, memory_order_relaxed);
+        } else if (key.action != KEY_RELEASE) {
+            const EventType types[] = {EventType::P1_UP, EventType::P1_DOWN, EventType::P2_UP, EventType::P2_DOWN};
+            pushEvent(slot / 2 + 1, types[slot], readNs);
         }
-        while (!queueP1.empty()) {
-            EventType ev = queueP1.front(); queueP1.pop();
-            // desbloquear cola mientras procesamos para evitar retener la cola
-            pthread_mutex_unlock(&mtxQueueP1);
-            pthread_mutex_lock(&mutex_paddleA);
-            if (ev == EventType::P1_UP) {
-                paddle1Y = inBounds(paddle1Y - 1);
-            } else if (ev == EventType::P1_DOWN) {
-                paddle1Y = inBounds(paddle1Y + 1);
-            }
-            pthread_mutex_unlock(&mutex_paddleA);
-            // volver a bloquear cola para posibles siguientes eventos
-            pthread_mutex_lock(&mtxQueueP1);
+        return true;
+    }
+
+    // Comandos: solo la pulsación (ni repeticiones ni el soltar de kitty)
+    if (key.action != KEY_PRESS) return true;
+    if (pauseGate.isPaused()) {
+        // En pausa solo P y Q cuentan
+        if (key.code == 'p') {
+            pauseGate.resume();
+        } else if (key.code == 'q') {
+            requestQuit();
+            return false;
         }
-        pthread_mutex_unlock(&mtxQueueP1);
+        return true;
     }
+    if (key.code == 'q') {
+        requestQuit();
+        return false;
+    } else if (key.code == 'p') {
+        pauseGate.pause();
+    } else if (key.code == 'r') {
+        // solicitar reinicio y notificar al serve thread
+        control.resetRequested.store(true, memory_order_release);
+        pthread_cond_signal(&cond_start_round);
+    } else if (key.code == 'l') {
+        control.showLatency.store(!control.showLatency.load(memory_order_relaxed), memory_order_relaxed);
+    } else if (key.code == 'g') {
+        control.saveRequested.store(true, memory_order_release);
+    } else if (key.code == 'c') {
+        control.loadRequested.store(true, memory_order_release);
+    } else if (key.code == 'b') {
+        control.rewindRequested.store(true, memory_order_release);
+    }
+    return true;
 }
 
-void PongGame::playerBThread() {
-    auto inBounds = [](int y) {
-        if (y < 1) return 1;
-        if (y > HEIGHT - PADDLE_HEIGHT - 1) return HEIGHT - PADDLE_HEIGHT - 1;
-        return y;
-    };
-
-    while (gameRunning) {
-        pthread_mutex_lock(&mtxQueueP2);
-        while (queueP2.empty() && gameRunning) {
-            pthread_cond_wait(&cvP2, &mtxQueueP2);
-        }
-        if (!gameRunning) {
-            pthread_mutex_unlock(&mtxQueueP2);
-            break;
-        }
-        while (!queueP2.empty()) {
-            EventType ev = queueP2.front(); queueP2.pop();
-            pthread_mutex_unlock(&mtxQueueP2);
-            pthread_mutex_lock(&mutex_paddleB);
-            if (ev == EventType::P2_UP) {
-                paddle2Y = inBounds(paddle2Y - 1);
-            } else if (ev == EventType::P2_DOWN) {
-                paddle2Y = inBounds(paddle2Y + 1);
-            }
-            pthread_mutex_unlock(&mutex_paddleB);
-            pthread_mutex_lock(&mtxQueueP2);
-        }
-        pthread_mutex_unlock(&mtxQueueP2);
+// Espera teclas en la cola del jugador y las aplica; false si la partida terminó
+bool PongGame::drainLane(int player) {
+    InputLane& lane = lanes[player - 1];
+    pthread_mutex_lock(&lane.mutex);
+    while (lane.queue.empty() && running()) {
+        pthread_cond_wait(&lane.cv, &lane.mutex);
+    }
+    if (!running()) {
+        pthread_mutex_unlock(&lane.mutex);
+        return false;
     }
+    while (!lane.queue.empty()) {
+        InputEvent ev = lane.queue.front(); lane.queue.pop();
+        // desbloquear cola mientras procesamos para evitar retener la cola
+        pthread_mutex_unlock(&lane.mutex);
+        applyPaddleEvent(player, ev);
+        // volver a bloquear cola para posibles siguientes eventos
+        pthread_mutex_lock(&lane.mutex);
+    }
+    pthread_mutex_unlock(&lane.mutex);
+    return true;
 }
 
 // Adaptador de teclado para jugador humano en modo JvsCPU
-// NOW: no lee teclado directamente — consume la misma cola que playerAThread
+// NOW: no lee teclado directamente — consume la misma cola que playerThread(1)
 void PongGame::player_keyboard_adapter_thread() {
-    auto inBounds = [](int y) {
-        if (y < 1) return 1;
-        if (y > HEIGHT - PADDLE_HEIGHT - 1) return HEIGHT - PADDLE_HEIGHT - 1;
-        return y;
-    };
-
-    while (gameRunning) {
-        // Esperar por eventos de la cola como en playerAThread
-        pthread_mutex_lock(&mtxQueueP1);
-        while (queueP1.empty() && gameRunning) {
-            pthread_cond_wait(&cvP1, &mtxQueueP1);
-        }
-        if (!gameRunning) {
-            pthread_mutex_unlock(&mtxQueueP1);
-            break;
-        }
-        while (!queueP1.empty()) {
-            EventType ev = queueP1.front(); queueP1.pop();
-            pthread_mutex_unlock(&mtxQueueP1);
-
-            pthread_mutex_lock(&mutex_paddleA);
-            if (ev == EventType::P1_UP) {
-                paddle1Y = inBounds(paddle1Y - 1);
-            } else if (ev == EventType::P1_DOWN) {
-                paddle1Y = inBounds(paddle1Y + 1);
-            }
-            pthread_mutex_unlock(&mutex_paddleA);
-
-            pthread_mutex_lock(&mtxQueueP1);
-        }
-        pthread_mutex_unlock(&mtxQueueP1);
-
+    applyThreadRole(ThreadRole::INPUT);
+    while (drainLane(1)) {
         usleep(16 * 1000); // ~60 FPS
     }
 }
 
+// Saque pedido por serve_manager_thread; lo hace el hilo de física, único escritor
+// de la pelota
+void PongGame::serveBall() {
+    resetBall();
+    if (rallyLog.isOpen()) {
+        World serve = snapshot().sim;
+        lock_guard<mutex> lock(rallyMutex);
+        rallyTracker.recordServe(serve, rallyEvents);
+    }
+}
+
 // Gestión de inicio/reinicio de rondas
 void PongGame::serve_manager_thread() {
-    while (gameRunning) {
+    while (running()) {
         pthread_mutex_lock(&mutex_start_round);
-        while (!resetRequested && gameRunning) {
+        while (!control.resetRequested.load(memory_order_acquire) && running()) {
             pthread_cond_wait(&cond_start_round, &mutex_start_round);
         }
-        if (!gameRunning) {
+        if (!running()) {
             pthread_mutex_unlock(&mutex_start_round);
             break;
         }
-        // Reiniciar posición de la pelota y estado de la ronda
-        resetBall();
-        roundInProgress = true;
-        resetRequested = false;
+        // Reiniciar posición de la pelota (en el hilo de física) y estado de la ronda
+        control.serveRequested.store(true, memory_order_release);
+        control.roundInProgress.store(true, memory_order_release);
+        control.resetRequested.store(false, memory_order_relaxed);
         pthread_mutex_unlock(&mutex_start_round);
         // Dar tiempo a los jugadores para prepararse
         sleep(2);
+        pauseGate.park();
 
         // Notificar que la ronda ha comenzado (opcional: renderer puede leer roundInProgress)
         renderer.renderScoreBoard();
@@ -722,6 +1219,8 @@ void PongGame::serve_manager_thread() {
 
 // Implementación de la IA para el modo JvsCPU
 void PongGame::ai_opponent_thread() {
+    applyThreadRole(ThreadRole::AI);
+
     auto inBounds = [](int y) {
         if (y < 1) return 1;
         if (y > HEIGHT - PADDLE_HEIGHT - 1) return HEIGHT - PADDLE_HEIGHT - 1;
@@ -729,36 +1228,50 @@ void PongGame::ai_opponent_thread() {
     };
 
     while (true) {
-        if (!gameRunning) break;
-        if (isAIEnabled && roundInProgress) {
-            // Simple protección de acceso a la paleta
-            pthread_mutex_lock(&mutex_paddleB);
-            // Asegurarse de no dividir por cero
-            if (ballSpeedX != 0) {
-                // Solo predecir si la pelota va hacia la derecha (hacia la paleta B)
-                if (ballSpeedX > 0) {
-                    // Estimación simple del tiempo que tarda en llegar
-                    float distance = static_cast<float>((WIDTH - 2) - ballX);
-                    float timeToReach = distance / static_cast<float>(ballSpeedX);
-                    // Predicción simplificada de Y con reflejos en bordes
-                    float predictedY = ballY + (ballSpeedY * timeToReach);
-                    // Reflejar en límites hasta que quede dentro del rango
-                    while (predictedY < 0 || predictedY > HEIGHT) {
-                        if (predictedY < 0) predictedY = -predictedY;
-                        else if (predictedY > HEIGHT) predictedY = 2 * HEIGHT - predictedY;
-                    }
-                    int targetY = static_cast<int>(predictedY - PADDLE_HEIGHT / 2);
-                    targetY = inBounds(targetY);
-                    float errorMargin = PADDLE_HEIGHT * (1.0f - ai_difficulty);
-                    int centerB = paddle2Y + PADDLE_HEIGHT / 2;
-                    if (centerB < targetY - static_cast<int>(errorMargin)) {
-                        paddle2Y = inBounds(paddle2Y + 1);
-                    } else if (centerB > targetY + static_cast<int>(errorMargin)) {
-                        paddle2Y = inBounds(paddle2Y - 1);
-                    }
+        pauseGate.park();
+        if (!running()) break;
+        if (botServer.attached(2)) {
+            // La paleta la maneja un bot externo (driveBots en el bucle principal)
+            usleep(16 * 1000);
+            continue;
+        }
+        bool playing = control.isAIEnabled.load(memory_order_relaxed) &&
+                       control.roundInProgress.load(memory_order_acquire);
+        if (playing && planner) {
+            // Búsqueda por simulaciones: decide con el estado actual y mueve una celda
+            MatchSnapshot snap = snapshot();
+            int move = planner->decide(snap.sim, 2);
+            // Si se pausó durante la búsqueda, la decisión ya no vale
+            if (pauseGate.isPaused()) continue;
+            shiftPaddle(2, move);
+        } else if (playing && learnedPolicy) {
+            MatchSnapshot snap = snapshot();
+            shiftPaddle(2, learnedPolicy->decide(snap.sim, 2));
+        } else if (playing) {
+            // Copia consistente de pelota y paleta (seqlock y lectura atómica)
+            World world = snapshot().sim;
+            // Solo predecir si la pelota va hacia la derecha (hacia la paleta B)
+            if (world.ballSpeedX > 0) {
+                // Estimación simple del tiempo que tarda en llegar
+                float distance = static_cast<float>((WIDTH - 2) - world.ballX);
+                float timeToReach = distance / static_cast<float>(world.ballSpeedX);
+                // Predicción simplificada de Y con reflejos en bordes
+                float predictedY = world.ballY + (world.ballSpeedY * timeToReach);
+                // Reflejar en límites hasta que quede dentro del rango
+                while (predictedY < 0 || predictedY > HEIGHT) {
+                    if (predictedY < 0) predictedY = -predictedY;
+                    else if (predictedY > HEIGHT) predictedY = 2 * HEIGHT - predictedY;
+                }
+                int targetY = static_cast<int>(predictedY - PADDLE_HEIGHT / 2);
+                targetY = inBounds(targetY);
+                float errorMargin = PADDLE_HEIGHT * (1.0f - ai_difficulty);
+                int centerB = world.paddle2Y + PADDLE_HEIGHT / 2;
+                if (centerB < targetY - static_cast<int>(errorMargin)) {
+                    shiftPaddle(2, 1);
+                } else if (centerB > targetY + static_cast<int>(errorMargin)) {
+                    shiftPaddle(2, -1);
                 }
             }
-            pthread_mutex_unlock(&mutex_paddleB);
         }
         usleep(16 * 1000);
     }
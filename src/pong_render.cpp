@@ -2,7 +2,9 @@
  * Archivo: pong_render.cpp
  * Descripción: Encargado de pintar el juego en pantalla. Aquí se dibuja todo: cancha,
  *              jugadores, pelota y marcador. También se actualiza la posición de cada
- *              elemento según el estado del juego.
+ *              elemento según el estado del juego. Por defecto la salida pasa por
+ *              TermEncoder y solo viajan los cambios; PONG_RENDER=full repinta todo.
+ *              La escritura no bloquea: si la terminal se atrasa se omiten frames.
  * - Marian Olivares
  * - Marcela Ordoñez
  * - Biancka Raxón
@@ -12,14 +14,27 @@
  ****************************************************/
 
 #include "pong_render.h"
+#include "key_input.h"
+#include "latency.h"
+#include "step_kernel.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
 #include <cstdlib>
-#include <iomanip>
+#include <cstdio>
 #include <iostream>
-#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
 
 using namespace std;
 
-PongRenderer::PongRenderer() {
+PongRenderer::PongRenderer()
+    : frame(SCREEN_ROWS, SCREEN_COLS), encoder(SCREEN_ROWS, SCREEN_COLS), outputFrames(0), outputBytes(0), recorder(nullptr),
+      outFd(STDOUT_FILENO), ownsOutFd(false), pendingOffset(0), fixedQueueLimit(0), lastFrameBytes(0), skippedFrames(0),
+      lastQueueDepth(0), maxQueueDepth(0), lastPresentNs(0), probeEnabled(false), terminalAnswers(false), probeOutstanding(false),
+      probeSentNs(0), minRttNs(UINT64_MAX), lastLagNs(0), maxLagNs(0) {
     scoreP1 = 0;
     scoreP2 = 0;
     paddle1Y = HEIGHT / 2 - PADDLE_HEIGHT / 2;
@@ -30,6 +45,36 @@ PongRenderer::PongRenderer() {
     ballDirY = 1;
     playerName1 = "JUGADOR 1";
     playerName2 = "JUGADOR 2";
+
+    const char* mode = getenv("PONG_RENDER");
+    diffOutput = !(mode != nullptr && string(mode) == "full");
+    encoder.setCaps(detectTermCaps());
+
+    // Capacidad suficiente para cualquier frame: pintar no vuelve a reservar memoria
+    const size_t screenBytes = static_cast<size_t>(SCREEN_ROWS) * (SCREEN_COLS + 1) * 4;
+    text.reserve(screenBytes);
+    scratch.reserve(screenBytes);
+    fullBytes.reserve(screenBytes + 16);
+    pendingOut.reserve(screenBytes + 16);
+    statusLine.reserve(256);
+
+    // Una descripción propia de la terminal con O_NONBLOCK: poner O_NONBLOCK en el
+    // descriptor 1 lo pondría también en la entrada, que comparte la descripción.
+    // Solo con terminales: reabrir un archivo empezaría a escribir desde el inicio.
+    if (isatty(STDOUT_FILENO)) {
+        int fd = open("/proc/self/fd/1", O_WRONLY | O_NONBLOCK | O_NOCTTY | O_CLOEXEC);
+        if (fd >= 0) {
+            outFd = fd;
+            ownsOutFd = true;
+        }
+    }
+    const char* limit = getenv("PONG_OUTQ");
+    if (limit != nullptr && atoi(limit) > 0) fixedQueueLimit = static_cast<size_t>(atoi(limit));
+}
+
+PongRenderer::~PongRenderer() {
+    drainPending();
+    if (ownsOutFd) close(outFd);
 }
 
 void PongRenderer::updateScores(int p1, int p2) {
@@ -58,52 +103,92 @@ void PongRenderer::updatePlayerNames(const string& name1, const string& name2) {
     playerName2 = name2;
 }
 
+void PongRenderer::setStatusLine(const string& line) {
+    lock_guard<mutex> lock(renderMutex);
+    statusLine.assign(line);
+}
+
+void PongRenderer::setStatusLine(const char* line) {
+    lock_guard<mutex> lock(renderMutex);
+    statusLine.assign(line);
+}
+
 void PongRenderer::clearScreen() {
+    {
+        lock_guard<mutex> lock(renderMutex);
+        drainPending();
+    }
     system("clear");
 }
 
 void PongRenderer::renderScoreBoard() {
-    string name1 = playerName1.length() > 10 ? playerName1.substr(0, 10) : playerName1;
-    string name2 = playerName2.length() > 10 ? playerName2.substr(0, 10) : playerName2;
-    
-    cout << "==================================================\n";
-    cout << "  " << left << setw(12) << (name1 + ":") << setw(3) << scoreP1;
-    cout << "     " << left << setw(12) << (name2 + ":") << setw(3) << scoreP2;
-    cout << "\n";
-    cout << "==================================================\n";
+    lock_guard<mutex> lock(renderMutex);
+    drainPending();
+    scratch.clear();
+    appendScoreBoard(scratch);
+    cout.write(scratch.data(), scratch.size());
+    cout.flush();
+    // Se escribió fuera del codificador: ya no se sabe qué hay en pantalla
+    encoder.invalidate();
+}
+
+// "nombre:" (máximo 10 bytes del nombre) alineado a 12 columnas y el puntaje a 3,
+// igual que setw(12) / setw(3) con left
+static void appendPlayer(string& out, const string& name, int score) {
+    size_t start = out.size();
+    out.append(name, 0, 10);
+    out.push_back(':');
+    if (out.size() - start < 12) out.append(12 - (out.size() - start), ' ');
+    char number[16];
+    int len = snprintf(number, sizeof(number), "%-3d", score);
+    out.append(number, len);
+}
+
+void PongRenderer::appendScoreBoard(string& out) {
+    out.append("==================================================\n");
+    out.append("  ");
+    appendPlayer(out, playerName1, scoreP1);
+    out.append("     ");
+    appendPlayer(out, playerName2, scoreP2);
+    out.append("\n");
+    out.append("==================================================\n");
 }
 
 void PongRenderer::renderCourt() {
-    vector<string> screen(HEIGHT, string(WIDTH, ' '));
-    
-    for (int y = 0; y < HEIGHT; y++) {
-        screen[y][0] = '#';
-        screen[y][WIDTH - 1] = '#';
-        screen[y][WIDTH / 2] = '|';
-    }
-    
-    for (int i = 0; i < PADDLE_HEIGHT; i++) {
-        if (paddle1Y + i < HEIGHT) {
-            screen[paddle1Y + i][2] = '|';
-        }
+    lock_guard<mutex> lock(renderMutex);
+    drainPending();
+    scratch.clear();
+    appendCourt(scratch, ClassicCourt());
+    cout.write(scratch.data(), scratch.size());
+    encoder.invalidate();
+}
+
+template <typename Court>
+void PongRenderer::appendCourt(string& out, const Court& court) {
+    const int width = court.width;
+    const int height = court.height;
+    const size_t rowBytes = width + 1;
+    const size_t base = out.size();
+    for (int y = 0; y < height; y++) {
+        out.append(width, ' ');
+        out.push_back('\n');
+        char* row = &out[base + y * rowBytes];
+        row[0] = '#';
+        row[width - 1] = '#';
+        row[width / 2] = '|';
     }
-    
-    for (int i = 0; i < PADDLE_HEIGHT; i++) {
-        if (paddle2Y + i < HEIGHT) {
-            screen[paddle2Y + i][WIDTH - 3] = '|';
+
+    for (int i = 0; i < court.paddleHeight; i++) {
+        if (paddle1Y + i >= 0 && paddle1Y + i < height) {
+            out[base + (paddle1Y + i) * rowBytes + 2] = '|';
         }
-    }
-    
-    if (ballX >= 0 && ballX < WIDTH && ballY >= 0 && ballY < HEIGHT) {
-        if (ballDirX > 0) {
-            screen[ballY][ballX] = '>';
-        } else {
-            screen[ballY][ballX] = '<';
+        if (paddle2Y + i >= 0 && paddle2Y + i < height) {
+            out[base + (paddle2Y + i) * rowBytes + width - 3] = '|';
         }
     }
-    
-    for (int y = 0; y < HEIGHT; y++) {
-        cout << screen[y] << "\n";
+
+    if (ballX >= 0 && ballX < width && ballY >= 0 && ballY < height) {
+        out[base + ballY * rowBytes + ballX] = (ballDirX > 0) ? '>' : '<';
     }
 }
 
@@ -115,12 +200,244 @@ void PongRenderer::renderBall() {
     // Ya se dibuja en renderCourt()
 }
 
-void PongRenderer::renderGame() {
-    clearScreen();
-    renderScoreBoard();
-    renderCourt();
-    
-    cout << "Controles: W/S (P1) ↑/↓ (P2) | Q: Salir | R: Reiniciar\n";
-    cout << "==================================================\n";
+// Texto plano del frame con el estado actual
+template <typename Court>
+void PongRenderer::composeText(const Court& court) {
+    text.clear();
+    appendScoreBoard(text);
+    appendCourt(text, court);
+    text.append("Controles: W/S (P1) ↑/↓ (P2) | Q: Salir | R: Reiniciar | P: Pausa\n");
+    text.append("==================================================\n");
+    if (!statusLine.empty()) {
+        text.append(statusLine);
+        text.push_back('\n');
+    }
+}
+
+// Reparte el texto en las celdas del frame y marca la pelota en negrita
+template <typename Court>
+void PongRenderer::fillCells(const Court& court) {
+    frame.clear();
+    size_t pos = 0;
+    for (int row = 0; row < SCREEN_ROWS && pos < text.size(); row++) {
+        size_t end = text.find('\n', pos);
+        if (end == string::npos) end = text.size();
+        frame.put(row, 0, string_view(text).substr(pos, end - pos));
+        pos = end + 1;
+    }
+    if (ballX >= 0 && ballX < court.width && ballY >= 0 && ballY < court.height) {
+        frame.at(SCOREBOARD_ROWS + ballY, ballX).attr = ATTR_BOLD;
+    }
+}
+
+// Arma el frame con el estado actual y devuelve los bytes que lo pintan. Todo se
+// escribe en buffers reservados en el constructor: en estado estable no hay reservas.
+const string& PongRenderer::composeFrame() {
+    composeText(ClassicCourt());
+    if (!diffOutput) {
+        // Igual que antes: borrar (lo mismo que imprime clear) y repintar todo
+        fullBytes.assign("\x1b[H\x1b[2J\x1b[3J");
+        fullBytes.append(text);
+        return fullBytes;
+    }
+    fillCells(ClassicCourt());
+    return encoder.encode(frame);
+}
+
+const TermFrame& PongRenderer::layoutGame() {
+    lock_guard<mutex> lock(renderMutex);
+    composeText(ClassicCourt());
+    fillCells(ClassicCourt());
+    return frame;
+}
+
+// Bytes que aún no llegan a la terminal: los de la cola del tty más los pendientes
+size_t PongRenderer::queuedOutput() {
+    int queued = 0;
+    if (!ownsOutFd || ioctl(outFd, TIOCOUTQ, &queued) != 0 || queued < 0) queued = 0;
+    return static_cast<size_t>(queued) + (pendingOut.size() - pendingOffset);
+}
+
+// Intenta entregar lo pendiente sin bloquear; true si ya no queda nada
+bool PongRenderer::flushPending() {
+    while (pendingOffset < pendingOut.size()) {
+        ssize_t n = write(outFd, pendingOut.data() + pendingOffset, pendingOut.size() - pendingOffset);
+        if (n > 0) {
+            pendingOffset += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            return false;   // EAGAIN: la terminal no acepta más por ahora
+        }
+    }
+    pendingOut.clear();
+    pendingOffset = 0;
+    return true;
+}
+
+// Escribe el frame; lo que el descriptor no bloqueante no acepta queda pendiente
+void PongRenderer::writeOutput(const char* data, size_t len) {
+    if (pendingOffset < pendingOut.size()) {
+        // Frame forzado con la terminal atrasada: va detrás de lo pendiente
+        pendingOut.append(data, len);
+        return;
+    }
+    size_t written = 0;
+    while (written < len) {
+        ssize_t n = write(outFd, data + written, len - written);
+        if (n > 0) {
+            written += static_cast<size_t>(n);
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            break;
+        }
+    }
+    if (written < len) {
+        pendingOut.assign(data + written, len - written);
+        pendingOffset = 0;
+    }
+}
+
+// Antes de escribir por otro camino (cout, system): esperar lo pendiente (máximo 1 s)
+void PongRenderer::drainPending() {
+    for (int i = 0; i < 100 && !flushPending(); i++) {
+        struct pollfd pfd = {outFd, POLLOUT, 0};
+        poll(&pfd, 1, 10);
+    }
+}
+
+bool PongRenderer::renderGame() {
+    lock_guard<mutex> lock(renderMutex);
+    // Lo que otra pantalla haya dejado en cout va antes que el frame
     cout.flush();
-}
\ No newline at end of file
+
+    uint64_t now = monotonicNowNs();
+    if (probeOutstanding) {
+        lastLagNs = now - probeSentNs;
+        if (lastLagNs > maxLagNs) maxLagNs = lastLagNs;
+        // Dejó de responder (o nunca lo hizo): se deja de usar la sonda
+        if (lastLagNs > OUTPUT_PROBE_TIMEOUT_NS) {
+            probeOutstanding = false;
+            terminalAnswers = false;
+        }
+    }
+    size_t limit = fixedQueueLimit > 0 ? fixedQueueLimit : max(OUTPUT_QUEUE_MIN, 2 * lastFrameBytes);
+    bool caughtUp = flushPending();
+    lastQueueDepth = queuedOutput();
+    if (lastQueueDepth > maxQueueDepth) maxQueueDepth = lastQueueDepth;
+    bool lagging = terminalAnswers && probeOutstanding && lastLagNs > minRttNs + OUTPUT_LAG_SLACK_NS;
+    bool behind = !caughtUp || lastQueueDepth > limit || lagging;
+    if (behind && now - lastPresentNs < OUTPUT_MAX_SKIP_NS) {
+        // Sin armar el frame: el codificador sigue comparando contra lo último enviado,
+        // así que el próximo frame que salga junta todos los cambios omitidos
+        skippedFrames++;
+        return false;
+    }
+
+    const string& bytes = composeFrame();
+    writeOutput(bytes.data(), bytes.size());
+    lastFrameBytes = bytes.size();
+    lastPresentNs = now;
+    outputBytes += bytes.size();
+    // Si la grabación descartó este frame, los diferenciales siguientes no tendrían
+    // base en el .cast: el próximo frame sale completo
+    if (recorder && recorder->isOpen() && !recorder->push(bytes.data(), bytes.size())) encoder.invalidate();
+    outputFrames++;
+
+    // La sonda va después del frame: su respuesta confirma que el terminal lo procesó
+    if (probeEnabled && !probeOutstanding && now - probeSentNs >= OUTPUT_PROBE_INTERVAL_NS && ownsOutFd) {
+        writeOutput("\x1b[5n", 4);
+        probeOutstanding = true;
+        probeSentNs = now;
+    }
+    return true;
+}
+
+void PongRenderer::setOutputProbe(bool enabled) {
+    lock_guard<mutex> lock(renderMutex);
+    probeEnabled = enabled;
+    if (!enabled) terminalAnswers = false;
+}
+
+void PongRenderer::onStatusReply(uint64_t nowNs) {
+    lock_guard<mutex> lock(renderMutex);
+    // Respuesta tardía a una sonda ya descartada: no dice nada del frame actual
+    if (!probeOutstanding) return;
+    uint64_t rtt = nowNs - probeSentNs;
+    if (rtt < minRttNs) minRttNs = rtt;
+    lastLagNs = rtt;
+    probeOutstanding = false;
+    terminalAnswers = true;
+}
+
+const string& PongRenderer::encodeGame() {
+    lock_guard<mutex> lock(renderMutex);
+    const string& bytes = composeFrame();
+    outputBytes += bytes.size();
+    outputFrames++;
+    return bytes;
+}
+
+void PongRenderer::invalidateScreen() {
+    lock_guard<mutex> lock(renderMutex);
+    encoder.invalidate();
+}
+
+void PongRenderer::restoreTerminal() {
+    lock_guard<mutex> lock(renderMutex);
+    drainPending();
+    // La respuesta de la última sonda no debe llegarle al menú como teclas
+    if (probeOutstanding) {
+        awaitStatusReply(static_cast<int>(OUTPUT_PROBE_TIMEOUT_NS / 1000000ULL) / 10);
+        probeOutstanding = false;
+    }
+    if (diffOutput) {
+        cout << "\x1b[m\x1b[?25h";
+        cout.flush();
+    }
+    encoder.invalidate();
+}
+
+void PongRenderer::setRecorder(CastRecorder* rec) {
+    lock_guard<mutex> lock(renderMutex);
+    recorder = rec;
+    // La grabación empieza con un frame completo para poder reproducirse sola
+    encoder.invalidate();
+}
+
+void PongRenderer::resetOutputStats() {
+    lock_guard<mutex> lock(renderMutex);
+    outputFrames = 0;
+    outputBytes = 0;
+    skippedFrames = 0;
+    lastQueueDepth = 0;
+    maxQueueDepth = 0;
+    lastLagNs = 0;
+    maxLagNs = 0;
+}
+
+double PongRenderer::bytesPerFrame() {
+    lock_guard<mutex> lock(renderMutex);
+    return outputFrames > 0 ? static_cast<double>(outputBytes) / outputFrames : 0.0;
+}
+
+uint64_t PongRenderer::skippedFrameCount() {
+    lock_guard<mutex> lock(renderMutex);
+    return skippedFrames;
+}
+
+size_t PongRenderer::outputQueueDepth() {
+    lock_guard<mutex> lock(renderMutex);
+    return lastQueueDepth;
+}
+
+size_t PongRenderer::maxOutputQueueDepth() {
+    lock_guard<mutex> lock(renderMutex);
+    return maxQueueDepth;
+}
+
+uint64_t PongRenderer::maxOutputLagNs() {
+    lock_guard<mutex> lock(renderMutex);
+    return maxLagNs;
+}
@@ -0,0 +1,86 @@
+/****************************************************
+ * Archivo: pong_sim.cpp
+ * Descripción: Simulación de Pong sin terminal ni hilos: rebote en bordes, colisión
+ *              con paletas y punto para el rival cuando la pelota pasa la paleta. Se usa
+ *              para correr partidas a máxima velocidad en torneos y entrenamiento de IA.
+ *              simStepReference conserva la versión original con saltos.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "pong_sim.h"
+#include "step_kernel.h"
+
+uint32_t simRandom(SimState& state) {
+    uint32_t x = state.rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state.rng = x;
+    return x;
+}
+
+void simInit(SimState& state, uint32_t seed) {
+    state.scoreP1 = 0;
+    state.scoreP2 = 0;
+    state.paddle1Y = HEIGHT / 2 - PADDLE_HEIGHT / 2;
+    state.paddle2Y = HEIGHT / 2 - PADDLE_HEIGHT / 2;
+    state.rng = seed != 0 ? seed : 0x9E3779B9u;
+    state.tick = 0;
+    simResetBall(state);
+}
+
+void simResetBall(SimState& state) {
+    state.ballX = WIDTH / 2;
+    state.ballY = HEIGHT / 2;
+    state.ballSpeedX = (simRandom(state) % 2 == 0) ? 1 : -1;
+    state.ballSpeedY = (simRandom(state) % 2 == 0) ? 1 : -1;
+}
+
+void simStep(SimState& state, int moveP1, int moveP2) {
+    step(state, Inputs{moveP1, moveP2});
+}
+
+void simStepReference(SimState& state, int moveP1, int moveP2) {
+    auto inBounds = [](int y) {
+        if (y < 1) return 1;
+        if (y > HEIGHT - PADDLE_HEIGHT - 1) return HEIGHT - PADDLE_HEIGHT - 1;
+        return y;
+    };
+
+    state.paddle1Y = inBounds(state.paddle1Y + moveP1);
+    state.paddle2Y = inBounds(state.paddle2Y + moveP2);
+
+    // Mover pelota
+    state.ballX += state.ballSpeedX;
+    state.ballY += state.ballSpeedY;
+
+    // Rebotes con bordes superior e inferior
+    if (state.ballY <= 1 || state.ballY >= HEIGHT - 2) {
+        state.ballSpeedY = -state.ballSpeedY;
+    }
+
+    // Colisiones con paletas
+    if (state.ballX <= 3) {
+        if (state.ballY >= state.paddle1Y && state.ballY <= state.paddle1Y + PADDLE_HEIGHT) {
+            state.ballSpeedX = 1;
+        } else {
+            state.scoreP2++;
+            simResetBall(state);
+        }
+    }
+    if (state.ballX >= WIDTH - 4) {
+        if (state.ballY >= state.paddle2Y && state.ballY <= state.paddle2Y + PADDLE_HEIGHT) {
+            state.ballSpeedX = -1;
+        } else {
+            state.scoreP1++;
+            simResetBall(state);
+        }
+    }
+
+    state.tick++;
+}
@@ -0,0 +1,579 @@
+/****************************************************
+ * Archivo: pty_harness.cpp
+ * Descripción: Generador de carga de entrada y arnés de extremo a extremo. Ejecuta el
+ *              binario real de Pong dentro de un pseudo-terminal, navega mostrarMenu,
+ *              inyecta secuencias de teclas (guionizadas o aleatorias) a la tasa pedida
+ *              y captura toda la salida para medir entradas perdidas, FPS y CPU.
+ *              Con --throttle el maestro se lee a un ritmo fijo, como un enlace lento.
+ *              Con --hold emula teclas mantenidas con la auto-repetición de un terminal
+ *              (o, con --kitty, con los eventos de pulsar/repetir/soltar de kitty).
+ *              Con --mouse inunda la entrada con reportes SGR de movimiento del mouse.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "pty_harness.h"
+#include "latency.h"
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <dirent.h>
+
+using namespace std;
+
+struct HarnessOptions {
+    string mode = "jvj";
+    double rate = 100.0;        // eventos por segundo
+    double duration = 5.0;      // segundos de inyección
+    string script;              // w/s = P1, u/d = P2 (flechas); vacío = aleatorio
+    unsigned int seed = 1;
+    double drainTimeout = 10.0; // segundos para que el juego procese la cola tras 'q'
+    string capturePath;
+    double pauseSeconds = 0.0; // > 0: pausar (P) tras la inyección y medir al proceso quieto
+    string render;              // "full" | "diff" (PONG_RENDER del juego); vacío = por defecto
+    double throttle = 0.0;      // bytes/s leídos del maestro durante la partida; 0 = sin límite
+    bool allocCheck = false;    // falla si algún frame en estado estable reservó memoria
+    bool hold = false;          // teclas mantenidas en lugar de eventos sueltos a --rate
+    double holdSeconds = 1.0;   // duración de cada tecla mantenida
+    double holdGap = 0.3;       // pausa entre teclas mantenidas
+    double repeatDelay = 0.5;   // segundos hasta la primera auto-repetición
+    double repeatRate = 30.0;   // auto-repeticiones por segundo (con ±15% de jitter)
+    bool kitty = false;         // el terminal emulado acepta el protocolo de teclado de kitty
+    double mouseRate = 0.0;     // reportes de movimiento del mouse por segundo (P1); 0 = sin mouse
+    vector<string> gameArgs;    // lo que va después de "--" se pasa al juego
+};
+
+// Enlace lento simulado: cuántos bytes se pueden leer según el tiempo transcurrido
+struct LinkThrottle {
+    double bytesPerSec = 0.0;
+    uint64_t startNs = 0;
+    uint64_t bytesRead = 0;
+};
+static LinkThrottle slowLink;
+
+// Respuestas del terminal emulado a las consultas del juego: DA1 siempre y el
+// protocolo de teclado de kitty (CSI ? u) solo con --kitty
+struct TerminalReplies {
+    bool kitty = false;
+    size_t scanned = 0;
+};
+static TerminalReplies terminal;
+
+struct PtyChild {
+    int masterFd = -1;
+    pid_t pid = -1;
+};
+
+static bool parseOptions(int argc, char* argv[], HarnessOptions& opts) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--") {
+            opts.gameArgs.assign(argv + i + 1, argv + argc);
+            break;
+        }
+        if (arg == "--mode" && hasValue) opts.mode = argv[++i];
+        else if (arg == "--rate" && hasValue) opts.rate = atof(argv[++i]);
+        else if (arg == "--duration" && hasValue) opts.duration = atof(argv[++i]);
+        else if (arg == "--script" && hasValue) opts.script = argv[++i];
+        else if (arg == "--seed" && hasValue) opts.seed = static_cast<unsigned int>(atoi(argv[++i]));
+        else if (arg == "--capture" && hasValue) opts.capturePath = argv[++i];
+        else if (arg == "--drain-timeout" && hasValue) opts.drainTimeout = atof(argv[++i]);
+        else if (arg == "--pause" && hasValue) opts.pauseSeconds = atof(argv[++i]);
+        else if (arg == "--render" && hasValue) opts.render = argv[++i];
+        else if (arg == "--throttle" && hasValue) opts.throttle = atof(argv[++i]);
+        else if (arg == "--alloc-check") opts.allocCheck = true;
+        else if (arg == "--hold") opts.hold = true;
+        else if (arg == "--hold-seconds" && hasValue) opts.holdSeconds = atof(argv[++i]);
+        else if (arg == "--repeat-delay" && hasValue) opts.repeatDelay = atof(argv[++i]) / 1000.0;
+        else if (arg == "--repeat-rate" && hasValue) opts.repeatRate = atof(argv[++i]);
+        else if (arg == "--kitty") opts.kitty = true;
+        else if (arg == "--mouse" && hasValue) opts.mouseRate = atof(argv[++i]);
+        else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return false;
+        }
+    }
+    if (opts.mode != "jvj" && opts.mode != "jvc") {
+        cerr << "Modo no soportado por el arnés: " << opts.mode << " (usa jvj o jvc)\n";
+        return false;
+    }
+    if (opts.repeatRate <= 0 || opts.holdSeconds <= 0) {
+        cerr << "La auto-repetición y la duración de las teclas deben ser positivas\n";
+        return false;
+    }
+    if (opts.rate <= 0 || opts.duration <= 0) {
+        cerr << "La tasa y la duración deben ser positivas\n";
+        return false;
+    }
+    return true;
+}
+
+// Crea el par maestro/esclavo y ejecuta /proc/self/exe en el esclavo
+static bool spawnUnderPty(PtyChild& child, const HarnessOptions& opts) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        perror("posix_openpt");
+        return false;
+    }
+    const char* slaveName = ptsname(master);
+    if (slaveName == nullptr) {
+        perror("ptsname");
+        close(master);
+        return false;
+    }
+    string slavePath = slaveName;
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(master);
+        return false;
+    }
+    if (pid == 0) {
+        setsid();
+        int slave = open(slavePath.c_str(), O_RDWR);
+        if (slave < 0) _exit(127);
+        ioctl(slave, TIOCSCTTY, 0);
+        struct winsize ws = {40, 100, 0, 0};
+        ioctl(slave, TIOCSWINSZ, &ws);
+        dup2(slave, STDIN_FILENO);
+        dup2(slave, STDOUT_FILENO);
+        dup2(slave, STDERR_FILENO);
+        if (slave > STDERR_FILENO) close(slave);
+        close(master);
+        setenv("TERM", "xterm", 1);
+        setenv("PONG_HARNESS", "1", 1);
+        if (!opts.render.empty()) setenv("PONG_RENDER", opts.render.c_str(), 1);
+        vector<char*> args;
+        args.push_back(const_cast<char*>("Pong"));
+        for (const auto& arg : opts.gameArgs) args.push_back(const_cast<char*>(arg.c_str()));
+        args.push_back(nullptr);
+        execv("/proc/self/exe", args.data());
+        _exit(127);
+    }
+
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    child.masterFd = master;
+    child.pid = pid;
+    return true;
+}
+
+// Contesta las consultas que el juego escribió desde la última revisión
+static void answerQueries(int fd, const string& output) {
+    const string KITTY_QUERY = "\x1b[?u";
+    const string DA1_QUERY = "\x1b[c";
+    const string DSR_QUERY = "\x1b[5n";
+    size_t from = terminal.scanned > 4 ? terminal.scanned - 4 : 0;
+    string replies;
+    // Solo cuentan las consultas que terminan en lo recién leído (ya contestadas si no)
+    auto fresh = [&](size_t pos, const string& query) {
+        return output.compare(pos, query.size(), query) == 0 && pos + query.size() > terminal.scanned;
+    };
+    for (size_t pos = output.find("\x1b[", from); pos != string::npos; pos = output.find("\x1b[", pos + 1)) {
+        if (terminal.kitty && fresh(pos, KITTY_QUERY)) replies += "\x1b[?0u";
+        if (fresh(pos, DA1_QUERY)) replies += "\x1b[?62;22c";
+        if (fresh(pos, DSR_QUERY)) replies += "\x1b[0n";
+    }
+    terminal.scanned = output.size();
+    if (!replies.empty() && write(fd, replies.data(), replies.size()) < 0) { /* el juego ya salió */ }
+}
+
+// Lee lo disponible del maestro (hasta lo que permita el enlace simulado)
+static size_t drainOutput(int fd, string& output, int timeoutMs) {
+    struct pollfd pfd = {fd, POLLIN, 0};
+    size_t total = 0;
+    size_t allowed = 65536;
+    if (slowLink.bytesPerSec > 0) {
+        double budget = slowLink.bytesPerSec * (monotonicNowNs() - slowLink.startNs) / 1e9 - slowLink.bytesRead;
+        if (budget < 1) {
+            usleep(static_cast<useconds_t>(min(timeoutMs, 5)) * 1000);
+            return 0;
+        }
+        allowed = static_cast<size_t>(min(budget, 65536.0));
+    }
+    if (poll(&pfd, 1, timeoutMs) <= 0) return 0;
+    char buffer[65536];
+    while (total < allowed) {
+        ssize_t n = read(fd, buffer, allowed - total);
+        if (n <= 0) break;
+        slowLink.bytesRead += static_cast<uint64_t>(n);
+        output.append(buffer, static_cast<size_t>(n));
+        total += static_cast<size_t>(n);
+    }
+    if (total > 0) answerQueries(fd, output);
+    return total;
+}
+
+static void sendKeys(int fd, const string& keys, string& output) {
+    size_t offset = 0;
+    while (offset < keys.size()) {
+        ssize_t n = write(fd, keys.data() + offset, keys.size() - offset);
+        if (n > 0) {
+            offset += static_cast<size_t>(n);
+        } else {
+            // El esclavo tiene el buffer lleno: vaciar salida para no bloquear al juego
+            drainOutput(fd, output, 1);
+        }
+    }
+}
+
+// Espera hasta que aparezca un texto en la salida (o se acabe el tiempo)
+static bool waitFor(int fd, string& output, const string& text, size_t from, int timeoutMs) {
+    uint64_t deadline = monotonicNowNs() + static_cast<uint64_t>(timeoutMs) * 1000000ULL;
+    while (output.find(text, from) == string::npos) {
+        if (monotonicNowNs() > deadline) return false;
+        drainOutput(fd, output, 10);
+    }
+    return true;
+}
+
+// CPU (ns, de schedstat) y cambios de contexto sumados sobre todos los hilos del hijo
+struct ProcessActivity {
+    unsigned long long cpuNs = 0;
+    unsigned long long contextSwitches = 0;
+    int threads = 0;
+};
+
+static ProcessActivity sampleActivity(pid_t pid) {
+    ProcessActivity activity;
+    string taskDir = "/proc/" + to_string(pid) + "/task";
+    DIR* dir = opendir(taskDir.c_str());
+    if (dir == nullptr) return activity;
+    while (struct dirent* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') continue;
+        string base = taskDir + "/" + entry->d_name;
+        ifstream sched(base + "/schedstat");
+        unsigned long long runNs = 0;
+        if (sched >> runNs) activity.cpuNs += runNs;
+        ifstream status(base + "/status");
+        string line;
+        while (getline(status, line)) {
+            if (line.compare(0, 23, "voluntary_ctxt_switches") == 0 ||
+                line.compare(0, 26, "nonvoluntary_ctxt_switches") == 0) {
+                activity.contextSwitches += strtoull(line.c_str() + line.find(':') + 1, nullptr, 10);
+            }
+        }
+        activity.threads++;
+    }
+    closedir(dir);
+    return activity;
+}
+
+// Tecla mantenida emulada: pulsación, auto-repetición tras repeatDelay y soltar
+// (el soltar solo lo ve el juego con --kitty). Se alternan arriba y abajo.
+struct EmulatedHold {
+    int player = 1;
+    int cycle = 0;
+    bool down = false;
+    uint64_t nextNs = 0;        // próxima pulsación (suelta) o repetición (mantenida)
+    uint64_t releaseNs = 0;
+};
+
+// Secuencia que envía el terminal para una tecla de movimiento
+static string encodeKey(bool kitty, int player, bool up, int action) {
+    if (!kitty) {
+        if (player == 1) return up ? "w" : "s";
+        return up ? "\x1b[A" : "\x1b[B";
+    }
+    // kitty: CSI código ; mods:evento u (1 = pulsar, 2 = repetir, 3 = soltar)
+    const char* events[] = {"", ";1:2", ";1:3"};
+    if (player == 1) return string("\x1b[") + (up ? "119" : "115") + events[action] + "u";
+    if (action == 0) return up ? "\x1b[A" : "\x1b[B";
+    return string("\x1b[1") + events[action] + (up ? "A" : "B");
+}
+
+static unsigned long long parseStat(const string& line, const string& key) {
+    size_t pos = line.find(key + "=");
+    if (pos == string::npos) return 0;
+    return strtoull(line.c_str() + pos + key.size() + 1, nullptr, 10);
+}
+
+int runPtyHarness(int argc, char* argv[]) {
+    HarnessOptions opts;
+    if (!parseOptions(argc, argv, opts)) return 2;
+
+    terminal.kitty = opts.kitty;
+    terminal.scanned = 0;
+    PtyChild child;
+    if (!spawnUnderPty(child, opts)) return 1;
+    int fd = child.masterFd;
+    string output;
+
+    const string DOWN = "\x1b[B";
+    const string UP = "\x1b[A";
+
+    // Menú principal -> modo elegido
+    if (!waitFor(fd, output, "Enter para seleccionar", 0, 5000)) {
+        cerr << "El menú no apareció\n";
+        kill(child.pid, SIGKILL);
+        return 1;
+    }
+    string navigate = DOWN;
+    if (opts.mode == "jvc") navigate += DOWN;
+    sendKeys(fd, navigate + "\n", output);
+
+    // Nombres fijos (una línea vacía para P1 se la come el cin.ignore de getPlayerNames)
+    waitFor(fd, output, "Jugador 1 (izquierda)", 0, 5000);
+    sendKeys(fd, "Bot1\n", output);
+    waitFor(fd, output, "Jugador 2 (derecha)", 0, 5000);
+    sendKeys(fd, "Bot2\n", output);
+    waitFor(fd, output, "para comenzar", 0, 5000);
+    sendKeys(fd, " ", output);
+    size_t matchStart = output.size();
+    waitFor(fd, output, "Controles:", matchStart, 5000);
+    slowLink.bytesPerSec = opts.throttle;
+    slowLink.startNs = monotonicNowNs();
+    slowLink.bytesRead = 0;
+
+    // Inyección de eventos a la tasa pedida
+    srand(opts.seed);
+    const bool allowP2 = (opts.mode == "jvj");
+    unsigned long long injected[2] = {0, 0};
+    uint64_t startNs = monotonicNowNs();
+    uint64_t endNs = startNs + static_cast<uint64_t>(opts.duration * 1e9);
+    unsigned long long scheduled = 0;
+    size_t scriptPos = 0;
+
+    // Teclas mantenidas: como en un teclado real, solo se auto-repite la última tecla
+    // pulsada aunque la otra siga abajo
+    vector<EmulatedHold> holds(allowP2 ? 2 : 1);
+    for (size_t h = 0; h < holds.size(); h++) {
+        holds[h].player = static_cast<int>(h) + 1;
+        holds[h].nextNs = startNs + static_cast<uint64_t>(h * (opts.holdSeconds + opts.holdGap) * 0.5e9);
+    }
+    int lastPressed = -1;
+    uint64_t repeatNs = static_cast<uint64_t>(1e9 / opts.repeatRate);
+
+    while (opts.hold && monotonicNowNs() < endNs) {
+        uint64_t now = monotonicNowNs();
+        string batch;
+        for (size_t h = 0; h < holds.size(); h++) {
+            EmulatedHold& hold = holds[h];
+            bool up = (hold.cycle % 2 == 0);
+            if (!hold.down && now >= hold.nextNs) {
+                batch += encodeKey(opts.kitty, hold.player, up, 0);
+                injected[hold.player - 1]++;
+                hold.down = true;
+                hold.releaseNs = now + static_cast<uint64_t>(opts.holdSeconds * 1e9);
+                hold.nextNs = now + static_cast<uint64_t>(opts.repeatDelay * 1e9);
+                lastPressed = static_cast<int>(h);
+            } else if (hold.down && now >= hold.releaseNs) {
+                if (opts.kitty) batch += encodeKey(true, hold.player, up, 2);
+                hold.down = false;
+                hold.cycle++;
+                hold.nextNs = now + static_cast<uint64_t>(opts.holdGap * 1e9);
+            } else if (hold.down && now >= hold.nextNs) {
+                if (lastPressed == static_cast<int>(h)) {
+                    batch += encodeKey(opts.kitty, hold.player, up, 1);
+                    injected[hold.player - 1]++;
+                }
+                hold.nextNs = now + repeatNs * (85 + rand() % 31) / 100;
+            }
+        }
+        if (!batch.empty()) sendKeys(fd, batch, output);
+        drainOutput(fd, output, 1);
+    }
+
+    unsigned long long mouseSent = 0;
+    while (!opts.hold && monotonicNowNs() < endNs) {
+        double elapsed = (monotonicNowNs() - startNs) / 1e9;
+        unsigned long long due = static_cast<unsigned long long>(elapsed * opts.rate);
+        string batch;
+        // Mouse: el puntero sube y baja por la mitad de P1 (CSI < 35 ; col ; fila M)
+        unsigned long long mouseDue = static_cast<unsigned long long>(elapsed * opts.mouseRate);
+        for (; mouseSent < mouseDue; mouseSent++) {
+            int row = static_cast<int>(mouseSent / 4 % 50);
+            row = 4 + (row < 25 ? row : 49 - row);
+            batch += "\x1b[<35;20;" + to_string(row) + "M";
+        }
+        for (; scheduled < due; scheduled++) {
+            char key;
+            if (!opts.script.empty()) {
+                key = opts.script[scriptPos++ % opts.script.size()];
+            } else {
+                const char choices[] = {'w', 's', 'u', 'd'};
+                key = choices[rand() % (allowP2 ? 4 : 2)];
+            }
+            if (key == 'w' || key == 's') {
+                batch += key;
+                injected[0]++;
+            } else if ((key == 'u' || key == 'd') && allowP2) {
+                batch += (key == 'u') ? UP : DOWN;
+                injected[1]++;
+            }
+        }
+        if (!batch.empty()) sendKeys(fd, batch, output);
+        drainOutput(fd, output, 1);
+    }
+    uint64_t injectEndNs = monotonicNowNs();
+
+    // Dar tiempo a que se procese la cola antes de salir
+    for (int i = 0; i < 50; i++) drainOutput(fd, output, 10);
+
+    // Pausa: tras el aviso, el proceso no debería ejecutar nada hasta reanudar
+    bool pauseMeasured = false;
+    ProcessActivity pauseBefore, pauseAfter;
+    size_t pauseBytes = 0;
+    double pauseWallSecs = 0.0;
+    if (opts.pauseSeconds > 0) {
+        size_t pauseFrom = output.size();
+        sendKeys(fd, "p", output);
+        if (waitFor(fd, output, "PAUSA", pauseFrom, 3000)) {
+            for (int i = 0; i < 10; i++) drainOutput(fd, output, 10);
+            size_t bytesBefore = output.size();
+            pauseBefore = sampleActivity(child.pid);
+            uint64_t pauseStart = monotonicNowNs();
+            uint64_t pauseEnd = pauseStart + static_cast<uint64_t>(opts.pauseSeconds * 1e9);
+            while (monotonicNowNs() < pauseEnd) drainOutput(fd, output, 50);
+            pauseAfter = sampleActivity(child.pid);
+            pauseWallSecs = (monotonicNowNs() - pauseStart) / 1e9;
+            pauseBytes = output.size() - bytesBefore;
+            pauseMeasured = true;
+        } else {
+            cerr << "El juego no mostró el aviso de pausa\n";
+        }
+        sendKeys(fd, "p", output);
+        for (int i = 0; i < 20; i++) drainOutput(fd, output, 10);
+    }
+
+    // Fin de la medición: desde aquí se lee sin límite para que el juego salga rápido
+    uint64_t matchEndNs = monotonicNowNs();
+    size_t matchBytes = output.size() - matchStart;
+    slowLink.bytesPerSec = 0;
+    sendKeys(fd, "q", output);
+
+    size_t statsPos = output.find("PONG_STATS", matchStart);
+    int drainMs = static_cast<int>(opts.drainTimeout * 1000);
+    if (statsPos == string::npos && waitFor(fd, output, "PONG_STATS", matchStart, drainMs)) {
+        statsPos = output.find("PONG_STATS", matchStart);
+    }
+    string statsLine;
+    if (statsPos != string::npos) {
+        waitFor(fd, output, "\n", statsPos, 1000);
+        statsLine = output.substr(statsPos, output.find('\n', statsPos) - statsPos);
+    }
+
+    // Salir del reporte de latencia y del menú (Salir es la última opción)
+    sendKeys(fd, " ", output);
+    waitFor(fd, output, "Enter para seleccionar", statsPos == string::npos ? matchStart : statsPos, 3000);
+    sendKeys(fd, UP + "\n", output);
+
+    int status = 0;
+    struct rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    uint64_t exitDeadline = monotonicNowNs() + 3000000000ULL;
+    pid_t done = 0;
+    while ((done = wait4(child.pid, &status, WNOHANG, &usage)) == 0) {
+        if (monotonicNowNs() > exitDeadline) {
+            kill(child.pid, SIGKILL);
+            wait4(child.pid, &status, 0, &usage);
+            break;
+        }
+        drainOutput(fd, output, 10);
+    }
+    uint64_t wallNs = monotonicNowNs() - startNs;
+    close(fd);
+
+    if (!opts.capturePath.empty()) {
+        ofstream capture(opts.capturePath, ios::binary);
+        capture << output;
+    }
+
+    double injectSecs = (injectEndNs - startNs) / 1e9;
+    double cpuSecs = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+                     usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+    unsigned long long applied[2] = {parseStat(statsLine, "p1_events"), parseStat(statsLine, "p2_events")};
+    unsigned long long frames = parseStat(statsLine, "frames");
+    double matchSecs = (matchEndNs - startNs) / 1e9 - (pauseMeasured ? pauseWallSecs : 0.0);
+
+    cout << "========================================\n";
+    cout << "           ARNÉS PTY - RESULTADOS       \n";
+    cout << "========================================\n";
+    if (opts.hold) {
+        cout << "Modo: " << opts.mode << "  teclas mantenidas " << opts.holdSeconds << " s, auto-repetición "
+             << opts.repeatDelay * 1000 << " ms + " << opts.repeatRate << " Hz"
+             << (opts.kitty ? " (kitty)" : "") << "  duración: " << injectSecs << " s\n";
+    } else {
+        cout << "Modo: " << opts.mode << "  tasa: " << opts.rate << " ev/s  duración: " << injectSecs << " s\n";
+    }
+    for (int p = 0; p < 2; p++) {
+        if (injected[p] == 0 && applied[p] == 0) continue;
+        long long dropped = static_cast<long long>(injected[p]) - static_cast<long long>(applied[p]);
+        cout << "P" << (p + 1) << ": inyectados " << injected[p]
+             << "  aplicados " << applied[p]
+             << "  perdidos " << dropped << "\n";
+    }
+    if (statsLine.empty()) {
+        cout << "(el juego no terminó en " << opts.drainTimeout
+             << " s tras 'q': la entrada sigue encolada en la terminal, no se pueden contar pérdidas)\n";
+    }
+    cout << "Frames: " << frames << "  FPS: " << (frames / matchSecs) << "\n";
+    cout << "Bytes de salida: " << output.size() << "  en partida: " << matchBytes;
+    if (frames > 0) cout << "  (" << matchBytes / frames << " bytes/frame)";
+    cout << "\n";
+    if (opts.throttle > 0) cout << "Enlace limitado a " << opts.throttle << " bytes/s\n";
+    if (mouseSent > 0 && !statsLine.empty()) {
+        unsigned long long mouseApplied = parseStat(statsLine, "mouse_applied");
+        cout << "Mouse: inyectados " << mouseSent << "  leídos " << parseStat(statsLine, "mouse_reports")
+             << "  posiciones aplicadas " << mouseApplied;
+        if (frames > 0) cout << " (" << static_cast<double>(mouseApplied) / frames << " por frame)";
+        cout << "  lecturas máx entre ticks " << parseStat(statsLine, "mouse_max_burst") << "\n";
+    }
+    if (!statsLine.empty()) {
+        unsigned long long skipped = parseStat(statsLine, "skipped_frames");
+        cout << "Frames omitidos por contrapresión: " << skipped << "  (pintados + omitidos: "
+             << (frames + skipped) / matchSecs << "/s)"
+             << "\nCola de salida máx: " << parseStat(statsLine, "max_outq") << " bytes"
+             << "  atraso máx: " << parseStat(statsLine, "max_lag_us") / 1000.0 << " ms\n";
+    }
+    if (pauseMeasured) {
+        cout << "Pausa: " << pauseWallSecs << " s  hilos " << pauseAfter.threads
+             << "  CPU " << (pauseAfter.cpuNs - pauseBefore.cpuNs) / 1000 << " us"
+             << "  cambios de contexto " << (pauseAfter.contextSwitches - pauseBefore.contextSwitches)
+             << "  bytes de salida " << pauseBytes << "\n";
+    }
+    cout << "CPU: " << cpuSecs << " s (" << (100.0 * cpuSecs / (wallNs / 1e9)) << "% de un núcleo)\n";
+
+    for (int p = 1; p <= 2 && !statsLine.empty(); p++) {
+        string prefix = "p" + to_string(p) + "_";
+        unsigned long long moves = parseStat(statsLine, prefix + "moves");
+        if (moves == 0) continue;
+        cout << "Paleta P" << p << (parseStat(statsLine, "kitty") ? " (kitty)" : "") << ": " << moves
+             << " pasos, intervalo ms p50 " << parseStat(statsLine, prefix + "step_p50_us") / 1000.0
+             << " p99 " << parseStat(statsLine, prefix + "step_p99_us") / 1000.0
+             << " máx " << parseStat(statsLine, prefix + "step_max_us") / 1000.0
+             << " | latencia tecla -> frame ms p50 " << parseStat(statsLine, prefix + "key_p50_us") / 1000.0
+             << " p99 " << parseStat(statsLine, prefix + "key_p99_us") / 1000.0 << "\n";
+    }
+
+    unsigned long long steadyFrames = parseStat(statsLine, "steady_frames");
+    unsigned long long steadyAllocs = parseStat(statsLine, "steady_allocs");
+    if (!statsLine.empty()) {
+        cout << "Reservas de memoria: " << steadyAllocs << " en " << steadyFrames
+             << " frames estables (peor frame: " << parseStat(statsLine, "worst_frame_allocs") << ")\n";
+    }
+    if (opts.allocCheck && (statsLine.empty() || steadyFrames == 0 || steadyAllocs > 0)) {
+        cout << "FALLA: el bucle de juego reservó memoria en estado estable\n";
+        return 1;
+    }
+    return 0;
+}
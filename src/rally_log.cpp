@@ -0,0 +1,495 @@
+/****************************************************
+ * Archivo: rally_log.cpp
+ * Descripción: Registro columnar de eventos de peloteo (golpes, fallos y saques)
+ *              para partidas en vivo y sin terminal, y su analizador fuera de línea:
+ *              mapea el archivo con mmap y recorre las columnas con vectores de 32
+ *              bytes (extensiones de GCC) para contar, sumar y armar mapas de calor.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "rally_log.h"
+#include "latency.h"
+#include "async_log.h"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const char FILE_MAGIC[8] = {'P', 'O', 'N', 'G', 'R', 'L', 'Y', '1'};
+static const char BLOCK_MAGIC[4] = {'R', 'B', 'L', 'K'};
+static const size_t FILE_HEADER_BYTES = 32;
+static const size_t BLOCK_HEADER_BYTES = 32;    // "RBLK", eventos (u32), sesión (u64), ceros
+static const size_t BLOCK_SESSION_OFFSET = 8;
+
+static size_t pad32(size_t bytes) {
+    return (bytes + 31) & ~static_cast<size_t>(31);
+}
+
+// Posición de cada columna dentro de un bloque de n eventos
+struct BlockLayout {
+    size_t kind, side, offset, ballY, rally, tick, match, total;
+
+    explicit BlockLayout(size_t n) {
+        kind = BLOCK_HEADER_BYTES;
+        side = kind + pad32(n);
+        offset = side + pad32(n);
+        ballY = offset + pad32(n);
+        rally = ballY + pad32(n);
+        tick = rally + pad32(n * sizeof(uint16_t));
+        match = tick + pad32(n * sizeof(uint32_t));
+        total = match + pad32(n * sizeof(uint32_t));
+    }
+};
+
+// ===================== COLUMNAS Y SEGUIMIENTO =====================
+
+void RallyColumns::add(int k, int s, int o, int y, int r, uint32_t t, uint32_t m) {
+    kind.push_back(static_cast<uint8_t>(k));
+    side.push_back(static_cast<uint8_t>(s));
+    offset.push_back(static_cast<uint8_t>(o));
+    ballY.push_back(static_cast<uint8_t>(y));
+    rally.push_back(static_cast<uint16_t>(r));
+    tick.push_back(t);
+    match.push_back(m);
+}
+
+void RallyColumns::append(const RallyColumns& other) {
+    kind.insert(kind.end(), other.kind.begin(), other.kind.end());
+    side.insert(side.end(), other.side.begin(), other.side.end());
+    offset.insert(offset.end(), other.offset.begin(), other.offset.end());
+    ballY.insert(ballY.end(), other.ballY.begin(), other.ballY.end());
+    rally.insert(rally.end(), other.rally.begin(), other.rally.end());
+    tick.insert(tick.end(), other.tick.begin(), other.tick.end());
+    match.insert(match.end(), other.match.begin(), other.match.end());
+}
+
+void RallyColumns::clear() {
+    kind.clear();
+    side.clear();
+    offset.clear();
+    ballY.clear();
+    rally.clear();
+    tick.clear();
+    match.clear();
+}
+
+void RallyColumns::reserve(size_t events) {
+    kind.reserve(events);
+    side.reserve(events);
+    offset.reserve(events);
+    ballY.reserve(events);
+    rally.reserve(events);
+    tick.reserve(events);
+    match.reserve(events);
+}
+
+RallyTracker::RallyTracker(uint32_t id, bool serve) : matchId(id), serveOnMiss(serve), rallyHits(0) {}
+
+void RallyTracker::reset(uint32_t id, bool serve) {
+    matchId = id;
+    serveOnMiss = serve;
+    rallyHits = 0;
+}
+
+void RallyTracker::recordChange(const World& before, const World& after, int scorer, RallyColumns& out) {
+    if (scorer != STEP_NO_SCORE) {
+        // La pelota ya volvió al centro: la fila del fallo es la que tenía al llegar
+        int loser = (scorer == STEP_SCORE_P1) ? 2 : 1;
+        int missY = stepClamp(before.ballY + before.ballSpeedY, 0, HEIGHT - 1);
+        out.add(RALLY_MISS, loser, 0, missY, rallyHits, before.tick, matchId);
+        rallyHits = 0;
+        if (serveOnMiss) recordServe(after, out);
+        return;
+    }
+    // Cambio de dirección horizontal sin punto = golpe de paleta
+    int hitter = (after.ballSpeedX > 0) ? 1 : 2;
+    int paddleY = (hitter == 1) ? after.paddle1Y : after.paddle2Y;
+    if (rallyHits < UINT16_MAX) rallyHits++;
+    out.add(RALLY_HIT, hitter, stepClamp(after.ballY - paddleY, 0, PADDLE_HEIGHT), after.ballY,
+            rallyHits, after.tick, matchId);
+}
+
+void RallyTracker::recordServe(const World& state, RallyColumns& out) {
+    int receiver = (state.ballSpeedX > 0) ? 2 : 1;
+    out.add(RALLY_SERVE, receiver, state.ballSpeedY > 0 ? 1 : 0, state.ballY, 0, state.tick, matchId);
+    rallyHits = 0;
+}
+
+// ===================== ARCHIVO =====================
+
+RallyLog::RallyLog() : fd(-1), written(0), session(0), nextMatch(0) {}
+
+RallyLog::~RallyLog() {
+    close();
+}
+
+bool RallyLog::open(const string& path) {
+    close();
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size == 0) {
+        char header[FILE_HEADER_BYTES] = {0};
+        memcpy(header, FILE_MAGIC, sizeof(FILE_MAGIC));
+        if (write(fd, header, sizeof(header)) != static_cast<ssize_t>(sizeof(header))) {
+            close();
+            return false;
+        }
+    }
+    // Sesión aleatoria (0 queda para los bloques escritos antes de que existiera)
+    random_device entropy;
+    session = (static_cast<uint64_t>(entropy()) << 32 | entropy()) ^ monotonicNowNs();
+    if (session == 0) session = 1;
+    nextMatch.store(0, memory_order_relaxed);
+    written = 0;
+    return true;
+}
+
+void RallyLog::flush() {
+    lock_guard<mutex> lock(writeMutex);
+    if (fd < 0) return;
+    writeBlocks(staged);
+    staged.clear();
+}
+
+void RallyLog::close() {
+    lock_guard<mutex> lock(writeMutex);
+    if (fd >= 0) {
+        writeBlocks(staged);
+        staged.clear();
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void RallyLog::append(const RallyColumns& columns) {
+    lock_guard<mutex> lock(writeMutex);
+    if (fd < 0) return;
+    writeBlocks(columns);
+}
+
+// Una partida no se parte entre bloques salvo que sola llene uno
+void RallyLog::appendBatched(const RallyColumns& columns) {
+    lock_guard<mutex> lock(writeMutex);
+    if (fd < 0) return;
+    if (staged.size() + columns.size() > BLOCK_EVENTS) {
+        writeBlocks(staged);
+        staged.clear();
+    }
+    if (columns.size() >= BLOCK_EVENTS) {
+        writeBlocks(columns);
+        return;
+    }
+    if (staged.size() == 0) staged.reserve(BLOCK_EVENTS);
+    staged.append(columns);
+}
+
+// Un write() por bloque: con O_APPEND los bloques de distintos hilos no se mezclan
+void RallyLog::writeBlocks(const RallyColumns& columns) {
+    for (size_t first = 0; first < columns.size(); first += BLOCK_EVENTS) {
+        size_t n = min(BLOCK_EVENTS, columns.size() - first);
+        BlockLayout layout(n);
+        buffer.assign(layout.total, 0);
+        memcpy(buffer.data(), BLOCK_MAGIC, sizeof(BLOCK_MAGIC));
+        uint32_t count = static_cast<uint32_t>(n);
+        memcpy(buffer.data() + sizeof(BLOCK_MAGIC), &count, sizeof(count));
+        memcpy(buffer.data() + BLOCK_SESSION_OFFSET, &session, sizeof(session));
+        memcpy(buffer.data() + layout.kind, columns.kind.data() + first, n);
+        memcpy(buffer.data() + layout.side, columns.side.data() + first, n);
+        memcpy(buffer.data() + layout.offset, columns.offset.data() + first, n);
+        memcpy(buffer.data() + layout.ballY, columns.ballY.data() + first, n);
+        memcpy(buffer.data() + layout.rally, columns.rally.data() + first, n * sizeof(uint16_t));
+        memcpy(buffer.data() + layout.tick, columns.tick.data() + first, n * sizeof(uint32_t));
+        memcpy(buffer.data() + layout.match, columns.match.data() + first, n * sizeof(uint32_t));
+        if (write(fd, buffer.data(), buffer.size()) != static_cast<ssize_t>(buffer.size())) {
+            logWrite(LOG_ERROR, "No se pudo escribir el registro de peloteos: %s", strerror(errno));
+            return;
+        }
+        written += n;
+    }
+}
+
+// ===================== ANÁLISIS =====================
+
+typedef uint8_t v16u8 __attribute__((vector_size(16)));
+typedef uint8_t v32u8 __attribute__((vector_size(32)));
+typedef uint16_t v16u16 __attribute__((vector_size(32)));
+typedef uint32_t v16u32 __attribute__((vector_size(64)));
+
+struct RallyStats {
+    uint64_t events = 0;
+    uint64_t blocks = 0;
+    uint64_t byKind[3][2] = {{0}};          // [tipo][lado - 1]
+    uint64_t rallySum = 0;                  // suma de largos en los fallos
+    uint32_t rallyMax = 0;
+    uint64_t aces = 0;                      // fallos sin ningún golpe (saque ganador)
+    uint64_t heat[3][2][32] = {{{0}}};      // [tipo][lado - 1][fila]
+    uint64_t hitOffset[2][8] = {{0}};       // [lado - 1][fila de la paleta]
+};
+
+static void analyzeBlock(const uint8_t* kind, const uint8_t* side, const uint8_t* offset,
+                         const uint8_t* ballY, const uint16_t* rally, size_t n, RallyStats& stats) {
+    // Conteo por (tipo, lado): 32 eventos por iteración, contadores de 8 bits que se
+    // vuelcan antes de desbordar
+    size_t i = 0;
+    v32u8 acc[6] = {};
+    int pending = 0;
+    auto flushCounts = [&]() {
+        for (int key = 0; key < 6; key++) {
+            for (int lane = 0; lane < 32; lane++) stats.byKind[key / 2][key % 2] += acc[key][lane];
+            acc[key] = v32u8{};
+        }
+        pending = 0;
+    };
+    for (; i + 32 <= n; i += 32) {
+        v32u8 k, s;
+        memcpy(&k, kind + i, 32);
+        memcpy(&s, side + i, 32);
+        v32u8 key = k * 2 + s - 1;
+        for (int j = 0; j < 6; j++) acc[j] -= reinterpret_cast<v32u8>(key == static_cast<uint8_t>(j));
+        if (++pending == 255) flushCounts();
+    }
+    flushCounts();
+    for (; i < n; i++) {
+        if (kind[i] < 3 && (side[i] == 1 || side[i] == 2)) stats.byKind[kind[i]][side[i] - 1]++;
+    }
+
+    // Largo de peloteo en los fallos: suma, máximo y saques ganadores, 16 por iteración
+    size_t j = 0;
+    v16u32 sum = {};
+    v16u32 aces = {};
+    v16u16 longest = {};
+    for (; j + 16 <= n; j += 16) {
+        v16u8 k8;
+        v16u16 r;
+        memcpy(&k8, kind + j, 16);
+        memcpy(&r, rally + j, 32);
+        v16u16 k = __builtin_convertvector(k8, v16u16);
+        v16u16 miss = reinterpret_cast<v16u16>(k == static_cast<uint16_t>(RALLY_MISS));
+        v16u16 length = r & miss;
+        sum += __builtin_convertvector(length, v16u32);
+        longest = longest > length ? longest : length;
+        v16u16 ace = reinterpret_cast<v16u16>(length == static_cast<uint16_t>(0)) & miss & static_cast<uint16_t>(1);
+        aces += __builtin_convertvector(ace, v16u32);
+    }
+    for (int lane = 0; lane < 16; lane++) {
+        stats.rallySum += sum[lane];
+        stats.aces += aces[lane];
+        stats.rallyMax = max<uint32_t>(stats.rallyMax, longest[lane]);
+    }
+    for (; j < n; j++) {
+        if (kind[j] != RALLY_MISS) continue;
+        stats.rallySum += rally[j];
+        stats.rallyMax = max<uint32_t>(stats.rallyMax, rally[j]);
+        if (rally[j] == 0) stats.aces++;
+    }
+
+    // Mapas de calor: histograma con 4 tablas para no encadenar escrituras a la misma celda
+    static const int BINS = 256;
+    uint32_t heat[4][BINS];
+    memset(heat, 0, sizeof(heat));
+    for (size_t e = 0; e < n; e++) {
+        unsigned key = (kind[e] * 2u + side[e] - 1u) * 32u + (ballY[e] & 31u);
+        unsigned hit = 192u + (side[e] - 1u) * 8u + (offset[e] & 7u);
+        heat[e & 3][key < 192u ? key : 255u]++;
+        heat[(e + 2) & 3][kind[e] == RALLY_HIT && hit < 208u ? hit : 255u]++;
+    }
+    for (int bin = 0; bin < 208; bin++) {
+        uint64_t total = heat[0][bin] + heat[1][bin] + heat[2][bin] + heat[3][bin];
+        if (bin < 192) stats.heat[bin / 64][(bin / 32) % 2][bin % 32] += total;
+        else stats.hitOffset[(bin - 192) / 8][(bin - 192) % 8] += total;
+    }
+
+    stats.events += n;
+    stats.blocks++;
+}
+
+// Recorre el archivo mapeado; false si no es un registro válido
+static bool analyzeFile(const string& path, RallyStats& stats, uint64_t& fileBytes) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < FILE_HEADER_BYTES) {
+        close(fd);
+        return false;
+    }
+    fileBytes = static_cast<uint64_t>(st.st_size);
+    void* data = mmap(nullptr, fileBytes, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+    madvise(data, fileBytes, MADV_SEQUENTIAL);
+
+    const char* base = static_cast<const char*>(data);
+    bool ok = memcmp(base, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0;
+    size_t pos = FILE_HEADER_BYTES;
+    while (ok && pos + BLOCK_HEADER_BYTES <= fileBytes) {
+        const char* block = base + pos;
+        uint32_t n;
+        memcpy(&n, block + sizeof(BLOCK_MAGIC), sizeof(n));
+        if (memcmp(block, BLOCK_MAGIC, sizeof(BLOCK_MAGIC)) != 0 || n > RallyLog::BLOCK_EVENTS) break;
+        BlockLayout layout(n);
+        if (pos + layout.total > fileBytes) break;     // bloque incompleto al final
+        analyzeBlock(reinterpret_cast<const uint8_t*>(block + layout.kind),
+                     reinterpret_cast<const uint8_t*>(block + layout.side),
+                     reinterpret_cast<const uint8_t*>(block + layout.offset),
+                     reinterpret_cast<const uint8_t*>(block + layout.ballY),
+                     reinterpret_cast<const uint16_t*>(block + layout.rally), n, stats);
+        pos += layout.total;
+    }
+    munmap(data, fileBytes);
+    return ok;
+}
+
+static void printStats(const RallyStats& stats) {
+    static const char* KIND_NAMES[] = {"Golpes", "Fallos", "Saques"};
+    cout << "Eventos: " << stats.events << " en " << stats.blocks << " bloques\n\n";
+    cout << left << setw(10) << "" << setw(14) << "Jugador 1" << "Jugador 2\n";
+    for (int k = 0; k < 3; k++) {
+        cout << left << setw(10) << KIND_NAMES[k] << setw(14) << stats.byKind[k][0] << stats.byKind[k][1] << "\n";
+    }
+    uint64_t misses = stats.byKind[RALLY_MISS][0] + stats.byKind[RALLY_MISS][1];
+    if (misses > 0) {
+        cout << "\nPeloteos: " << misses << "  largo promedio " << fixed << setprecision(2)
+             << static_cast<double>(stats.rallySum) / misses << " golpes  máximo " << stats.rallyMax
+             << "  saques ganadores " << stats.aces << " ("
+             << setprecision(1) << 100.0 * stats.aces / misses << "%)\n";
+    }
+
+    cout << "\nGolpes por fila de la paleta (0 = borde superior):\n";
+    for (int s = 0; s < 2; s++) {
+        cout << "  Jugador " << (s + 1) << ":";
+        for (int o = 0; o <= PADDLE_HEIGHT; o++) cout << "  " << o << "=" << stats.hitOffset[s][o];
+        cout << "\n";
+    }
+
+    // Mapa de calor por fila de la cancha: golpes y fallos de cada lado
+    uint64_t peak = 1;
+    for (int k = 0; k < 2; k++)
+        for (int s = 0; s < 2; s++)
+            for (int y = 0; y < HEIGHT; y++) peak = max(peak, stats.heat[k][s][y]);
+    const char* SHADES = " .:-=+*#%@";
+    auto shade = [&](uint64_t value) {
+        return SHADES[value == 0 ? 0 : 1 + static_cast<int>(8 * value / peak)];
+    };
+    cout << "\nMapa de calor por fila (golpes/fallos):\n";
+    cout << "  fila  J1 golpe fallo   J2 golpe fallo\n";
+    for (int y = 0; y < HEIGHT; y++) {
+        cout << "  " << setw(4) << y << "     " << shade(stats.heat[RALLY_HIT][0][y])
+             << "     " << shade(stats.heat[RALLY_MISS][0][y])
+             << "           " << shade(stats.heat[RALLY_HIT][1][y])
+             << "     " << shade(stats.heat[RALLY_MISS][1][y]) << "\n";
+    }
+}
+
+int runRallyStats(int argc, char* argv[]) {
+    if (argc < 2) {
+        cerr << "Uso: ./Pong --rally-stats ARCHIVO\n";
+        return 2;
+    }
+    RallyStats stats;
+    uint64_t bytes = 0;
+    uint64_t start = monotonicNowNs();
+    if (!analyzeFile(argv[1], stats, bytes)) {
+        cerr << "No es un registro de peloteos válido: " << argv[1] << "\n";
+        return 1;
+    }
+    double secs = (monotonicNowNs() - start) / 1e9;
+
+    cout << "========================================\n";
+    cout << "        ANÁLISIS DE PELOTEOS            \n";
+    cout << "========================================\n";
+    printStats(stats);
+    cout << "\nAnálisis: " << setprecision(3) << secs << " s  ("
+         << setprecision(1) << stats.events / secs / 1e6 << " M eventos/s, "
+         << bytes / secs / 1e9 << " GB/s)\n";
+    return 0;
+}
+
+// ===================== BENCHMARK =====================
+
+int runRallyBench(int argc, char* argv[]) {
+    uint64_t events = 100000000ULL;
+    string path = "/tmp/pong_rally_bench.bin";
+    for (int i = 1; i + 1 < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--events") events = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--file") path = argv[++i];
+    }
+    unlink(path.c_str());
+
+    // Eventos sintéticos con la misma forma que los reales: saque, golpes, fallo
+    RallyLog log;
+    if (!log.open(path)) {
+        cerr << "No se pudo crear " << path << "\n";
+        return 1;
+    }
+    uint64_t writeStart = monotonicNowNs();
+    RallyColumns columns;
+    uint32_t rng = 2025;
+    uint32_t tick = 0;
+    uint32_t match = 0;
+    uint64_t produced = 0;
+    while (produced < events) {
+        columns.clear();
+        while (columns.size() < RallyLog::BLOCK_EVENTS && produced < events) {
+            rng = stepXorshift(rng);
+            int receiver = 1 + (rng & 1);
+            columns.add(RALLY_SERVE, receiver, (rng >> 1) & 1, HEIGHT / 2, 0, tick, match);
+            int hits = (rng >> 2) % 24;
+            int side = receiver;
+            for (int h = 1; h <= hits; h++) {
+                rng = stepXorshift(rng);
+                tick += 76;
+                columns.add(RALLY_HIT, side, rng % (PADDLE_HEIGHT + 1), 1 + (rng >> 8) % (HEIGHT - 2), h, tick, match);
+                side = 3 - side;
+            }
+            rng = stepXorshift(rng);
+            columns.add(RALLY_MISS, side, 0, 1 + rng % (HEIGHT - 2), hits, tick + 40, match);
+            produced += hits + 2;
+            if ((rng >> 20) % 16 == 0) {
+                match++;
+                tick = 0;
+            }
+        }
+        log.append(columns);
+    }
+    uint64_t total = log.eventsWritten();
+    log.close();
+    double writeSecs = (monotonicNowNs() - writeStart) / 1e9;
+
+    RallyStats stats;
+    uint64_t bytes = 0;
+    uint64_t start = monotonicNowNs();
+    bool ok = analyzeFile(path, stats, bytes);
+    double secs = (monotonicNowNs() - start) / 1e9;
+    unlink(path.c_str());
+    if (!ok || stats.events != total) {
+        cerr << "El análisis no coincide: " << stats.events << " de " << total << " eventos\n";
+        return 1;
+    }
+
+    cout << "========================================\n";
+    cout << "     REGISTRO DE PELOTEOS - PRUEBA      \n";
+    cout << "========================================\n";
+    cout << "Escritura: " << total << " eventos, " << bytes / 1000000 << " MB en " << fixed
+         << setprecision(2) << writeSecs << " s\n";
+    cout << "Análisis:  " << setprecision(3) << secs << " s  (" << setprecision(1)
+         << stats.events / secs / 1e6 << " M eventos/s, " << bytes / secs / 1e9 << " GB/s)\n";
+    uint64_t misses = stats.byKind[RALLY_MISS][0] + stats.byKind[RALLY_MISS][1];
+    cout << "Control: " << misses << " peloteos, largo promedio " << setprecision(2)
+         << (misses ? static_cast<double>(stats.rallySum) / misses : 0.0) << ", máximo " << stats.rallyMax << "\n";
+    return 0;
+}
@@ -0,0 +1,184 @@
+/****************************************************
+ * Archivo: rollout_ai.cpp
+ * Descripción: Oponente por búsqueda de simulaciones con presupuesto de tiempo. Cada
+ *              decisión reparte simulaciones cortas (step) entre hilos auxiliares
+ *              persistentes hasta que vence el plazo; la dificultad depende del cómputo
+ *              disponible en lugar de un error artificial.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "rollout_ai.h"
+#include "latency.h"
+#include "step_kernel.h"
+#include "thread_tuning.h"
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+// Ticks que se mantiene la acción candidata antes de pasar a la política por defecto
+static const int COMMIT_TICKS = 4;
+
+static uint32_t nextSeed(uint32_t& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+// Política por defecto de las simulaciones: perseguir la pelota con algo de ruido
+static int noisyChase(const SimState& state, int paddleY, uint32_t& seed) {
+    uint32_t roll = nextSeed(seed) % 8;
+    if (roll == 0) return -1;
+    if (roll == 1) return 1;
+    int targetY = state.ballY - PADDLE_HEIGHT / 2;
+    if (paddleY < targetY) return 1;
+    if (paddleY > targetY) return -1;
+    return 0;
+}
+
+RolloutPlanner::RolloutPlanner(int threads, uint64_t budgetNs, int horizonTicks)
+    : stats(threads < 1 ? 1 : threads), generation(0), activeHelpers(0), stopping(false),
+      rootSide(2), deadlineNs(0), budget(budgetNs), horizon(horizonTicks),
+      rolloutsLast(0), rolloutsTotal(0), searchNsTotal(0) {
+    memset(&root, 0, sizeof(root));
+    for (size_t i = 1; i < stats.size(); i++) {
+        helpers.emplace_back(&RolloutPlanner::helperLoop, this, static_cast<int>(i));
+    }
+}
+
+RolloutPlanner::~RolloutPlanner() {
+    {
+        lock_guard<mutex> lock(jobMutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (auto& helper : helpers) {
+        helper.join();
+    }
+}
+
+void RolloutPlanner::setBudgetNs(uint64_t budgetNs) {
+    budget = budgetNs;
+}
+
+uint64_t RolloutPlanner::budgetNs() const {
+    return budget.load();
+}
+
+uint64_t RolloutPlanner::lastRollouts() const {
+    return rolloutsLast;
+}
+
+double RolloutPlanner::rolloutsPerSecond() const {
+    return searchNsTotal == 0 ? 0.0 : rolloutsTotal * 1e9 / searchNsTotal;
+}
+
+// Recompensa: +1 si el rival falla, -1 si fallamos; si nadie anota, cercanía a la pelota
+double RolloutPlanner::rollout(SimState state, int side, int action, uint32_t& seed) const {
+    int startMine = (side == 1) ? state.scoreP1 : state.scoreP2;
+    int startTheirs = (side == 1) ? state.scoreP2 : state.scoreP1;
+
+    for (int t = 0; t < horizon; t++) {
+        int mine = (side == 1) ? state.paddle1Y : state.paddle2Y;
+        int theirs = (side == 1) ? state.paddle2Y : state.paddle1Y;
+        int myMove = (t < COMMIT_TICKS) ? action : noisyChase(state, mine, seed);
+        int theirMove = noisyChase(state, theirs, seed);
+        if (side == 1) step(state, Inputs{myMove, theirMove});
+        else step(state, Inputs{theirMove, myMove});
+
+        int mineScore = (side == 1) ? state.scoreP1 : state.scoreP2;
+        int theirScore = (side == 1) ? state.scoreP2 : state.scoreP1;
+        if (mineScore != startMine) return 1.0;
+        if (theirScore != startTheirs) return -1.0;
+    }
+
+    int mine = (side == 1) ? state.paddle1Y : state.paddle2Y;
+    int distance = abs(mine + PADDLE_HEIGHT / 2 - state.ballY);
+    return -0.5 * distance / HEIGHT;
+}
+
+void RolloutPlanner::search(int id, uint32_t seed) {
+    WorkerStats& mine = stats[id];
+    for (int a = 0; a < NUM_ACTIONS; a++) {
+        mine.reward[a] = 0.0;
+        mine.count[a] = 0;
+    }
+    // Las acciones se alternan para que las tres reciban muestras aun con poco tiempo
+    int action = id % NUM_ACTIONS;
+    while (monotonicNowNs() < deadlineNs.load(memory_order_relaxed)) {
+        mine.reward[action] += rollout(root, rootSide, action - 1, seed);
+        mine.count[action]++;
+        action = (action + 1) % NUM_ACTIONS;
+    }
+}
+
+void RolloutPlanner::helperLoop(int id) {
+    applyThreadRole(ThreadRole::AI);
+    uint64_t seen = 0;
+    while (true) {
+        {
+            unique_lock<mutex> lock(jobMutex);
+            jobReady.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        search(id, static_cast<uint32_t>(seen * 2654435761u + id) | 1u);
+        {
+            lock_guard<mutex> lock(jobMutex);
+            activeHelpers--;
+        }
+        jobDone.notify_one();
+    }
+}
+
+int RolloutPlanner::decide(const SimState& state, int side) {
+    uint64_t start = monotonicNowNs();
+    {
+        lock_guard<mutex> lock(jobMutex);
+        root = state;
+        rootSide = side;
+        deadlineNs = start + budget.load();
+        activeHelpers = static_cast<int>(helpers.size());
+        generation++;
+    }
+    jobReady.notify_all();
+
+    search(0, static_cast<uint32_t>(start) | 1u);
+
+    {
+        unique_lock<mutex> lock(jobMutex);
+        jobDone.wait(lock, [this] { return activeHelpers == 0; });
+    }
+
+    double reward[NUM_ACTIONS] = {0.0, 0.0, 0.0};
+    uint64_t count[NUM_ACTIONS] = {0, 0, 0};
+    for (const WorkerStats& s : stats) {
+        for (int a = 0; a < NUM_ACTIONS; a++) {
+            reward[a] += s.reward[a];
+            count[a] += s.count[a];
+        }
+    }
+
+    // Sin muestras: quedarse quieto. Empates favorecen no moverse (acción 0)
+    int best = 1;
+    double bestMean = count[1] > 0 ? reward[1] / count[1] : -2.0;
+    for (int a = 0; a < NUM_ACTIONS; a++) {
+        if (count[a] == 0) continue;
+        double mean = reward[a] / count[a];
+        if (mean > bestMean + 1e-9) {
+            best = a;
+            bestMean = mean;
+        }
+    }
+
+    rolloutsLast = count[0] + count[1] + count[2];
+    rolloutsTotal += rolloutsLast;
+    searchNsTotal += monotonicNowNs() - start;
+    return best - 1;
+}
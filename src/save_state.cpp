@@ -0,0 +1,256 @@
+/****************************************************
+ * Archivo: save_state.cpp
+ * Descripción: Guardado/carga de partidas y buffer de rebobinado. El estado completo
+ *              (pelota, paletas, marcador, RNG, tick y ronda) se empaqueta en 19 bytes;
+ *              el buffer guarda solo los bytes que cambian entre ticks y un keyframe
+ *              periódico, en memoria fija, para repeticiones instantáneas.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "save_state.h"
+#include "latency.h"
+#include <cstring>
+#include <fstream>
+
+using namespace std;
+
+static const char SAVE_MAGIC[8] = {'P', 'O', 'N', 'G', 'S', 'A', 'V', '1'};
+static const size_t MASK_BYTES = 3;     // 19 bits -> una máscara de 3 bytes
+
+static void putU16(uint8_t* out, uint32_t v) {
+    out[0] = static_cast<uint8_t>(v);
+    out[1] = static_cast<uint8_t>(v >> 8);
+}
+
+static void putU32(uint8_t* out, uint32_t v) {
+    putU16(out, v);
+    putU16(out + 2, v >> 16);
+}
+
+static uint32_t getU16(const uint8_t* in) {
+    return in[0] | (in[1] << 8);
+}
+
+static uint32_t getU32(const uint8_t* in) {
+    return getU16(in) | (getU16(in + 2) << 16);
+}
+
+void packSnapshot(const MatchSnapshot& snapshot, uint8_t* out) {
+    const SimState& s = snapshot.sim;
+    out[0] = static_cast<uint8_t>(s.ballX);
+    out[1] = static_cast<uint8_t>(s.ballY);
+    out[2] = static_cast<uint8_t>(static_cast<int8_t>(s.ballSpeedX));
+    out[3] = static_cast<uint8_t>(static_cast<int8_t>(s.ballSpeedY));
+    out[4] = static_cast<uint8_t>(s.paddle1Y);
+    out[5] = static_cast<uint8_t>(s.paddle2Y);
+    putU16(out + 6, static_cast<uint32_t>(s.scoreP1));
+    putU16(out + 8, static_cast<uint32_t>(s.scoreP2));
+    putU32(out + 10, s.rng);
+    putU32(out + 14, s.tick);
+    out[18] = snapshot.roundInProgress ? 1 : 0;
+}
+
+void unpackSnapshot(const uint8_t* in, MatchSnapshot& snapshot) {
+    SimState& s = snapshot.sim;
+    s.ballX = static_cast<int8_t>(in[0]);
+    s.ballY = static_cast<int8_t>(in[1]);
+    s.ballSpeedX = static_cast<int8_t>(in[2]);
+    s.ballSpeedY = static_cast<int8_t>(in[3]);
+    s.paddle1Y = in[4];
+    s.paddle2Y = in[5];
+    s.scoreP1 = static_cast<int>(getU16(in + 6));
+    s.scoreP2 = static_cast<int>(getU16(in + 8));
+    s.rng = getU32(in + 10);
+    s.tick = getU32(in + 14);
+    snapshot.roundInProgress = in[18] != 0;
+}
+
+bool saveSnapshotFile(const string& path, const MatchSnapshot& snapshot) {
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file.is_open()) return false;
+    uint8_t packed[SNAPSHOT_BYTES];
+    packSnapshot(snapshot, packed);
+    file.write(SAVE_MAGIC, sizeof(SAVE_MAGIC));
+    file.write(reinterpret_cast<const char*>(packed), sizeof(packed));
+    return file.good();
+}
+
+bool loadSnapshotFile(const string& path, MatchSnapshot& snapshot) {
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) return false;
+    char magic[sizeof(SAVE_MAGIC)];
+    uint8_t packed[SNAPSHOT_BYTES];
+    if (!file.read(magic, sizeof(magic)) || memcmp(magic, SAVE_MAGIC, sizeof(magic)) != 0) return false;
+    if (!file.read(reinterpret_cast<char*>(packed), sizeof(packed))) return false;
+    unpackSnapshot(packed, snapshot);
+    return true;
+}
+
+// ===================== BUFFER DE REBOBINADO =====================
+
+RewindBuffer::RewindBuffer(size_t maxTicks, int keyframeInterval)
+    : entries(maxTicks),
+      bytes(maxTicks * (MASK_BYTES + SNAPSHOT_BYTES)),
+      keyframeInterval(keyframeInterval) {
+    clear();
+}
+
+void RewindBuffer::clear() {
+    firstEntry = 0;
+    entryCount = 0;
+    byteHead = 0;
+    byteCount = 0;
+    sinceKeyframe = 0;
+    captures = 0;
+    captureNsTotal = 0;
+    memset(last, 0, sizeof(last));
+}
+
+void RewindBuffer::writeByte(uint8_t value) {
+    bytes[byteHead] = value;
+    byteHead = (byteHead + 1) % bytes.size();
+    byteCount++;
+}
+
+uint8_t RewindBuffer::readByte(size_t offset) const {
+    return bytes[offset % bytes.size()];
+}
+
+// Expulsa el keyframe más antiguo y todos sus deltas: el buffer siempre empieza en keyframe
+void RewindBuffer::dropOldestRun() {
+    do {
+        byteCount -= entries[firstEntry].length;
+        firstEntry = (firstEntry + 1) % entries.size();
+        entryCount--;
+    } while (entryCount > 0 && !entries[firstEntry].keyframe);
+}
+
+void RewindBuffer::capture(const MatchSnapshot& snapshot) {
+    uint64_t start = monotonicNowNs();
+
+    uint8_t packed[SNAPSHOT_BYTES];
+    packSnapshot(snapshot, packed);
+
+    bool keyframe = (entryCount == 0 || sinceKeyframe >= keyframeInterval);
+    uint32_t mask = 0;
+    size_t length = SNAPSHOT_BYTES;
+    if (!keyframe) {
+        length = MASK_BYTES;
+        for (size_t i = 0; i < SNAPSHOT_BYTES; i++) {
+            if (packed[i] != last[i]) {
+                mask |= 1u << i;
+                length++;
+            }
+        }
+    }
+
+    while (entryCount > 0 && (entryCount == entries.size() || byteCount + length > bytes.size())) {
+        dropOldestRun();
+    }
+    // Si se expulsó todo, el siguiente registro debe ser keyframe
+    if (entryCount == 0 && !keyframe) {
+        keyframe = true;
+        length = SNAPSHOT_BYTES;
+    }
+
+    size_t slot = (firstEntry + entryCount) % entries.size();
+    entries[slot] = {static_cast<uint32_t>(byteHead), static_cast<uint8_t>(length), keyframe};
+    entryCount++;
+
+    if (keyframe) {
+        for (size_t i = 0; i < SNAPSHOT_BYTES; i++) writeByte(packed[i]);
+        sinceKeyframe = 0;
+    } else {
+        writeByte(static_cast<uint8_t>(mask));
+        writeByte(static_cast<uint8_t>(mask >> 8));
+        writeByte(static_cast<uint8_t>(mask >> 16));
+        for (size_t i = 0; i < SNAPSHOT_BYTES; i++) {
+            if (mask & (1u << i)) writeByte(packed[i]);
+        }
+        sinceKeyframe++;
+    }
+    memcpy(last, packed, sizeof(last));
+
+    captures++;
+    captureNsTotal += monotonicNowNs() - start;
+}
+
+void RewindBuffer::decode(const Entry& entry, uint8_t* state) const {
+    if (entry.keyframe) {
+        for (size_t i = 0; i < SNAPSHOT_BYTES; i++) state[i] = readByte(entry.offset + i);
+        return;
+    }
+    uint32_t mask = readByte(entry.offset) |
+                    (readByte(entry.offset + 1) << 8) |
+                    (readByte(entry.offset + 2) << 16);
+    size_t pos = entry.offset + MASK_BYTES;
+    for (size_t i = 0; i < SNAPSHOT_BYTES; i++) {
+        if (mask & (1u << i)) state[i] = readByte(pos++);
+    }
+}
+
+bool RewindBuffer::get(size_t ticksBack, MatchSnapshot& snapshot) const {
+    if (ticksBack >= entryCount) return false;
+    size_t target = entryCount - 1 - ticksBack;
+
+    // Buscar el keyframe anterior y aplicar deltas hacia adelante
+    size_t start = target;
+    while (!entries[(firstEntry + start) % entries.size()].keyframe) start--;
+
+    uint8_t state[SNAPSHOT_BYTES];
+    for (size_t i = start; i <= target; i++) {
+        decode(entries[(firstEntry + i) % entries.size()], state);
+    }
+    unpackSnapshot(state, snapshot);
+    return true;
+}
+
+void RewindBuffer::truncate(size_t ticksBack) {
+    if (ticksBack >= entryCount) {
+        uint64_t captured = captures;
+        uint64_t total = captureNsTotal;
+        clear();
+        captures = captured;
+        captureNsTotal = total;
+        return;
+    }
+    MatchSnapshot newest;
+    get(ticksBack, newest);
+    for (size_t i = 0; i < ticksBack; i++) {
+        size_t slot = (firstEntry + entryCount - 1) % entries.size();
+        byteCount -= entries[slot].length;
+        byteHead = (byteHead + bytes.size() - entries[slot].length) % bytes.size();
+        entryCount--;
+    }
+    // Recalcular la referencia para el siguiente delta
+    packSnapshot(newest, last);
+    sinceKeyframe = 0;
+    for (size_t i = entryCount; i > 0 && !entries[(firstEntry + i - 1) % entries.size()].keyframe; i--) {
+        sinceKeyframe++;
+    }
+}
+
+size_t RewindBuffer::size() const {
+    return entryCount;
+}
+
+size_t RewindBuffer::bytesUsed() const {
+    return byteCount + entryCount * sizeof(Entry);
+}
+
+size_t RewindBuffer::bytesCapacity() const {
+    return bytes.size() + entries.size() * sizeof(Entry);
+}
+
+uint64_t RewindBuffer::captureCount() const {
+    return captures;
+}
+
+double RewindBuffer::averageCaptureNs() const {
+    return captures == 0 ? 0.0 : static_cast<double>(captureNsTotal) / captures;
+}
@@ -0,0 +1,172 @@
+/****************************************************
+ * Archivo: score_stress.cpp
+ * Descripción: Prueba de carga del HighScoreManager entre procesos. Lanza escritores
+ *              con fork() que agregan registros únicos lo más rápido posible y lectores
+ *              que leen instantáneas sin candado; reporta registros perdidos,
+ *              duplicados, instantáneas incoherentes y tasas de escritura/lectura.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "score_stress.h"
+#include "highscores.h"
+#include "latency.h"
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+struct ReaderResult {
+    unsigned long long snapshots;
+    unsigned long long incoherent;  // registros mal formados o conteo que retrocede
+};
+
+static volatile sig_atomic_t readerStop = 0;
+
+static void onReaderStop(int) {
+    readerStop = 1;
+}
+
+// Los registros de prueba se llaman "w<escritor>" / "r<número>"
+static bool wellFormed(const HighScore& score) {
+    return score.player1Name.size() > 1 && score.player1Name[0] == 'w' &&
+           score.player2Name.size() > 1 && score.player2Name[0] == 'r' &&
+           score.player1Score == atoi(score.player1Name.c_str() + 1) &&
+           score.player2Score == atoi(score.player2Name.c_str() + 1);
+}
+
+static void readerProcess(const string& path, int resultFd) {
+    signal(SIGTERM, onReaderStop);
+    ReaderResult result = {0, 0};
+    size_t lastCount = 0;
+    vector<HighScore> snapshot;
+    while (!readerStop) {
+        if (!HighScoreManager::readSnapshot(path, snapshot)) continue;
+        result.snapshots++;
+        if (snapshot.size() < lastCount) result.incoherent++;
+        lastCount = snapshot.size();
+        for (const auto& score : snapshot) {
+            if (!wellFormed(score)) {
+                result.incoherent++;
+                break;
+            }
+        }
+    }
+    if (write(resultFd, &result, sizeof(result)) != static_cast<ssize_t>(sizeof(result))) _exit(1);
+    _exit(0);
+}
+
+int runScoreStress(int argc, char* argv[]) {
+    int writers = 16;
+    int records = 200;
+    int readers = 4;
+    string path = "/tmp/pong_score_stress.txt";
+    for (int i = 1; i + 1 < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--writers") writers = atoi(argv[++i]);
+        else if (arg == "--records") records = atoi(argv[++i]);
+        else if (arg == "--readers") readers = atoi(argv[++i]);
+        else if (arg == "--file") path = argv[++i];
+    }
+    if (writers <= 0 || records <= 0 || readers < 0) {
+        cerr << "Parámetros inválidos\n";
+        return 2;
+    }
+    size_t total = static_cast<size_t>(writers) * static_cast<size_t>(records);
+    unlink(path.c_str());
+
+    int resultPipe[2];
+    if (pipe(resultPipe) != 0) {
+        perror("pipe");
+        return 1;
+    }
+
+    vector<pid_t> readerPids;
+    for (int r = 0; r < readers; r++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(resultPipe[0]);
+            readerProcess(path, resultPipe[1]);
+        }
+        readerPids.push_back(pid);
+    }
+
+    // Capacidad suficiente para conservar todos los registros y poder contarlos
+    uint64_t startNs = monotonicNowNs();
+    vector<pid_t> writerPids;
+    for (int w = 0; w < writers; w++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            HighScoreManager manager(path, total);
+            for (int j = 0; j < records; j++) {
+                manager.addScore("w" + to_string(w), "r" + to_string(j), w, j);
+            }
+            _exit(0);
+        }
+        writerPids.push_back(pid);
+    }
+    int failedWriters = 0;
+    for (pid_t pid : writerPids) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) failedWriters++;
+    }
+    double writeSecs = (monotonicNowNs() - startNs) / 1e9;
+
+    ReaderResult readTotals = {0, 0};
+    for (pid_t pid : readerPids) kill(pid, SIGTERM);
+    close(resultPipe[1]);
+    for (size_t r = 0; r < readerPids.size(); r++) {
+        ReaderResult result;
+        if (read(resultPipe[0], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result))) {
+            readTotals.snapshots += result.snapshots;
+            readTotals.incoherent += result.incoherent;
+        }
+    }
+    close(resultPipe[0]);
+    for (pid_t pid : readerPids) waitpid(pid, nullptr, 0);
+
+    // Verificación final: cada (escritor, número) exactamente una vez
+    vector<HighScore> finalScores;
+    HighScoreManager::readSnapshot(path, finalScores);
+    set<pair<int, int>> seen;
+    size_t duplicates = 0;
+    size_t malformed = 0;
+    for (const auto& score : finalScores) {
+        if (!wellFormed(score)) {
+            malformed++;
+            continue;
+        }
+        if (!seen.insert(make_pair(score.player1Score, score.player2Score)).second) duplicates++;
+    }
+    size_t lost = total - seen.size();
+
+    cout << "========================================\n";
+    cout << "     PUNTAJES ENTRE PROCESOS - PRUEBA   \n";
+    cout << "========================================\n";
+    cout << "Escritores: " << writers << " x " << records << " registros  lectores: " << readers << "\n";
+    cout << "Escritura: " << total << " registros en " << writeSecs << " s ("
+         << static_cast<long long>(total / writeSecs) << " registros/s)\n";
+    cout << "Lectura: " << readTotals.snapshots << " instantáneas ("
+         << static_cast<long long>(readTotals.snapshots / writeSecs) << "/s), incoherentes "
+         << readTotals.incoherent << "\n";
+    cout << "Archivo final: " << finalScores.size() << " registros  perdidos " << lost
+         << "  duplicados " << duplicates << "  mal formados " << malformed << "\n";
+    if (failedWriters > 0) cout << "Escritores con error: " << failedWriters << "\n";
+
+    unlink(path.c_str());
+    unlink((path + ".lock").c_str());
+    bool ok = lost == 0 && duplicates == 0 && malformed == 0 && readTotals.incoherent == 0 && failedWriters == 0;
+    cout << (ok ? "OK" : "FALLÓ") << "\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+/****************************************************
+ * Archivo: step_check.cpp
+ * Descripción: Verificación y benchmark del núcleo de simulación. Genera estados
+ *              aleatorios válidos (incluyendo pelotas en las zonas de paleta), avanza
+ *              cada uno con step() y con simStepReference y compara byte a byte;
+ *              luego mide ns por tick de ambas versiones.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "step_check.h"
+#include "step_kernel.h"
+#include "latency.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static World randomWorld(uint32_t& seed) {
+    World w;
+    seed = stepXorshift(seed);
+    w.ballX = static_cast<int>(seed % WIDTH);
+    seed = stepXorshift(seed);
+    w.ballY = 1 + static_cast<int>(seed % (HEIGHT - 2));
+    seed = stepXorshift(seed);
+    w.ballSpeedX = (seed & 1) ? 1 : -1;
+    w.ballSpeedY = (seed & 2) ? 1 : -1;
+    seed = stepXorshift(seed);
+    w.paddle1Y = 1 + static_cast<int>(seed % (HEIGHT - PADDLE_HEIGHT - 1));
+    seed = stepXorshift(seed);
+    w.paddle2Y = 1 + static_cast<int>(seed % (HEIGHT - PADDLE_HEIGHT - 1));
+    seed = stepXorshift(seed);
+    w.scoreP1 = static_cast<int>(seed % 100);
+    w.scoreP2 = static_cast<int>((seed >> 8) % 100);
+    seed = stepXorshift(seed);
+    w.rng = seed | 1u;
+    w.tick = seed >> 4;
+    return w;
+}
+
+static bool sameWorld(const World& a, const World& b) {
+    return a.ballX == b.ballX && a.ballY == b.ballY &&
+           a.ballSpeedX == b.ballSpeedX && a.ballSpeedY == b.ballSpeedY &&
+           a.paddle1Y == b.paddle1Y && a.paddle2Y == b.paddle2Y &&
+           a.scoreP1 == b.scoreP1 && a.scoreP2 == b.scoreP2 &&
+           a.rng == b.rng && a.tick == b.tick;
+}
+
+int runStepCheck(int argc, char* argv[]) {
+    long long states = 5000000;
+    uint32_t seed = 12345;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string arg = argv[i];
+        if (arg == "--states") states = atoll(argv[i + 1]);
+        else if (arg == "--seed") seed = static_cast<uint32_t>(atoi(argv[i + 1])) | 1u;
+    }
+
+    cout << "========================================\n";
+    cout << "      NÚCLEO step(): EQUIVALENCIA       \n";
+    cout << "========================================\n";
+
+    // 1) Equivalencia en estados aleatorios independientes
+    long long mismatches = 0;
+    uint32_t s = seed;
+    for (long long i = 0; i < states; i++) {
+        World a = randomWorld(s);
+        World b = a;
+        s = stepXorshift(s);
+        Inputs in = {static_cast<int>(s % 3) - 1, static_cast<int>((s >> 4) % 3) - 1};
+        step(a, in);
+        simStepReference(b, in.moveP1, in.moveP2);
+        if (!sameWorld(a, b)) {
+            if (mismatches < 5) {
+                cout << "Diferencia en estado " << i << "\n";
+            }
+            mismatches++;
+        }
+    }
+    cout << "Estados comparados: " << states << "  diferencias: " << mismatches << "\n";
+
+    // 2) Benchmark sobre trayectorias largas (misma secuencia de entradas)
+    const int lanes = 1024;
+    vector<World> worlds(lanes), reference(lanes);
+    s = seed;
+    for (int i = 0; i < lanes; i++) {
+        worlds[i] = randomWorld(s);
+        reference[i] = worlds[i];
+    }
+    long long rounds = states / lanes;
+
+    // Se mide cada versión tres veces alternando y se toma el mejor tiempo
+    auto timeKernel = [&]() {
+        uint64_t start = monotonicNowNs();
+        for (long long r = 0; r < rounds; r++) {
+            Inputs in = {static_cast<int>(r % 3) - 1, static_cast<int>((r / 3) % 3) - 1};
+            for (int i = 0; i < lanes; i++) step(worlds[i], in);
+        }
+        return static_cast<double>(monotonicNowNs() - start) / (rounds * lanes);
+    };
+    auto timeReference = [&]() {
+        uint64_t start = monotonicNowNs();
+        for (long long r = 0; r < rounds; r++) {
+            Inputs in = {static_cast<int>(r % 3) - 1, static_cast<int>((r / 3) % 3) - 1};
+            for (int i = 0; i < lanes; i++) simStepReference(reference[i], in.moveP1, in.moveP2);
+        }
+        return static_cast<double>(monotonicNowNs() - start) / (rounds * lanes);
+    };
+    double kernelNs = 1e9, referenceNs = 1e9;
+    for (int rep = 0; rep < 3; rep++) {
+        kernelNs = min(kernelNs, timeKernel());
+        referenceNs = min(referenceNs, timeReference());
+    }
+
+    // 3) Pelotas en la zona de paletas con estados aleatorios: los saltos de la
+    //    referencia no se pueden predecir (el conjunto es demasiado grande para aprenderlo)
+    const int pool = 1 << 16;
+    vector<World> scattered(pool);
+    s = seed ^ 0xA5A5A5A5u;
+    for (int i = 0; i < pool; i++) {
+        scattered[i] = randomWorld(s);
+        scattered[i].ballX = (i & 1) ? 3 + static_cast<int>(s % 3) : WIDTH - 5 - static_cast<int>(s % 3);
+        s = stepXorshift(s);
+    }
+    long long samples = max(static_cast<long long>(pool), states);
+    auto timeScattered = [&](bool kernel) {
+        long long checksum = 0;
+        uint64_t start = monotonicNowNs();
+        for (long long i = 0; i < samples; i++) {
+            World w = scattered[i & (pool - 1)];
+            if (kernel) step(w, Inputs{0, 0});
+            else simStepReference(w, 0, 0);
+            checksum += w.ballX;
+        }
+        double ns = static_cast<double>(monotonicNowNs() - start) / samples;
+        return checksum > 0 ? ns : ns + 1e-9;
+    };
+    double scatteredKernelNs = 1e9, scatteredReferenceNs = 1e9;
+    for (int rep = 0; rep < 3; rep++) {
+        scatteredKernelNs = min(scatteredKernelNs, timeScattered(true));
+        scatteredReferenceNs = min(scatteredReferenceNs, timeScattered(false));
+    }
+
+    long long trajectoryMismatches = 0;
+    for (int i = 0; i < lanes; i++) {
+        if (!sameWorld(worlds[i], reference[i])) trajectoryMismatches++;
+    }
+
+    cout << "Trayectorias: " << lanes << " x " << 3 * rounds << " ticks  diferencias finales: "
+         << trajectoryMismatches << "\n";
+    cout << fixed << setprecision(2);
+    cout << "Trayectorias completas:\n";
+    cout << "step():             " << kernelNs << " ns/tick\n";
+    cout << "referencia:         " << referenceNs << " ns/tick\n";
+    cout << "Aceleración:        " << referenceNs / kernelNs << "x\n";
+    cout << "Zona de paletas (estados aleatorios):\n";
+    cout << "step():             " << scatteredKernelNs << " ns/tick\n";
+    cout << "referencia:         " << scatteredReferenceNs << " ns/tick\n";
+    cout << "Aceleración:        " << scatteredReferenceNs / scatteredKernelNs << "x\n";
+
+    return (mismatches == 0 && trajectoryMismatches == 0) ? 0 : 1;
+}
@@ -0,0 +1,333 @@
+/****************************************************
+ * Archivo: term_encoder.cpp
+ * Descripción: Codificador de secuencias de escape optimizado para enlaces lentos
+ *              (SSH). Guarda lo que hay en pantalla y, para cada frame, emite solo las
+ *              celdas que cambiaron eligiendo el camino más barato en bytes: movimiento
+ *              relativo o absoluto, reescribir huecos cortos, EL/ECH/REP para corridas y
+ *              SGR solo cuando cambia el atributo. Envuelve los frames grandes en
+ *              marcas de actualización sincronizada si el terminal las soporta.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "term_encoder.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+// Frames más cortos que esto caben en una sola escritura: no vale la pena marcarlos
+static const size_t SYNC_THRESHOLD = 64;
+// Hueco máximo que se considera reescribir en lugar de saltar con un movimiento
+static const int MAX_OVERWRITE = 8;
+
+static const TermCell BLANK = {{' ', 0, 0, 0}, 1, ATTR_NONE};
+
+static bool sameCell(const TermCell& a, const TermCell& b) {
+    return a.len == b.len && a.attr == b.attr && memcmp(a.bytes, b.bytes, a.len) == 0;
+}
+
+static bool isBlank(const TermCell& cell) {
+    return sameCell(cell, BLANK);
+}
+
+// Secuencia corta armada en la pila (candidatos de movimiento, SGR, ECH, REP)
+struct EscSeq {
+    static const int CAPACITY = 48;
+    char bytes[CAPACITY];
+    int len = 0;
+
+    bool fits(int n) const { return len + n <= CAPACITY; }
+    void add(const char* text, int n) {
+        memcpy(bytes + len, text, n);
+        len += n;
+    }
+    void add(char c) { bytes[len++] = c; }
+    void addNumber(int n) {
+        char digits[12];
+        int count = 0;
+        do {
+            digits[count++] = static_cast<char>('0' + n % 10);
+            n /= 10;
+        } while (n > 0);
+        while (count > 0) add(digits[--count]);
+    }
+    // CSI n final (n = 1 se omite)
+    void addCsi(int n, char final) {
+        add("\x1b[", 2);
+        if (n != 1) addNumber(n);
+        add(final);
+    }
+};
+
+// ===================== FRAME =====================
+
+TermFrame::TermFrame(int rows, int cols) : numRows(rows), numCols(cols), cells(rows * cols, BLANK) {}
+
+void TermFrame::clear() {
+    for (auto& cell : cells) cell = BLANK;
+}
+
+void TermFrame::put(int row, int col, string_view text, uint8_t attr) {
+    if (row < 0 || row >= numRows) return;
+    const size_t size = text.size();
+    size_t i = 0;
+    while (i < size && col < numCols) {
+        unsigned char lead = static_cast<unsigned char>(text[i]);
+        size_t len = (lead < 0x80) ? 1 : (lead < 0xE0) ? 2 : (lead < 0xF0) ? 3 : 4;
+        if (i + len > size) len = size - i;
+        if (col >= 0) {
+            TermCell& cell = at(row, col);
+            memcpy(cell.bytes, text.data() + i, len);
+            cell.len = static_cast<uint8_t>(len);
+            cell.attr = attr;
+        }
+        i += len;
+        col++;
+    }
+}
+
+// ===================== CAPACIDADES =====================
+
+static bool envFlag(const char* name, bool& value) {
+    const char* text = getenv(name);
+    if (text == nullptr || *text == '\0') return false;
+    value = (text[0] == '1');
+    return true;
+}
+
+TermCaps detectTermCaps() {
+    TermCaps caps;
+    string term = getenv("TERM") ? getenv("TERM") : "";
+    string program = getenv("TERM_PROGRAM") ? getenv("TERM_PROGRAM") : "";
+    bool windowsTerminal = getenv("WT_SESSION") != nullptr;
+
+    bool modern = term.find("kitty") != string::npos || term.find("foot") != string::npos ||
+                  term.find("wezterm") != string::npos || term.find("contour") != string::npos ||
+                  program == "WezTerm" || program == "ghostty" || windowsTerminal;
+    caps.syncUpdates = modern || program == "iTerm.app" || term.find("alacritty") != string::npos;
+    // REP está en xterm y VTE; Terminal.app y screen no lo implementan
+    caps.repeat = modern || getenv("XTERM_VERSION") != nullptr ||
+                  (getenv("VTE_VERSION") != nullptr && atoi(getenv("VTE_VERSION")) >= 5400);
+
+    envFlag("PONG_SYNC", caps.syncUpdates);
+    envFlag("PONG_REP", caps.repeat);
+    return caps;
+}
+
+// ===================== CODIFICADOR =====================
+
+TermEncoder::TermEncoder(int rows, int cols)
+    : screen(rows, cols), valid(false), curRow(-1), curCol(-1), curAttr(-1) {
+    // Peor caso: cada celda con su carácter de 4 bytes y un cambio de SGR
+    out.reserve(static_cast<size_t>(rows) * cols * 12 + 64);
+}
+
+void TermEncoder::setCaps(const TermCaps& newCaps) {
+    caps = newCaps;
+}
+
+void TermEncoder::invalidate() {
+    valid = false;
+}
+
+void TermEncoder::setAttr(uint8_t attr) {
+    if (curAttr == attr) return;
+    if (attr == ATTR_NONE) {
+        out += "\x1b[m";
+    } else {
+        // Si solo se agregan bits no hace falta reiniciar con 0
+        bool additive = curAttr >= 0 && (curAttr & ~attr) == 0;
+        uint8_t bits = additive ? (attr & ~curAttr) : attr;
+        EscSeq seq;
+        seq.add("\x1b[", 2);
+        if (!additive) seq.add('0');
+        if (bits & ATTR_BOLD) {
+            if (seq.len > 2) seq.add(';');
+            seq.add('1');
+        }
+        if (bits & ATTR_REVERSE) {
+            if (seq.len > 2) seq.add(';');
+            seq.add('7');
+        }
+        seq.add('m');
+        out.append(seq.bytes, seq.len);
+    }
+    curAttr = attr;
+}
+
+// Movimiento horizontal de fromCol a col sobre la fila row (ya en esa fila)
+void TermEncoder::appendHorizontal(EscSeq& seq, int row, int fromCol, int col) const {
+    if (fromCol == col) return;
+    if (fromCol < col) {
+        EscSeq move;
+        move.addCsi(col - fromCol, 'C');
+        // Reescribir lo que ya está en pantalla suele ser más corto que saltar
+        if (col - fromCol <= MAX_OVERWRITE) {
+            EscSeq rewrite;
+            bool ok = true;
+            for (int c = fromCol; c < col && ok; c++) {
+                const TermCell& cell = screen.at(row, c);
+                ok = (cell.attr == curAttr) && rewrite.fits(cell.len);
+                if (ok) rewrite.add(cell.bytes, cell.len);
+            }
+            if (ok && rewrite.len < move.len) move = rewrite;
+        }
+        if (seq.fits(move.len)) seq.add(move.bytes, move.len);
+        return;
+    }
+    EscSeq back;
+    if (fromCol - col <= 2) {
+        for (int k = 0; k < fromCol - col; k++) back.add('\b');
+    } else {
+        back.addCsi(fromCol - col, 'D');
+    }
+    EscSeq fromStart;
+    fromStart.add('\r');
+    if (col > 0) fromStart.addCsi(col, 'C');
+    const EscSeq& best = fromStart.len < back.len ? fromStart : back;
+    seq.add(best.bytes, best.len);
+}
+
+// Elige la secuencia más corta (en bytes) para llevar el cursor a (row, col)
+void TermEncoder::moveTo(int row, int col) {
+    if (curRow == row && curCol == col) return;
+
+    EscSeq best;
+    best.add("\x1b[", 2);
+    if (row > 0 || col > 0) best.addNumber(row + 1);
+    if (col > 0) {
+        best.add(';');
+        best.addNumber(col + 1);
+    }
+    best.add('H');
+    if (curRow >= 0 && curCol >= 0) {
+        int dr = row - curRow;
+        EscSeq candidate;
+        if (dr > 0) candidate.addCsi(dr, 'B');
+        else if (dr < 0) candidate.addCsi(-dr, 'A');
+        // No se usa '\n': con ONLCR desactivado no volvería a la columna 0
+        appendHorizontal(candidate, row, curCol, col);
+        if (candidate.len < best.len) best = candidate;
+    }
+    out.append(best.bytes, best.len);
+    curRow = row;
+    curCol = col;
+}
+
+void TermEncoder::writeCell(int row, int col, const TermCell& cell) {
+    setAttr(cell.attr);
+    out.append(cell.bytes, cell.len);
+    screen.at(row, col) = cell;
+    curCol = col + 1;
+    // En la última columna el cursor queda en "wrap pendiente": mejor no suponer nada
+    if (curCol >= screen.cols()) {
+        curRow = -1;
+        curCol = -1;
+    }
+}
+
+void TermEncoder::encodeRow(const TermFrame& next, int row) {
+    const int cols = screen.cols();
+    int first = -1;
+    int last = -1;
+    for (int c = 0; c < cols; c++) {
+        if (!sameCell(screen.at(row, c), next.at(row, c))) {
+            if (first < 0) first = c;
+            last = c;
+        }
+    }
+    if (first < 0) return;
+
+    // Cola en blanco: EL (3 bytes) borra todo lo que queda a la derecha
+    int tail = cols;
+    while (tail > 0 && isBlank(next.at(row, tail - 1))) tail--;
+    int tailChanges = 0;
+    for (int c = tail; c < cols; c++) {
+        if (!isBlank(screen.at(row, c))) tailChanges++;
+    }
+    bool eraseTail = tailChanges >= 3;
+    int limit = eraseTail ? min(last, tail - 1) : last;
+
+    int c = first;
+    while (c <= limit) {
+        const TermCell& cell = next.at(row, c);
+        if (sameCell(screen.at(row, c), cell)) {
+            c++;
+            continue;
+        }
+        moveTo(row, c);
+
+        // Corrida de blancos: ECH borra n celdas sin mover el cursor
+        if (isBlank(cell)) {
+            int n = 0;
+            while (c + n <= limit && isBlank(next.at(row, c + n))) n++;
+            EscSeq ech;
+            ech.addCsi(n, 'X');
+            if (n > ech.len + 3) {
+                setAttr(ATTR_NONE);
+                out.append(ech.bytes, ech.len);
+                for (int k = 0; k < n; k++) screen.at(row, c + k) = BLANK;
+                c += n;
+                continue;
+            }
+        }
+
+        writeCell(row, c, cell);
+        c++;
+
+        // Corrida del mismo carácter: REP lo repite n veces
+        if (caps.repeat) {
+            int n = 0;
+            while (c + n <= limit && sameCell(next.at(row, c + n), cell)) n++;
+            EscSeq rep;
+            rep.addCsi(n, 'b');
+            if (n > 0 && n * cell.len > rep.len) {
+                out.append(rep.bytes, rep.len);
+                for (int k = 0; k < n; k++) screen.at(row, c + k) = cell;
+                c += n;
+                curCol = (curCol < 0) ? -1 : c;
+                if (curCol >= cols) {
+                    curRow = -1;
+                    curCol = -1;
+                }
+            }
+        }
+    }
+
+    if (eraseTail) {
+        moveTo(row, tail);
+        setAttr(ATTR_NONE);
+        out += "\x1b[K";
+        for (int k = tail; k < cols; k++) screen.at(row, k) = BLANK;
+    }
+}
+
+const string& TermEncoder::encode(const TermFrame& next) {
+    out.clear();
+    bool fullRedraw = !valid;
+    if (fullRedraw) {
+        // Pantalla limpia y cursor oculto; desde aquí el contenido es conocido
+        out += "\x1b[?25l\x1b[m\x1b[H\x1b[2J";
+        screen.clear();
+        curRow = 0;
+        curCol = 0;
+        curAttr = ATTR_NONE;
+        valid = true;
+    }
+
+    for (int row = 0; row < screen.rows(); row++) {
+        encodeRow(next, row);
+    }
+
+    if (caps.syncUpdates && (fullRedraw || out.size() > SYNC_THRESHOLD)) {
+        out.insert(0, "\x1b[?2026h");
+        out += "\x1b[?2026l";
+    }
+    return out;
+}
@@ -0,0 +1,197 @@
+/****************************************************
+ * Archivo: thread_tuning.cpp
+ * Descripción: Configuración por rol de los hilos de la partida: fijación a CPU con
+ *              pthread_setaffinity_np, prioridad SCHED_FIFO opcional (si el sistema lo
+ *              permite) y mlockall. Incluye medición de jitter de ticks y frames y una
+ *              carga de fondo sintética para comparar con y sin ajustes.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "thread_tuning.h"
+#include "async_log.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+static ThreadTuning currentTuning;
+static mutex tuningMutex;
+static string tuningErrors;
+static bool memoryLocked = false;
+
+static vector<thread> loadThreads;
+static atomic<bool> loadRunning(false);
+
+static const char* ROLE_NAMES[] = {"physics", "input", "ai", "render"};
+
+int parseThreadTuningArg(int argc, char* argv[], int index, ThreadTuning& tuning) {
+    string arg = argv[index];
+    if (arg == "--mlockall") {
+        tuning.lockMemory = true;
+        return 1;
+    }
+    if (index + 1 >= argc) return 0;
+    if (arg == "--background-load") {
+        tuning.backgroundLoad = atoi(argv[index + 1]);
+        return 2;
+    }
+    for (int r = 0; r < static_cast<int>(ThreadRole::COUNT); r++) {
+        if (arg == string("--pin-") + ROLE_NAMES[r]) {
+            // CPU_SET fuera de cpu_set_t escribiría fuera del conjunto
+            char* end = nullptr;
+            long cpu = strtol(argv[index + 1], &end, 10);
+            if (end == argv[index + 1] || *end != '\0' || cpu < 0 || cpu >= CPU_SETSIZE) {
+                cerr << arg << ": CPU inválida '" << argv[index + 1] << "' (0.." << CPU_SETSIZE - 1 << ")\n";
+                return -1;
+            }
+            tuning.roles[r].cpu = static_cast<int>(cpu);
+            return 2;
+        }
+        if (arg == string("--fifo-") + ROLE_NAMES[r]) {
+            tuning.roles[r].fifoPriority = atoi(argv[index + 1]);
+            return 2;
+        }
+    }
+    return 0;
+}
+
+void setThreadTuning(const ThreadTuning& tuning) {
+    lock_guard<mutex> lock(tuningMutex);
+    currentTuning = tuning;
+    tuningErrors.clear();
+    if (tuning.lockMemory && !memoryLocked) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            memoryLocked = true;
+        } else {
+            tuningErrors += string("mlockall: ") + strerror(errno) + "; ";
+        }
+    }
+}
+
+const ThreadTuning& threadTuning() {
+    return currentTuning;
+}
+
+void applyThreadRole(ThreadRole role) {
+    RoleConfig config;
+    {
+        lock_guard<mutex> lock(tuningMutex);
+        config = currentTuning.roles[static_cast<int>(role)];
+    }
+
+    if (config.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(config.cpu, &set);
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rc != 0) {
+            lock_guard<mutex> lock(tuningMutex);
+            tuningErrors += string(ROLE_NAMES[static_cast<int>(role)]) + " cpu " +
+                            to_string(config.cpu) + ": " + strerror(rc) + "; ";
+            logWrite(LOG_WARN, "%s: no se pudo fijar la CPU %d: %s", ROLE_NAMES[static_cast<int>(role)], config.cpu,
+                     strerror(rc));
+        }
+    }
+    if (config.fifoPriority > 0) {
+        sched_param param;
+        param.sched_priority = config.fifoPriority;
+        int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (rc != 0) {
+            lock_guard<mutex> lock(tuningMutex);
+            tuningErrors += string(ROLE_NAMES[static_cast<int>(role)]) + " SCHED_FIFO: " + strerror(rc) + "; ";
+            logWrite(LOG_WARN, "%s: no se pudo usar SCHED_FIFO %d: %s", ROLE_NAMES[static_cast<int>(role)],
+                     config.fifoPriority, strerror(rc));
+        }
+    }
+}
+
+void noteThreadRoleIgnored(ThreadRole role, const char* reason) {
+    lock_guard<mutex> lock(tuningMutex);
+    const RoleConfig& config = currentTuning.roles[static_cast<int>(role)];
+    if (config.cpu < 0 && config.fifoPriority <= 0) return;
+    const char* name = ROLE_NAMES[static_cast<int>(role)];
+    tuningErrors += string(name) + " ignorado: " + reason + "; ";
+    logWrite(LOG_WARN, "%s: opciones ignoradas: %s", name, reason);
+}
+
+ScopedThreadRole::ScopedThreadRole(ThreadRole role) {
+    saved = pthread_getaffinity_np(pthread_self(), sizeof(savedCpus), &savedCpus) == 0 &&
+            pthread_getschedparam(pthread_self(), &savedPolicy, &savedParam) == 0;
+    applyThreadRole(role);
+}
+
+ScopedThreadRole::~ScopedThreadRole() {
+    if (!saved) return;
+    pthread_setschedparam(pthread_self(), savedPolicy, &savedParam);
+    pthread_setaffinity_np(pthread_self(), sizeof(savedCpus), &savedCpus);
+}
+
+string threadTuningSummary() {
+    lock_guard<mutex> lock(tuningMutex);
+    stringstream ss;
+    for (int r = 0; r < static_cast<int>(ThreadRole::COUNT); r++) {
+        const RoleConfig& c = currentTuning.roles[r];
+        ss << ROLE_NAMES[r] << "=";
+        if (c.cpu >= 0) ss << "cpu" << c.cpu;
+        else ss << "libre";
+        if (c.fifoPriority > 0) ss << "/fifo" << c.fifoPriority;
+        ss << " ";
+    }
+    ss << "mlock=" << (memoryLocked ? "si" : "no");
+    ss << " carga=" << currentTuning.backgroundLoad;
+    if (!tuningErrors.empty()) ss << "\nAvisos: " << tuningErrors;
+    return ss.str();
+}
+
+void startBackgroundLoad(int threads) {
+    stopBackgroundLoad();
+    loadRunning = true;
+    for (int i = 0; i < threads; i++) {
+        loadThreads.emplace_back([] {
+            volatile uint64_t sink = 0;
+            while (loadRunning.load(memory_order_relaxed)) {
+                for (int k = 0; k < 100000; k++) sink = sink + k;
+            }
+        });
+    }
+}
+
+void stopBackgroundLoad() {
+    loadRunning = false;
+    for (auto& t : loadThreads) t.join();
+    loadThreads.clear();
+}
+
+void measuredSleepUs(unsigned int micros, LatencyHistogram& jitter) {
+    uint64_t start = monotonicNowNs();
+    usleep(micros);
+    uint64_t slept = monotonicNowNs() - start;
+    uint64_t requested = static_cast<uint64_t>(micros) * 1000ULL;
+    jitter.record(slept > requested ? (slept - requested) / 1000 : 0);
+}
+
+void FrameJitterProbe::mark(LatencyHistogram& jitter) {
+    uint64_t now = monotonicNowNs();
+    if (last != 0) {
+        uint64_t interval = now - last;
+        uint64_t deviation = interval > period ? interval - period : period - interval;
+        jitter.record(deviation / 1000);
+    }
+    last = now;
+}
@@ -0,0 +1,332 @@
+/****************************************************
+ * Archivo: tournament.cpp
+ * Descripción: Motor de torneos entre perfiles de IA. Programa partidas sin terminal
+ *              (round-robin o sistema suizo) sobre WorkStealingPool, actualiza el Elo
+ *              a medida que llegan los resultados y guarda todo con una sola escritura
+ *              de HighScoreManager. Reporta partidas por segundo y eficiencia al escalar.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "tournament.h"
+#include "ai_profile.h"
+#include "highscores.h"
+#include "latency.h"
+#include "pong_sim.h"
+#include "rally_log.h"
+#include "step_kernel.h"
+#include "work_pool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct TournamentOptions {
+    string format = "rr";
+    int rounds = 5;             // solo suizo
+    int gamesPerPair = 2;       // solo round-robin (alterna lados)
+    int threads = 0;            // 0 = todos los núcleos
+    string rosterPath;
+    int targetScore = 5;
+    int maxTicks = 20000;
+    uint32_t seed = 2025;
+    bool scaling = false;
+    bool save = true;
+    // Archivo propio: en pong_highscores.txt (10 entradas) el torneo desplazaría
+    // los puntajes de las partidas jugadas y solo quedarían sus últimos resultados
+    string savePath = "pong_tournament.txt";
+    string rallyLogPath;        // vacío = sin registro de peloteos
+};
+
+struct MatchSpec {
+    int left;
+    int right;
+    uint32_t seed;
+};
+
+struct MatchResult {
+    int left;
+    int right;
+    int scoreLeft;
+    int scoreRight;
+    uint32_t ticks;
+};
+
+// Tabla de Elo compartida: se actualiza bajo mutex conforme terminan las partidas
+class EloTable {
+public:
+    static constexpr double INITIAL = 1500.0;
+    static constexpr double K = 24.0;
+
+    explicit EloTable(size_t players) : ratings(players, INITIAL), played(players, 0) {}
+
+    void apply(const MatchResult& result) {
+        lock_guard<mutex> lock(tableMutex);
+        double expected = 1.0 / (1.0 + pow(10.0, (ratings[result.right] - ratings[result.left]) / 400.0));
+        double actual = result.scoreLeft > result.scoreRight ? 1.0
+                      : result.scoreLeft < result.scoreRight ? 0.0 : 0.5;
+        ratings[result.left] += K * (actual - expected);
+        ratings[result.right] -= K * (actual - expected);
+        played[result.left]++;
+        played[result.right]++;
+        results.push_back(result);
+    }
+
+    vector<double> ratings;
+    vector<int> played;
+    vector<MatchResult> results;
+
+private:
+    mutex tableMutex;
+};
+
+static bool parseOptions(int argc, char* argv[], TournamentOptions& opts) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if (arg == "--format" && hasValue) opts.format = argv[++i];
+        else if (arg == "--rounds" && hasValue) opts.rounds = atoi(argv[++i]);
+        else if (arg == "--games" && hasValue) opts.gamesPerPair = atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue) opts.threads = atoi(argv[++i]);
+        else if (arg == "--roster" && hasValue) opts.rosterPath = argv[++i];
+        else if (arg == "--target" && hasValue) opts.targetScore = atoi(argv[++i]);
+        else if (arg == "--max-ticks" && hasValue) opts.maxTicks = atoi(argv[++i]);
+        else if (arg == "--seed" && hasValue) opts.seed = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (arg == "--scaling") opts.scaling = true;
+        else if (arg == "--no-save") opts.save = false;
+        else if (arg == "--save-to" && hasValue) opts.savePath = argv[++i];
+        else if (arg == "--rally-log" && hasValue) opts.rallyLogPath = argv[++i];
+        else {
+            cerr << "Opción no reconocida: " << arg << "\n";
+            return false;
+        }
+    }
+    if (opts.format != "rr" && opts.format != "swiss") {
+        cerr << "Formato desconocido: " << opts.format << " (usa rr o swiss)\n";
+        return false;
+    }
+    if (opts.threads <= 0) {
+        opts.threads = max(1u, thread::hardware_concurrency());
+    }
+    return true;
+}
+
+static MatchResult playMatch(const vector<AIProfile>& roster, const MatchSpec& spec,
+                             int targetScore, int maxTicks, RallyLog* rallyLog, uint32_t matchId) {
+    SimState state;
+    simInit(state, spec.seed);
+    const AIProfile& left = roster[spec.left];
+    const AIProfile& right = roster[spec.right];
+    uint32_t rng1 = aiSeed(spec.seed, 1);
+    uint32_t rng2 = aiSeed(spec.seed, 2);
+
+    if (rallyLog == nullptr) {
+        while (state.scoreP1 < targetScore && state.scoreP2 < targetScore &&
+               static_cast<int>(state.tick) < maxTicks) {
+            int move1 = aiDecide(left, state, 1, rng1);
+            int move2 = aiDecide(right, state, 2, rng2);
+            step(state, Inputs{move1, move2});
+        }
+        return {spec.left, spec.right, state.scoreP1, state.scoreP2, state.tick};
+    }
+
+    // Con registro: los eventos se juntan en columnas locales y se escriben por bloques
+    RallyColumns events;
+    RallyTracker tracker(matchId, true);
+    tracker.recordServe(state, events);
+    while (state.scoreP1 < targetScore && state.scoreP2 < targetScore &&
+           static_cast<int>(state.tick) < maxTicks) {
+        int move1 = aiDecide(left, state, 1, rng1);
+        int move2 = aiDecide(right, state, 2, rng2);
+        World before = state;
+        int scorer = step(state, Inputs{move1, move2});
+        tracker.observe(before, state, scorer, events);
+        if (events.size() >= RallyLog::BLOCK_EVENTS) {
+            rallyLog->appendBatched(events);
+            events.clear();
+        }
+    }
+    // Las partidas del torneo son cortas: comparten bloques en lugar de rellenar uno cada una
+    rallyLog->appendBatched(events);
+    return {spec.left, spec.right, state.scoreP1, state.scoreP2, state.tick};
+}
+
+static vector<MatchSpec> roundRobinSchedule(int players, int gamesPerPair, uint32_t seed) {
+    vector<MatchSpec> schedule;
+    uint32_t matchSeed = seed;
+    for (int a = 0; a < players; a++) {
+        for (int b = a + 1; b < players; b++) {
+            for (int g = 0; g < gamesPerPair; g++) {
+                matchSeed = matchSeed * 1664525u + 1013904223u;
+                if (g % 2 == 0) schedule.push_back({a, b, matchSeed});
+                else schedule.push_back({b, a, matchSeed});
+            }
+        }
+    }
+    return schedule;
+}
+
+// Emparejamiento suizo: ordenar por Elo y emparejar vecinos evitando revanchas
+static vector<MatchSpec> swissRound(const EloTable& table, set<pair<int, int>>& history,
+                                    int round, uint32_t seed) {
+    int players = static_cast<int>(table.ratings.size());
+    vector<int> order(players);
+    for (int i = 0; i < players; i++) order[i] = i;
+    stable_sort(order.begin(), order.end(), [&table](int a, int b) {
+        return table.ratings[a] > table.ratings[b];
+    });
+
+    vector<bool> paired(players, false);
+    vector<MatchSpec> schedule;
+    uint32_t matchSeed = seed + static_cast<uint32_t>(round) * 7919u;
+    for (int i = 0; i < players; i++) {
+        int a = order[i];
+        if (paired[a]) continue;
+        int opponent = -1;
+        for (int j = i + 1; j < players; j++) {
+            int b = order[j];
+            if (paired[b]) continue;
+            if (opponent < 0) opponent = b;
+            if (!history.count({min(a, b), max(a, b)})) {
+                opponent = b;
+                break;
+            }
+        }
+        if (opponent < 0) continue;     // número impar: descanso
+        paired[a] = paired[opponent] = true;
+        history.insert({min(a, opponent), max(a, opponent)});
+        matchSeed = matchSeed * 1664525u + 1013904223u;
+        if (round % 2 == 0) schedule.push_back({a, opponent, matchSeed});
+        else schedule.push_back({opponent, a, matchSeed});
+    }
+    return schedule;
+}
+
+// Corre el torneo completo con N hilos y devuelve el tiempo en segundos
+static double runWithThreads(const vector<AIProfile>& roster, const TournamentOptions& opts,
+                             int threads, EloTable& table, RallyLog* rallyLog) {
+    WorkStealingPool pool(threads);
+    uint64_t start = monotonicNowNs();
+    auto runBatch = [&](const vector<MatchSpec>& batch) {
+        for (const MatchSpec& spec : batch) {
+            uint32_t matchId = rallyLog != nullptr ? rallyLog->nextMatchId() : 0;
+            pool.submit([&roster, &opts, &table, rallyLog, spec, matchId] {
+                table.apply(playMatch(roster, spec, opts.targetScore, opts.maxTicks, rallyLog, matchId));
+            });
+        }
+        pool.waitIdle();
+    };
+
+    if (opts.format == "rr") {
+        runBatch(roundRobinSchedule(static_cast<int>(roster.size()), opts.gamesPerPair, opts.seed));
+    } else {
+        set<pair<int, int>> history;
+        for (int round = 0; round < opts.rounds; round++) {
+            runBatch(swissRound(table, history, round, opts.seed));
+        }
+    }
+
+    return (monotonicNowNs() - start) / 1e9;
+}
+
+static void printStandings(const vector<AIProfile>& roster, const EloTable& table) {
+    vector<int> order(roster.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = static_cast<int>(i);
+    sort(order.begin(), order.end(), [&table](int a, int b) {
+        return table.ratings[a] > table.ratings[b];
+    });
+
+    cout << left << setw(5) << "#" << setw(15) << "Perfil" << setw(10) << "Elo" << "Partidas\n";
+    cout << "----------------------------------------\n";
+    for (size_t i = 0; i < order.size(); i++) {
+        int p = order[i];
+        cout << left << setw(5) << (i + 1) << setw(15) << roster[p].name
+             << setw(10) << fixed << setprecision(1) << table.ratings[p]
+             << table.played[p] << "\n";
+    }
+}
+
+int runTournament(int argc, char* argv[]) {
+    TournamentOptions opts;
+    if (!parseOptions(argc, argv, opts)) return 2;
+
+    vector<AIProfile> roster = defaultRoster();
+    if (!opts.rosterPath.empty() && !loadRoster(opts.rosterPath, roster)) {
+        cerr << "No se pudo leer el roster: " << opts.rosterPath << "\n";
+        return 1;
+    }
+    if (roster.size() < 2) {
+        cerr << "Se necesitan al menos dos perfiles\n";
+        return 1;
+    }
+
+    cout << "========================================\n";
+    cout << "             TORNEO DE IA               \n";
+    cout << "========================================\n";
+    cout << "Formato: " << (opts.format == "rr" ? "round-robin" : "suizo")
+         << "  perfiles: " << roster.size() << "  hilos: " << opts.threads << "\n\n";
+
+    RallyLog rallyLog;
+    if (!opts.rallyLogPath.empty() && !rallyLog.open(opts.rallyLogPath)) {
+        cerr << "No se pudo abrir el registro de peloteos: " << opts.rallyLogPath << "\n";
+        return 1;
+    }
+
+    EloTable table(roster.size());
+    double seconds = runWithThreads(roster, opts, opts.threads, table,
+                                    rallyLog.isOpen() ? &rallyLog : nullptr);
+    size_t matches = table.results.size();
+
+    printStandings(roster, table);
+    cout << "\nPartidas: " << matches << " en " << setprecision(3) << seconds << " s ("
+         << setprecision(1) << (matches / seconds) << " partidas/s)\n";
+    if (rallyLog.isOpen()) {
+        rallyLog.flush();
+        cout << "Peloteos: " << rallyLog.eventsWritten() << " eventos en " << opts.rallyLogPath
+             << " (./Pong --rally-stats " << opts.rallyLogPath << ")\n";
+        rallyLog.close();
+    }
+
+    if (opts.scaling) {
+        cout << "\nEscalamiento (mismo calendario):\n";
+        cout << left << setw(8) << "Hilos" << setw(16) << "Partidas/s" << "Eficiencia\n";
+        vector<int> counts;
+        for (int threads = 1; threads < opts.threads; threads *= 2) counts.push_back(threads);
+        counts.push_back(opts.threads);
+
+        double baseRate = 0.0;
+        for (int threads : counts) {
+            EloTable scratch(roster.size());
+            double t = runWithThreads(roster, opts, threads, scratch, nullptr);
+            double rate = scratch.results.size() / t;
+            if (threads == 1) baseRate = rate;
+            cout << left << setw(8) << threads << setw(16) << setprecision(1) << rate
+                 << setprecision(0) << (100.0 * rate / (baseRate * threads)) << "%\n";
+        }
+    }
+
+    if (opts.save) {
+        vector<HighScore> scores;
+        scores.reserve(matches);
+        for (const MatchResult& r : table.results) {
+            scores.push_back({roster[r.left].name, roster[r.right].name, r.scoreLeft, r.scoreRight, ""});
+        }
+        // Capacidad para el torneo completo: la fusión recorta solo torneos anteriores
+        HighScoreManager manager(opts.savePath, scores.size());
+        manager.addScores(scores);
+        cout << "Resultados guardados en " << opts.savePath << " (" << scores.size() << " partidas, una escritura)\n";
+    }
+    return 0;
+}
@@ -15,9 +15,23 @@
 #include <termios.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <cstdio>
 
+// stdin sin buffer de stdio: así poll() ve exactamente lo que falta por leer
+static void unbufferStdin() {
+    static bool done = false;
+    if (!done) {
+        setvbuf(stdin, nullptr, _IONBF, 0);
+        done = true;
+    }
+}
+
+static struct termios savedInputMode;
+static bool rawInputActive = false;
+
 int getch(void) {
+    unbufferStdin();
     struct termios oldt, newt;
     int ch;
     tcgetattr(STDIN_FILENO, &oldt);
@@ -29,29 +43,39 @@ int getch(void) {
     return ch;
 }
 
+// No cambia O_NONBLOCK: stdin comparte descripción con stdout y una escritura de
+// frame en ese instante fallaría con EAGAIN.
 int kbhit(void) {
+    unbufferStdin();
     struct termios oldt, newt;
-    int ch;
-    int oldf;
 
     tcgetattr(STDIN_FILENO, &oldt);
     newt = oldt;
     newt.c_lflag &= ~(ICANON | ECHO);
     tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-    oldf = fcntl(STDIN_FILENO, F_GETFL, 0);
-    fcntl(STDIN_FILENO, F_SETFL, oldf | O_NONBLOCK);
 
-    ch = getchar();
+    struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+    int ready = poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN);
 
     tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
-    fcntl(STDIN_FILENO, F_SETFL, oldf);
+    return ready;
+}
 
-    if (ch != EOF) {
-        ungetc(ch, stdin);
-        return 1;
-    }
+// Durante la partida la terminal queda sin eco ni modo canónico: las teclas no se
+// imprimen encima de la cancha entre una lectura y otra
+void enterRawInput(void) {
+    if (rawInputActive) return;
+    if (tcgetattr(STDIN_FILENO, &savedInputMode) != 0) return;
+    struct termios raw = savedInputMode;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    rawInputActive = true;
+}
 
-    return 0;
+void leaveRawInput(void) {
+    if (!rawInputActive) return;
+    tcsetattr(STDIN_FILENO, TCSANOW, &savedInputMode);
+    rawInputActive = false;
 }
 
 void gotoxy(int x, int y) {
@@ -0,0 +1,121 @@
+/****************************************************
+ * Archivo: work_pool.cpp
+ * Descripción: Pool de hilos con robo de trabajo usado para correr muchas partidas
+ *              sin terminal en paralelo. Las tareas enviadas desde un hilo del pool
+ *              van a su propia cola; las externas se reparten en round-robin.
+ * - Marian Olivares
+ * - Marcela Ordoñez
+ * - Biancka Raxón
+ * - Diana Sosa
+ *
+ * Fecha: Septiembre de 2025
+ ****************************************************/
+
+#include "work_pool.h"
+
+using namespace std;
+
+// Índice del hilo del pool que ejecuta el código actual (-1 si es externo)
+static thread_local int currentWorker = -1;
+static thread_local const WorkStealingPool* currentPool = nullptr;
+
+WorkStealingPool::WorkStealingPool(int numWorkers)
+    : queued(0), unfinished(0), stopping(false), nextQueue(0), steals(0) {
+    if (numWorkers < 1) numWorkers = 1;
+    for (int i = 0; i < numWorkers; i++) {
+        queues.push_back(unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    for (int i = 0; i < numWorkers; i++) {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    waitIdle();
+    {
+        lock_guard<mutex> lock(stateMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+int WorkStealingPool::size() const {
+    return static_cast<int>(workers.size());
+}
+
+uint64_t WorkStealingPool::stealCount() const {
+    return steals.load();
+}
+
+void WorkStealingPool::submit(function<void()> task) {
+    int target;
+    if (currentPool == this && currentWorker >= 0) {
+        target = currentWorker;
+    } else {
+        target = static_cast<int>(nextQueue++ % queues.size());
+    }
+
+    unfinished++;
+    {
+        lock_guard<mutex> lock(queues[target]->queueMutex);
+        queues[target]->tasks.push_back(move(task));
+    }
+    {
+        lock_guard<mutex> lock(stateMutex);
+        queued++;
+    }
+    workAvailable.notify_one();
+}
+
+void WorkStealingPool::waitIdle() {
+    unique_lock<mutex> lock(stateMutex);
+    allDone.wait(lock, [this] { return unfinished.load() == 0; });
+}
+
+bool WorkStealingPool::popLocal(int id, function<void()>& task) {
+    WorkerQueue& own = *queues[id];
+    lock_guard<mutex> lock(own.queueMutex);
+    if (own.tasks.empty()) return false;
+    task = move(own.tasks.back());
+    own.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(int id, function<void()>& task) {
+    int n = static_cast<int>(queues.size());
+    for (int offset = 1; offset < n; offset++) {
+        WorkerQueue& victim = *queues[(id + offset) % n];
+        lock_guard<mutex> lock(victim.queueMutex);
+        if (victim.tasks.empty()) continue;
+        task = move(victim.tasks.front());
+        victim.tasks.pop_front();
+        steals++;
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(int id) {
+    currentWorker = id;
+    currentPool = this;
+
+    while (true) {
+        function<void()> task;
+        if (popLocal(id, task) || steal(id, task)) {
+            queued--;
+            task();
+            if (--unfinished == 0) {
+                lock_guard<mutex> lock(stateMutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        unique_lock<mutex> lock(stateMutex);
+        workAvailable.wait(lock, [this] { return stopping.load() || queued.load() > 0; });
+        if (stopping && queued.load() == 0) break;
+    }
+}